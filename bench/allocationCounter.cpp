@@ -0,0 +1,106 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Benchmark Suit
+ *	@file		bench/allocationCounter.cpp
+ *	@brief		Heap allocation counting for benchmarks.
+ *
+ * When linked with --wrap=malloc,--wrap=calloc,--wrap=realloc (SOLACE_BENCH_WRAP_MALLOC),
+ * every malloc call made by the library and by the benchmarks is counted.
+ * Otherwise only allocations made via operator new are counted.
+ ******************************************************************************/
+#include "benchmark.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+using namespace Solace;
+
+
+namespace {
+
+std::atomic<uint64> gAllocationCount{0};
+std::atomic<uint64> gAllocatedBytes{0};
+
+inline void countAllocation(size_t nbBytes) noexcept {
+	gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+	gAllocatedBytes.fetch_add(nbBytes, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+
+uint64
+Solace::bench::allocationCount() noexcept {
+	return gAllocationCount.load(std::memory_order_relaxed);
+}
+
+
+uint64
+Solace::bench::allocatedBytes() noexcept {
+	return gAllocatedBytes.load(std::memory_order_relaxed);
+}
+
+
+#ifdef SOLACE_BENCH_WRAP_MALLOC
+
+extern "C" {
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t nmemb, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+	countAllocation(size);
+	return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t nmemb, size_t size) {
+	countAllocation(nmemb * size);
+	return __real_calloc(nmemb, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+	countAllocation(size);
+	return __real_realloc(ptr, size);
+}
+
+}  // extern "C"
+
+#endif  // SOLACE_BENCH_WRAP_MALLOC
+
+
+void* operator new(size_t size) {
+#ifndef SOLACE_BENCH_WRAP_MALLOC
+	countAllocation(size);
+#endif
+
+	if (auto ptr = malloc(size ? size : 1)) {
+		return ptr;
+	}
+
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	free(ptr);
+}
@@ -0,0 +1,92 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Benchmark Suit
+ *	@file		bench/bench_byteReader.cpp
+ *	@brief		Benchmarks of ByteReader read loops, dominated by the cost of returning Result<void, Error>.
+ ******************************************************************************/
+#include "benchmark.hpp"
+
+#include <solace/byteReader.hpp>
+
+
+using namespace Solace;
+using namespace Solace::bench;
+
+
+namespace {
+
+/// Buffer sizes in bytes: from a small message to a large read buffer.
+constexpr uint64 kSizes[] = {256, 4096, 65536};
+
+constexpr uint64 kBufferSize = 65536;
+
+
+MemoryView buffer(uint64 size) noexcept {
+	static byte data[kBufferSize];
+	static bool const isInitialized = [] {
+		uint32 seed = 0x2545F491;
+		for (auto& b : data) {
+			seed = seed * 1664525 + 1013904223;
+			b = static_cast<byte>(seed >> 24);
+		}
+		return true;
+	}();
+	doNotOptimize(isInitialized);
+
+	return wrapMemory(data, size);
+}
+
+
+template <typename T>
+void readAll(State& state) {
+	ByteReader reader{buffer(state.arg())};
+	state.resetTimer();
+
+	for (auto i = state.iterations(); i; --i) {
+		reader.rewind();
+
+		T value{};
+		T total{};
+		while (reader.read(&value)) {
+			total += value;
+		}
+		doNotOptimize(total);
+	}
+}
+SOLACE_BENCHMARK("ByteReader/read/uint8", readAll<uint8>, kSizes);
+SOLACE_BENCHMARK("ByteReader/read/uint32", readAll<uint32>, kSizes);
+SOLACE_BENCHMARK("ByteReader/read/uint64", readAll<uint64>, kSizes);
+
+
+void readBigEndian(State& state) {
+	ByteReader reader{buffer(state.arg())};
+	state.resetTimer();
+
+	for (auto i = state.iterations(); i; --i) {
+		reader.rewind();
+
+		uint32 value = 0;
+		uint32 total = 0;
+		while (reader.readBE(value)) {
+			total += value;
+		}
+		doNotOptimize(total);
+	}
+}
+SOLACE_BENCHMARK("ByteReader/readBE/uint32", readBigEndian, kSizes);
+
+}  // namespace
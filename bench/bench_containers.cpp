@@ -0,0 +1,132 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Benchmark Suit
+ *	@file		bench/bench_containers.cpp
+ *	@brief		Benchmarks of Vector and Dictionary operations.
+ ******************************************************************************/
+#include "benchmark.hpp"
+#include "randomSequence.hpp"
+
+#include <solace/vector.hpp>
+#include <solace/dictionary.hpp>
+
+
+using namespace Solace;
+using namespace Solace::bench;
+
+
+namespace {
+
+/// Number of elements in a container.
+constexpr uint64 kVectorSizes[] = {16, 1024, 65536};
+constexpr uint64 kDictionarySizes[] = {10, 100, 1000, 10000, 100000, 1000000};
+
+
+struct Record {
+	uint64	id;
+	uint32	flags;
+	uint32	size;
+	char	tag[16];
+
+	Record(uint64 anId, uint32 someFlags, uint32 aSize) noexcept
+		: id{anId}
+		, flags{someFlags}
+		, size{aSize}
+		, tag{}
+	{}
+};
+
+
+/// Dictionary of the given size. Large ones exceed the capacity of the system heap manager, so use a dedicated one.
+Dictionary<uint64, Record>
+makeRecords(MemoryManager& memoryManager, uint64 nbKeys, uint64 keyStride) {
+	auto dictionary = makeDictionary<uint64, Record>(
+				memoryManager.allocate(nbKeys * sizeof(uint64)).unwrap(),
+				memoryManager.allocate(nbKeys * sizeof(Record)).unwrap()).unwrap();
+
+	for (uint64 key = 0; key < nbKeys; ++key) {
+		dictionary.put(key * keyStride, key, 0U, 0U);
+	}
+
+	return dictionary;
+}
+
+
+/// Pseudo-random sequence of lookup keys
+inline uint64 nextKey(uint64& seed, uint64 nbKeys) noexcept {
+	return nextRandom(seed) % nbKeys;
+}
+
+
+void vectorEmplaceBack(State& state) {
+	auto const capacity = static_cast<Vector<Record>::size_type>(state.arg());
+	auto vector = makeVector<Record>(capacity).unwrap();
+	state.resetTimer();
+
+	for (auto i = state.iterations(); i; --i) {
+		if (vector.full()) {
+			vector.clear();
+		}
+
+		doNotOptimize(vector.emplace_back(i, 0U, 16U));
+	}
+}
+SOLACE_BENCHMARK("Vector/emplace_back", vectorEmplaceBack, kVectorSizes);
+
+
+void vectorCreate(State& state) {
+	auto const capacity = static_cast<Vector<Record>::size_type>(state.arg());
+	state.resetTimer();
+
+	for (auto i = state.iterations(); i; --i) {
+		auto vector = makeVector<Record>(capacity);
+		doNotOptimize(vector);
+	}
+}
+SOLACE_BENCHMARK("Vector/make", vectorCreate, kVectorSizes);
+
+
+void dictionaryFind(State& state) {
+	auto const nbKeys = state.arg();
+	MemoryManager memoryManager{nbKeys * (sizeof(uint64) + sizeof(Record))};
+	auto dictionary = makeRecords(memoryManager, nbKeys, 7919);
+
+	uint64 seed = 42;
+	state.resetTimer();
+
+	for (auto i = state.iterations(); i; --i) {
+		doNotOptimize(dictionary.find(nextKey(seed, nbKeys) * 7919));
+	}
+}
+SOLACE_BENCHMARK("Dictionary/find", dictionaryFind, kDictionarySizes);
+
+
+void dictionaryFindMissing(State& state) {
+	auto const nbKeys = state.arg();
+	MemoryManager memoryManager{nbKeys * (sizeof(uint64) + sizeof(Record))};
+	auto dictionary = makeRecords(memoryManager, nbKeys, 2);
+
+	uint64 seed = 42;
+	state.resetTimer();
+
+	for (auto i = state.iterations(); i; --i) {
+		doNotOptimize(dictionary.find(nextKey(seed, nbKeys) * 2 + 1));
+	}
+}
+SOLACE_BENCHMARK("Dictionary/find/missing", dictionaryFindMissing, kDictionarySizes);
+
+}  // namespace
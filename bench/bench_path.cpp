@@ -0,0 +1,84 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Benchmark Suit
+ *	@file		bench/bench_path.cpp
+ *	@brief		Benchmarks of Path parsing and normalization.
+ ******************************************************************************/
+#include "benchmark.hpp"
+
+#include <solace/path.hpp>
+
+#include <cstdio>
+
+
+using namespace Solace;
+using namespace Solace::bench;
+
+
+namespace {
+
+/// Number of path components: from a typical file path to a deep generated tree.
+constexpr uint64 kDepths[] = {2, 8, 32, 128};
+
+constexpr uint32 kMaxPathSize = 128 * 16;
+
+
+/**
+ * Absolute path of the given depth, such as "/usr/component-01/./component-02/../component-03".
+ * Every third component is a self reference and every fifth is a parent reference.
+ */
+StringView deepPath(char (&buffer)[kMaxPathSize], uint64 depth) noexcept {
+	uint32 size = 0;
+	for (uint64 i = 0; i < depth; ++i) {
+		auto const written = (i % 3 == 2)
+				? snprintf(buffer + size, kMaxPathSize - size, "/.")
+				: (i % 5 == 4)
+				  ? snprintf(buffer + size, kMaxPathSize - size, "/..")
+				  : snprintf(buffer + size, kMaxPathSize - size, "/component-%02u", static_cast<unsigned>(i));
+		size += static_cast<uint32>(written);
+	}
+
+	return StringView{buffer, static_cast<StringView::size_type>(size)};
+}
+
+
+void parse(State& state) {
+	char buffer[kMaxPathSize];
+	auto const str = deepPath(buffer, state.arg());
+	state.resetTimer();
+
+	for (auto i = state.iterations(); i; --i) {
+		auto path = Path::parse(str);
+		doNotOptimize(path);
+	}
+}
+SOLACE_BENCHMARK("Path/parse", parse, kDepths);
+
+
+void normalize(State& state) {
+	char buffer[kMaxPathSize];
+	auto const path = Path::parse(deepPath(buffer, state.arg())).unwrap();
+	state.resetTimer();
+
+	for (auto i = state.iterations(); i; --i) {
+		auto normalized = path.normalize();
+		doNotOptimize(normalized);
+	}
+}
+SOLACE_BENCHMARK("Path/normalize", normalize, kDepths);
+
+}  // namespace
@@ -0,0 +1,166 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Benchmark Suit
+ *	@file		bench/bench_string.cpp
+ *	@brief		Benchmarks of StringView search, split and hashing, and of String creation.
+ ******************************************************************************/
+#include "benchmark.hpp"
+
+#include <solace/stringView.hpp>
+#include <solace/string.hpp>
+
+
+using namespace Solace;
+using namespace Solace::bench;
+
+
+namespace {
+
+/// String lengths: from short identifiers to large text blocks.
+constexpr uint64 kLengths[] = {16, 256, 4096, 32768};
+
+constexpr StringView::size_type kTextSize = 32768;
+
+
+/// Text of random lowercase words separated by spaces and commas.
+StringView text(uint64 length) noexcept {
+	static char buffer[kTextSize];
+	static bool const isInitialized = [] {
+		uint32 seed = 0x2545F491;
+		uint32 wordLength = 0;
+		for (auto& c : buffer) {
+			seed = seed * 1664525 + 1013904223;
+			if (wordLength > 2 && (seed >> 28) < 3) {
+				c = ((seed >> 24) & 1) ? ' ' : ',';
+				wordLength = 0;
+			} else {
+				c = static_cast<char>('a' + (seed >> 16) % 26);
+				wordLength += 1;
+			}
+		}
+		return true;
+	}();
+	doNotOptimize(isInitialized);
+
+	return StringView{buffer, static_cast<StringView::size_type>(length)};
+}
+
+
+void indexOfChar(State& state) {
+	auto const str = text(state.arg());
+	state.resetTimer();
+
+	// Character not in the text: scan the whole string
+	for (auto i = state.iterations(); i; --i) {
+		doNotOptimize(str.indexOf('#'));
+	}
+}
+SOLACE_BENCHMARK("StringView/indexOf/char", indexOfChar, kLengths);
+
+
+void indexOfString(State& state) {
+	auto const str = text(state.arg());
+	auto const needle = str.substring(str.size() - 4);
+	state.resetTimer();
+
+	for (auto i = state.iterations(); i; --i) {
+		doNotOptimize(str.indexOf(needle));
+	}
+}
+SOLACE_BENCHMARK("StringView/indexOf/string", indexOfString, kLengths);
+
+
+void indexOfEach(State& state) {
+	auto const str = text(state.arg());
+	state.resetTimer();
+
+	// Find every separator: a loop over Optional results
+	for (auto i = state.iterations(); i; --i) {
+		StringView::size_type count = 0;
+		for (auto index = str.indexOf(' '); index; index = str.indexOf(' ', *index + 1)) {
+			count += 1;
+		}
+		doNotOptimize(count);
+	}
+}
+SOLACE_BENCHMARK("StringView/indexOf/each", indexOfEach, kLengths);
+
+
+void splitChar(State& state) {
+	auto const str = text(state.arg());
+	state.resetTimer();
+
+	for (auto i = state.iterations(); i; --i) {
+		StringView::size_type total = 0;
+		str.split(' ', [&total](StringView segment) { total += segment.size(); });
+		doNotOptimize(total);
+	}
+}
+SOLACE_BENCHMARK("StringView/split/char", splitChar, kLengths);
+
+
+void splitString(State& state) {
+	auto const str = text(state.arg());
+	state.resetTimer();
+
+	for (auto i = state.iterations(); i; --i) {
+		StringView::size_type total = 0;
+		str.split(StringView{", "}, [&total](StringView segment) { total += segment.size(); });
+		doNotOptimize(total);
+	}
+}
+SOLACE_BENCHMARK("StringView/split/string", splitString, kLengths);
+
+
+void hashCode(State& state) {
+	auto const str = text(state.arg());
+	state.resetTimer();
+
+	for (auto i = state.iterations(); i; --i) {
+		doNotOptimize(str.hashCode());
+	}
+}
+SOLACE_BENCHMARK("StringView/hashCode", hashCode, kLengths);
+
+
+void makeStringFromView(State& state) {
+	auto const str = text(state.arg());
+	state.resetTimer();
+
+	for (auto i = state.iterations(); i; --i) {
+		auto result = makeString(str);
+		doNotOptimize(result);
+	}
+}
+SOLACE_BENCHMARK("String/make", makeStringFromView, kLengths);
+
+
+void makeStringConcat(State& state) {
+	auto const str = text(state.arg());
+	auto const half = str.size() / 2;
+	auto const head = str.substring(0, half);
+	auto const tail = str.substring(half);
+	state.resetTimer();
+
+	for (auto i = state.iterations(); i; --i) {
+		auto result = makeString(head, "/", tail);
+		doNotOptimize(result);
+	}
+}
+SOLACE_BENCHMARK("String/concat", makeStringConcat, kLengths);
+
+}  // namespace
@@ -0,0 +1,216 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Benchmark Suit
+ *	@file		bench/benchmark.cpp
+ *	@brief		Benchmark runner: registry, iteration calibration and JSON report.
+ ******************************************************************************/
+#include "benchmark.hpp"
+
+#include <solace/version.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+using namespace Solace;
+using namespace Solace::bench;
+
+
+namespace {
+
+constexpr uint32 kMaxBenchmarks = 512;
+
+struct BenchmarkEntry {
+	char const*			name;
+	BenchmarkFunction	function;
+	uint64				arg;
+	bool				hasArg;
+};
+
+struct Registry {
+	BenchmarkEntry	entries[kMaxBenchmarks];
+	uint32			size{0};
+};
+
+Registry& registry() noexcept {
+	static Registry instance;
+	return instance;
+}
+
+
+struct Options {
+	char const*		filter{nullptr};
+	char const*		jsonPath{nullptr};
+	uint64			minTimeNs{200 * 1000 * 1000};
+	uint64			maxIterations{1000 * 1000 * 1000};
+};
+
+
+struct Measurement {
+	uint64	iterations;
+	double	nsPerOp;
+	double	allocationsPerOp;
+	double	bytesPerOp;
+};
+
+
+void formatName(char* buffer, size_t size, BenchmarkEntry const& entry) noexcept {
+	if (entry.hasArg) {
+		snprintf(buffer, size, "%s/%llu", entry.name, static_cast<unsigned long long>(entry.arg));  // NOLINT
+	} else {
+		snprintf(buffer, size, "%s", entry.name);
+	}
+}
+
+
+/// Run a benchmark with increasing number of iterations until it takes at least the minimal time.
+Measurement run(BenchmarkEntry const& entry, Options const& options) {
+	uint64 iterations = 1;
+	while (true) {
+		State state{iterations, entry.arg};
+		entry.function(state);
+		if (!state.isStopped()) {
+			state.stopTimer();
+		}
+
+		auto const elapsedNs = static_cast<uint64>(
+					std::chrono::duration_cast<std::chrono::nanoseconds>(state.elapsed()).count());
+		if (elapsedNs >= options.minTimeNs || iterations >= options.maxIterations) {
+			auto const n = static_cast<double>(iterations);
+			return {iterations,
+					static_cast<double>(elapsedNs) / n,
+					static_cast<double>(state.allocations()) / n,
+					static_cast<double>(state.bytes()) / n};
+		}
+
+		// Estimate iterations needed to reach the minimal time, but grow by at most 10x at a time
+		auto const scale = (elapsedNs == 0)
+				? 10.0
+				: 1.4 * static_cast<double>(options.minTimeNs) / static_cast<double>(elapsedNs);
+		auto const next = static_cast<uint64>(static_cast<double>(iterations) * (scale < 10.0 ? scale : 10.0));
+		iterations = (next > iterations) ? next : iterations + 1;
+		if (iterations > options.maxIterations) {
+			iterations = options.maxIterations;
+		}
+	}
+}
+
+
+void writeJsonString(FILE* out, char const* str) {
+	fputc('"', out);
+	for (; *str; ++str) {
+		if (*str == '"' || *str == '\\') {
+			fputc('\\', out);
+		}
+		fputc(*str, out);
+	}
+	fputc('"', out);
+}
+
+
+bool parseOptions(int argc, char** argv, Options& options) {
+	for (int i = 1; i < argc; ++i) {
+		char const* arg = argv[i];
+		if (strncmp(arg, "--filter=", 9) == 0) {
+			options.filter = arg + 9;
+		} else if (strncmp(arg, "--json=", 7) == 0) {
+			options.jsonPath = arg + 7;
+		} else if (strncmp(arg, "--min-time-ms=", 14) == 0) {
+			options.minTimeNs = strtoull(arg + 14, nullptr, 10) * 1000 * 1000;
+		} else if (strncmp(arg, "--max-iterations=", 17) == 0) {
+			options.maxIterations = strtoull(arg + 17, nullptr, 10);
+		} else {
+			fprintf(stderr, "Usage: %s [--filter=SUBSTRING] [--json=FILE] [--min-time-ms=N] [--max-iterations=N]\n",
+					argv[0]);
+			return false;
+		}
+	}
+
+	if (options.maxIterations == 0) {
+		options.maxIterations = 1;
+	}
+
+	return true;
+}
+
+}  // namespace
+
+
+bool
+Solace::bench::registerBenchmark(char const* name, BenchmarkFunction function,
+								 uint64 const* args, uint32 nbArgs) noexcept {
+	auto& reg = registry();
+	for (uint32 i = 0; i < (nbArgs ? nbArgs : 1) && reg.size < kMaxBenchmarks; ++i) {
+		reg.entries[reg.size++] = BenchmarkEntry{name, function, nbArgs ? args[i] : 0, nbArgs != 0};
+	}
+
+	return true;
+}
+
+
+int main(int argc, char** argv) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) {
+		return EXIT_FAILURE;
+	}
+
+	FILE* json = stdout;
+	if (options.jsonPath) {
+		json = fopen(options.jsonPath, "w");
+		if (!json) {
+			perror(options.jsonPath);
+			return EXIT_FAILURE;
+		}
+	}
+
+	auto const version = getBuildVersion();
+	fprintf(json, "{\n  \"library\": \"solace\",\n  \"version\": \"%u.%u.%u\",\n  \"benchmarks\": [",
+			version.majorNumber, version.minorNumber, version.patchNumber);
+
+	fprintf(stderr, "%-48s %14s %14s %12s %14s\n", "Benchmark", "Iterations", "ns/op", "allocs/op", "bytes/op");
+
+	char name[256];
+	bool isFirst = true;
+	auto const& reg = registry();
+	for (uint32 i = 0; i < reg.size; ++i) {
+		auto const& entry = reg.entries[i];
+		formatName(name, sizeof(name), entry);
+		if (options.filter && !strstr(name, options.filter)) {
+			continue;
+		}
+
+		auto const m = run(entry, options);
+		fprintf(stderr, "%-48s %14llu %14.2f %12.2f %14.2f\n", name,
+				static_cast<unsigned long long>(m.iterations),  // NOLINT
+				m.nsPerOp, m.allocationsPerOp, m.bytesPerOp);
+
+		fprintf(json, "%s\n    {\"name\": ", isFirst ? "" : ",");
+		writeJsonString(json, name);
+		fprintf(json, ", \"iterations\": %llu, \"ns_per_op\": %.3f, \"allocs_per_op\": %.3f, \"bytes_per_op\": %.3f}",
+				static_cast<unsigned long long>(m.iterations),  // NOLINT
+				m.nsPerOp, m.allocationsPerOp, m.bytesPerOp);
+		isFirst = false;
+	}
+
+	fprintf(json, "\n  ]\n}\n");
+	if (json != stdout) {
+		fclose(json);
+	}
+
+	return EXIT_SUCCESS;
+}
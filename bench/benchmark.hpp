@@ -0,0 +1,139 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Benchmark Suit
+ *	@file		bench/benchmark.hpp
+ *	@brief		Minimal benchmark harness measuring time and allocations per operation.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_BENCH_BENCHMARK_HPP
+#define SOLACE_BENCH_BENCHMARK_HPP
+
+#include <solace/types.hpp>
+
+#include <chrono>
+
+
+namespace Solace {
+namespace bench {
+
+/// @return Number of heap allocations made by the process so far.
+uint64 allocationCount() noexcept;
+
+/// @return Number of bytes requested from the heap by the process so far.
+uint64 allocatedBytes() noexcept;
+
+
+/**
+ * State of a single benchmark run.
+ * A benchmark function is expected to perform the measured operation iterations() times.
+ * Any setup preceding the measured loop is excluded by calling resetTimer() once it is done.
+ */
+class State {
+public:
+	using Clock = std::chrono::steady_clock;
+
+public:
+	State(uint64 iterations, uint64 arg) noexcept
+		: _iterations{iterations}
+		, _arg{arg}
+	{
+		resetTimer();
+	}
+
+	/// @return Number of times the measured operation has to be performed.
+	uint64 iterations() const noexcept { return _iterations; }
+
+	/// @return Size parameter of the benchmark, such as a number of elements in a container.
+	uint64 arg() const noexcept { return _arg; }
+
+	/// Restart time and allocation measurement, excluding everything done so far.
+	void resetTimer() noexcept {
+		_startAllocations = allocationCount();
+		_startBytes = allocatedBytes();
+		_start = Clock::now();
+	}
+
+	/// Stop time and allocation measurement, excluding anything done afterwards.
+	void stopTimer() noexcept {
+		_elapsed = Clock::now() - _start;
+		_allocations = allocationCount() - _startAllocations;
+		_bytes = allocatedBytes() - _startBytes;
+		_isStopped = true;
+	}
+
+	bool isStopped() const noexcept { return _isStopped; }
+	Clock::duration elapsed() const noexcept { return _elapsed; }
+	uint64 allocations() const noexcept { return _allocations; }
+	uint64 bytes() const noexcept { return _bytes; }
+
+private:
+	uint64				_iterations;
+	uint64				_arg;
+
+	Clock::time_point	_start;
+	uint64				_startAllocations{0};
+	uint64				_startBytes{0};
+
+	Clock::duration		_elapsed{};
+	uint64				_allocations{0};
+	uint64				_bytes{0};
+	bool				_isStopped{false};
+};
+
+
+/// Signature of a benchmark function.
+using BenchmarkFunction = void (*)(State& state);
+
+/**
+ * Register a benchmark to be run by the harness.
+ * @param name Name of the benchmark. Registered arguments are appended to the name as "name/arg".
+ * @param function Benchmark function.
+ * @param args Values of the size parameter to run the benchmark with, or nullptr for a single run.
+ * @param nbArgs Number of values in args.
+ * @return Always true, so the call can be used to initialize a static.
+ */
+bool registerBenchmark(char const* name, BenchmarkFunction function, uint64 const* args, uint32 nbArgs) noexcept;
+
+template<uint32 N>
+bool registerBenchmark(char const* name, BenchmarkFunction function, uint64 const (&args)[N]) noexcept {
+	return registerBenchmark(name, function, args, N);
+}
+
+inline bool registerBenchmark(char const* name, BenchmarkFunction function) noexcept {
+	return registerBenchmark(name, function, nullptr, 0);
+}
+
+
+/// Prevent the compiler from optimizing away computation of a value.
+template<typename T>
+inline void doNotOptimize(T const& value) noexcept {
+	asm volatile("" : : "r,m"(value) : "memory");  // NOLINT
+}
+
+}  // namespace bench
+}  // namespace Solace
+
+
+#define SOLACE_BENCH_CONCAT_IMPL(a, b) a##b
+#define SOLACE_BENCH_CONCAT(a, b) SOLACE_BENCH_CONCAT_IMPL(a, b)
+
+/// Register a benchmark function at static initialization time.
+#define SOLACE_BENCHMARK(name, ...) \
+	static bool const SOLACE_BENCH_CONCAT(solaceBenchmark_, __LINE__) = \
+		::Solace::bench::registerBenchmark(name, __VA_ARGS__)
+
+#endif  // SOLACE_BENCH_BENCHMARK_HPP
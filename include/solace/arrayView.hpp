@@ -163,17 +163,28 @@ public:
     }
 
 
+    /**
+     * Get element at the given index.
+     * Index is checked according to the bounds checking policy: @see SOLACE_BOUNDS_CHECK_LEVEL
+     */
     const_reference operator[] (size_type index) const {
-		index = assertIndexInRange(index, size(), "ArrayView[] const");
-
-		return _memory.template dataAs<T>(sizeof(T) * index);
+		return unchecked_at(checkIndex(index, size(), "ArrayView[] const"));
     }
 
-
     reference operator[] (size_type index) {
-		index = assertIndexInRange(index, size(), "ArrayView[]");
+		return unchecked_at(checkIndex(index, size(), "ArrayView[]"));
+	}
 
-		return _memory.template dataAs<T>(sizeof(T) * index);
+    /**
+     * Get element at the given index without bounds checking.
+     * @note The behavior is undefined if index is not less then size().
+     */
+    const_reference unchecked_at(size_type index) const noexcept {
+		return static_cast<const_pointer>(_memory.dataAddress())[index];
+    }
+
+    reference unchecked_at(size_type index) noexcept {
+		return static_cast<pointer_type>(_memory.dataAddress())[index];
 	}
 
 
@@ -204,6 +215,24 @@ public:
         return {_memory.slice(from*sizeof(T), to*sizeof(T))};
     }
 
+    /**
+     * Get a slice of this array, checking that the requested range is within the array.
+     * Unlike @see slice that silently clamps the range, this method throws if the range is not valid.
+     * Use this to validate range once before iterating over it with unchecked access.
+     */
+	ArrayView<T const>
+    checkedSlice(size_type from, size_type to) const {
+		assertRangeInBounds(from, to, size(), "ArrayView.checkedSlice()");
+
+        return {_memory.slice(from*sizeof(T), to*sizeof(T))};
+    }
+
+    ArrayView checkedSlice(size_type from, size_type to) {
+		assertRangeInBounds(from, to, size(), "ArrayView.checkedSlice()");
+
+        return {_memory.slice(from*sizeof(T), to*sizeof(T))};
+    }
+
 	constexpr MemoryView view() const noexcept { return _memory; }
 
 	constexpr MemoryViewType view() noexcept { return _memory; }
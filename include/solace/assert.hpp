@@ -229,5 +229,61 @@ uint32 assertIndexInRange(uint32 index, uint32 size, const char* message);
  */
 uint64 assertIndexInRange(uint64 index, uint64 size, const char* message);
 
+
+/**
+ * Throw an error to signal that an index is out of range.
+ * @param index Index value that is out of range.
+ * @param size Upper value bound (exclusive).
+ * @param tag Tag identifying location.
+ */
+[[noreturn]]
+void raiseIndexOutOfRange(uint64 index, uint64 size, const char* tag);
+
+
+/**
+ * Check that the given index is within [0, size) according to the bounds checking policy.
+ * @see SOLACE_BOUNDS_CHECK_LEVEL
+ * Unlike @see assertIndexInRange the check is inlined, so that it can be hoisted out of loops by the compiler,
+ * and it is compiled out completely if bounds checking is disabled.
+ *
+ * @param index Index value to be checked.
+ * @param size Upper value bound (exclusive).
+ * @param tag Tag identifying location.
+ * @return Index value if the index is in range. Throws otherwise.
+ */
+template <typename T>
+constexpr T checkIndex(T index, T size, const char* tag) {
+#if SOLACE_BOUNDS_CHECK_ENABLED
+	if (size <= index) {
+		raiseIndexOutOfRange(index, size, tag);
+	}
+#else
+	static_cast<void>(size);
+	static_cast<void>(tag);
+#endif
+
+	return index;
+}
+
+
+/**
+ * Check that the range [from, to) is within [0, size). Throw if it is not.
+ * The check is always performed, regardless of bounds checking policy, as it is expected to be done once per loop.
+ *
+ * @param from Lower bound of the range (inclusive).
+ * @param to Upper bound of the range (exclusive).
+ * @param size Upper value bound (exclusive).
+ * @param tag Tag identifying location.
+ */
+template <typename T>
+constexpr void assertRangeInBounds(T from, T to, T size, const char* tag) {
+	if (to < from) {
+		raiseIndexOutOfRange(from, to, tag);
+	}
+	if (size < to) {
+		raiseIndexOutOfRange(to, size, tag);
+	}
+}
+
 }  // End of namespace Solace
 #endif  // SOLACE_ASSERT_HPP
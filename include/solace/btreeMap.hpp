@@ -0,0 +1,819 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace:
+ *	@file		solace/btreeMap.hpp
+ *	@brief		Ordered map implemented as a B+ tree with nodes drawn from a memory manager.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_BTREEMAP_HPP
+#define SOLACE_BTREEMAP_HPP
+
+#include "solace/types.hpp"
+#include "solace/utils.hpp"
+#include "solace/arrayView.hpp"
+#include "solace/memoryManager.hpp"
+#include "solace/posixErrorDomain.hpp"
+#include "solace/optional.hpp"
+#include "solace/result.hpp"
+
+#include "solace/details/btree_search.hpp"
+
+
+namespace Solace {
+
+/**
+ * Ordered map of unique keys, implemented as a B+ tree.
+ *
+ * Entries are kept sorted by key in leaf nodes, which are linked to allow iteration of ranges without
+ * walking up the tree. Nodes are of NodeBytes size, which is expected to be a few cache lines or a page.
+ * Nodes are allocated in chunks from a memory manager and recycled by the map itself.
+ *
+ * Keys must be copyable and ordered by operator<. Integer keys are searched within a node with SIMD compare.
+ *
+ * Invariant:
+ *  - All leaves are at the same depth.
+ *  - Keys of a subtree to the right of a separator key are not less than the separator.
+ *  - No leaf but the root is empty. Erase does not merge nodes, empty ones are freed.
+ *
+ * @note Inserting or erasing invalidates iterators.
+ */
+template<typename Key,
+		 typename T,
+		 size_t NodeBytes = 256>
+class BTreeMap {
+private:
+	struct Node {
+		uint16	size;	//!< Number of keys in the node.
+		bool	isLeaf;
+	};
+
+	static constexpr size_t kNodeHeaderSize = 16;
+
+	static constexpr size_t capacityFor(size_t nbBytes, size_t entrySize) noexcept {
+		return (nbBytes < kNodeHeaderSize + 3 * entrySize)
+				? 3
+				: ((nbBytes - kNodeHeaderSize) / entrySize < 0xFFFF ? (nbBytes - kNodeHeaderSize) / entrySize : 0xFFFE);
+	}
+
+public:
+	using key_type = Key;
+	using value_type = T;
+	using size_type = uint32;
+
+	/// Maximum number of entries in a leaf node.
+	static constexpr size_type kLeafCapacity = static_cast<size_type>(
+				capacityFor(NodeBytes - 2 * sizeof(void*), sizeof(Key) + sizeof(T)));
+
+	/// Maximum number of keys in an inner node. Inner node has one more child than keys.
+	static constexpr size_type kInnerCapacity = static_cast<size_type>(
+				capacityFor(NodeBytes - sizeof(void*), sizeof(Key) + sizeof(void*)));
+
+	struct EntryRef {
+		Key const&	key;
+		T&			value;
+	};
+
+	struct EntryConstRef {
+		Key const&	key;
+		T const&	value;
+	};
+
+private:
+
+	struct Leaf : Node {
+		Leaf*	prev;
+		Leaf*	next;
+		alignas(Key) byte	keyData[sizeof(Key) * kLeafCapacity];
+		alignas(T) byte		valueData[sizeof(T) * kLeafCapacity];
+
+		Key* keys() noexcept { return reinterpret_cast<Key*>(keyData); }
+		Key const* keys() const noexcept { return reinterpret_cast<Key const*>(keyData); }
+		T* values() noexcept { return reinterpret_cast<T*>(valueData); }
+		T const* values() const noexcept { return reinterpret_cast<T const*>(valueData); }
+	};
+
+	struct Inner : Node {
+		alignas(Key) byte	keyData[sizeof(Key) * kInnerCapacity];
+		Node*				children[kInnerCapacity + 1];
+
+		Key* keys() noexcept { return reinterpret_cast<Key*>(keyData); }
+		Key const* keys() const noexcept { return reinterpret_cast<Key const*>(keyData); }
+	};
+
+	template<typename LeafPtr, typename Ref>
+	struct Iterator_base {
+		constexpr Iterator_base(LeafPtr leaf, size_type index) noexcept
+			: _leaf{leaf}
+			, _index{index}
+		{}
+
+		constexpr bool operator!= (Iterator_base const& other) const noexcept {
+			return (_leaf != other._leaf) || (_index != other._index);
+		}
+
+		constexpr bool operator== (Iterator_base const& other) const noexcept {
+			return (_leaf == other._leaf) && (_index == other._index);
+		}
+
+		Ref operator* () const noexcept { return {_leaf->keys()[_index], _leaf->values()[_index]}; }
+
+		Iterator_base& operator++ () noexcept {
+			if (++_index >= _leaf->size) {
+				_leaf = _leaf->next;
+				_index = 0;
+			}
+
+			return *this;
+		}
+
+	private:
+		LeafPtr		_leaf;
+		size_type	_index;
+	};
+
+public:
+	using Iterator = Iterator_base<Leaf*, EntryRef>;
+	using const_iterator = Iterator_base<Leaf const*, EntryConstRef>;
+
+	/// A range of entries between two iterators.
+	template<typename I>
+	struct Range {
+		I	first;
+		I	last;
+
+		constexpr I begin() const noexcept { return first; }
+		constexpr I end() const noexcept { return last; }
+		constexpr bool empty() const noexcept { return (first == last); }
+	};
+
+public:
+
+	~BTreeMap() {
+		clear();
+		releaseChunks();
+	}
+
+	BTreeMap(BTreeMap const&) = delete;
+	BTreeMap& operator= (BTreeMap const&) = delete;
+
+	BTreeMap(BTreeMap&& rhs) noexcept
+		: _memoryManager{rhs._memoryManager}
+		, _root{exchange(rhs._root, nullptr)}
+		, _first{exchange(rhs._first, nullptr)}
+		, _last{exchange(rhs._last, nullptr)}
+		, _size{exchange(rhs._size, 0)}
+		, _height{exchange(rhs._height, 0)}
+		, _chunks{exchange(rhs._chunks, nullptr)}
+		, _freeSlots{exchange(rhs._freeSlots, nullptr)}
+		, _nbFreeSlots{exchange(rhs._nbFreeSlots, 0)}
+	{}
+
+	BTreeMap& operator= (BTreeMap&& rhs) noexcept {
+		return swap(rhs);
+	}
+
+	/**
+	 * Construct an empty map. No memory is allocated until the first entry is inserted.
+	 * @param memoryManager Memory manager to allocate nodes from. Must outlive the map.
+	 */
+	explicit BTreeMap(MemoryManager& memoryManager) noexcept
+		: _memoryManager{&memoryManager}
+	{}
+
+	BTreeMap& swap(BTreeMap& rhs) noexcept {
+		using std::swap;
+		swap(_memoryManager, rhs._memoryManager);
+		swap(_root, rhs._root);
+		swap(_first, rhs._first);
+		swap(_last, rhs._last);
+		swap(_size, rhs._size);
+		swap(_height, rhs._height);
+		swap(_chunks, rhs._chunks);
+		swap(_freeSlots, rhs._freeSlots);
+		swap(_nbFreeSlots, rhs._nbFreeSlots);
+
+		return *this;
+	}
+
+	constexpr bool empty() const noexcept { return (_size == 0); }
+	constexpr size_type size() const noexcept { return _size; }
+
+	/// @return Number of levels of the tree, 0 for a tree without nodes.
+	constexpr size_type height() const noexcept { return _height; }
+
+	bool contains(Key const& key) const noexcept {
+		return find(key).isSome();
+	}
+
+	Optional<T&> find(Key const& key) noexcept {
+		auto leaf = findLeaf(key);
+		if (!leaf) {
+			return none;
+		}
+
+		auto const pos = details::lowerBound(leaf->keys(), leaf->size, key);
+		if (pos < leaf->size && !(key < leaf->keys()[pos])) {
+			return leaf->values()[pos];
+		}
+
+		return none;
+	}
+
+	Optional<T const&> find(Key const& key) const noexcept {
+		auto leaf = findLeaf(key);
+		if (!leaf) {
+			return none;
+		}
+
+		auto const pos = details::lowerBound(leaf->keys(), leaf->size, key);
+		if (pos < leaf->size && !(key < leaf->keys()[pos])) {
+			return leaf->values()[pos];
+		}
+
+		return none;
+	}
+
+	/**
+	 * Insert a value with a given key. Value of an existing entry with the same key is replaced.
+	 * @return Reference to the value in the map or an error if a node could not be allocated.
+	 */
+	Result<T&, Error>
+	put(Key key, T&& value) {
+		return insert(mv(key), mv(value));
+	}
+
+	template<typename... Args>
+	Result<T&, Error>
+	put(Key key, Args&&... args) {
+		return insert(mv(key), fwd<Args>(args)...);
+	}
+
+	/**
+	 * Remove an entry with a given key.
+	 * @return True if an entry was removed, false if there was no such key.
+	 */
+	bool erase(Key const& key) {
+		if (!_root) {
+			return false;
+		}
+
+		PathEntry path[kMaxHeight];
+		size_type depth = 0;
+		auto leaf = descend(key, path, depth);
+
+		auto const pos = details::lowerBound(leaf->keys(), leaf->size, key);
+		if (pos >= leaf->size || key < leaf->keys()[pos]) {
+			return false;
+		}
+
+		eraseAt(leaf->keys(), leaf->size, pos);
+		eraseAt(leaf->values(), leaf->size, pos);
+		leaf->size -= 1;
+		_size -= 1;
+
+		if (leaf->size != 0 || leaf == _root) {
+			return true;
+		}
+
+		// Empty leaf: unlink it and remove it from its parents, removing parents that become empty
+		(leaf->prev ? leaf->prev->next : _first) = leaf->next;
+		(leaf->next ? leaf->next->prev : _last) = leaf->prev;
+		freeNode(leaf);
+
+		while (depth > 0) {
+			auto& entry = path[--depth];
+			auto inner = entry.node;
+			if (inner->size == 0) {  // The only child removed
+				freeNode(inner);
+				continue;
+			}
+
+			auto const keyIndex = (entry.childIndex > 0) ? entry.childIndex - 1 : 0;
+			eraseAt(inner->keys(), inner->size, keyIndex);
+			for (auto i = entry.childIndex; i < inner->size; ++i) {
+				inner->children[i] = inner->children[i + 1];
+			}
+			inner->size -= 1;
+			break;
+		}
+
+		// Collapse root with a single child
+		while (!_root->isLeaf && _root->size == 0) {
+			auto oldRoot = static_cast<Inner*>(_root);
+			_root = oldRoot->children[0];
+			_height -= 1;
+			freeNode(oldRoot);
+		}
+
+		return true;
+	}
+
+	/// Remove all entries. Nodes are kept for reuse.
+	void clear() noexcept {
+		if (_root) {
+			destroyNode(_root);
+		}
+
+		_root = nullptr;
+		_first = nullptr;
+		_last = nullptr;
+		_size = 0;
+		_height = 0;
+	}
+
+	/**
+	 * Fill an empty map with sorted entries.
+	 * Leaves and inner nodes are filled to capacity and built bottom up, which is much faster than
+	 * inserting entries one by one.
+	 * @param keys Keys in strictly ascending order.
+	 * @param values Values, one per key.
+	 * @return Error if the map is not empty, input is not sorted or nodes could not be allocated.
+	 */
+	Result<void, Error>
+	assignSorted(ArrayView<Key const> keys, ArrayView<T const> values) {
+		if (!empty()) {
+			return makeError(GenericError::BUSY, "BTreeMap::assignSorted");
+		}
+
+		if (keys.size() != values.size()) {
+			return makeError(BasicError::InvalidInput, "BTreeMap::assignSorted");
+		}
+
+		auto const n = static_cast<size_type>(keys.size());
+		for (size_type i = 1; i < n; ++i) {
+			if (!(keys[i - 1] < keys[i])) {
+				return makeError(BasicError::InvalidInput, "BTreeMap::assignSorted");
+			}
+		}
+
+		clear();
+		if (n == 0) {
+			return Ok();
+		}
+
+		// Reserve all nodes up front, so building the tree can not fail half way
+		auto const nbLeaves = (n + kLeafCapacity - 1) / kLeafCapacity;
+		size_type nbNodes = nbLeaves;
+		for (auto count = nbLeaves; count > 1; ) {
+			count = (count + kInnerCapacity) / (kInnerCapacity + 1);
+			nbNodes += count;
+		}
+
+		auto maybeLevel = _memoryManager->allocate(nbLeaves * sizeof(Node*));
+		if (!maybeLevel) {
+			return maybeLevel.moveError();
+		}
+
+		auto maybeReserved = reserveSlots(nbNodes);
+		if (!maybeReserved) {
+			return maybeReserved.moveError();
+		}
+
+		auto level = static_cast<Node**>(maybeLevel.unwrap().view().dataAddress());
+
+		// Leaves: entries evenly distributed
+		size_type offset = 0;
+		for (size_type i = 0; i < nbLeaves; ++i) {
+			auto const leafSize = n / nbLeaves + (i < n % nbLeaves ? 1 : 0);
+			auto leaf = newLeaf();
+			for (size_type j = 0; j < leafSize; ++j) {
+				ctor(leaf->keys()[j], keys[offset + j]);
+				ctor(leaf->values()[j], values[offset + j]);
+			}
+			leaf->size = static_cast<uint16>(leafSize);
+			offset += leafSize;
+
+			leaf->prev = _last;
+			(_last ? _last->next : _first) = leaf;
+			_last = leaf;
+			level[i] = leaf;
+		}
+
+		// Inner levels: children evenly distributed
+		_height = 1;
+		for (auto count = nbLeaves; count > 1; ) {
+			auto const nbGroups = (count + kInnerCapacity) / (kInnerCapacity + 1);
+			size_type child = 0;
+			for (size_type i = 0; i < nbGroups; ++i) {
+				auto const nbChildren = count / nbGroups + (i < count % nbGroups ? 1 : 0);
+				auto inner = newInner();
+				inner->children[0] = level[child];
+				for (size_type j = 1; j < nbChildren; ++j) {
+					ctor(inner->keys()[j - 1], minKey(level[child + j]));
+					inner->children[j] = level[child + j];
+				}
+				inner->size = static_cast<uint16>(nbChildren - 1);
+				child += nbChildren;
+				level[i] = inner;
+			}
+
+			count = nbGroups;
+			_height += 1;
+		}
+
+		_root = level[0];
+		_size = n;
+
+		return Ok();
+	}
+
+	Iterator begin() noexcept { return {_size ? _first : nullptr, 0}; }
+	Iterator end() noexcept { return {nullptr, 0}; }
+	const_iterator begin() const noexcept { return {_size ? _first : nullptr, 0}; }
+	const_iterator end() const noexcept { return {nullptr, 0}; }
+
+	/// @return Iterator to the first entry with a key not less than the given one.
+	Iterator lowerBound(Key const& key) noexcept { return bound<false, Iterator>(findLeaf(key), key); }
+	const_iterator lowerBound(Key const& key) const noexcept { return bound<false, const_iterator>(findLeaf(key), key); }
+
+	/// @return Iterator to the first entry with a key greater than the given one.
+	Iterator upperBound(Key const& key) noexcept { return bound<true, Iterator>(findLeaf(key), key); }
+	const_iterator upperBound(Key const& key) const noexcept { return bound<true, const_iterator>(findLeaf(key), key); }
+
+	/// @return Range of entries with keys in [from, to).
+	Range<Iterator> range(Key const& from, Key const& to) noexcept {
+		return (from < to)
+				? Range<Iterator>{lowerBound(from), lowerBound(to)}
+				: Range<Iterator>{end(), end()};
+	}
+
+	Range<const_iterator> range(Key const& from, Key const& to) const noexcept {
+		return (from < to)
+				? Range<const_iterator>{lowerBound(from), lowerBound(to)}
+				: Range<const_iterator>{end(), end()};
+	}
+
+protected:
+
+	/// Tree height is bounded by the number of entries: 2^32 entries in nodes of at least 2 children.
+	static constexpr size_type kMaxHeight = 33;
+
+	struct PathEntry {
+		Inner*		node;
+		size_type	childIndex;
+	};
+
+	Leaf const* findLeaf(Key const& key) const noexcept {
+		Node const* node = _root;
+		while (node && !node->isLeaf) {
+			auto inner = static_cast<Inner const*>(node);
+			node = inner->children[details::upperBound(inner->keys(), inner->size, key)];
+		}
+
+		return static_cast<Leaf const*>(node);
+	}
+
+	Leaf* findLeaf(Key const& key) noexcept {
+		return const_cast<Leaf*>(static_cast<BTreeMap const*>(this)->findLeaf(key));
+	}
+
+	Leaf* descend(Key const& key, PathEntry (&path)[kMaxHeight], size_type& depth) noexcept {
+		auto node = _root;
+		while (!node->isLeaf) {
+			auto inner = static_cast<Inner*>(node);
+			auto const index = details::upperBound(inner->keys(), inner->size, key);
+			path[depth++] = PathEntry{inner, index};
+			node = inner->children[index];
+		}
+
+		return static_cast<Leaf*>(node);
+	}
+
+	template<bool OrEqual, typename I, typename LeafPtr>
+	static I bound(LeafPtr leaf, Key const& key) noexcept {
+		if (!leaf) {
+			return {nullptr, 0};
+		}
+
+		auto const pos = details::countKeys<OrEqual>(leaf->keys(), leaf->size, key);
+		return (pos < leaf->size)
+				? I{leaf, pos}
+				: I{leaf->next, 0};
+	}
+
+	static Key const& minKey(Node const* node) noexcept {
+		while (!node->isLeaf) {
+			node = static_cast<Inner const*>(node)->children[0];
+		}
+
+		return static_cast<Leaf const*>(node)->keys()[0];
+	}
+
+	template<typename... Args>
+	Result<T&, Error>
+	insert(Key&& key, Args&&... args) {
+		// Worst case: every node on the path splits and a new root is added
+		auto maybeReserved = reserveSlots(_height + 1);
+		if (!maybeReserved) {
+			return maybeReserved.moveError();
+		}
+
+		if (!_root) {
+			auto leaf = newLeaf();
+			_root = leaf;
+			_first = leaf;
+			_last = leaf;
+			_height = 1;
+		}
+
+		PathEntry path[kMaxHeight];
+		size_type depth = 0;
+		auto leaf = descend(key, path, depth);
+
+		auto pos = details::lowerBound(leaf->keys(), leaf->size, key);
+		if (pos < leaf->size && !(key < leaf->keys()[pos])) {  // Replace existing value
+			auto& value = leaf->values()[pos];
+			value = T(fwd<Args>(args)...);
+
+			return Result<T&, Error>{types::okTag, in_place, value};
+		}
+
+		if (leaf->size == kLeafCapacity) {
+			// Appending past the last leaf: start a new leaf, so that sequential inserts fill leaves completely
+			auto const nbLeft = (pos == kLeafCapacity && !leaf->next)
+					? kLeafCapacity
+					: kLeafCapacity / 2;
+
+			auto right = newLeaf();
+			relocate(right->keys(), leaf->keys() + nbLeft, kLeafCapacity - nbLeft);
+			relocate(right->values(), leaf->values() + nbLeft, kLeafCapacity - nbLeft);
+			right->size = static_cast<uint16>(kLeafCapacity - nbLeft);
+			leaf->size = static_cast<uint16>(nbLeft);
+
+			right->prev = leaf;
+			right->next = leaf->next;
+			(leaf->next ? leaf->next->prev : _last) = right;
+			leaf->next = right;
+
+			if (pos > nbLeft || nbLeft == kLeafCapacity) {
+				pos -= nbLeft;
+				leaf = right;
+			}
+
+			insertAt(leaf->keys(), leaf->size, pos, mv(key));
+			insertAt(leaf->values(), leaf->size, pos, fwd<Args>(args)...);
+			leaf->size += 1;
+			_size += 1;
+
+			insertSeparator(path, depth, Key{right->keys()[0]}, right);
+		} else {
+			insertAt(leaf->keys(), leaf->size, pos, mv(key));
+			insertAt(leaf->values(), leaf->size, pos, fwd<Args>(args)...);
+			leaf->size += 1;
+			_size += 1;
+		}
+
+		return Result<T&, Error>{types::okTag, in_place, leaf->values()[pos]};
+	}
+
+	/// Insert a separator and a new right child into the parent of a split node, splitting parents as needed.
+	void insertSeparator(PathEntry (&path)[kMaxHeight], size_type depth, Key&& separator, Node* child) {
+		while (depth > 0) {
+			auto& entry = path[--depth];
+			auto inner = entry.node;
+			if (inner->size < kInnerCapacity) {
+				insertChild(inner, entry.childIndex, mv(separator), child);
+				return;
+			}
+
+			// Split: keys left of the middle stay, the middle key moves up, the rest move to a new node
+			auto const mid = kInnerCapacity / 2;
+			auto right = newInner();
+			Key promoted{mv(inner->keys()[mid])};
+			dtor(inner->keys()[mid]);
+
+			relocate(right->keys(), inner->keys() + mid + 1, kInnerCapacity - mid - 1);
+			for (size_type i = 0; i < kInnerCapacity - mid; ++i) {
+				right->children[i] = inner->children[mid + 1 + i];
+			}
+			inner->size = static_cast<uint16>(mid);
+			right->size = static_cast<uint16>(kInnerCapacity - mid - 1);
+
+			if (entry.childIndex <= mid) {
+				insertChild(inner, entry.childIndex, mv(separator), child);
+			} else {
+				insertChild(right, entry.childIndex - mid - 1, mv(separator), child);
+			}
+
+			separator = mv(promoted);
+			child = right;
+		}
+
+		// Root split: grow a new root
+		auto root = newInner();
+		ctor(root->keys()[0], mv(separator));
+		root->children[0] = _root;
+		root->children[1] = child;
+		root->size = 1;
+		_root = root;
+		_height += 1;
+	}
+
+	static void insertChild(Inner* inner, size_type childIndex, Key&& separator, Node* child) {
+		insertAt(inner->keys(), inner->size, childIndex, mv(separator));
+		for (auto i = static_cast<size_type>(inner->size) + 1; i > childIndex + 1; --i) {
+			inner->children[i] = inner->children[i - 1];
+		}
+		inner->children[childIndex + 1] = child;
+		inner->size += 1;
+	}
+
+	/// Construct an element at a position of an array of `size` elements, shifting elements after it.
+	template<typename E, typename... Args>
+	static void insertAt(E* items, size_type size, size_type pos, Args&&... args) {
+		if (pos == size) {
+			ctor(items[pos], fwd<Args>(args)...);
+			return;
+		}
+
+		ctor(items[size], mv(items[size - 1]));
+		for (auto i = size - 1; i > pos; --i) {
+			items[i] = mv(items[i - 1]);
+		}
+
+		// Construct aside and move in: the element is never left destroyed if construction throws
+		items[pos] = E(fwd<Args>(args)...);
+	}
+
+	/// Destroy an element at a position of an array of `size` elements, shifting elements after it.
+	template<typename E>
+	static void eraseAt(E* items, size_type size, size_type pos) {
+		for (auto i = pos; i + 1 < size; ++i) {
+			items[i] = mv(items[i + 1]);
+		}
+
+		dtor(items[size - 1]);
+	}
+
+	/// Move elements into uninitialized memory, destroying the source.
+	template<typename E>
+	static void relocate(E* dest, E* src, size_type count) {
+		for (size_type i = 0; i < count; ++i) {
+			ctor(dest[i], mv(src[i]));
+			dtor(src[i]);
+		}
+	}
+
+	void destroyNode(Node* node) noexcept {
+		if (node->isLeaf) {
+			auto leaf = static_cast<Leaf*>(node);
+			for (size_type i = 0; i < leaf->size; ++i) {
+				dtor(leaf->keys()[i]);
+				dtor(leaf->values()[i]);
+			}
+		} else {
+			auto inner = static_cast<Inner*>(node);
+			for (size_type i = 0; i <= inner->size; ++i) {
+				destroyNode(inner->children[i]);
+			}
+			for (size_type i = 0; i < inner->size; ++i) {
+				dtor(inner->keys()[i]);
+			}
+		}
+
+		freeNode(node);
+	}
+
+protected:  // Node pool
+
+	struct FreeSlot {
+		FreeSlot*	next;
+	};
+
+	struct Chunk {
+		MemoryResource	memory;
+		Chunk*			next;
+	};
+
+	static constexpr size_t kCacheLineSize = 64;
+
+	static constexpr size_t alignUp(size_t value, size_t alignment) noexcept {
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	static constexpr size_t kSlotSize = alignUp(sizeof(Leaf) > sizeof(Inner) ? sizeof(Leaf) : sizeof(Inner),
+												kCacheLineSize);
+	static constexpr size_t kChunkHeaderSize = alignUp(sizeof(Chunk), kCacheLineSize);
+	static constexpr size_type kSlotsPerChunk = (16 * 1024 / kSlotSize > 8) ? 16 * 1024 / kSlotSize : 8;
+
+	/// Make sure at least a given number of nodes can be allocated without a failure.
+	Result<void, Error> reserveSlots(size_type nbSlots) {
+		while (_nbFreeSlots < nbSlots) {
+			// Extra cache line to align nodes
+			auto maybeMemory = _memoryManager->allocate(kChunkHeaderSize + kSlotsPerChunk * kSlotSize + kCacheLineSize);
+			if (!maybeMemory) {
+				return maybeMemory.moveError();
+			}
+
+			auto const address = reinterpret_cast<uintptr_t>(maybeMemory.unwrap().view().dataAddress());
+			auto const base = reinterpret_cast<byte*>(alignUp(address, kCacheLineSize));
+
+			_chunks = ctor(*reinterpret_cast<Chunk*>(base), maybeMemory.moveResult(), _chunks);
+			for (size_type i = 0; i < kSlotsPerChunk; ++i) {
+				auto slot = reinterpret_cast<FreeSlot*>(base + kChunkHeaderSize + i * kSlotSize);
+				slot->next = _freeSlots;
+				_freeSlots = slot;
+			}
+			_nbFreeSlots += kSlotsPerChunk;
+		}
+
+		return Ok();
+	}
+
+	void* allocateSlot() noexcept {
+		auto slot = _freeSlots;
+		_freeSlots = slot->next;
+		_nbFreeSlots -= 1;
+
+		return slot;
+	}
+
+	void freeNode(Node* node) noexcept {
+		auto slot = reinterpret_cast<FreeSlot*>(node);
+		slot->next = _freeSlots;
+		_freeSlots = slot;
+		_nbFreeSlots += 1;
+	}
+
+	Leaf* newLeaf() noexcept {
+		auto leaf = new (_::PlacementNew(), allocateSlot()) Leaf;
+		leaf->size = 0;
+		leaf->isLeaf = true;
+		leaf->prev = nullptr;
+		leaf->next = nullptr;
+
+		return leaf;
+	}
+
+	Inner* newInner() noexcept {
+		auto inner = new (_::PlacementNew(), allocateSlot()) Inner;
+		inner->size = 0;
+		inner->isLeaf = false;
+
+		return inner;
+	}
+
+	void releaseChunks() noexcept {
+		while (_chunks) {
+			auto chunk = _chunks;
+			_chunks = chunk->next;
+
+			auto memory = mv(chunk->memory);
+			dtor(*chunk);
+		}
+
+		_freeSlots = nullptr;
+		_nbFreeSlots = 0;
+	}
+
+private:
+	MemoryManager*	_memoryManager;
+
+	Node*			_root{nullptr};
+	Leaf*			_first{nullptr};
+	Leaf*			_last{nullptr};
+	size_type		_size{0};
+	size_type		_height{0};
+
+	Chunk*			_chunks{nullptr};
+	FreeSlot*		_freeSlots{nullptr};
+	size_type		_nbFreeSlots{0};
+};
+
+
+/**
+ * Create a new map from sorted entries.
+ * @param memoryManager Memory manager to allocate nodes from.
+ * @param keys Keys in strictly ascending order.
+ * @param values Values, one per key.
+ * @return A new map or an error if input is not sorted or memory could not be allocated.
+ */
+template<typename K, typename V, size_t NodeBytes = 256>
+[[nodiscard]]
+Result<BTreeMap<K, V, NodeBytes>, Error>
+makeBTreeMap(MemoryManager& memoryManager, ArrayView<K const> keys, ArrayView<V const> values) {
+	BTreeMap<K, V, NodeBytes> map{memoryManager};
+	auto result = map.assignSorted(keys, values);
+	if (!result) {
+		return result.moveError();
+	}
+
+	return Result<BTreeMap<K, V, NodeBytes>, Error>{types::okTag, in_place, mv(map)};
+}
+
+}  // End of namespace Solace
+#endif  // SOLACE_BTREEMAP_HPP
@@ -0,0 +1,430 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace:
+ *	@file		solace/clockCache.hpp
+ *	@brief		Fixed capacity cache with CLOCK eviction.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_CLOCKCACHE_HPP
+#define SOLACE_CLOCKCACHE_HPP
+
+#include "solace/types.hpp"
+#include "solace/utils.hpp"
+#include "solace/memoryManager.hpp"
+#include "solace/posixErrorDomain.hpp"
+#include "solace/optional.hpp"
+#include "solace/result.hpp"
+
+#include <type_traits>
+
+
+namespace Solace {
+
+/// Counters of cache operations.
+struct CacheStats {
+	uint64	hits;		//!< Number of lookups that found an entry.
+	uint64	misses;		//!< Number of lookups that found nothing.
+	uint64	insertions;	//!< Number of entries put into the cache, including replacements.
+	uint64	evictions;	//!< Number of entries evicted to make room for new ones.
+};
+
+
+namespace details {
+
+/// Finalization step of Murmur3: spreads entropy of all bits of a hash code to the low bits used for indexing.
+constexpr uint64 mixHash(uint64 h) noexcept {
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+
+	return h;
+}
+
+/// Hash of a cache key: integers are hashed by value, other keys are expected to provide hashCode().
+template<typename K>
+uint64 hashKey(K const& key) noexcept {
+	if constexpr (std::is_integral<K>::value || std::is_enum<K>::value) {
+		return mixHash(static_cast<uint64>(key));
+	} else {
+		return mixHash(key.hashCode());
+	}
+}
+
+}  // namespace details
+
+
+/**
+ * Cache of a fixed number of entries, evicting entries not used recently to make room for new ones.
+ *
+ * Entries live in a slot array allocated once, indexed by an open addressing hash table with linear probing.
+ * Eviction follows the CLOCK algorithm: a lookup marks an entry referenced and the clock hand sweeps over slots,
+ * clearing reference marks and evicting the first entry found unmarked. New entries start unmarked, so entries
+ * used only once are evicted before entries that have been looked up again.
+ *
+ * Capacity is limited by the number of slots and, optionally, by a budget of bytes: each entry is charged
+ * a number of bytes when put into the cache and entries are evicted until the total charge fits the budget.
+ * All of get, put and erase are O(1) on average.
+ *
+ * Keys must be equality comparable and either integers or provide `uint64 hashCode() const`.
+ */
+template<typename Key,
+		 typename T>
+class ClockCache {
+public:
+	using key_type = Key;
+	using value_type = T;
+	using size_type = uint32;
+
+	/// Bytes charged for an entry put into the cache without an explicit charge.
+	static constexpr size_t kDefaultCharge = sizeof(Key) + sizeof(T);
+
+private:
+
+	struct Slot {
+		alignas(Key) byte	keyData[sizeof(Key)];
+		alignas(T) byte		valueData[sizeof(T)];
+		size_t				charge;
+		uint32				hash;
+		uint32				nextFree;
+		bool				isOccupied;
+		bool				isReferenced;
+
+		Key& key() noexcept { return *reinterpret_cast<Key*>(keyData); }
+		Key const& key() const noexcept { return *reinterpret_cast<Key const*>(keyData); }
+		T& value() noexcept { return *reinterpret_cast<T*>(valueData); }
+		T const& value() const noexcept { return *reinterpret_cast<T const*>(valueData); }
+	};
+
+	struct Bucket {
+		uint32	slot;	//!< Index of the slot or kEmpty.
+		uint32	hash;	//!< Low bits of the key hash, to skip key compare on mismatch and to rehash on erase.
+	};
+
+	static constexpr uint32 kEmpty = 0xFFFFFFFF;
+
+public:
+
+	/// @return Number of bytes of memory required for a cache of a given capacity.
+	static constexpr size_t memoryRequired(size_type capacity) noexcept {
+		return capacity * sizeof(Slot) + bucketCountFor(capacity) * sizeof(Bucket);
+	}
+
+public:
+
+	~ClockCache() {
+		clear();
+	}
+
+	ClockCache(ClockCache const&) = delete;
+	ClockCache& operator= (ClockCache const&) = delete;
+
+	ClockCache(ClockCache&& rhs) noexcept
+		: _memory{mv(rhs._memory)}
+		, _slots{exchange(rhs._slots, nullptr)}
+		, _buckets{exchange(rhs._buckets, nullptr)}
+		, _capacity{exchange(rhs._capacity, 0)}
+		, _bucketMask{exchange(rhs._bucketMask, 0)}
+		, _size{exchange(rhs._size, 0)}
+		, _freeSlot{exchange(rhs._freeSlot, kEmpty)}
+		, _hand{exchange(rhs._hand, 0)}
+		, _maxBytes{exchange(rhs._maxBytes, 0)}
+		, _bytesUsed{exchange(rhs._bytesUsed, 0)}
+		, _stats{exchange(rhs._stats, CacheStats{})}
+	{}
+
+	ClockCache& operator= (ClockCache&& rhs) noexcept {
+		return swap(rhs);
+	}
+
+	/**
+	 * Construct a cache in a given memory.
+	 * @param memory Memory for slots and index of at least memoryRequired(capacity) bytes.
+	 * @param capacity Maximum number of entries.
+	 * @param maxBytes Budget of bytes charged for entries, 0 for no limit other than the number of entries.
+	 * @see makeClockCache
+	 */
+	ClockCache(MemoryResource&& memory, size_type capacity, size_t maxBytes) noexcept
+		: _memory{mv(memory)}
+		, _slots{reinterpret_cast<Slot*>(_memory.view().dataAddress())}
+		, _buckets{reinterpret_cast<Bucket*>(_memory.view().begin() + capacity * sizeof(Slot))}
+		, _capacity{capacity}
+		, _bucketMask{bucketCountFor(capacity) - 1}
+		, _maxBytes{maxBytes}
+	{
+		for (size_type i = 0; i < capacity; ++i) {
+			auto& slot = _slots[i];
+			slot.isOccupied = false;
+			slot.isReferenced = false;
+			slot.nextFree = (i + 1 < capacity) ? i + 1 : kEmpty;
+		}
+		_freeSlot = capacity ? 0 : kEmpty;
+
+		for (size_type i = 0; i <= _bucketMask; ++i) {
+			_buckets[i].slot = kEmpty;
+		}
+	}
+
+	ClockCache& swap(ClockCache& rhs) noexcept {
+		using std::swap;
+		swap(_memory, rhs._memory);
+		swap(_slots, rhs._slots);
+		swap(_buckets, rhs._buckets);
+		swap(_capacity, rhs._capacity);
+		swap(_bucketMask, rhs._bucketMask);
+		swap(_size, rhs._size);
+		swap(_freeSlot, rhs._freeSlot);
+		swap(_hand, rhs._hand);
+		swap(_maxBytes, rhs._maxBytes);
+		swap(_bytesUsed, rhs._bytesUsed);
+		swap(_stats, rhs._stats);
+
+		return *this;
+	}
+
+	constexpr bool empty() const noexcept { return (_size == 0); }
+	constexpr size_type size() const noexcept { return _size; }
+
+	/// @return Maximum number of entries.
+	constexpr size_type capacity() const noexcept { return _capacity; }
+
+	/// @return Budget of bytes for entries, 0 if there is none.
+	constexpr size_t maxBytes() const noexcept { return _maxBytes; }
+
+	/// @return Sum of bytes charged for entries in the cache.
+	constexpr size_t bytesUsed() const noexcept { return _bytesUsed; }
+
+	constexpr CacheStats const& stats() const noexcept { return _stats; }
+
+	void resetStats() noexcept { _stats = CacheStats{}; }
+
+	/// @return True if the cache has an entry for the key. Neither marks the entry used nor counts as a lookup.
+	bool contains(Key const& key) const noexcept {
+		return findBucket(key, hashOf(key)) != kEmpty;
+	}
+
+	/**
+	 * Look up an entry, marking it used.
+	 * @return Value for the key if it is in the cache.
+	 */
+	Optional<T&> get(Key const& key) noexcept {
+		auto const bucket = findBucket(key, hashOf(key));
+		if (bucket == kEmpty) {
+			_stats.misses += 1;
+			return none;
+		}
+
+		_stats.hits += 1;
+		auto& slot = _slots[_buckets[bucket].slot];
+		slot.isReferenced = true;
+
+		return slot.value();
+	}
+
+	/**
+	 * Put a value into the cache, replacing the value for an existing key.
+	 * Entries are evicted as needed to make room for the new one.
+	 * @param charge Number of bytes charged against the byte budget for the entry.
+	 * @return Reference to the value in the cache or an error if the charge exceeds the budget of the whole cache.
+	 */
+	Result<T&, Error>
+	put(Key key, T value, size_t charge = kDefaultCharge) {
+		if (_capacity == 0 || (_maxBytes && charge > _maxBytes)) {
+			return makeError(BasicError::Overflow, "ClockCache::put");
+		}
+
+		auto const hash = hashOf(key);
+		auto const existing = findBucket(key, hash);
+		if (existing != kEmpty) {
+			removeAt(existing);
+		}
+
+		while (_size == _capacity || (_maxBytes && _bytesUsed + charge > _maxBytes)) {
+			evictOne();
+		}
+
+		auto const index = _freeSlot;
+		auto& slot = _slots[index];
+		_freeSlot = slot.nextFree;
+
+		ctor(slot.key(), mv(key));
+		ctor(slot.value(), mv(value));
+		slot.charge = charge;
+		slot.hash = hash;
+		slot.isOccupied = true;
+		slot.isReferenced = false;
+
+		auto bucket = hash & _bucketMask;
+		while (_buckets[bucket].slot != kEmpty) {
+			bucket = (bucket + 1) & _bucketMask;
+		}
+		_buckets[bucket] = Bucket{index, hash};
+
+		_size += 1;
+		_bytesUsed += charge;
+		_stats.insertions += 1;
+
+		return Result<T&, Error>{types::okTag, in_place, slot.value()};
+	}
+
+	/**
+	 * Remove an entry with a given key.
+	 * @return True if an entry was removed, false if there was no such key.
+	 */
+	bool erase(Key const& key) noexcept {
+		auto const bucket = findBucket(key, hashOf(key));
+		if (bucket == kEmpty) {
+			return false;
+		}
+
+		removeAt(bucket);
+		return true;
+	}
+
+	/// Remove all entries. Statistics are kept.
+	void clear() noexcept {
+		for (size_type i = 0; i <= _bucketMask && _size; ++i) {
+			if (_buckets[i].slot != kEmpty) {
+				releaseSlot(_buckets[i].slot);
+				_buckets[i].slot = kEmpty;
+			}
+		}
+	}
+
+protected:
+
+	static constexpr size_type bucketCountFor(size_type capacity) noexcept {
+		// Load factor of at most 1/2 keeps probe sequences short
+		size_type count = 2;
+		while (count < 2 * capacity) {
+			count *= 2;
+		}
+
+		return count;
+	}
+
+	static uint32 hashOf(Key const& key) noexcept {
+		return static_cast<uint32>(details::hashKey(key));
+	}
+
+	/// @return Index of the bucket holding the key or kEmpty if there is none.
+	uint32 findBucket(Key const& key, uint32 hash) const noexcept {
+		if (!_buckets) {
+			return kEmpty;
+		}
+
+		for (auto i = hash & _bucketMask; _buckets[i].slot != kEmpty; i = (i + 1) & _bucketMask) {
+			if (_buckets[i].hash == hash && _slots[_buckets[i].slot].key() == key) {
+				return i;
+			}
+		}
+
+		return kEmpty;
+	}
+
+	/// Remove an entry of a given bucket, shifting back entries of the probe sequence that follow it.
+	void removeAt(uint32 bucket) noexcept {
+		releaseSlot(_buckets[bucket].slot);
+
+		auto hole = bucket;
+		for (auto i = (bucket + 1) & _bucketMask; _buckets[i].slot != kEmpty; i = (i + 1) & _bucketMask) {
+			// An entry can fill the hole unless its home bucket lies cyclically within (hole, i]
+			auto const home = _buckets[i].hash & _bucketMask;
+			auto const staysPut = (hole <= i)
+					? (hole < home && home <= i)
+					: (hole < home || home <= i);
+			if (!staysPut) {
+				_buckets[hole] = _buckets[i];
+				hole = i;
+			}
+		}
+
+		_buckets[hole].slot = kEmpty;
+	}
+
+	void releaseSlot(uint32 index) noexcept {
+		auto& slot = _slots[index];
+		dtor(slot.key());
+		dtor(slot.value());
+		slot.isOccupied = false;
+		slot.isReferenced = false;
+		slot.nextFree = _freeSlot;
+		_freeSlot = index;
+
+		_size -= 1;
+		_bytesUsed -= slot.charge;
+	}
+
+	/// Advance the clock hand to the first entry not referenced since the last sweep and evict it.
+	void evictOne() noexcept {
+		while (true) {
+			auto const index = _hand;
+			_hand = (_hand + 1 == _capacity) ? 0 : _hand + 1;
+
+			auto& slot = _slots[index];
+			if (!slot.isOccupied) {
+				continue;
+			}
+
+			if (slot.isReferenced) {
+				slot.isReferenced = false;
+				continue;
+			}
+
+			removeAt(findBucket(slot.key(), slot.hash));
+			_stats.evictions += 1;
+			return;
+		}
+	}
+
+private:
+	MemoryResource	_memory;
+	Slot*			_slots{nullptr};
+	Bucket*			_buckets{nullptr};
+	size_type		_capacity{0};
+	size_type		_bucketMask{0};
+	size_type		_size{0};
+	uint32			_freeSlot{kEmpty};
+	size_type		_hand{0};
+	size_t			_maxBytes{0};
+	size_t			_bytesUsed{0};
+	CacheStats		_stats{};
+};
+
+
+/**
+ * Create a cache with memory for its slots and index allocated from a memory manager.
+ * @param memoryManager Memory manager to allocate the cache from.
+ * @param capacity Maximum number of entries.
+ * @param maxBytes Budget of bytes charged for entries, 0 for no limit other than the number of entries.
+ * @return A new empty cache or an error if memory could not be allocated.
+ */
+template<typename K, typename V>
+[[nodiscard]]
+Result<ClockCache<K, V>, Error>
+makeClockCache(MemoryManager& memoryManager, typename ClockCache<K, V>::size_type capacity, size_t maxBytes = 0) {
+	auto maybeMemory = memoryManager.allocate(ClockCache<K, V>::memoryRequired(capacity));
+	if (!maybeMemory) {
+		return maybeMemory.moveError();
+	}
+
+	return Result<ClockCache<K, V>, Error>{types::okTag, in_place, maybeMemory.moveResult(), capacity, maxBytes};
+}
+
+}  // End of namespace Solace
+#endif  // SOLACE_CLOCKCACHE_HPP
@@ -0,0 +1,343 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace:
+ *  @brief		Fixed size dictionary container in a single block of memory
+ *	@file		solace/compactDictionary.hpp
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_COMPACTDICTIONARY_HPP
+#define SOLACE_COMPACTDICTIONARY_HPP
+
+#include "solace/memoryManager.hpp"
+#include "solace/optional.hpp"
+#include "solace/posixErrorDomain.hpp"
+#include "solace/utils.hpp"
+
+
+namespace Solace {
+
+/**
+ * Fixed size unordered map with keys and values stored in a single memory resource.
+ *
+ * Entries are stored in blocks of kBlockSize: keys of a block are next to each other, followed by their values.
+ * A lookup scans keys a block at a time, and the value of the matching key is in the same block,
+ * usually within the same or the next cache line.
+ *
+ * Removing an entry moves the last entry into its place, so entries are always dense and erase takes
+ * constant time once the key is found. Once many entries are removed, shrink moves the remaining entries
+ * into a smaller memory resource.
+ */
+template<typename Key,
+		 typename T>
+class CompactDictionary {
+public:
+	static_assert(std::is_nothrow_move_constructible_v<Key>,
+				  "Key is moved into place after the value is constructed and must not throw");
+
+	using value_type = T;
+	using key_type = Key;
+	using size_type = MemoryResource::size_type;
+
+	/// Number of entries in a block.
+	static constexpr size_type kBlockSize = 8;
+
+	struct EntryConstRef {
+		Key const&	key;
+		T const&	value;
+	};
+
+	struct EntryRef {
+		Key const&	key;
+		T&			value;
+	};
+
+private:
+
+	/// Raw storage of a block of entries. Only entries below the size of the dictionary are constructed.
+	struct Block {
+		alignas(Key) byte	keys[kBlockSize * sizeof(Key)];
+		alignas(T) byte		values[kBlockSize * sizeof(T)];
+	};
+
+public:
+
+	template<typename Dict, typename Ref>
+	struct Iterator_base {
+
+		constexpr Iterator_base(Dict* dictionary, size_type index) noexcept
+			: _dictionary{dictionary}
+			, _index{index}
+		{}
+
+		constexpr bool operator!= (Iterator_base const& other) const noexcept { return (_index != other._index); }
+		constexpr bool operator== (Iterator_base const& other) const noexcept { return (_index == other._index); }
+
+		Ref operator* () const noexcept {
+			return {_dictionary->keyAt(_index), _dictionary->valueAt(_index)};
+		}
+
+		Iterator_base& operator++ () noexcept {
+			++_index;
+
+			return *this;
+		}
+
+	private:
+		Dict*		_dictionary;
+		size_type	_index;
+	};
+
+	using Iterator = Iterator_base<CompactDictionary, EntryRef>;
+	using const_iterator = Iterator_base<CompactDictionary const, EntryConstRef>;
+
+public:
+
+	~CompactDictionary() {
+		clear();
+	}
+
+	constexpr CompactDictionary() noexcept = default;
+
+	CompactDictionary(CompactDictionary const&) = delete;
+	CompactDictionary& operator= (CompactDictionary const&) = delete;
+
+	CompactDictionary(CompactDictionary&& rhs) noexcept
+		: _memory{mv(rhs._memory)}
+		, _size{exchange(rhs._size, 0)}
+	{}
+
+	CompactDictionary& operator= (CompactDictionary&& rhs) noexcept {
+		return swap(rhs);
+	}
+
+	/**
+	 * Construct an empty dictionary in a given memory resource.
+	 * Capacity of the dictionary is determined by the size of the resource.
+	 */
+	explicit CompactDictionary(MemoryResource&& memory) noexcept
+		: _memory{mv(memory)}
+	{}
+
+	CompactDictionary& swap(CompactDictionary& rhs) noexcept {
+		using std::swap;
+		swap(_memory, rhs._memory);
+		swap(_size, rhs._size);
+
+		return *this;
+	}
+
+	constexpr bool empty() const noexcept { return (_size == 0); }
+	constexpr size_type size() const noexcept { return _size; }
+	constexpr size_type capacity() const noexcept { return (_memory.size() / sizeof(Block)) * kBlockSize; }
+
+	/// @return Size in bytes of memory required to store a given number of entries.
+	static constexpr size_type memorySize(size_type capacity) noexcept {
+		return ((capacity + kBlockSize - 1) / kBlockSize) * sizeof(Block);
+	}
+
+	bool contains(Key const& key) const noexcept {
+		return (indexOf(key) != _size);
+	}
+
+	Optional<T&> find(Key const& key) noexcept {
+		auto const index = indexOf(key);
+		if (index == _size) {
+			return none;
+		}
+
+		return valueAt(index);
+	}
+
+	Optional<T const&> find(Key const& key) const noexcept {
+		auto const index = indexOf(key);
+		if (index == _size) {
+			return none;
+		}
+
+		return valueAt(index);
+	}
+
+	/**
+	 * Add an entry. Like Dictionary, no check is made if an entry with the same key exists.
+	 * @return Reference to the value or an error if the dictionary is full.
+	 */
+	template<typename... Args>
+	Result<T&, Error>
+	put(Key key, Args&&... args) {
+		if (_size == capacity()) {
+			return makeError(BasicError::Overflow, "CompactDictionary::put");
+		}
+
+		auto value = ctor(valueAt(_size), fwd<Args>(args)...);
+		ctor(keyAt(_size), mv(key));
+		_size += 1;
+
+		return Result<T&, Error>{types::okTag, in_place, *value};
+	}
+
+	/**
+	 * Remove the entry with a given key. The last entry is moved into its place.
+	 * @note This method changes the order of entries and invalidates all iterators.
+	 * @return True if an entry was removed.
+	 */
+	bool erase(Key const& key) {
+		auto const index = indexOf(key);
+		if (index == _size) {
+			return false;
+		}
+
+		auto const last = _size - 1;
+		if (index != last) {
+			keyAt(index) = mv(keyAt(last));
+			valueAt(index) = mv(valueAt(last));
+		}
+
+		dtor(keyAt(last));
+		dtor(valueAt(last));
+		_size = last;
+
+		return true;
+	}
+
+	/// Remove all entries.
+	void clear() noexcept {
+		for (size_type i = 0; i < _size; ++i) {
+			dtor(keyAt(i));
+			dtor(valueAt(i));
+		}
+
+		_size = 0;
+	}
+
+	/**
+	 * Move entries into memory just enough to store them, releasing the memory held now.
+	 * @param memoryManager Memory manager to allocate the new memory from.
+	 * @return Error if memory could not be allocated, in which case the dictionary is left unchanged.
+	 */
+	Result<void, Error> shrink(MemoryManager& memoryManager) {
+		auto const requiredSize = memorySize(_size);
+		if (requiredSize == _memory.size()) {
+			return Ok();
+		}
+
+		CompactDictionary shrunk;
+		if (requiredSize != 0) {
+			auto maybeMemory = memoryManager.allocate(requiredSize);
+			if (!maybeMemory) {
+				return maybeMemory.moveError();
+			}
+
+			shrunk._memory = maybeMemory.moveResult();
+		}
+
+		for (size_type i = 0; i < _size; ++i) {
+			ctor(shrunk.valueAt(i), mv(valueAt(i)));
+			ctor(shrunk.keyAt(i), mv(keyAt(i)));
+			shrunk._size += 1;
+		}
+
+		swap(shrunk);
+
+		return Ok();
+	}
+
+	/// Move entries into memory just enough to store them, allocated from the system heap.
+	Result<void, Error> shrink() {
+		return shrink(getSystemHeapMemoryManager());
+	}
+
+	Iterator begin() noexcept { return {this, 0}; }
+	Iterator end() noexcept { return {this, _size}; }
+
+	const_iterator begin() const noexcept { return {this, 0}; }
+	const_iterator end() const noexcept { return {this, _size}; }
+
+protected:
+
+	Block* blocks() noexcept { return static_cast<Block*>(_memory.view().dataAddress()); }
+	Block const* blocks() const noexcept { return static_cast<Block const*>(_memory.view().dataAddress()); }
+
+	Key& keyAt(size_type index) noexcept {
+		return reinterpret_cast<Key*>(blocks()[index / kBlockSize].keys)[index % kBlockSize];
+	}
+
+	Key const& keyAt(size_type index) const noexcept {
+		return reinterpret_cast<Key const*>(blocks()[index / kBlockSize].keys)[index % kBlockSize];
+	}
+
+	T& valueAt(size_type index) noexcept {
+		return reinterpret_cast<T*>(blocks()[index / kBlockSize].values)[index % kBlockSize];
+	}
+
+	T const& valueAt(size_type index) const noexcept {
+		return reinterpret_cast<T const*>(blocks()[index / kBlockSize].values)[index % kBlockSize];
+	}
+
+	/// @return Index of the entry with a given key or size() if there is none.
+	size_type indexOf(Key const& key) const noexcept {
+		auto block = blocks();
+		for (size_type start = 0; start < _size; start += kBlockSize, ++block) {
+			auto const keys = reinterpret_cast<Key const*>(block->keys);
+			auto const nbKeys = (_size - start < kBlockSize) ? _size - start : kBlockSize;
+			for (size_type i = 0; i < nbKeys; ++i) {
+				if (keys[i] == key) {
+					return start + i;
+				}
+			}
+		}
+
+		return _size;
+	}
+
+private:
+	MemoryResource	_memory;
+	size_type		_size{0};
+};
+
+
+/**
+ * Create a new compact dictionary with a given capacity.
+ * @param memoryManager Memory manager to allocate memory for entries from.
+ * @param capacity Desired dictionary capacity, rounded up to a whole number of blocks.
+ * @return A new empty dictionary or an error if memory could not be allocated.
+ */
+template<typename K, typename T>
+[[nodiscard]]
+Result<CompactDictionary<K, T>, Error>
+makeCompactDictionary(MemoryManager& memoryManager, typename CompactDictionary<K, T>::size_type capacity) noexcept {
+	auto maybeMemory = memoryManager.allocate(CompactDictionary<K, T>::memorySize(capacity));
+	if (!maybeMemory) {
+		return maybeMemory.moveError();
+	}
+
+	return Result<CompactDictionary<K, T>, Error>{types::okTag, in_place, maybeMemory.moveResult()};
+}
+
+/**
+ * Create a new compact dictionary with a given capacity, allocated from the system heap.
+ * @param capacity Desired dictionary capacity, rounded up to a whole number of blocks.
+ * @return A new empty dictionary or an error if memory could not be allocated.
+ */
+template<typename K, typename T>
+[[nodiscard]]
+Result<CompactDictionary<K, T>, Error>
+makeCompactDictionary(typename CompactDictionary<K, T>::size_type capacity) noexcept {
+	return makeCompactDictionary<K, T>(getSystemHeapMemoryManager(), capacity);
+}
+
+}  // End of namespace Solace
+#endif  // SOLACE_COMPACTDICTIONARY_HPP
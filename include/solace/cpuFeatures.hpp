@@ -0,0 +1,245 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: CPU features detection
+ *	@file		solace/cpuFeatures.hpp
+ *	@brief		Runtime detection of CPU features and dispatch of optimized kernels.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_CPUFEATURES_HPP
+#define SOLACE_CPUFEATURES_HPP
+
+#include "solace/types.hpp"
+#include "solace/stringView.hpp"
+#include "solace/optional.hpp"
+
+#include <atomic>
+#include <initializer_list>
+
+
+namespace Solace {
+
+/**
+ * CPU features that optimized kernels may depend on.
+ */
+enum class CpuFeature : uint8 {
+	// x86 family
+	SSE2 = 0,
+	SSSE3,
+	SSE4_1,
+	SSE4_2,
+	POPCNT,
+	PCLMUL,
+	AVX,
+	AVX2,
+	AVX512F,
+	AVX512BW,
+	BMI1,
+	BMI2,
+	SHA,
+	ERMS,		//!< Enhanced REP MOVSB/STOSB
+
+	// ARM family
+	NEON,
+	ARM_AES,
+	ARM_PMULL,
+	ARM_SHA1,
+	ARM_SHA2,
+	ARM_CRC32,
+};
+
+
+/**
+ * A set of CPU features.
+ */
+class CpuFeatureSet {
+public:
+
+	constexpr CpuFeatureSet() noexcept = default;
+
+	constexpr CpuFeatureSet(std::initializer_list<CpuFeature> features) noexcept {
+		for (auto f : features) {
+			_bits |= bit(f);
+		}
+	}
+
+	/// Check if the given feature is in the set.
+	constexpr bool has(CpuFeature feature) const noexcept { return (_bits & bit(feature)) != 0; }
+
+	/// Check if all features of the other set are in this set.
+	constexpr bool contains(CpuFeatureSet other) const noexcept { return (_bits & other._bits) == other._bits; }
+
+	constexpr CpuFeatureSet with(CpuFeature feature) const noexcept { return CpuFeatureSet{_bits | bit(feature)}; }
+
+	constexpr CpuFeatureSet intersect(CpuFeatureSet other) const noexcept { return CpuFeatureSet{_bits & other._bits}; }
+
+	constexpr bool empty() const noexcept { return _bits == 0; }
+
+	constexpr bool operator== (CpuFeatureSet const& rhs) const noexcept { return _bits == rhs._bits; }
+	constexpr bool operator!= (CpuFeatureSet const& rhs) const noexcept { return _bits != rhs._bits; }
+
+private:
+	constexpr explicit CpuFeatureSet(uint64 bits) noexcept
+		: _bits{bits}
+	{}
+
+	static constexpr uint64 bit(CpuFeature feature) noexcept { return uint64{1} << static_cast<uint8>(feature); }
+
+	uint64	_bits{0};
+};
+
+
+/**
+ * Levels of CPU capabilities.
+ * Each level includes all features of the levels below it for the same CPU family.
+ */
+enum class CpuLevel : uint8 {
+	Scalar = 0,		//!< Portable code only
+	SSE2,			//!< x86-64 baseline
+	SSE4_2,			//!< SSSE3, SSE4.1, SSE4.2, POPCNT, PCLMUL, SHA
+	AVX2,			//!< AVX, AVX2, BMI1, BMI2
+	AVX512,			//!< AVX-512 F and BW
+	NEON,			//!< ARM Advanced SIMD, including crypto extensions
+	Native,			//!< All features supported by the CPU
+};
+
+
+/**
+ * Name of the environment variable to restrict features used by the process to a given level.
+ * Accepted values are: scalar, sse2, sse4.2, avx2, avx512, neon and native.
+ * This is intended for testing and benchmarking of different kernel implementations.
+ */
+inline constexpr char const kCpuLevelEnvVar[] = "SOLACE_CPU_LEVEL";
+
+/**
+ * Parse the name of a CPU level.
+ * @param name Name of the level, such as 'avx2'. Case-insensitive.
+ * @return Level if the name is known, none otherwise.
+ */
+Optional<CpuLevel> parseCpuLevel(StringView name) noexcept;
+
+/**
+ * Get features a given CPU level permits.
+ * @param level CPU level.
+ * @return A set of features allowed to be used at the given level.
+ */
+CpuFeatureSet cpuLevelFeatures(CpuLevel level) noexcept;
+
+/**
+ * Detect features supported by the CPU (and enabled by the OS) the process is running on.
+ * @note This queries the hardware on each call, @see cpuFeatures() for a cached value.
+ * @return A set of supported features.
+ */
+CpuFeatureSet detectCpuFeatures() noexcept;
+
+/**
+ * Get features optimized kernels are allowed to use.
+ * Features are detected once and restricted by the level set in SOLACE_CPU_LEVEL environment variable, if any.
+ * @return A set of features to use.
+ */
+CpuFeatureSet cpuFeatures() noexcept;
+
+/**
+ * Check if a feature is available to optimized kernels.
+ * @param feature A feature to check.
+ * @return True if the feature can be used.
+ */
+inline bool hasCpuFeature(CpuFeature feature) noexcept {
+	return cpuFeatures().has(feature);
+}
+
+
+/**
+ * A function pointer bound on the first call to the best implementation supported by the CPU.
+ * Implementations are given as a list of candidates ordered by preference with a set of required features.
+ * The first candidate whose features are all available is selected. Fallback implementation is used if none is.
+ *
+ * Example:
+ * @code
+ * static KernelDispatch<uint32(MemoryView)>::Candidate const kCandidates[] = {
+ *	{{CpuFeature::AVX2}, countAvx2},
+ *	{{CpuFeature::SSE4_2, CpuFeature::POPCNT}, countSse42},
+ * };
+ * static KernelDispatch<uint32(MemoryView)> count{kCandidates, countScalar};
+ * @endcode
+ */
+template <typename Signature>
+class KernelDispatch;
+
+template <typename R, typename... Args>
+class KernelDispatch<R(Args...)> {
+public:
+	using FunctionPointer = R (*)(Args...);
+
+	struct Candidate {
+		CpuFeatureSet		required;
+		FunctionPointer		implementation;
+	};
+
+public:
+
+	template <size_t N>
+	constexpr KernelDispatch(Candidate const (&candidates)[N], FunctionPointer fallback) noexcept
+		: _candidates{candidates}
+		, _nbCandidates{N}
+		, _fallback{fallback}
+	{}
+
+	constexpr explicit KernelDispatch(FunctionPointer fallback) noexcept
+		: _candidates{nullptr}
+		, _nbCandidates{0}
+		, _fallback{fallback}
+	{}
+
+	R operator() (Args... args) const {
+		return get()(fwd<Args>(args)...);
+	}
+
+	/// Get selected implementation.
+	FunctionPointer get() const noexcept {
+		auto impl = _selected.load(std::memory_order_relaxed);
+		if (!impl) {
+			impl = select(cpuFeatures());
+			_selected.store(impl, std::memory_order_relaxed);
+		}
+
+		return impl;
+	}
+
+	/**
+	 * Select implementation for a given feature set.
+	 * @param features Available features.
+	 * @return Best implementation for the given features.
+	 */
+	FunctionPointer select(CpuFeatureSet features) const noexcept {
+		for (size_t i = 0; i < _nbCandidates; ++i) {
+			if (features.contains(_candidates[i].required)) {
+				return _candidates[i].implementation;
+			}
+		}
+
+		return _fallback;
+	}
+
+private:
+	Candidate const*						_candidates;
+	size_t									_nbCandidates;
+	FunctionPointer							_fallback;
+	mutable std::atomic<FunctionPointer>	_selected{nullptr};
+};
+
+}  // End of namespace Solace
+#endif  // SOLACE_CPUFEATURES_HPP
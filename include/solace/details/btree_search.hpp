@@ -0,0 +1,154 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace
+ *	@file		solace/details/btree_search.hpp
+ *  @brief		Search of a key within a sorted node of a B-tree.
+ * Note: Not to be included directly.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_DETAILS_BTREE_SEARCH_HPP
+#define SOLACE_DETAILS_BTREE_SEARCH_HPP
+
+#include "solace/types.hpp"
+
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+
+namespace Solace {
+namespace details {
+
+/// Number of keys, below which integer keys are counted with a linear branchless scan instead of a binary search.
+constexpr uint32 kLinearSearchThreshold = 32;
+
+
+/**
+ * Count integer keys less than (or, if OrEqual, less than or equal to) the given key.
+ * Keys are compared all at once, without branching on the result, which is faster than a binary search
+ * over the few cache lines of a node. SIMD compare is used for 32 bit keys, and for 64 bit keys if SSE4.2
+ * or AVX2 is enabled at compile time.
+ */
+template<bool OrEqual, typename K>
+uint32 countIntegerKeys(K const* keys, uint32 n, K key) noexcept {
+	uint32 count = 0;
+	uint32 i = 0;
+
+#if defined(__SSE2__)
+	if constexpr (sizeof(K) == 4) {
+		// Signed compare only: bias unsigned values into the signed range
+		auto const bias = _mm_set1_epi32(std::is_signed<K>::value ? 0 : static_cast<int>(0x80000000U));
+		auto const needle = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(key)), bias);
+		for (; i + 4 <= n; i += 4) {
+			auto const k = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(keys + i)), bias);
+			auto const mask = OrEqual
+					? (~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(k, needle))) & 0xF)
+					: _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(needle, k)));
+			count += static_cast<uint32>(__builtin_popcount(static_cast<unsigned>(mask)));
+		}
+	}
+#endif
+
+#if defined(__AVX2__)
+	if constexpr (sizeof(K) == 8) {
+		auto const bias = _mm256_set1_epi64x(std::is_signed<K>::value ? 0 : static_cast<long long>(0x8000000000000000ULL));  // NOLINT
+		auto const needle = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(key)), bias);  // NOLINT
+		for (; i + 4 <= n; i += 4) {
+			auto const k = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(keys + i)), bias);
+			auto const mask = OrEqual
+					? (~_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(k, needle))) & 0xF)
+					: _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(needle, k)));
+			count += static_cast<uint32>(__builtin_popcount(static_cast<unsigned>(mask)));
+		}
+	}
+#elif defined(__SSE4_2__)
+	if constexpr (sizeof(K) == 8) {
+		auto const bias = _mm_set1_epi64x(std::is_signed<K>::value ? 0 : static_cast<long long>(0x8000000000000000ULL));  // NOLINT
+		auto const needle = _mm_xor_si128(_mm_set1_epi64x(static_cast<long long>(key)), bias);  // NOLINT
+		for (; i + 2 <= n; i += 2) {
+			auto const k = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(keys + i)), bias);
+			auto const mask = OrEqual
+					? (~_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(k, needle))) & 0x3)
+					: _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(needle, k)));
+			count += static_cast<uint32>(__builtin_popcount(static_cast<unsigned>(mask)));
+		}
+	}
+#endif
+
+	for (; i < n; ++i) {
+		count += OrEqual
+				? static_cast<uint32>(!(key < keys[i]))
+				: static_cast<uint32>(keys[i] < key);
+	}
+
+	return count;
+}
+
+
+/**
+ * Count keys of a sorted node less than (or, if OrEqual, less than or equal to) the given key.
+ * This is the position of the lower (upper) bound of the key in the node.
+ */
+template<bool OrEqual, typename K>
+uint32 countKeys(K const* keys, uint32 n, K const& key) noexcept {
+	uint32 low = 0;
+	uint32 high = n;
+
+	constexpr bool isIntegral = std::is_integral<K>::value && !std::is_same<K, bool>::value;
+	while (high - low > (isIntegral ? kLinearSearchThreshold : 0)) {
+		auto const mid = low + (high - low) / 2;
+		bool const isBefore = OrEqual
+				? !(key < keys[mid])
+				: (keys[mid] < key);
+		if (isBefore) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	if constexpr (isIntegral) {
+		return low + countIntegerKeys<OrEqual>(keys + low, high - low, key);
+	} else {
+		return low;
+	}
+}
+
+
+/// @return Index of the first key not less than the given key.
+template<typename K>
+uint32 lowerBound(K const* keys, uint32 n, K const& key) noexcept {
+	return countKeys<false>(keys, n, key);
+}
+
+/// @return Index of the first key greater than the given key.
+template<typename K>
+uint32 upperBound(K const* keys, uint32 n, K const& key) noexcept {
+	return countKeys<true>(keys, n, key);
+}
+
+}  // End of namespace details
+}  // End of namespace Solace
+#endif  // SOLACE_DETAILS_BTREE_SEARCH_HPP
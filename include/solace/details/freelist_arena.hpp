@@ -0,0 +1,160 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace
+ *	@file		solace/details/freelist_arena.hpp
+ *  @brief		First-fit free list allocator over a fixed memory region.
+ * Note: Not to be included directly.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_DETAILS_FREELIST_ARENA_HPP
+#define SOLACE_DETAILS_FREELIST_ARENA_HPP
+
+#include "solace/utils.hpp"
+#include "solace/mutableMemoryView.hpp"
+
+
+namespace Solace {
+namespace details {
+
+/**
+ * First-fit allocator over a fixed memory region.
+ * Free blocks are kept in a list ordered by address and are merged with their neighbours when released.
+ * Allocation sizes are rounded up to kAlignment, region is expected to be kAlignment aligned.
+ */
+class FreeListArena {
+public:
+	using size_type = MemoryView::size_type;
+
+	static constexpr size_type kAlignment = 64;
+
+public:
+	constexpr FreeListArena() noexcept = default;
+
+	FreeListArena(FreeListArena const&) = delete;
+	FreeListArena& operator= (FreeListArena const&) = delete;
+
+	/// Start managing a memory region. All of it is free.
+	void reset(byte* region, size_type size) noexcept {
+		_region = region;
+		_size = size;
+		_available = size;
+		_freeList = nullptr;
+		if (size >= sizeof(FreeBlock)) {
+			_freeList = ctor(*reinterpret_cast<FreeBlock*>(region));
+			_freeList->size = size;
+			_freeList->next = nullptr;
+		}
+	}
+
+	/// @return Size of the region in bytes.
+	constexpr size_type capacity() const noexcept { return _size; }
+
+	/// @return Number of free bytes in the region.
+	constexpr size_type available() const noexcept { return _available; }
+
+	/// @return True if the address belongs to the region.
+	bool owns(void const* address) const noexcept {
+		auto const p = static_cast<byte const*>(address);
+		return (p >= _region) && (p < _region + _size);
+	}
+
+	/// @return Size of an allocation of the given number of bytes.
+	static constexpr size_type blockSize(size_type nbBytes) noexcept {
+		return ((nbBytes ? nbBytes : 1) + kAlignment - 1) & ~(kAlignment - 1);
+	}
+
+	/**
+	 * Allocate a block of memory.
+	 * @return Allocated block, of size blockSize(nbBytes), or an empty view if there is no free block large enough.
+	 */
+	MutableMemoryView allocate(size_type nbBytes) noexcept {
+		auto const size = blockSize(nbBytes);
+		if (size < nbBytes) {  // Overflow
+			return {};
+		}
+
+		for (FreeBlock** link = &_freeList; *link; link = &(*link)->next) {
+			auto block = *link;
+			if (block->size < size) {
+				continue;
+			}
+
+			if (block->size == size) {
+				*link = block->next;
+			} else {
+				auto rest = ctor(*reinterpret_cast<FreeBlock*>(reinterpret_cast<byte*>(block) + size));
+				rest->size = block->size - size;
+				rest->next = block->next;
+				*link = rest;
+			}
+
+			_available -= size;
+
+			return wrapMemory(reinterpret_cast<byte*>(block), size);
+		}
+
+		return {};
+	}
+
+	/// Return a block previously allocated from this arena.
+	void release(MemoryView block) noexcept {
+		auto const address = static_cast<byte*>(const_cast<MemoryView::MutableMemoryAddress>(block.dataAddress()));
+		auto const size = block.size();
+
+		FreeBlock* prev = nullptr;
+		FreeBlock* next = _freeList;
+		while (next && reinterpret_cast<byte*>(next) < address) {
+			prev = next;
+			next = next->next;
+		}
+
+		auto freed = ctor(*reinterpret_cast<FreeBlock*>(address));
+		freed->size = size;
+		freed->next = next;
+
+		if (next && address + size == reinterpret_cast<byte*>(next)) {
+			freed->size += next->size;
+			freed->next = next->next;
+		}
+
+		if (prev && reinterpret_cast<byte*>(prev) + prev->size == address) {
+			prev->size += freed->size;
+			prev->next = freed->next;
+		} else if (prev) {
+			prev->next = freed;
+		} else {
+			_freeList = freed;
+		}
+
+		_available += size;
+	}
+
+private:
+	struct FreeBlock {
+		size_type	size;
+		FreeBlock*	next;
+	};
+
+	byte*		_region{nullptr};
+	size_type	_size{0};
+	size_type	_available{0};
+	FreeBlock*	_freeList{nullptr};
+};
+
+}  // End of namespace details
+}  // End of namespace Solace
+#endif  // SOLACE_DETAILS_FREELIST_ARENA_HPP
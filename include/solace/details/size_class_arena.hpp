@@ -0,0 +1,219 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace
+ *	@file		solace/details/size_class_arena.hpp
+ *  @brief		Allocator of variable size blocks from chunks of a memory manager.
+ * Note: Not to be included directly.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_DETAILS_SIZE_CLASS_ARENA_HPP
+#define SOLACE_DETAILS_SIZE_CLASS_ARENA_HPP
+
+#include "solace/utils.hpp"
+#include "solace/memoryManager.hpp"
+#include "solace/result.hpp"
+#include "solace/posixErrorDomain.hpp"
+
+
+namespace Solace {
+namespace details {
+
+/**
+ * Allocator of small variable size blocks carved out of large chunks allocated from a memory manager.
+ * Block sizes are rounded up to a size class: multiples of kGranularity up to kMaxSmallSize, powers of two above.
+ * Released blocks are kept in a free list of their class for reuse, chunks are only returned when the arena is destroyed.
+ */
+class SizeClassArena {
+public:
+	using size_type = uint32;
+
+	static constexpr size_type kGranularity = 16;
+	static constexpr size_type kMaxSmallSize = 4096;
+	static constexpr size_type kChunkSize = 64 * 1024;
+	static constexpr size_type kMaxBlockSize = 128 * 1024;
+
+public:
+	~SizeClassArena() {
+		releaseChunks();
+	}
+
+	SizeClassArena(SizeClassArena const&) = delete;
+	SizeClassArena& operator= (SizeClassArena const&) = delete;
+
+	SizeClassArena(SizeClassArena&& rhs) noexcept
+		: _memoryManager{rhs._memoryManager}
+		, _chunks{exchange(rhs._chunks, nullptr)}
+		, _cursor{exchange(rhs._cursor, nullptr)}
+		, _cursorEnd{exchange(rhs._cursorEnd, nullptr)}
+		, _allocated{exchange(rhs._allocated, 0)}
+	{
+		for (size_type i = 0; i < kNbClasses; ++i) {
+			_freeLists[i] = exchange(rhs._freeLists[i], nullptr);
+		}
+	}
+
+	SizeClassArena& operator= (SizeClassArena&& rhs) noexcept {
+		return swap(rhs);
+	}
+
+	explicit SizeClassArena(MemoryManager& memoryManager) noexcept
+		: _memoryManager{&memoryManager}
+	{}
+
+	SizeClassArena& swap(SizeClassArena& rhs) noexcept {
+		using std::swap;
+		swap(_memoryManager, rhs._memoryManager);
+		swap(_chunks, rhs._chunks);
+		swap(_cursor, rhs._cursor);
+		swap(_cursorEnd, rhs._cursorEnd);
+		swap(_allocated, rhs._allocated);
+		swap(_freeLists, rhs._freeLists);
+
+		return *this;
+	}
+
+	/// @return Number of bytes in blocks currently allocated, including rounding to the size class.
+	constexpr size_t allocated() const noexcept { return _allocated; }
+
+	/// @return Size of a block allocated for a request of the given number of bytes.
+	static constexpr size_type blockSize(size_type nbBytes) noexcept {
+		return classSize(classOf(nbBytes));
+	}
+
+	/**
+	 * Allocate a block of at least the given size, aligned to kGranularity.
+	 * @return Address of the block or an error if the memory manager could not provide a new chunk.
+	 */
+	Result<void*, Error>
+	allocate(size_type nbBytes) {
+		if (nbBytes > kMaxBlockSize) {
+			return makeError(BasicError::Overflow, "SizeClassArena::allocate");
+		}
+
+		auto const cls = classOf(nbBytes);
+		auto const size = classSize(cls);
+
+		if (_freeLists[cls]) {
+			auto block = _freeLists[cls];
+			_freeLists[cls] = block->next;
+			_allocated += size;
+
+			return Result<void*, Error>{types::okTag, in_place, static_cast<void*>(block)};
+		}
+
+		if (static_cast<size_t>(_cursorEnd - _cursor) < size) {
+			// Large blocks get a chunk of their own so the current chunk is not abandoned
+			auto const isLarge = (size > kChunkSize / 4);
+			auto maybeChunk = newChunk(isLarge ? size : kChunkSize);
+			if (!maybeChunk) {
+				return maybeChunk.moveError();
+			}
+
+			if (isLarge) {
+				_allocated += size;
+				return maybeChunk;
+			}
+
+			_cursor = static_cast<byte*>(maybeChunk.unwrap());
+			_cursorEnd = _cursor + kChunkSize;
+		}
+
+		auto block = _cursor;
+		_cursor += size;
+		_allocated += size;
+
+		return Result<void*, Error>{types::okTag, in_place, static_cast<void*>(block)};
+	}
+
+	/// Return a block of a given requested size to the arena.
+	void release(void* address, size_type nbBytes) noexcept {
+		auto const cls = classOf(nbBytes);
+		auto block = static_cast<FreeBlock*>(address);
+		block->next = _freeLists[cls];
+		_freeLists[cls] = block;
+		_allocated -= classSize(cls);
+	}
+
+protected:
+
+	struct FreeBlock {
+		FreeBlock*	next;
+	};
+
+	struct Chunk {
+		MemoryResource	memory;
+		Chunk*			next;
+	};
+
+	static constexpr size_type kNbSmallClasses = kMaxSmallSize / kGranularity;
+	static constexpr size_type kNbClasses = kNbSmallClasses + 5;  // Up to 128KB: 8K, 16K, 32K, 64K, 128K
+	static constexpr size_type kChunkHeaderSize = (sizeof(Chunk) + kGranularity - 1) & ~(kGranularity - 1);
+
+	static constexpr size_type classOf(size_type nbBytes) noexcept {
+		if (nbBytes <= kMaxSmallSize) {
+			return (nbBytes ? nbBytes - 1 : 0) / kGranularity;
+		}
+
+		size_type cls = kNbSmallClasses;
+		for (size_type size = 2 * kMaxSmallSize; size < nbBytes; size *= 2) {
+			++cls;
+		}
+
+		return cls;
+	}
+
+	static constexpr size_type classSize(size_type cls) noexcept {
+		return (cls < kNbSmallClasses)
+				? (cls + 1) * kGranularity
+				: (2 * kMaxSmallSize) << (cls - kNbSmallClasses);
+	}
+
+	Result<void*, Error> newChunk(size_type size) {
+		auto maybeMemory = _memoryManager->allocate(kChunkHeaderSize + size + kGranularity);
+		if (!maybeMemory) {
+			return maybeMemory.moveError();
+		}
+
+		auto const address = reinterpret_cast<uintptr_t>(maybeMemory.unwrap().view().dataAddress());
+		auto const base = reinterpret_cast<byte*>((address + kGranularity - 1) & ~uintptr_t{kGranularity - 1});
+		_chunks = ctor(*reinterpret_cast<Chunk*>(base), maybeMemory.moveResult(), _chunks);
+
+		return Result<void*, Error>{types::okTag, in_place, static_cast<void*>(base + kChunkHeaderSize)};
+	}
+
+	void releaseChunks() noexcept {
+		while (_chunks) {
+			auto chunk = _chunks;
+			_chunks = chunk->next;
+
+			MemoryResource memory{mv(chunk->memory)};
+			dtor(*chunk);
+		}
+	}
+
+private:
+	MemoryManager*	_memoryManager;
+	Chunk*			_chunks{nullptr};
+	byte*			_cursor{nullptr};
+	byte*			_cursorEnd{nullptr};
+	size_t			_allocated{0};
+	FreeBlock*		_freeLists[kNbClasses]{};
+};
+
+}  // namespace details
+}  // namespace Solace
+#endif  // SOLACE_DETAILS_SIZE_CLASS_ARENA_HPP
@@ -16,7 +16,7 @@
 /*******************************************************************************
  * libSolace
  *	@file		solace/details/string_utils.hpp
- *  @brief		Implemenetation details for error string.
+ *  @brief		Implemenetation details for error message formatting.
  * Note: Not to be included directly.
  ******************************************************************************/
 #pragma once
@@ -29,72 +29,20 @@ namespace Solace {
 namespace details {
 
 /**
- * A short and limited string to be used in error handling.
- * Short string owns the memory it is given.
+ * A writer to format short messages, such as exception messages, into a fixed size buffer.
+ * Writer does not own the memory it is given and never allocates.
+ * Data that does not fit into the buffer is truncated. The buffer is always kept null-terminated.
  */
-struct ErrorString {
-
-	using value_type = StringView::value_type;
-	using size_type = StringView::size_type;
-
-	~ErrorString() noexcept;
-	ErrorString(ErrorString const& rhs) = delete;
-	ErrorString& operator= (ErrorString const& rhs) = delete;
-
-	ErrorString(ErrorString&& rhs) noexcept
-		: _size{rhs.size()}
-		, _message{exchange(rhs._message, nullptr)}
-	{}
-
-	ErrorString& operator= (ErrorString&& rhs) noexcept {
-		_size = exchange(rhs._size, 0);
-		_message = exchange(rhs._message, nullptr);
-
-		return *this;
-	}
-
-	ErrorString(StringView view);
-
-	ErrorString(char* data, size_type size) noexcept
-		: _size{size}
-		, _message{data}
-	{}
-
-	size_type size() const noexcept { return _size; }
-
-	value_type const* c_str() const noexcept { return _message; }
-	StringView view() const noexcept { return {_message, _size}; }
-
-private:
-
-	size_type		_size;
-	// Owned memory
-	value_type*		_message;
-};
-
-
-
 struct StringWriter {
-	using size_type = details::ErrorString::size_type;
-	using value_type = details::ErrorString::value_type;
-
-	static size_type measure(StringView value) noexcept { return value.size(); }
-
-	static size_type measure(int16 value) noexcept;
-	static size_type measure(int32 value) noexcept;
-	static size_type measure(int64 value) noexcept;
-
-	static size_type measure(uint16 value) noexcept;
-	static size_type measure(uint32 value) noexcept;
-	static size_type measure(uint64 value) noexcept;
-
-	template<size_t N>
-	static constexpr size_type measure(char const (&SOLACE_UNUSED(str))[N]) noexcept {  // NOLINT(whitespace/parens)
-		return N;
-	}
-
+	using size_type = StringView::size_type;
+	using value_type = StringView::value_type;
 
-	StringWriter(size_type memSize) noexcept;
+	/**
+	 * Construct a writer into the given buffer.
+	 * @param buffer Memory to write into.
+	 * @param capacity Size of the buffer in bytes, including space for null-terminator.
+	 */
+	StringWriter(value_type* buffer, size_type capacity) noexcept;
 
 	StringWriter& append(StringView data) noexcept;
 
@@ -108,19 +56,21 @@ struct StringWriter {
 
 	StringWriter& append(const char* value) noexcept;
 
+	//! Number of characters written so far, excluding null-terminator.
+	size_type size() const noexcept { return _offset; }
 
 	size_type remaining() const noexcept { return _size - _offset; }
 	value_type* currentBuffer() const noexcept { return _buffer + _offset; }
 
-	details::ErrorString build() noexcept {
-		_size = 0;
-		return {exchange(_buffer, nullptr), exchange(_offset, 0)};
-	}
+private:
+
+	StringWriter& advance(int nbWritten) noexcept;
 
 	size_type		_size;
 	size_type		_offset;
 	value_type*		_buffer;
 };
+
 }  // namespace details
 }  // namespace Solace
 #endif  // SOLACE_DETAILS_STRING_UTILS_HPP
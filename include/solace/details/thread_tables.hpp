@@ -0,0 +1,129 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace
+ *	@file		solace/details/thread_tables.hpp
+ *  @brief		Fixed set of statistics tables claimed by threads for exclusive writing.
+ * Note: Not to be included directly.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_DETAILS_THREAD_TABLES_HPP
+#define SOLACE_DETAILS_THREAD_TABLES_HPP
+
+#include "solace/types.hpp"
+
+#include <atomic>
+
+
+namespace Solace {
+namespace details {
+
+/**
+ * Fixed set of tables, each owned by at most one thread, and a shared table for threads that could not claim one.
+ * A thread claims a table on first use and releases it for reuse when the thread exits. Table content is preserved.
+ *
+ * Only the owning thread writes to its table, while the shared table is written by many threads:
+ * counters must be updated with @see incrementCounter that picks the update matching the table.
+ *
+ * Registry has no dynamic initialization: an instance with static storage duration is constant-initialized,
+ * thus safe to use from static initializers of other translation units.
+ * Claimed table is remembered in a thread local variable per table type, so there must be one registry per type.
+ *
+ * @tparam Table Type of a table. Must have `std::atomic<bool> isOwned` member.
+ * @tparam NbTables Number of tables threads can claim.
+ */
+template <typename Table, uint32 NbTables>
+struct ThreadTableRegistry {
+
+	/// @return Table of the calling thread. Claims a table if the thread does not have one yet.
+	Table& threadTable() noexcept {
+		static thread_local Handle handle;
+		if (handle.table) {
+			return *handle.table;
+		}
+
+		for (auto& table : tables) {
+			bool expected = false;
+			if (!table.isOwned.load(std::memory_order_relaxed) &&
+				table.isOwned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+				handle.table = &table;
+				handle.isOwned = true;
+				return table;
+			}
+		}
+
+		handle.table = &shared;
+		return shared;
+	}
+
+	/// @return True if the table is written by more than one thread.
+	bool isShared(Table const& table) const noexcept {
+		return (&table == &shared);
+	}
+
+	/// Call the given function for each table of the registry, including the shared one.
+	template <typename F>
+	void forEach(F&& f) {
+		for (auto& table : tables) {
+			f(table);
+		}
+		f(shared);
+	}
+
+	template <typename F>
+	void forEach(F&& f) const {
+		for (auto const& table : tables) {
+			f(table);
+		}
+		f(shared);
+	}
+
+	Table	tables[NbTables];
+	Table	shared;
+
+private:
+
+	/// Releases the table claimed by a thread when the thread exits.
+	struct Handle {
+		~Handle() noexcept {
+			if (isOwned) {
+				table->isOwned.store(false, std::memory_order_release);
+			}
+		}
+
+		Table*	table{nullptr};
+		bool	isOwned{false};
+	};
+};
+
+
+/**
+ * Add a value to a counter of a table of ThreadTableRegistry.
+ * A counter of an owned table has a single writer: a relaxed load and store is enough for it to be exact and
+ * avoids a locked instruction. Counters of the shared table are updated with an atomic read-modify-write.
+ */
+inline void
+incrementCounter(std::atomic<uint64>& counter, uint64 value, bool isShared) noexcept {
+	if (isShared) {
+		counter.fetch_add(value, std::memory_order_relaxed);
+	} else {
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+}
+
+}  // namespace details
+}  // namespace Solace
+#endif  // SOLACE_DETAILS_THREAD_TABLES_HPP
@@ -203,6 +203,32 @@ public:
         return none;
     }
 
+	/**
+	 * Remove the entry with a given key. The last entry is moved into its place.
+	 * @note This method changes the order of entries and invalidates all iterators.
+	 * @return True if an entry was removed.
+	 */
+	bool erase(Key const& key) {
+		auto keys = _lookup.view();
+		auto values = _values.view();
+		for (size_type i = 0; i < keys.size(); ++i) {
+			if (keys[i] == key) {
+				auto const last = keys.size() - 1;
+				if (i != last) {
+					keys[i] = mv(keys[last]);
+					values[i] = mv(values[last]);
+				}
+
+				_lookup.pop_back();
+				_values.pop_back();
+
+				return true;
+			}
+		}
+
+		return false;
+	}
+
 	Iterator begin() noexcept { return {_lookup.begin(), _values.begin()}; }
 	Iterator end() noexcept { return {_lookup.end(), _values.end()}; }
 
@@ -38,7 +38,12 @@ namespace Solace {
 class Error {
 public:
 
-    //! Construct error with a message
+    /**
+     * Construct error with a message
+     * @param errorDomain Domain of the error. Must not be empty atom.
+     * @param code Error code.
+     * @param tag Tag for the error.
+     */
 	constexpr Error(AtomValue errorDomain, int code, StringView tag) noexcept
 		: _code{code}
 		, _domain{errorDomain}
@@ -106,5 +111,19 @@ static_assert(sizeof(Error) <= 4*sizeof(void*),
 static_assert(std::is_trivially_copyable<Error>::value,
               "Error is not trivially copyable");
 
+
+/**
+ * Errors always belong to a domain, thus an error with an empty domain atom is never valid.
+ * Optional<Error> (and Result<void, Error>) use it to represent absence of an error.
+ */
+template <>
+struct OptionalNiche<Error> : std::true_type {
+	static constexpr Error none() noexcept { return Error{AtomValue{}, 0}; }
+	static constexpr bool isNone(Error const& error) noexcept { return error.domain() == AtomValue{}; }
+};
+
+static_assert(sizeof(Optional<Error>) == sizeof(Error),
+			  "Optional<Error> must not be larger than Error");
+
 }  // End of namespace Solace
 #endif  // SOLACE_ERROR_HPP_
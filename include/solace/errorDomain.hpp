@@ -55,6 +55,8 @@ struct ErrorDomain {
 
 /**
  * Lookup error domain/category by atom value
+ * @note The lookup is lock-free and can be safely called from any thread,
+ * including concurrently with registration of new domains.
  * @param categoryId Atom identifing error domain
  * @return An error domain if one was found.
  */
@@ -62,9 +64,11 @@ Optional<ErrorDomain&> findErrorDomain(AtomValue categoryId) noexcept;
 
 /**
  * Register Error domain
- * @param categoryId Atom value of a error category
+ * Registering a domain for a category that already has one replaces previously registered domain.
+ * @note The registry has a fixed capacity and never allocates memory.
+ * @param categoryId Atom value of a error category. Empty atom can not be registered.
  * @param domain Error domain to be associated with the category
- * @return Registration id
+ * @return Registration id: number of registered domains, or 0 if the domain could not be registered.
  */
 uint32 registerErrorDomain(AtomValue categoryId, ErrorDomain& domain) noexcept;
 
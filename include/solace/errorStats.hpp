@@ -0,0 +1,102 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Error statistics
+ *	@file		solace/errorStats.hpp
+ *	@brief		Opt-in counters of errors created by the process.
+ *
+ * When the library is built with SOLACE_ERROR_STATS defined (cmake -DERROR_STATS=ON),
+ * every error created via makeError/makeErrno/makeSystemError is counted by (domain, code, tag).
+ * Counting is done into per-thread tables with a relaxed load and store of a counter, without a locked instruction.
+ * Nothing is done on the success path.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_ERRORSTATS_HPP
+#define SOLACE_ERRORSTATS_HPP
+
+#include "solace/error.hpp"
+#include "solace/arrayView.hpp"
+
+
+namespace Solace {
+
+/**
+ * Number of times an error with a given domain, code and tag has been created.
+ */
+struct ErrorStatsEntry {
+	AtomValue	domain;
+	int			code;
+	StringView	tag;
+	uint64		count;
+};
+
+
+/**
+ * Count an occurrence of an error.
+ * @note Errors are distinguished by tag's address, thus tags are expected to be string literals.
+ * @param domain Domain of the error.
+ * @param code Error code.
+ * @param tag Error tag.
+ */
+void recordError(AtomValue domain, int code, StringView tag) noexcept;
+
+/**
+ * Count an occurrence of an error.
+ * @param error Error to count.
+ */
+inline void recordError(Error const& error) noexcept {
+	recordError(error.domain(), error.value(), error.tag());
+}
+
+
+/**
+ * Take a snapshot of error counters aggregated across all threads.
+ * @param dest A buffer to write counters into. If there are more distinct errors than the buffer can hold
+ * - extra counters are not reported.
+ * @return Number of entries written into the buffer.
+ */
+uint32 errorStatsSnapshot(ArrayView<ErrorStatsEntry> dest) noexcept;
+
+/**
+ * Get most frequent errors.
+ * @param buffer A buffer to aggregate counters into.
+ * @param n Number of most frequent errors to report.
+ * @return A slice of the buffer with up to n most frequent errors, sorted by count in descending order.
+ */
+ArrayView<ErrorStatsEntry> errorStatsTopN(ArrayView<ErrorStatsEntry> buffer, uint32 n) noexcept;
+
+/**
+ * Reset all error counters to zero.
+ * @note Errors recorded concurrently with the reset may or may not be counted.
+ */
+void errorStatsReset() noexcept;
+
+
+/**
+ * Count the error if error statistics is enabled.
+ * @param error An error to count.
+ * @return The error given.
+ */
+inline Error trackError(Error error) noexcept {
+#ifdef SOLACE_ERROR_STATS
+	recordError(error);
+#endif  // SOLACE_ERROR_STATS
+
+	return error;
+}
+
+}  // End of namespace Solace
+#endif  // SOLACE_ERRORSTATS_HPP
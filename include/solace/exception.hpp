@@ -32,6 +32,7 @@
 #endif  // SOLACE_DEBUG
 */
 
+#include <atomic>
 #include <exception>
 
 
@@ -39,38 +40,83 @@ namespace Solace {
 
 /** Base of exceptions hierarchy.
  *
+ * Exceptions store raw values describing the error and only format a human-readable message
+ * when it is requested via @see what() or @see getMessage(). The message is formatted into a fixed size buffer,
+ * owned by the exception object, thus throwing and catching an exception never allocates memory.
+ * Formatting happens at most once, even if the message is requested concurrently from several threads.
  */
 class Exception :
         public std::exception {
+public:
+	using size_type = StringView::size_type;
+
+	//! Maximum length of an exception message. Longer messages are truncated.
+	static constexpr size_type kMaxMessageSize = 127;
+
 public:
 
     ~Exception() noexcept override = default;
 
-    //! Construct exception w. message
+	//! Construct exception w. message. Message is copied into the exception.
 	Exception(StringView message) noexcept;
-	Exception(Exception&& other) noexcept = default;
 
-	virtual StringView getMessage() const noexcept {
-		return _message.view();
-	}
+	//! Copy exception. Copy carries formatted message of the original, thus slicing copies are safe.
+	Exception(Exception const& other) noexcept;
+
+	Exception& operator= (Exception const& rhs) = delete;
+
+	//! Get message description of the exception.
+	StringView getMessage() const noexcept;
 
     //! STD compatible message:
     const char* what() const noexcept override;
 
     //! Get message description of the exception.
 	StringView toString() const noexcept {
-		return _message.view();
+		return getMessage();
 	}
 
 protected:
 
-	/*constexpr */Exception(details::ErrorString&& msg) noexcept
-		: _message{mv(msg)}
-	{}
+	//! Tag type to select constructor that defers message formatting.
+	struct DeferFormatting {};
+
+	/**
+	 * Construct exception which message is formatted on first access by @see formatMessage.
+	 * @param messagePrefix Message prefix copied into the exception. Formatted message is appended to it.
+	 */
+	Exception(DeferFormatting, StringView messagePrefix = StringView{}) noexcept;
+
+	/**
+	 * Copy exception without formatting its message: the copy formats it on first access.
+	 * Used by copy constructors of derived types, as they copy the values @see formatMessage relies upon.
+	 */
+	Exception(DeferFormatting, Exception const& other) noexcept;
+
+	/**
+	 * Format exception message.
+	 * Called at most once: on the first request of the exception message.
+	 * @param writer A writer to append message to.
+	 */
+	virtual void formatMessage(details::StringWriter& writer) const noexcept;
+
+private:
+
+	enum class FormatState : uint8 {
+		Deferred,
+		Formatting,
+		Formatted
+	};
+
+	void ensureFormatted() const noexcept;
+	void copyMessage(Exception const& other) noexcept;
 
 private:
 
-	details::ErrorString	_message;		//!< Message of the exception.
+	mutable std::atomic<FormatState>	_state;			//!< Formatting state of the message.
+	size_type			_prefixSize;						//!< Length of the message prefix given at construction.
+	mutable size_type	_size;								//!< Length of the message, valid once formatted.
+	mutable char		_message[kMaxMessageSize + 1];		//!< Message of the exception.
 
 #ifdef SOLACE_DEBUG
 //  const Debug::Trace 	_trace;			//!< Stack trace
@@ -86,12 +132,21 @@ struct IllegalArgumentException final : public Exception {
 
 	IllegalArgumentException() noexcept;
 
-	IllegalArgumentException(StringLiteral msg) noexcept;
+	IllegalArgumentException(StringLiteral argumentName) noexcept;
+
+	IllegalArgumentException(IllegalArgumentException const& other) noexcept;
+
+protected:
+	void formatMessage(details::StringWriter& writer) const noexcept override;
+
+private:
+	StringLiteral	_argumentName;
 };
 
 
 /**
  * An error type to signal that index value is outsige of acceptable range.
+ * @note Message prefix is not copied and must be a string literal or have static storage duration.
 */
 struct IndexOutOfRangeException final : public Exception {
     IndexOutOfRangeException() noexcept;
@@ -110,6 +165,16 @@ struct IndexOutOfRangeException final : public Exception {
 	IndexOutOfRangeException(uint32 index, uint32 minValue, uint32 maxValue, const char* messagePrefix) noexcept;
 	IndexOutOfRangeException(uint16 index, uint16 minValue, uint16 maxValue, const char* messagePrefix) noexcept;
 
+	IndexOutOfRangeException(IndexOutOfRangeException const& other) noexcept;
+
+protected:
+	void formatMessage(details::StringWriter& writer) const noexcept override;
+
+private:
+	const char*		_messagePrefix;
+	uint64			_index;
+	uint64			_minValue;
+	uint64			_maxValue;
 };
 
 /**
@@ -123,6 +188,17 @@ struct OverflowException final : public Exception {
 	OverflowException(uint16 index, uint16 minValue, uint16 maxValue) noexcept;
 	OverflowException(uint32 index, uint32 minValue, uint32 maxValue) noexcept;
 	OverflowException(uint64 index, uint64 minValue, uint64 maxValue) noexcept;
+
+	OverflowException(OverflowException const& other) noexcept;
+
+protected:
+	void formatMessage(details::StringWriter& writer) const noexcept override;
+
+private:
+	StringLiteral	_indexName;
+	uint64			_index;
+	uint64			_minValue;
+	uint64			_maxValue;
 };
 
 
@@ -133,16 +209,33 @@ struct NoSuchElementException final : public Exception {
     NoSuchElementException() noexcept;
 
 	NoSuchElementException(StringLiteral elementName) noexcept;
+
+	NoSuchElementException(NoSuchElementException const& other) noexcept;
+
+protected:
+	void formatMessage(details::StringWriter& writer) const noexcept override;
+
+private:
+	StringLiteral	_elementName;
 };
 
 
 /**
  * Raised by accessor methods to signal that requested element does not exist.
+ * @note The tag is not copied and must be a string literal or have static storage duration.
  */
 struct InvalidStateException final : public Exception {
     InvalidStateException() noexcept;
 
     InvalidStateException(const char* tag) noexcept;
+
+	InvalidStateException(InvalidStateException const& other) noexcept;
+
+protected:
+	void formatMessage(details::StringWriter& writer) const noexcept override;
+
+private:
+	const char*		_tag;
 };
 
 
@@ -157,10 +250,15 @@ struct IOException: public Exception {
 
 	IOException(StringView msg) noexcept;
 
+	IOException(IOException const& other) noexcept;
+
     int getErrorCode() const noexcept {
         return _errorCode;
     }
 
+protected:
+	void formatMessage(details::StringWriter& writer) const noexcept override;
+
 private:
     int _errorCode;
 };
@@ -0,0 +1,305 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Glob patterns
+ *	@file		solace/glob.hpp
+ *	@brief		Compiled glob patterns to match paths and strings against.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_GLOB_HPP
+#define SOLACE_GLOB_HPP
+
+#include "solace/path.hpp"
+#include "solace/stringView.hpp"
+#include "solace/memoryManager.hpp"
+#include "solace/optional.hpp"
+#include "solace/vector.hpp"
+
+
+namespace Solace {
+
+namespace details {
+
+/// Set of bytes matched by a bracket expression.
+struct GlobCharClass {
+	uint64	bits[4];
+
+	constexpr bool contains(byte c) const noexcept {
+		return (bits[c >> 6] >> (c & 63)) & 1;
+	}
+};
+
+/// Single step of a segment automaton.
+struct GlobToken {
+	enum Kind : uint8 {
+		Char,		//!< Exactly the given character
+		AnyChar,	//!< '?'
+		Class,		//!< Bracket expression
+		Star		//!< '*', any sequence of characters
+	};
+
+	Kind	kind;
+	byte	value;
+	uint16	classIndex;
+};
+
+/// Compiled pattern of a single path component.
+struct GlobSegment {
+	uint32	firstToken;
+	uint16	nbTokens;
+	uint16	minLength;		//!< Number of non-star tokens
+	uint16	firstStar;		//!< Index of the first star token, nbTokens if there is none
+	uint16	lastStar;		//!< Index of the last star token, nbTokens if there is none
+	uint32	literalOffset;	//!< Offset of the literal prefix followed by the literal suffix
+	uint16	prefixLength;
+	uint16	suffixLength;
+	bool	anySegments;	//!< '**', any sequence of components
+};
+
+/// Properties of a path computed once to match it against many patterns.
+struct GlobSubject {
+	uint64		nbComponents;
+	StringView	lastComponent;
+};
+
+GlobSubject describeGlobSubject(Path const& path) noexcept;
+GlobSubject describeGlobSubject(StringView path) noexcept;
+
+}  // namespace details
+
+
+/**
+ * Glob pattern compiled into a small automaton.
+ *
+ * Pattern is a sequence of segments delimited by '/', each matched against a single path component:
+ *  - '*' matches any sequence of characters within a component;
+ *  - '?' matches any single character;
+ *  - '[abc]', '[a-f]' match any of the listed characters, '[!a-f]' or '[^a-f]' any character not listed;
+ *  - '\' escapes the character following it;
+ *  - segment '**' matches zero or more whole components.
+ * Pattern starting with '/' only matches absolute paths.
+ *
+ * Literal prefix and suffix of each segment are checked before the wildcards are matched, and the last component
+ * of a path is checked first, so most mismatches are rejected without walking the pattern.
+ * Matching does not allocate.
+ */
+class GlobPattern {
+public:
+	using size_type = uint32;
+
+public:
+
+	GlobPattern(GlobPattern const&) = delete;
+	GlobPattern& operator= (GlobPattern const&) = delete;
+
+	GlobPattern(GlobPattern&& rhs) noexcept
+		: _memory{mv(rhs._memory)}
+		, _nbClasses{exchange(rhs._nbClasses, 0)}
+		, _nbSegments{exchange(rhs._nbSegments, 0)}
+		, _nbTokens{exchange(rhs._nbTokens, 0)}
+		, _minComponents{exchange(rhs._minComponents, 0)}
+		, _anySegments{exchange(rhs._anySegments, false)}
+	{}
+
+	GlobPattern& operator= (GlobPattern&& rhs) noexcept {
+		return swap(rhs);
+	}
+
+	GlobPattern& swap(GlobPattern& rhs) noexcept {
+		using std::swap;
+		_memory.swap(rhs._memory);
+		swap(_nbClasses, rhs._nbClasses);
+		swap(_nbSegments, rhs._nbSegments);
+		swap(_nbTokens, rhs._nbTokens);
+		swap(_minComponents, rhs._minComponents);
+		swap(_anySegments, rhs._anySegments);
+
+		return *this;
+	}
+
+	/**
+	 * Match a path against this pattern.
+	 * @param path A path to match.
+	 * @return True if each component of the path is matched by the pattern.
+	 */
+	bool matches(Path const& path) const noexcept;
+
+	/**
+	 * Match a string representation of a path, with components delimited by '/', against this pattern.
+	 * Components are split the same way Path::parse() does, without allocating, except that an empty string
+	 * has no components rather than being the root.
+	 * @param path A string to match.
+	 * @return True if the string is matched by the pattern.
+	 */
+	bool matches(StringView path) const noexcept;
+
+	/// @return Number of segments in the pattern.
+	constexpr size_type segmentsCount() const noexcept { return _nbSegments; }
+
+	/// @return True if the pattern has a '**' segment and can match paths of any length.
+	constexpr bool hasAnySegments() const noexcept { return _anySegments; }
+
+protected:
+	friend class GlobSet;
+	friend Result<GlobPattern, Error> makeGlobPattern(MemoryManager& memoryManager, StringView pattern);
+
+	GlobPattern(MemoryResource&& memory, size_type nbClasses, size_type nbSegments, size_type nbTokens,
+				size_type minComponents, bool anySegments) noexcept
+		: _memory{mv(memory)}
+		, _nbClasses{nbClasses}
+		, _nbSegments{nbSegments}
+		, _nbTokens{nbTokens}
+		, _minComponents{minComponents}
+		, _anySegments{anySegments}
+	{}
+
+	bool matches(details::GlobSubject const& subject, Path const& path) const noexcept;
+	bool matches(details::GlobSubject const& subject, StringView path) const noexcept;
+
+	bool matchesSubject(details::GlobSubject const& subject) const noexcept;
+	bool matchesSegment(details::GlobSegment const& segment, StringView component) const noexcept;
+
+	details::GlobCharClass const* classes() const noexcept;
+	details::GlobSegment const* segments() const noexcept;
+	details::GlobToken const* tokens() const noexcept;
+	char const* literals() const noexcept;
+
+	template<typename Components>
+	bool matchComponents(Components const& components) const noexcept;
+
+private:
+	MemoryResource	_memory;
+	size_type		_nbClasses{0};
+	size_type		_nbSegments{0};
+	size_type		_nbTokens{0};
+	size_type		_minComponents{0};
+	bool			_anySegments{false};
+};
+
+
+/**
+ * Compile a glob pattern.
+ * @param memoryManager Memory manager to allocate the automaton from.
+ * @param pattern Pattern to compile, @see GlobPattern for the syntax.
+ * @return Compiled pattern or an error if the pattern is malformed.
+ */
+[[nodiscard]]
+Result<GlobPattern, Error>
+makeGlobPattern(MemoryManager& memoryManager, StringView pattern);
+
+/**
+ * Compile a glob pattern using the system heap memory manager.
+ * @param pattern Pattern to compile, @see GlobPattern for the syntax.
+ * @return Compiled pattern or an error if the pattern is malformed.
+ */
+[[nodiscard]]
+Result<GlobPattern, Error>
+makeGlobPattern(StringView pattern);
+
+
+/**
+ * A set of compiled glob patterns to match a path against in one call.
+ * Properties of the path used to reject patterns early, such as the number of its components,
+ * are computed once for all of the patterns.
+ */
+class GlobSet {
+public:
+	using size_type = GlobPattern::size_type;
+
+public:
+
+	GlobSet(Vector<GlobPattern>&& patterns) noexcept
+		: _patterns{mv(patterns)}
+	{}
+
+	/// @return Number of patterns in the set.
+	size_type size() const noexcept { return static_cast<size_type>(_patterns.size()); }
+
+	bool empty() const noexcept { return _patterns.empty(); }
+
+	/**
+	 * Find the first pattern matching a path.
+	 * @param path A path or its string representation to match.
+	 * @return Index of the first matching pattern or none if no pattern matches.
+	 */
+	template<typename P>
+	Optional<size_type> firstMatch(P const& path) const noexcept {
+		Optional<size_type> result;
+		forEachMatch(path, [&result](size_type index) {
+			result = index;
+			return false;
+		});
+
+		return result;
+	}
+
+	/**
+	 * Check if any of the patterns matches a path.
+	 * @param path A path or its string representation to match.
+	 * @return True if at least one pattern matches the path.
+	 */
+	template<typename P>
+	bool matchesAny(P const& path) const noexcept {
+		return firstMatch(path).isSome();
+	}
+
+	/**
+	 * Call a function with an index of each pattern matching a path, in the order the patterns were given.
+	 * @param path A path or its string representation to match.
+	 * @param f A callable to invoke with an index of a matching pattern.
+	 * If it returns bool, false stops the search.
+	 * @return Number of matching patterns found.
+	 */
+	template<typename P, typename F>
+	size_type forEachMatch(P const& path, F&& f) const {
+		auto const subject = details::describeGlobSubject(path);
+
+		size_type count = 0;
+		for (size_type i = 0; i < size(); ++i) {
+			if (!_patterns.data()[i].matches(subject, path)) {
+				continue;
+			}
+
+			count += 1;
+			if constexpr (std::is_same_v<bool, std::invoke_result_t<F&, size_type>>) {
+				if (!f(i)) {
+					break;
+				}
+			} else {
+				f(i);
+			}
+		}
+
+		return count;
+	}
+
+private:
+	Vector<GlobPattern>	_patterns;
+};
+
+
+/**
+ * Compile a set of glob patterns.
+ * @param memoryManager Memory manager to allocate compiled patterns from.
+ * @param patterns Patterns to compile.
+ * @return A set of compiled patterns or an error if any of the patterns is malformed.
+ */
+[[nodiscard]]
+Result<GlobSet, Error>
+makeGlobSet(MemoryManager& memoryManager, ArrayView<StringView const> patterns);
+
+}  // End of namespace Solace
+#endif  // SOLACE_GLOB_HPP
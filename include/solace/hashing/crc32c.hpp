@@ -0,0 +1,88 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: CRC-32C checksum
+ *	@file		solace/hashing/crc32c.hpp
+ *	@brief		Defines CRC-32C (Castagnoli) checksum algorithm
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_HASHING_CRC32C_HPP
+#define SOLACE_HASHING_CRC32C_HPP
+
+#include "solace/hashing/digestAlgorithm.hpp"
+
+
+namespace Solace {
+namespace hashing {
+
+/**
+ * Compute CRC-32C (Castagnoli polynomial, as used by iSCSI, ext4 and SSE4.2 crc32 instruction) of the data.
+ * CPU crc32 instructions are used when available: SSE4.2 on x86 and CRC extension on ARMv8.
+ *
+ * @param data Data to compute checksum of.
+ * @param crc Checksum of the preceding data to continue from, 0 to start a new one.
+ * @return Checksum of the data, such that crc32c(b, crc32c(a)) == crc32c(a + b).
+ */
+uint32 crc32c(MemoryView data, uint32 crc = 0) noexcept;
+
+
+/**
+ * CRC-32C checksum as a hashing algorithm.
+ * Checksum is not a cryptographic hash: it is meant to detect accidental data corruption.
+ */
+class CRC32C :
+        public HashingAlgorithm {
+public:
+    using HashingAlgorithm::size_type;
+
+public:
+
+    using HashingAlgorithm::update;
+
+    constexpr CRC32C() noexcept = default;
+
+    /**
+     * Get a string name of the hashing algorithm.
+     * @return A string name of the hashing algorithm.
+     */
+    StringView getAlgorithm() const override;
+
+    /**
+     * Get a length of the digest in bits.
+     * @return Length of the digest produced by this algorithm.
+     */
+    size_type getDigestLength() const override;
+
+    /**
+     * Update the checksum with the given input.
+     * @param input A memory view to read data from.
+     * @return A reference to self for a fluent interface.
+     */
+    HashingAlgorithm& update(MemoryView input) override;
+
+    /*
+     * Get the checksum of all the input as 4 bytes, most significant byte first.
+     * @return An array of bytes representing message digest.
+     */
+    MessageDigest digest() override;
+
+private:
+    uint32  _crc{0};
+};
+
+}  // End of namespace hashing
+}  // End of namespace Solace
+#endif  // SOLACE_HASHING_CRC32C_HPP
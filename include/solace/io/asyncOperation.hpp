@@ -0,0 +1,117 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Asynchronous operation
+ *	@file		solace/io/asyncOperation.hpp
+ *	@brief		Base of awaitable operations driven by the reactor.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_IO_ASYNCOPERATION_HPP
+#define SOLACE_IO_ASYNCOPERATION_HPP
+
+#include "solace/io/reactor.hpp"
+#include "solace/optional.hpp"
+
+#if SOLACE_HAS_COROUTINES
+#include <coroutine>
+#endif
+
+
+namespace Solace {
+namespace io {
+
+/**
+ * Base of an asynchronous I/O operation.
+ * An operation is first attempted synchronously and only waits for the reactor if the descriptor is not ready.
+ *
+ * Operation can be used as a C++20 awaitable: `auto data = co_await stream.readSome();`
+ * Without coroutines, start() takes a continuation that the reactor calls once the result is available.
+ *
+ * @note Operation must stay at the same address until it is complete.
+ */
+template<typename Derived, typename R>
+class AsyncOperation : public IoWaiter {
+public:
+	using result_type = R;
+	using Continuation = void (*)(void* context) noexcept;
+
+public:
+	AsyncOperation(AsyncOperation const&) = delete;
+	AsyncOperation& operator= (AsyncOperation const&) = delete;
+
+	/**
+	 * Start the operation.
+	 * @param continuation A function to call once the operation completes asynchronously.
+	 * @param context Argument to pass to the continuation.
+	 * @return True if the operation has completed without waiting and continuation will not be called.
+	 */
+	bool start(Continuation continuation, void* context) {
+		_continuation = continuation;
+		_context = context;
+
+		return static_cast<Derived*>(this)->advance();
+	}
+
+	/// @return True if the result of the operation is available.
+	bool isReady() const noexcept { return _result.isSome(); }
+
+	/// Take the result of a completed operation.
+	result_type takeResult() {
+		return _result.move();
+	}
+
+#if SOLACE_HAS_COROUTINES
+	bool await_ready() {
+		return start(nullptr, nullptr);
+	}
+
+	void await_suspend(std::coroutine_handle<> awaiting) noexcept {
+		_continuation = &resumeCoroutine;
+		_context = awaiting.address();
+	}
+
+	result_type await_resume() {
+		return takeResult();
+	}
+#endif
+
+protected:
+	AsyncOperation() noexcept
+		: IoWaiter{&onDescriptorReady}
+	{}
+
+	static void onDescriptorReady(IoWaiter* self) noexcept {
+		auto op = static_cast<Derived*>(self);
+		if (op->advance() && op->_continuation) {
+			op->_continuation(op->_context);
+		}
+	}
+
+#if SOLACE_HAS_COROUTINES
+	static void resumeCoroutine(void* address) noexcept {
+		std::coroutine_handle<>::from_address(address).resume();
+	}
+#endif
+
+protected:
+	Optional<R>			_result;
+	Continuation		_continuation{nullptr};
+	void*				_context{nullptr};
+};
+
+}  // End of namespace io
+}  // End of namespace Solace
+#endif  // SOLACE_IO_ASYNCOPERATION_HPP
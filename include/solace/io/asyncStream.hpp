@@ -0,0 +1,172 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Asynchronous byte stream
+ *	@file		solace/io/asyncStream.hpp
+ *	@brief		Awaitable read and write operations over a non-blocking file descriptor.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_IO_ASYNCSTREAM_HPP
+#define SOLACE_IO_ASYNCSTREAM_HPP
+
+#include "solace/io/asyncOperation.hpp"
+#include "solace/byteReader.hpp"
+#include "solace/mutableMemoryView.hpp"
+
+
+namespace Solace {
+namespace io {
+
+/**
+ * Asynchronous byte stream over a non-blocking file descriptor, such as a pipe or a socket.
+ * Stream does not own the descriptor.
+ *
+ * Stream has a receive buffer, provided by the caller, that readSome() and readExactly() fill.
+ * Data returned by a read is only valid until the next read from the stream.
+ */
+class AsyncStream {
+public:
+	using size_type = MemoryView::size_type;
+
+	/// Read whatever data is available, at least one byte unless end of stream has been reached.
+	class ReadSome : public AsyncOperation<ReadSome, Result<MemoryView, Error>> {
+	public:
+		ReadSome(AsyncStream& stream, MutableMemoryView destination) noexcept
+			: _stream{&stream}
+			, _destination{destination}
+		{}
+
+		bool advance();
+
+	private:
+		AsyncStream*		_stream;
+		MutableMemoryView	_destination;
+	};
+
+	/// Read exactly the given number of bytes into the stream buffer.
+	class ReadExactly : public AsyncOperation<ReadExactly, Result<ByteReader, Error>> {
+	public:
+		ReadExactly(AsyncStream& stream, size_type nbBytes) noexcept
+			: _stream{&stream}
+			, _nbBytes{nbBytes}
+		{}
+
+		bool advance();
+
+	private:
+		AsyncStream*	_stream;
+		size_type		_nbBytes;
+		size_type		_nbRead{0};
+	};
+
+	/// Write all of the given data.
+	class Write : public AsyncOperation<Write, Result<void, Error>> {
+	public:
+		Write(AsyncStream& stream, MemoryView data) noexcept
+			: _stream{&stream}
+			, _data{data}
+		{}
+
+		bool advance();
+
+	private:
+		AsyncStream*	_stream;
+		MemoryView		_data;
+		size_type		_nbWritten{0};
+	};
+
+public:
+	~AsyncStream();
+
+	AsyncStream(AsyncStream const&) = delete;
+	AsyncStream& operator= (AsyncStream const&) = delete;
+
+	/// Move a stream. Stream must not have any operations pending.
+	AsyncStream(AsyncStream&& rhs) noexcept;
+
+	AsyncStream& operator= (AsyncStream&& rhs) noexcept = delete;
+
+	/// @return File descriptor of the stream.
+	int fd() const noexcept { return _watch.fd; }
+
+	/// @return Receive buffer of the stream.
+	MemoryView buffer() const noexcept { return _buffer; }
+
+	/**
+	 * Read available data into the stream buffer.
+	 * Operation completes with an empty view when end of stream is reached.
+	 */
+	ReadSome readSome() noexcept {
+		return {*this, _buffer};
+	}
+
+	/**
+	 * Read available data into a given buffer.
+	 * Operation completes with an empty view when end of stream is reached.
+	 */
+	ReadSome readSome(MutableMemoryView destination) noexcept {
+		return {*this, destination};
+	}
+
+	/**
+	 * Read exactly nbBytes into the stream buffer.
+	 * Operation completes with a reader over the data read, or an error if end of stream is reached first.
+	 */
+	ReadExactly readExactly(size_type nbBytes) noexcept {
+		return {*this, nbBytes};
+	}
+
+	/// Write all of the given data into the stream.
+	Write write(MemoryView data) noexcept {
+		return {*this, data};
+	}
+
+protected:
+	friend class ReadSome;
+	friend class ReadExactly;
+	friend class Write;
+	friend Result<AsyncStream, Error> makeAsyncStream(Reactor& reactor, int fd, MutableMemoryView buffer);
+
+	AsyncStream(Reactor& reactor, int fd, bool isSocket, MutableMemoryView buffer) noexcept
+		: _reactor{&reactor}
+		, _isSocket{isSocket}
+		, _buffer{buffer}
+	{
+		_watch.fd = fd;
+	}
+
+private:
+	Reactor*			_reactor;
+	IoWatch				_watch;
+	bool				_isSocket;
+	MutableMemoryView	_buffer;
+};
+
+
+/**
+ * Create an asynchronous stream over a file descriptor.
+ * The descriptor is switched into non-blocking mode.
+ * @param reactor Reactor to wait for readiness of the descriptor.
+ * @param fd File descriptor to read from and write to.
+ * @param buffer Receive buffer of the stream.
+ * @return A stream or an error.
+ */
+Result<AsyncStream, Error>
+makeAsyncStream(Reactor& reactor, int fd, MutableMemoryView buffer);
+
+}  // End of namespace io
+}  // End of namespace Solace
+#endif  // SOLACE_IO_ASYNCSTREAM_HPP
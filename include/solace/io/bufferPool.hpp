@@ -0,0 +1,109 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Pool of I/O buffers
+ *	@file		solace/io/bufferPool.hpp
+ *	@brief		Fixed number of equally sized buffers to receive data into.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_IO_BUFFERPOOL_HPP
+#define SOLACE_IO_BUFFERPOOL_HPP
+
+#include "solace/memoryManager.hpp"
+#include "solace/memoryResource.hpp"
+#include "solace/result.hpp"
+#include "solace/error.hpp"
+
+
+namespace Solace {
+namespace io {
+
+namespace details {
+struct BufferPoolState;
+}  // namespace details
+
+
+/**
+ * Pool of fixed size buffers.
+ * All buffers are allocated at once when the pool is created. A buffer acquired from the pool is a MemoryResource
+ * that returns the buffer into the pool when destroyed.
+ *
+ * @note Pool is not thread safe. All buffers must be returned before the pool is destroyed.
+ */
+class BufferPool {
+public:
+	using size_type = MemoryResource::size_type;
+
+public:
+	~BufferPool();
+
+	BufferPool(BufferPool const&) = delete;
+	BufferPool& operator= (BufferPool const&) = delete;
+
+	BufferPool(BufferPool&& rhs) noexcept
+		: _memory{mv(rhs._memory)}
+		, _state{exchange(rhs._state, nullptr)}
+	{}
+
+	BufferPool& operator= (BufferPool&& rhs) noexcept {
+		_memory.swap(rhs._memory);
+		std::swap(_state, rhs._state);
+
+		return *this;
+	}
+
+	/**
+	 * Take a buffer from the pool.
+	 * @return A buffer or an error if all the buffers are in use.
+	 */
+	Result<MemoryResource, Error> acquire() noexcept;
+
+	/// @return Size of each buffer in bytes.
+	size_type bufferSize() const noexcept;
+
+	/// @return Total number of buffers in the pool.
+	uint32 capacity() const noexcept;
+
+	/// @return Number of buffers available to acquire.
+	uint32 available() const noexcept;
+
+protected:
+	friend Result<BufferPool, Error> makeBufferPool(MemoryManager& memoryManager, size_type bufferSize, uint32 nbBuffers);
+
+	BufferPool(MemoryResource&& memory, details::BufferPoolState* state) noexcept
+		: _memory{mv(memory)}
+		, _state{state}
+	{}
+
+private:
+	MemoryResource					_memory;
+	details::BufferPoolState*		_state{nullptr};
+};
+
+
+/**
+ * Create a pool of buffers.
+ * @param memoryManager Memory manager to allocate all of the buffers from.
+ * @param bufferSize Size of each buffer in bytes.
+ * @param nbBuffers Number of buffers in the pool.
+ * @return A new buffer pool or an error.
+ */
+Result<BufferPool, Error>
+makeBufferPool(MemoryManager& memoryManager, BufferPool::size_type bufferSize, uint32 nbBuffers);
+
+}  // End of namespace io
+}  // End of namespace Solace
+#endif  // SOLACE_IO_BUFFERPOOL_HPP
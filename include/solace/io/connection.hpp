@@ -0,0 +1,314 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Connections
+ *	@file		solace/io/connection.hpp
+ *	@brief		Reactor driven stream connections, listeners and datagram channels.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_IO_CONNECTION_HPP
+#define SOLACE_IO_CONNECTION_HPP
+
+#include "solace/io/asyncOperation.hpp"
+#include "solace/io/bufferPool.hpp"
+#include "solace/io/socket.hpp"
+#include "solace/arrayView.hpp"
+#include "solace/byteReader.hpp"
+
+#include <sys/uio.h>
+
+
+namespace Solace {
+namespace io {
+
+/**
+ * Socket registered with a reactor.
+ * Channel must not be moved while it has operations pending.
+ */
+class SocketChannel {
+public:
+	~SocketChannel();
+
+	SocketChannel(SocketChannel const&) = delete;
+	SocketChannel& operator= (SocketChannel const&) = delete;
+
+	SocketChannel(SocketChannel&& rhs) noexcept;
+	SocketChannel& operator= (SocketChannel&& rhs) noexcept = delete;
+
+	/// @return File descriptor of the socket.
+	int fd() const noexcept { return _socket.fd(); }
+
+	/// @return Socket of the channel.
+	Socket const& socket() const noexcept { return _socket; }
+
+protected:
+	SocketChannel(Reactor& reactor, Socket&& socket) noexcept
+		: _reactor{&reactor}
+		, _socket{mv(socket)}
+	{
+		_watch.fd = _socket.fd();
+	}
+
+	Reactor*	_reactor;
+	Socket		_socket;
+	IoWatch		_watch;
+};
+
+
+/**
+ * Connection over a stream socket.
+ * Reads go into buffers taken from a buffer pool, writes are queued and flushed with vectored I/O.
+ */
+class StreamConnection : public SocketChannel {
+public:
+	using size_type = MemoryView::size_type;
+
+	/// Maximum number of views that can be queued for writing.
+	static constexpr uint32 kMaxQueuedWrites = 64;
+
+	/// Wait for a non-blocking connect to complete.
+	class Connect : public AsyncOperation<Connect, Result<void, Error>> {
+	public:
+		explicit Connect(StreamConnection& connection) noexcept
+			: _connection{&connection}
+		{}
+
+		bool advance();
+
+	private:
+		StreamConnection*	_connection;
+	};
+
+	/**
+	 * Read available data into a pooled buffer.
+	 * Result is a reader that owns the buffer, empty when end of stream is reached.
+	 */
+	class Read : public AsyncOperation<Read, Result<ByteReader, Error>> {
+	public:
+		explicit Read(StreamConnection& connection) noexcept
+			: _connection{&connection}
+		{}
+
+		bool advance();
+
+	private:
+		StreamConnection*	_connection;
+	};
+
+	/// Write all of the queued data.
+	class Flush : public AsyncOperation<Flush, Result<void, Error>> {
+	public:
+		explicit Flush(StreamConnection& connection) noexcept
+			: _connection{&connection}
+		{}
+
+		bool advance();
+
+	private:
+		StreamConnection*	_connection;
+	};
+
+public:
+	StreamConnection(StreamConnection&& rhs) noexcept;
+
+	/**
+	 * Queue data to be written by the next flush.
+	 * Memory referenced by the view must stay valid until the flush completes.
+	 * @return Error if the queue is full.
+	 */
+	Result<void, Error> queue(MemoryView data) noexcept;
+
+	/// @return Number of views waiting to be written.
+	uint32 nbQueued() const noexcept { return _queueSize; }
+
+	/// Wait for the connection to be established.
+	Connect connected() noexcept { return Connect{*this}; }
+
+	/// Read available data.
+	Read read() noexcept { return Read{*this}; }
+
+	/// Write all queued data.
+	Flush flush() noexcept { return Flush{*this}; }
+
+protected:
+	friend class Connect;
+	friend class Read;
+	friend class Flush;
+	friend Result<StreamConnection, Error> makeConnection(Reactor& reactor, BufferPool& pool, Socket&& socket);
+
+	StreamConnection(Reactor& reactor, BufferPool& pool, Socket&& socket) noexcept
+		: SocketChannel{reactor, mv(socket)}
+		, _pool{&pool}
+	{}
+
+private:
+	BufferPool*		_pool;
+	uint32			_queueHead{0};
+	uint32			_queueSize{0};
+	iovec			_queue[kMaxQueuedWrites];
+};
+
+
+/**
+ * Listening stream socket accepting new connections.
+ */
+class Listener : public SocketChannel {
+public:
+
+	/// Accept a new connection. Accepted socket is non-blocking.
+	class Accept : public AsyncOperation<Accept, Result<Socket, Error>> {
+	public:
+		explicit Accept(Listener& listener) noexcept
+			: _listener{&listener}
+		{}
+
+		bool advance();
+
+	private:
+		Listener*	_listener;
+	};
+
+public:
+	Listener(Listener&& rhs) noexcept = default;
+
+	/// Accept next incoming connection.
+	Accept accept() noexcept { return Accept{*this}; }
+
+protected:
+	friend class Accept;
+	friend Result<Listener, Error> makeListener(Reactor& reactor, Socket&& socket);
+
+	Listener(Reactor& reactor, Socket&& socket) noexcept
+		: SocketChannel{reactor, mv(socket)}
+	{}
+};
+
+
+/**
+ * A datagram received from or to be sent to a datagram socket.
+ */
+struct Datagram {
+	ByteReader		data;		//!< Received data, owns a pooled buffer.
+	SocketAddress	peer;		//!< Address of the sender.
+};
+
+/**
+ * A datagram to be sent.
+ */
+struct OutgoingDatagram {
+	MemoryView				data;				//!< Payload of the datagram.
+	SocketAddress const*	peer{nullptr};		//!< Destination address, nullptr for a connected socket.
+};
+
+
+/**
+ * Datagram socket channel exchanging datagrams in batches.
+ */
+class DatagramChannel : public SocketChannel {
+public:
+	/// Maximum number of datagrams exchanged with a single system call.
+	static constexpr uint32 kMaxBatchSize = 32;
+
+	/**
+	 * Receive a batch of datagrams into pooled buffers.
+	 * Result is the number of datagrams received.
+	 */
+	class ReceiveBatch : public AsyncOperation<ReceiveBatch, Result<uint32, Error>> {
+	public:
+		ReceiveBatch(DatagramChannel& channel, ArrayView<Datagram> datagrams) noexcept
+			: _channel{&channel}
+			, _datagrams{datagrams}
+		{}
+
+		bool advance();
+
+	private:
+		DatagramChannel*		_channel;
+		ArrayView<Datagram>		_datagrams;
+	};
+
+	/// Send all of the given datagrams.
+	class SendBatch : public AsyncOperation<SendBatch, Result<void, Error>> {
+	public:
+		SendBatch(DatagramChannel& channel, ArrayView<OutgoingDatagram const> datagrams) noexcept
+			: _channel{&channel}
+			, _datagrams{datagrams}
+		{}
+
+		bool advance();
+
+	private:
+		DatagramChannel*					_channel;
+		ArrayView<OutgoingDatagram const>	_datagrams;
+		uint32								_nbSent{0};
+	};
+
+public:
+	DatagramChannel(DatagramChannel&& rhs) noexcept = default;
+
+	/**
+	 * Receive up to datagrams.size() datagrams, at least one.
+	 * Number of datagrams received at once is also limited by the number of available pooled buffers.
+	 */
+	ReceiveBatch receive(ArrayView<Datagram> datagrams) noexcept { return {*this, datagrams}; }
+
+	/// Send a batch of datagrams.
+	SendBatch send(ArrayView<OutgoingDatagram const> datagrams) noexcept { return {*this, datagrams}; }
+
+protected:
+	friend class ReceiveBatch;
+	friend class SendBatch;
+	friend Result<DatagramChannel, Error> makeDatagramChannel(Reactor& reactor, BufferPool& pool, Socket&& socket);
+
+	DatagramChannel(Reactor& reactor, BufferPool& pool, Socket&& socket) noexcept
+		: SocketChannel{reactor, mv(socket)}
+		, _pool{&pool}
+	{}
+
+private:
+	BufferPool*		_pool;
+};
+
+
+/**
+ * Create a connection over a stream socket.
+ * @param reactor Reactor to drive the connection I/O.
+ * @param pool Pool of buffers to read data into.
+ * @param socket Connected or connecting stream socket, @see connect().
+ */
+Result<StreamConnection, Error>
+makeConnection(Reactor& reactor, BufferPool& pool, Socket&& socket);
+
+/**
+ * Create a listener from a listening socket.
+ * @param reactor Reactor to wait for incoming connections.
+ * @param socket Listening stream socket, @see listen().
+ */
+Result<Listener, Error>
+makeListener(Reactor& reactor, Socket&& socket);
+
+/**
+ * Create a channel over a datagram socket.
+ * @param reactor Reactor to drive the channel I/O.
+ * @param pool Pool of buffers to receive datagrams into.
+ * @param socket Bound or connected datagram socket.
+ */
+Result<DatagramChannel, Error>
+makeDatagramChannel(Reactor& reactor, BufferPool& pool, Socket&& socket);
+
+}  // End of namespace io
+}  // End of namespace Solace
+#endif  // SOLACE_IO_CONNECTION_HPP
@@ -0,0 +1,124 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Memory mapped file
+ *	@file		solace/io/mappedFile.hpp
+ *	@brief		Read-only view of a file content mapped into memory.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_IO_MAPPEDFILE_HPP
+#define SOLACE_IO_MAPPEDFILE_HPP
+
+#include "solace/memoryResource.hpp"
+#include "solace/stringView.hpp"
+#include "solace/result.hpp"
+#include "solace/error.hpp"
+
+
+namespace Solace {
+namespace io {
+
+/**
+ * Read-only memory mapping of a whole file.
+ * Content of the file is accessed as a MemoryView without copying it into a buffer: pages are read in by the OS
+ * on first access. Mapping stays valid after the file descriptor it was created from is closed.
+ *
+ * @note Mapping reflects the size of the file at the time it was created: data appended later is not visible.
+ */
+class MappedFile {
+public:
+	using size_type = MemoryView::size_type;
+
+	/// Expected pattern of access to the content, a hint for the OS read-ahead.
+	enum class Access {
+		Normal,
+		Sequential,
+		Random
+	};
+
+public:
+	~MappedFile();
+
+	MappedFile(MappedFile const&) = delete;
+	MappedFile& operator= (MappedFile const&) = delete;
+
+	MappedFile(MappedFile&& rhs) noexcept
+		: _address{exchange(rhs._address, nullptr)}
+		, _size{exchange(rhs._size, 0)}
+	{}
+
+	MappedFile& operator= (MappedFile&& rhs) noexcept {
+		std::swap(_address, rhs._address);
+		std::swap(_size, rhs._size);
+
+		return *this;
+	}
+
+	/**
+	 * Map a file given by its path.
+	 * @param path Path of the file to map.
+	 * @param access Expected pattern of access to the content.
+	 * @return Mapping of the file or an error if it could not be opened or mapped.
+	 */
+	static Result<MappedFile, Error> open(StringView path, Access access = Access::Normal) noexcept;
+
+	/**
+	 * Map a file given by an open file descriptor. The descriptor is not closed.
+	 * @param fd File descriptor, opened for reading.
+	 * @param access Expected pattern of access to the content.
+	 * @return Mapping of the file or an error if it could not be mapped.
+	 */
+	static Result<MappedFile, Error> map(int fd, Access access = Access::Normal) noexcept;
+
+	/// @return Content of the file.
+	MemoryView view() const noexcept {
+		return wrapMemory(static_cast<byte const*>(_address), _size);
+	}
+
+	/// @return Size of the mapped content in bytes.
+	constexpr size_type size() const noexcept { return _size; }
+
+	constexpr bool empty() const noexcept { return (_size == 0); }
+
+	/**
+	 * Advise the OS of the expected access pattern to a range of the content.
+	 * @param access Expected pattern of access.
+	 * @param offset Offset of the range, rounded down to a page boundary.
+	 * @param length Length of the range, till the end of the content by default.
+	 */
+	Result<void, Error> advise(Access access, size_type offset = 0, size_type length = ~size_type{0}) noexcept;
+
+	/**
+	 * Transfer ownership of the mapping to a memory resource that unmaps it when destroyed.
+	 * This object is left empty.
+	 * @note Mapped pages are read-only: memory of the resource must not be written to.
+	 */
+	MemoryResource release() noexcept;
+
+protected:
+	constexpr MappedFile(void* address, size_type size) noexcept
+		: _address{address}
+		, _size{size}
+	{}
+
+private:
+	void*		_address{nullptr};
+	size_type	_size{0};
+};
+
+}  // End of namespace io
+}  // End of namespace Solace
+#endif  // SOLACE_IO_MAPPEDFILE_HPP
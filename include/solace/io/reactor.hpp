@@ -0,0 +1,156 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: I/O readiness reactor
+ *	@file		solace/io/reactor.hpp
+ *	@brief		Single threaded epoll based reactor to drive non-blocking I/O.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_IO_REACTOR_HPP
+#define SOLACE_IO_REACTOR_HPP
+
+#include "solace/types.hpp"
+#include "solace/utils.hpp"
+#include "solace/error.hpp"
+#include "solace/result.hpp"
+
+
+namespace Solace {
+namespace io {
+
+/**
+ * An operation waiting for a file descriptor to become ready.
+ * Reactor calls onReady once the awaited readiness is reported.
+ */
+struct IoWaiter {
+	using ReadyFunction = void (*)(IoWaiter* self) noexcept;
+
+	ReadyFunction	onReady{nullptr};
+};
+
+
+/**
+ * Registration of a file descriptor with a reactor.
+ * At most one reader and one writer may wait on a watch at a time.
+ */
+struct IoWatch {
+	int				fd{-1};
+	bool			isRegistered{false};
+	IoWaiter*		reader{nullptr};
+	IoWaiter*		writer{nullptr};
+};
+
+
+/**
+ * Edge triggered epoll reactor.
+ * Reactor is not thread safe: all the operations on it and on the watches registered with it
+ * are expected to be performed by the thread that polls it.
+ */
+class Reactor {
+public:
+	~Reactor();
+
+	Reactor(Reactor const&) = delete;
+	Reactor& operator= (Reactor const&) = delete;
+
+	Reactor(Reactor&& rhs) noexcept
+		: _pollFd{exchange(rhs._pollFd, -1)}
+		, _nbWaiting{exchange(rhs._nbWaiting, 0)}
+		, _ready{exchange(rhs._ready, nullptr)}
+		, _nbReady{exchange(rhs._nbReady, 0)}
+	{}
+
+	Reactor& operator= (Reactor&& rhs) noexcept {
+		return swap(rhs);
+	}
+
+	Reactor& swap(Reactor& rhs) noexcept {
+		using std::swap;
+		swap(_pollFd, rhs._pollFd);
+		swap(_nbWaiting, rhs._nbWaiting);
+		swap(_ready, rhs._ready);
+		swap(_nbReady, rhs._nbReady);
+
+		return *this;
+	}
+
+	/// Start watching for readiness of the watch file descriptor.
+	Result<void, Error> add(IoWatch& watch);
+
+	/// Update registration of a watch that has been moved to a new address.
+	Result<void, Error> rebind(IoWatch& watch);
+
+	/**
+	 * Stop watching a file descriptor. Waiters, if any, are dropped.
+	 * Waiters of the watch that are ready but not resumed yet by the poll in progress are dropped as well,
+	 * so a watch may be removed and destroyed by any waiter being resumed.
+	 */
+	Result<void, Error> remove(IoWatch& watch);
+
+	/**
+	 * Wait for the file descriptor to become readable.
+	 * Registers the watch with the reactor if it is not registered yet.
+	 */
+	Result<void, Error> awaitReadable(IoWatch& watch, IoWaiter& waiter);
+
+	/**
+	 * Wait for the file descriptor to become writable.
+	 * Registers the watch with the reactor if it is not registered yet.
+	 */
+	Result<void, Error> awaitWritable(IoWatch& watch, IoWaiter& waiter);
+
+	/**
+	 * Wait for readiness events and resume waiters.
+	 * All ready waiters are detached from their watches before the first one is resumed.
+	 * @note Must not be called from a waiter being resumed.
+	 * @param timeoutMs Maximum time to wait in milliseconds, -1 to wait indefinitely.
+	 * @return Number of waiters resumed.
+	 */
+	Result<uint32, Error> poll(int timeoutMs = -1);
+
+	/// Poll until there are no more waiters.
+	Result<void, Error> run();
+
+	/// @return Number of waiters waiting for readiness.
+	uint32 nbWaiting() const noexcept { return _nbWaiting; }
+
+protected:
+	friend Result<Reactor, Error> makeReactor();
+
+	explicit Reactor(int pollFd) noexcept
+		: _pollFd{pollFd}
+	{}
+
+private:
+	struct ReadyWaiter;
+
+	int				_pollFd{-1};
+	uint32			_nbWaiting{0};
+	/// Waiters of the poll in progress, yet to be resumed.
+	ReadyWaiter*	_ready{nullptr};
+	uint32			_nbReady{0};
+};
+
+
+/**
+ * Create a new reactor.
+ * @return A reactor or an error if the system failed to create the poll descriptor.
+ */
+Result<Reactor, Error> makeReactor();
+
+}  // End of namespace io
+}  // End of namespace Solace
+#endif  // SOLACE_IO_REACTOR_HPP
@@ -0,0 +1,266 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Append-only record log
+ *	@file		solace/io/recordLog.hpp
+ *	@brief		Log segment of checksummed length-prefixed records.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_IO_RECORDLOG_HPP
+#define SOLACE_IO_RECORDLOG_HPP
+
+#include "solace/memoryManager.hpp"
+#include "solace/memoryResource.hpp"
+#include "solace/stringView.hpp"
+#include "solace/result.hpp"
+#include "solace/error.hpp"
+
+#include "solace/io/mappedFile.hpp"
+
+
+namespace Solace {
+namespace io {
+
+/**
+ * Log segment format.
+ *
+ * Segment starts with a header: magic bytes 'SLOG' followed by format version, a little endian uint32.
+ * Header is followed by records, each framed as a VariableSpan chunk with uint32 little endian size:
+ *  - uint32 LE: chunk size, that is 4 + size of the payload;
+ *  - uint32 LE: CRC-32C of the 4 bytes of chunk size followed by the payload;
+ *  - payload bytes.
+ *
+ * A record that is cut short or fails its checksum marks the end of the log: everything from that point on
+ * is a torn tail of an interrupted write.
+ */
+struct RecordLogFormat {
+	static constexpr byte kMagic[4] = {'S', 'L', 'O', 'G'};
+	static constexpr uint32 kVersion = 1;
+	static constexpr uint32 kHeaderSize = 8;
+	static constexpr uint32 kFrameHeaderSize = 8;
+	static constexpr uint32 kMaxPayloadSize = 0xFFFFFFFF - 4;
+};
+
+
+/**
+ * Zero-copy sequence of records of a log segment in memory.
+ * Iteration yields payloads of intact records in order, stopping at the end of data or at the first record that is
+ * incomplete or fails its checksum.
+ */
+class RecordLogView {
+public:
+	using size_type = MemoryView::size_type;
+
+	struct Iterator {
+
+		Iterator(MemoryView segment, size_type offset) noexcept
+			: _segment{segment}
+			, _offset{offset}
+		{
+			parse();
+		}
+
+		constexpr bool operator!= (Iterator const& other) const noexcept { return (_offset != other._offset); }
+		constexpr bool operator== (Iterator const& other) const noexcept { return (_offset == other._offset); }
+
+		/// @return Payload of the record, a view into the segment.
+		MemoryView operator* () const noexcept { return _payload; }
+
+		/// @return Offset of the record in the segment.
+		constexpr size_type offset() const noexcept { return _offset; }
+
+		/// @return Offset of the end of the record in the segment.
+		constexpr size_type endOffset() const noexcept { return _offset + _frameSize; }
+
+		Iterator& operator++ () noexcept {
+			if (_offset != kEnd) {
+				_offset += _frameSize;
+				parse();
+			}
+
+			return *this;
+		}
+
+	private:
+		friend class RecordLogView;
+
+		static constexpr size_type kEnd = ~size_type{0};
+
+		void parse() noexcept;
+
+		MemoryView	_segment;
+		size_type	_offset;
+		size_type	_frameSize{0};
+		MemoryView	_payload;
+	};
+
+	using const_iterator = Iterator;
+
+public:
+
+	constexpr RecordLogView() noexcept = default;
+
+	explicit RecordLogView(MemoryView segment) noexcept
+		: _segment{segment}
+	{}
+
+	/// @return True if the segment starts with a header of a supported version.
+	bool hasValidHeader() const noexcept;
+
+	Iterator begin() const noexcept {
+		return hasValidHeader()
+				? Iterator{_segment, RecordLogFormat::kHeaderSize}
+				: end();
+	}
+
+	Iterator end() const noexcept { return Iterator{_segment, Iterator::kEnd}; }
+
+	/// @return Size of the beginning of the segment holding the header and intact records.
+	size_type validSize() const noexcept;
+
+private:
+	MemoryView	_segment;
+};
+
+
+/**
+ * Reader of a log segment file.
+ * File is mapped into memory and records are read in place.
+ */
+class RecordLogReader {
+public:
+	using size_type = RecordLogView::size_type;
+	using Iterator = RecordLogView::Iterator;
+
+public:
+
+	/**
+	 * Open a log segment file for reading.
+	 * @return A reader or an error if the file can not be mapped or is not a log segment.
+	 */
+	static Result<RecordLogReader, Error> open(StringView path) noexcept;
+
+	RecordLogView records() const noexcept { return RecordLogView{_file.view()}; }
+
+	Iterator begin() const noexcept { return records().begin(); }
+	Iterator end() const noexcept { return records().end(); }
+
+	/// @return Size of the file.
+	constexpr size_type size() const noexcept { return _file.size(); }
+
+	/// @return Size of the beginning of the file holding the header and intact records.
+	size_type validSize() const noexcept { return records().validSize(); }
+
+protected:
+	explicit RecordLogReader(MappedFile&& file) noexcept
+		: _file{mv(file)}
+	{}
+
+private:
+	MappedFile	_file;
+};
+
+
+namespace details {
+struct RecordLogState;
+}  // namespace details
+
+
+/**
+ * Writer appending records to a log segment file.
+ *
+ * Appended records are framed into an in-memory batch and written to the file with a single write followed by
+ * fdatasync when the batch is synced or full. Writer is thread-safe and commits are grouped: while one thread
+ * syncs a batch, records appended by others go into a second batch, and threads waiting to sync records of
+ * that batch are all served by the next single fdatasync.
+ *
+ * Opening an existing segment drops its torn tail, if any, so that new records follow the last intact one.
+ */
+class RecordLogWriter {
+public:
+	using size_type = MemoryResource::size_type;
+
+	/// Default size of a batch of records.
+	static constexpr size_type kDefaultBatchSize = 1024 * 1024;
+
+public:
+	~RecordLogWriter();
+
+	RecordLogWriter(RecordLogWriter const&) = delete;
+	RecordLogWriter& operator= (RecordLogWriter const&) = delete;
+
+	RecordLogWriter(RecordLogWriter&& rhs) noexcept
+		: _memory{mv(rhs._memory)}
+		, _state{exchange(rhs._state, nullptr)}
+	{}
+
+	RecordLogWriter& operator= (RecordLogWriter&& rhs) noexcept {
+		_memory.swap(rhs._memory);
+		std::swap(_state, rhs._state);
+
+		return *this;
+	}
+
+	/**
+	 * Open a log segment file for appending, creating it if it does not exist.
+	 * @param path Path of the segment file.
+	 * @param memoryManager Memory manager to allocate batch buffers from.
+	 * @param batchSize Size of each of the two batch buffers, which limits the size of a record.
+	 * @return A writer or an error if the file can not be opened or is not a log segment.
+	 */
+	static Result<RecordLogWriter, Error>
+	open(StringView path, MemoryManager& memoryManager, size_type batchSize = kDefaultBatchSize) noexcept;
+
+	/**
+	 * Append a record to the current batch. Record is not durable until synced.
+	 * If the batch is full, it is synced first.
+	 * @param payload Content of the record.
+	 * @return Offset in the file of the end of the record or an error.
+	 */
+	Result<uint64, Error> append(MemoryView payload) noexcept;
+
+	/// Write and sync all appended records.
+	Result<void, Error> sync() noexcept;
+
+	/**
+	 * Make records up to a given offset durable, sharing fdatasync with other threads syncing concurrently.
+	 * @param offset Offset of the end of a record, as returned by append.
+	 */
+	Result<void, Error> sync(uint64 offset) noexcept;
+
+	/// @return Size of the segment including records not yet synced.
+	uint64 size() const noexcept;
+
+	/// @return Size of the segment known to be on disk.
+	uint64 durableSize() const noexcept;
+
+	/// @return Maximum size of a record payload.
+	size_type maxPayloadSize() const noexcept;
+
+protected:
+	RecordLogWriter(MemoryResource&& memory, details::RecordLogState* state) noexcept
+		: _memory{mv(memory)}
+		, _state{state}
+	{}
+
+private:
+	MemoryResource				_memory;
+	details::RecordLogState*	_state{nullptr};
+};
+
+}  // End of namespace io
+}  // End of namespace Solace
+#endif  // SOLACE_IO_RECORDLOG_HPP
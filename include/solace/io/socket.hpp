@@ -0,0 +1,125 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Sockets
+ *	@file		solace/io/socket.hpp
+ *	@brief		Non-blocking sockets created from dial strings.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_IO_SOCKET_HPP
+#define SOLACE_IO_SOCKET_HPP
+
+#include "solace/dialstring.hpp"
+#include "solace/utils.hpp"
+
+#include <sys/socket.h>
+
+
+namespace Solace {
+namespace io {
+
+/**
+ * Address of a socket endpoint together with the kind of socket to use to reach it.
+ */
+struct SocketAddress {
+	sockaddr_storage	storage{};
+	socklen_t			size{0};
+	int					type{0};	//!< SOCK_STREAM or SOCK_DGRAM
+
+	int family() const noexcept { return storage.ss_family; }
+
+	sockaddr const* address() const noexcept { return reinterpret_cast<sockaddr const*>(&storage); }
+	sockaddr* address() noexcept { return reinterpret_cast<sockaddr*>(&storage); }
+
+	/// @return Port number for IP addresses, 0 otherwise.
+	uint16 port() const noexcept;
+};
+
+
+/**
+ * Owned socket file descriptor.
+ */
+class Socket {
+public:
+	~Socket();
+
+	Socket(Socket const&) = delete;
+	Socket& operator= (Socket const&) = delete;
+
+	constexpr Socket() noexcept = default;
+
+	explicit constexpr Socket(int fd) noexcept
+		: _fd{fd}
+	{}
+
+	Socket(Socket&& rhs) noexcept
+		: _fd{exchange(rhs._fd, -1)}
+	{}
+
+	Socket& operator= (Socket&& rhs) noexcept {
+		std::swap(_fd, rhs._fd);
+
+		return *this;
+	}
+
+	/// @return File descriptor of the socket.
+	constexpr int fd() const noexcept { return _fd; }
+
+	constexpr explicit operator bool() const noexcept { return (_fd != -1); }
+
+	/// Give up ownership of the file descriptor.
+	int release() noexcept { return exchange(_fd, -1); }
+
+private:
+	int	_fd{-1};
+};
+
+
+/**
+ * Resolve a dial string into a socket address.
+ * Supported protocols are unix, tcp and udp.
+ * Unix socket address starting with '@' is in the abstract namespace.
+ * IP address '*' or empty address means any local address.
+ *
+ * @note Host and service names are resolved using getaddrinfo which may block.
+ */
+Result<SocketAddress, Error>
+resolve(DialString const& endpoint);
+
+/**
+ * Create a non-blocking socket bound to a local endpoint.
+ * Stream sockets are put into listening state, datagram sockets are ready to receive.
+ * @param endpoint Local address to listen on.
+ * @param backlog Maximum length of the queue of pending connections.
+ */
+Result<Socket, Error>
+listen(DialString const& endpoint, int backlog = SOMAXCONN);
+
+/**
+ * Create a non-blocking socket connected to a remote endpoint.
+ * Connection of a stream socket may still be in progress when this call returns.
+ * @see StreamConnection::connected()
+ */
+Result<Socket, Error>
+connect(DialString const& endpoint);
+
+/// @return Address the socket is bound to.
+Result<SocketAddress, Error>
+localAddress(Socket const& socket);
+
+}  // End of namespace io
+}  // End of namespace Solace
+#endif  // SOLACE_IO_SOCKET_HPP
@@ -0,0 +1,140 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Coroutine task
+ *	@file		solace/io/task.hpp
+ *	@brief		Minimal coroutine type to write asynchronous I/O code as straight-line code.
+ *	@note		Only available when compiled with C++20 coroutines support, @see SOLACE_HAS_COROUTINES
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_IO_TASK_HPP
+#define SOLACE_IO_TASK_HPP
+
+#include "solace/types.hpp"
+#include "solace/utils.hpp"
+#include "solace/optional.hpp"
+
+#if SOLACE_HAS_COROUTINES
+#include <coroutine>
+#include <exception>
+
+
+namespace Solace {
+namespace io {
+
+namespace details {
+
+template<typename T>
+class TaskPromiseBase {
+public:
+	struct FinalAwaiter {
+		bool await_ready() const noexcept { return false; }
+
+		template<typename Promise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> finished) noexcept {
+			auto continuation = finished.promise()._continuation;
+			return continuation ? continuation : std::noop_coroutine();
+		}
+
+		void await_resume() const noexcept {}
+	};
+
+	std::suspend_never initial_suspend() const noexcept { return {}; }
+	FinalAwaiter final_suspend() const noexcept { return {}; }
+
+	/// Tasks must not throw
+	[[noreturn]] void unhandled_exception() const noexcept { std::terminate(); }
+
+	void setContinuation(std::coroutine_handle<> continuation) noexcept { _continuation = continuation; }
+
+private:
+	std::coroutine_handle<>	_continuation;
+};
+
+}  // namespace details
+
+
+/**
+ * Eagerly started coroutine.
+ * Task runs until its first suspension when called and is resumed by the reactor.
+ * Another task can co_await it to get its result; top level code can poll isDone() and take the result.
+ * Coroutine frame is destroyed with the task object.
+ */
+template<typename T>
+class Task {
+public:
+	struct promise_type : public details::TaskPromiseBase<T> {
+		Task get_return_object() noexcept {
+			return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+		}
+
+		template<typename V>
+		void return_value(V&& value) {
+			result = Optional<T>{in_place, fwd<V>(value)};
+		}
+
+		Optional<T>	result;
+	};
+
+public:
+	~Task() {
+		if (_handle) {
+			_handle.destroy();
+		}
+	}
+
+	Task(Task const&) = delete;
+	Task& operator= (Task const&) = delete;
+
+	Task(Task&& rhs) noexcept
+		: _handle{exchange(rhs._handle, nullptr)}
+	{}
+
+	Task& operator= (Task&& rhs) noexcept {
+		using std::swap;
+		swap(_handle, rhs._handle);
+
+		return *this;
+	}
+
+	/// @return True if the coroutine has completed.
+	bool isDone() const noexcept { return _handle && _handle.done(); }
+
+	/// Take the result of a completed task.
+	T takeResult() { return _handle.promise().result.move(); }
+
+	bool await_ready() const noexcept { return isDone(); }
+
+	void await_suspend(std::coroutine_handle<> awaiting) noexcept {
+		_handle.promise().setContinuation(awaiting);
+	}
+
+	T await_resume() { return takeResult(); }
+
+protected:
+	explicit Task(std::coroutine_handle<promise_type> handle) noexcept
+		: _handle{handle}
+	{}
+
+private:
+	std::coroutine_handle<promise_type>	_handle;
+};
+
+}  // End of namespace io
+}  // End of namespace Solace
+
+#endif  // SOLACE_HAS_COROUTINES
+#endif  // SOLACE_IO_TASK_HPP
@@ -79,6 +79,55 @@
 #	define SOLACE_PLATFORM_POSIX
 #endif
 
+/*---------------------------------
+ * Bounds checking policy
+ *---------------------------------*/
+
+/**
+ * Bounds checking policy of element access operators, such as operator[] of memory views and array views.
+ * Define SOLACE_BOUNDS_CHECK_LEVEL to one of:
+ *  SOLACE_BOUNDS_CHECK_FULL  - Index is always checked. This is the default.
+ *  SOLACE_BOUNDS_CHECK_DEBUG - Index is checked only in debug builds, when SOLACE_DEBUG is defined.
+ *  SOLACE_BOUNDS_CHECK_NONE  - Index is never checked.
+ *
+ * Explicit asserts, such as assertIndexInRange(), are not affected by this policy.
+ * @note Same policy must be used to build the library and the code using it.
+ */
+#define SOLACE_BOUNDS_CHECK_NONE 0
+#define SOLACE_BOUNDS_CHECK_DEBUG 1
+#define SOLACE_BOUNDS_CHECK_FULL 2
+
+#if !defined(SOLACE_BOUNDS_CHECK_LEVEL)
+#	define SOLACE_BOUNDS_CHECK_LEVEL SOLACE_BOUNDS_CHECK_FULL
+#endif
+
+#if (SOLACE_BOUNDS_CHECK_LEVEL == SOLACE_BOUNDS_CHECK_FULL) || \
+	(SOLACE_BOUNDS_CHECK_LEVEL == SOLACE_BOUNDS_CHECK_DEBUG && defined(SOLACE_DEBUG))
+#	define SOLACE_BOUNDS_CHECK_ENABLED 1
+#else
+#	define SOLACE_BOUNDS_CHECK_ENABLED 0
+#endif
+
+
+/*---------------------------------
+ * Language features
+ *---------------------------------*/
+
+/**
+ * SOLACE_HAS_COROUTINES is 1 when the code is compiled with C++20 coroutines support.
+ * Library itself only requires C++17, coroutine based APIs are only available to C++20 clients.
+ */
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#	if __has_include(<coroutine>)
+#		define SOLACE_HAS_COROUTINES 1
+#	endif
+#endif
+
+#if !defined(SOLACE_HAS_COROUTINES)
+#	define SOLACE_HAS_COROUTINES 0
+#endif
+
+
 /*---------------------------------
  * Platform specific settings
  *---------------------------------*/
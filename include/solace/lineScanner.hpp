@@ -0,0 +1,217 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Line scanner
+ *	@file		solace/lineScanner.hpp
+ *	@brief		Vectorized splitting of large newline-delimited text into lines.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_LINESCANNER_HPP
+#define SOLACE_LINESCANNER_HPP
+
+#include "solace/memoryView.hpp"
+#include "solace/stringView.hpp"
+#include "solace/arrayView.hpp"
+#include "solace/threadPool.hpp"
+#include "solace/result.hpp"
+#include "solace/error.hpp"
+
+#include <atomic>
+#include <type_traits>
+
+
+namespace Solace {
+
+/**
+ * Single pass scanner of newline-delimited text.
+ * Newlines are located a 64-byte block at a time using the best SIMD kernel supported by the CPU,
+ * and lines are handed out in batches of StringViews into the scanned memory.
+ *
+ * A line is a sequence of bytes terminated by '\n' or by the end of the data. Terminating newline is not
+ * included in the line, so text ending with a newline has no empty last line, while empty text has no lines at all.
+ * Carriage returns are not stripped.
+ *
+ * @note A line longer than StringView can address is skipped and counted, @see nbSkipped().
+ */
+class LineScanner {
+public:
+	using size_type = MemoryView::size_type;
+
+	/// Number of lines handed out in a single batch by scanLines().
+	static constexpr StringView::size_type kBatchSize = 256;
+
+public:
+
+	constexpr explicit LineScanner(MemoryView data) noexcept
+		: _data{data}
+	{}
+
+	/**
+	 * Scan the next batch of lines.
+	 * @param lines Array to store lines into.
+	 * @return Number of lines stored, which is 0 only once all of the data has been scanned.
+	 */
+	StringView::size_type next(ArrayView<StringView> lines) noexcept;
+
+	/// @return True if all of the data has been scanned.
+	constexpr bool done() const noexcept { return (_position >= _data.size()); }
+
+	/// @return Offset of the first byte not scanned yet.
+	constexpr size_type position() const noexcept { return _position; }
+
+	/// @return Number of lines skipped so far as they are longer than StringView can address.
+	constexpr uint64 nbSkipped() const noexcept { return _nbSkipped; }
+
+private:
+	MemoryView	_data;
+	size_type	_position{0};
+	uint64		_nbSkipped{0};
+};
+
+
+/**
+ * Number of lines found by a scan of a text.
+ */
+struct LineScanStats {
+	/// Number of lines handed out.
+	uint64	nbLines{0};
+	/// Number of lines skipped as they are longer than StringView can address.
+	uint64	nbSkipped{0};
+};
+
+
+/**
+ * Find the first newline in a memory region.
+ * @param data Memory to search.
+ * @param from Offset to start search from.
+ * @return Offset of the first '\n' at or after `from`, or data.size() if there is none.
+ */
+MemoryView::size_type findNewline(MemoryView data, MemoryView::size_type from = 0) noexcept;
+
+/**
+ * Get a newline-aligned chunk of the data.
+ * Data is cut into chunks of about `chunkSize` bytes each, with every boundary moved forward past the next newline,
+ * so that each line falls into exactly one chunk. Chunks may be empty if a line is longer than the chunk size.
+ * @param data Text to split into chunks.
+ * @param index Index of the chunk.
+ * @param chunkSize Nominal size of a chunk.
+ * @return The chunk of the data.
+ */
+MemoryView lineChunk(MemoryView data, uint64 index, MemoryView::size_type chunkSize) noexcept;
+
+
+namespace details {
+
+template<typename F>
+Result<void, Error> invokeLineBatch(F& onBatch, ArrayView<StringView> batch) {
+	if constexpr (std::is_void_v<std::invoke_result_t<F&, ArrayView<StringView>>>) {
+		onBatch(batch);
+		return Ok();
+	} else {
+		return onBatch(batch);
+	}
+}
+
+}  // namespace details
+
+
+/**
+ * Scan lines of a text in a single pass.
+ * @param data Text to scan.
+ * @param onBatch Callable invoked with each batch of lines: void(ArrayView<StringView>) or
+ * Result<void, Error>(ArrayView<StringView>). An error returned by the callable stops the scan.
+ * @return Number of lines scanned and skipped, or an error.
+ */
+template<typename F>
+Result<LineScanStats, Error>
+scanLines(MemoryView data, F&& onBatch) {
+	StringView batch[LineScanner::kBatchSize];
+	LineScanner scanner{data};
+	LineScanStats stats;
+
+	while (!scanner.done()) {
+		auto const count = scanner.next(batch);
+		if (count == 0) {  // Only over-long lines were left
+			break;
+		}
+
+		auto result = details::invokeLineBatch(onBatch, arrayView(batch, count));
+		if (!result) {
+			return result.moveError();
+		}
+
+		stats.nbLines += count;
+	}
+
+	stats.nbSkipped = scanner.nbSkipped();
+
+	return Ok(stats);
+}
+
+
+/// Nominal size of a chunk of text scanned by a single task of a parallel scan.
+inline constexpr MemoryView::size_type kDefaultLineChunkSize = 4 * 1024 * 1024;
+
+/**
+ * Scan lines of a large text, such as a memory-mapped file, on multiple threads.
+ * Text is split into newline-aligned chunks using lineChunk() that are scanned by the threads of the pool.
+ * Calling thread participates in the scan and the call returns once all chunks are processed.
+ *
+ * @note Batches are handed out concurrently and in no particular order: `onBatch` must be thread-safe.
+ *
+ * @param pool Thread pool to run the scan on.
+ * @param data Text to scan.
+ * @param onBatch Callable invoked with each batch of lines, @see scanLines(MemoryView, F&&).
+ * @param chunkSize Nominal size of a chunk of the text scanned by a single task.
+ * @return Number of lines scanned and skipped, or the first error encountered.
+ */
+template<typename F>
+Result<LineScanStats, Error>
+scanLines(ThreadPool& pool, MemoryView data, F&& onBatch,
+		  MemoryView::size_type chunkSize = kDefaultLineChunkSize) {
+	if (chunkSize == 0) {
+		chunkSize = kDefaultLineChunkSize;
+	}
+
+	auto const nbChunks = data.size() / chunkSize + ((data.size() % chunkSize) ? 1 : 0);
+	std::atomic<uint64> nbLines{0};
+	std::atomic<uint64> nbSkipped{0};
+
+	auto result = pool.parallelFor(0, nbChunks, 1,
+		[data, chunkSize, &nbLines, &nbSkipped, &onBatch](uint64 from, uint64 to) -> Result<void, Error> {
+		for (auto i = from; i < to; ++i) {
+			auto maybeStats = scanLines(lineChunk(data, i, chunkSize), onBatch);
+			if (!maybeStats) {
+				return maybeStats.moveError();
+			}
+
+			auto const& stats = *maybeStats;
+			nbLines.fetch_add(stats.nbLines, std::memory_order_relaxed);
+			nbSkipped.fetch_add(stats.nbSkipped, std::memory_order_relaxed);
+		}
+
+		return Ok();
+	});
+
+	if (!result) {
+		return result.moveError();
+	}
+
+	return Ok(LineScanStats{nbLines.load(std::memory_order_relaxed), nbSkipped.load(std::memory_order_relaxed)});
+}
+
+}  // End of namespace Solace
+#endif  // SOLACE_LINESCANNER_HPP
@@ -0,0 +1,181 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Immutable memory mappable dictionary
+ *	@file		solace/mappedDictionary.hpp
+ *	@brief		Serialized read-only string to blob dictionary and its builder.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_MAPPEDDICTIONARY_HPP
+#define SOLACE_MAPPEDDICTIONARY_HPP
+
+#include "solace/byteWriter.hpp"
+#include "solace/memoryManager.hpp"
+#include "solace/optional.hpp"
+#include "solace/stringView.hpp"
+#include "solace/vector.hpp"
+
+
+namespace Solace {
+
+/**
+ * Layout of a serialized dictionary. All integers are little endian and all offsets are from the start of data.
+ *
+ * - Header of kHeaderSize bytes: magic, version, number of entries, number of buckets, hash seed, total size.
+ * - Buckets: uint32 displacement per bucket, padded to 8 bytes.
+ * - Entries: uint64 key offset, uint32 key size, uint32 value size; indexed by the perfect hash of the key.
+ * - Records: key followed by value, each padded to 8 bytes.
+ *
+ * Index is a minimal perfect hash built with the hash-and-displace method: a key hashes to a bucket, and
+ * displacement of the bucket, together with the hash of the key, gives the index of its entry.
+ */
+struct MappedDictionaryFormat {
+	static constexpr byte kMagic[4] = {'S', 'D', 'C', 'T'};
+	static constexpr uint32 kVersion = 1;
+	static constexpr uint64 kHeaderSize = 64;
+	static constexpr uint64 kEntrySize = 16;
+	static constexpr uint64 kAlignment = 8;
+};
+
+
+/**
+ * Immutable dictionary of string keys to blobs read in place from serialized data, usually a mapped file.
+ * Opening only checks the header, so it takes constant time whatever the size of the dictionary, and pages
+ * are read in by the OS as lookups touch them.
+ * A lookup hashes the key once, reads one bucket and one entry and compares the key: values are returned as
+ * views into the data.
+ */
+class MappedDictionary {
+public:
+	using size_type = uint32;
+
+public:
+
+	MappedDictionary(MappedDictionary const&) = delete;
+	MappedDictionary& operator= (MappedDictionary const&) = delete;
+
+	MappedDictionary(MappedDictionary&& rhs) noexcept = default;
+	MappedDictionary& operator= (MappedDictionary&& rhs) noexcept = default;
+
+	/**
+	 * Open a dictionary in memory.
+	 * @param data Serialized dictionary, written by MappedDictionaryBuilder.
+	 * @return Dictionary that owns the data or an error if the data is not a dictionary.
+	 */
+	static Result<MappedDictionary, Error> open(MemoryResource&& data) noexcept;
+
+	/**
+	 * Open a dictionary file by mapping it into memory.
+	 * @param path Path of the file written by MappedDictionaryBuilder.
+	 * @return Dictionary or an error if the file could not be mapped or is not a dictionary.
+	 */
+	static Result<MappedDictionary, Error> open(StringView path) noexcept;
+
+	constexpr size_type size() const noexcept { return _size; }
+	constexpr bool empty() const noexcept { return (_size == 0); }
+
+	/// @return View of the value for a given key, or none if there is no such key.
+	Optional<MemoryView> find(StringView key) const noexcept;
+
+	bool contains(StringView key) const noexcept {
+		return find(key).isSome();
+	}
+
+	/// @return Serialized dictionary.
+	MemoryView view() const noexcept { return _data.view(); }
+
+protected:
+	MappedDictionary(MemoryResource&& data, size_type size, uint32 nbBuckets, uint64 seed) noexcept
+		: _data{mv(data)}
+		, _size{size}
+		, _nbBuckets{nbBuckets}
+		, _seed{seed}
+	{}
+
+private:
+	MemoryResource	_data;
+	size_type		_size{0};
+	uint32			_nbBuckets{0};
+	uint64			_seed{0};
+};
+
+
+/**
+ * Builder of a serialized MappedDictionary.
+ * Builder keeps views of added keys and values without copying them: they must stay valid until built.
+ *
+ * @code
+ * auto builder = makeMappedDictionaryBuilder(memoryManager, 2).unwrap();
+ * builder.add("key", wrapMemory(blob));
+ * builder.add("other", wrapMemory(otherBlob));
+ * builder.build(writer);
+ * @endcode
+ */
+class MappedDictionaryBuilder {
+public:
+	using size_type = MappedDictionary::size_type;
+
+	struct Entry {
+		StringView	key;
+		MemoryView	value;
+	};
+
+public:
+
+	MappedDictionaryBuilder(MemoryManager& memoryManager, Vector<Entry>&& entries) noexcept
+		: _memoryManager{&memoryManager}
+		, _entries{mv(entries)}
+	{}
+
+	/// @return Number of entries added.
+	constexpr size_type size() const noexcept { return static_cast<size_type>(_entries.size()); }
+
+	/// @return Maximum number of entries of the dictionary.
+	constexpr size_type capacity() const noexcept { return static_cast<size_type>(_entries.capacity()); }
+
+	/**
+	 * Add an entry. Keys must be unique.
+	 * @return Error if the builder is full.
+	 */
+	Result<void, Error> add(StringView key, MemoryView value) noexcept;
+
+	/// @return Size in bytes of the serialized dictionary.
+	uint64 encodedSize() const noexcept;
+
+	/**
+	 * Build the index and write the dictionary.
+	 * @param dest Writer to write the dictionary to, at least encodedSize() bytes must remain.
+	 * @return Error if there is not enough room, memory for the index could not be allocated or keys are not unique.
+	 */
+	Result<void, Error> build(ByteWriter& dest) const noexcept;
+
+private:
+	MemoryManager*	_memoryManager;
+	Vector<Entry>	_entries;
+};
+
+
+/**
+ * Create a builder of a dictionary.
+ * @param memoryManager Memory manager to allocate the entries and the index being built from.
+ * @param capacity Maximum number of entries.
+ */
+[[nodiscard]]
+Result<MappedDictionaryBuilder, Error>
+makeMappedDictionaryBuilder(MemoryManager& memoryManager, MappedDictionaryBuilder::size_type capacity) noexcept;
+
+}  // End of namespace Solace
+#endif  // SOLACE_MAPPEDDICTIONARY_HPP
@@ -0,0 +1,87 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Memory algorithms
+ *	@file		solace/memoryAlgorithms.hpp
+ *	@brief		Vectorized search, count and transform algorithms on memory views.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_MEMORYALGORITHMS_HPP
+#define SOLACE_MEMORYALGORITHMS_HPP
+
+#include "solace/mutableMemoryView.hpp"
+#include "solace/optional.hpp"
+
+
+namespace Solace {
+
+/*
+ * Algorithms below use the best SIMD kernel supported by the CPU, selected at runtime on the first call.
+ * @see KernelDispatch
+ */
+
+/**
+ * Find the first occurrence of a byte.
+ * @param data Memory to search.
+ * @param value A byte to search for.
+ * @param fromIndex Offset to start the search from.
+ * @return Optional offset of the first occurrence of the byte at or after fromIndex.
+ */
+Optional<MemoryView::size_type>
+find(MemoryView data, byte value, MemoryView::size_type fromIndex = 0) noexcept;
+
+/**
+ * Find the first occurrence of a sequence of bytes.
+ * @param data Memory to search.
+ * @param pattern A sequence of bytes to search for. Empty pattern is found at fromIndex.
+ * @param fromIndex Offset to start the search from.
+ * @return Optional offset of the first occurrence of the pattern at or after fromIndex.
+ */
+Optional<MemoryView::size_type>
+find(MemoryView data, MemoryView pattern, MemoryView::size_type fromIndex = 0) noexcept;
+
+/**
+ * Count occurrences of a byte.
+ * @param data Memory to search.
+ * @param value A byte to count.
+ * @return Number of bytes of the data equal to the value.
+ */
+MemoryView::size_type
+count(MemoryView data, byte value) noexcept;
+
+/**
+ * Find the first byte two memory views differ in.
+ * @param lhs Memory to compare.
+ * @param rhs Memory to compare with.
+ * @return Offset of the first differing byte, the size of the shorter view if it is a prefix of the other one,
+ * or none if both views have the same content.
+ */
+Optional<MemoryView::size_type>
+firstMismatch(MemoryView lhs, MemoryView rhs) noexcept;
+
+/**
+ * XOR memory in place with a repeating mask, such as WebSocket frame masking key.
+ * @param data Memory to transform.
+ * @param mask Mask to apply, repeated over the whole data. Data is left unchanged if the mask is empty.
+ * @param maskOffset Index of the mask byte applied to the first byte of the data,
+ * to continue masking of a stream processed in parts.
+ * @return View of the transformed data.
+ */
+MutableMemoryView
+xorWith(MutableMemoryView data, MemoryView mask, MemoryView::size_type maskOffset = 0) noexcept;
+
+}  // End of namespace Solace
+#endif  // SOLACE_MEMORYALGORITHMS_HPP
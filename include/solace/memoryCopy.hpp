@@ -0,0 +1,109 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Bulk memory copy
+ *	@file		solace/memoryCopy.hpp
+ *	@brief		Copy and fill of memory that keeps large transfers out of the cache.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_MEMORYCOPY_HPP
+#define SOLACE_MEMORYCOPY_HPP
+
+#include "solace/mutableMemoryView.hpp"
+
+#include <cstring>  // memmove, memset
+
+
+namespace Solace {
+
+/**
+ * Default size of a transfer above which copy and fill use non-temporal stores.
+ * Streaming a block this large through the cache would evict most of the working set of the process.
+ */
+inline constexpr MemoryView::size_type kDefaultNonTemporalThreshold = 4 * 1024 * 1024;
+
+/// Size of a transfer below which copy and fill always use the C library.
+inline constexpr MemoryView::size_type kBulkCopyThreshold = 2048;
+
+/// @return Size of a transfer above which copyMemory() and fillMemory() use non-temporal stores.
+MemoryView::size_type nonTemporalThreshold() noexcept;
+
+/**
+ * Set the size of a transfer above which copyMemory() and fillMemory() use non-temporal stores.
+ * @param threshold New threshold in bytes. Threshold can not be lower than kBulkCopyThreshold.
+ */
+void setNonTemporalThreshold(MemoryView::size_type threshold) noexcept;
+
+
+namespace details {
+
+void copyBulk(void* dest, void const* src, MemoryView::size_type count) noexcept;
+void fillBulk(void* dest, byte value, MemoryView::size_type count) noexcept;
+
+}  // namespace details
+
+
+/**
+ * Copy memory, the regions may overlap as with memmove.
+ * Large copies use 'rep movsb' on CPUs with fast string instructions,
+ * and copies above the non-temporal threshold bypass the cache with streaming stores.
+ * @param dest Address to copy to.
+ * @param src Address to copy from.
+ * @param count Number of bytes to copy.
+ */
+inline void copyMemory(void* dest, void const* src, MemoryView::size_type count) noexcept {
+	if (count < kBulkCopyThreshold) {
+		std::memmove(dest, src, count);
+	} else {
+		details::copyBulk(dest, src, count);
+	}
+}
+
+/**
+ * Fill memory with a byte value.
+ * Fills above the non-temporal threshold bypass the cache with streaming stores.
+ * @param dest Address of the memory to fill.
+ * @param value Value to fill memory with.
+ * @param count Number of bytes to fill.
+ */
+inline void fillMemory(void* dest, byte value, MemoryView::size_type count) noexcept {
+	if (count < kBulkCopyThreshold) {
+		std::memset(dest, value, count);
+	} else {
+		details::fillBulk(dest, value, count);
+	}
+}
+
+/**
+ * Copy memory using non-temporal stores regardless of its size.
+ * Intended for data that is not going to be read again soon, such as a buffer handed to I/O.
+ * Overlapping regions are copied as with memmove.
+ * @param dest Address to copy to.
+ * @param src Address to copy from.
+ * @param count Number of bytes to copy.
+ */
+void copyNonTemporal(void* dest, void const* src, MemoryView::size_type count) noexcept;
+
+/**
+ * Copy content of a memory view using non-temporal stores.
+ * @param dest Memory to copy to.
+ * @param source Memory to copy.
+ * @return Error if the destination is smaller than the source.
+ */
+Result<void, Error> copyNonTemporal(MutableMemoryView dest, MemoryView source) noexcept;
+
+}  // End of namespace Solace
+#endif  // SOLACE_MEMORYCOPY_HPP
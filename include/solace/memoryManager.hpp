@@ -119,10 +119,10 @@ public:
      *
 	 * @param nbBytes The size of the memory segment in bytes to allocate.
      * @return A newly allocated memory segment.
-     * TODO(abbyssoul): should return Result<>
+     * @note Derived memory managers may override this method to serve memory from a different source.
      */
     [[nodiscard]]
-	Result<MemoryResource, Error> allocate(size_type nbBytes) noexcept;
+	virtual Result<MemoryResource, Error> allocate(size_type nbBytes) noexcept;
 
     /**
      * Prohibit memory allocations.
@@ -165,6 +165,12 @@ protected:
 
     void free(MemoryView* view);
 
+    /// Account for memory allocated by a derived manager from its own source.
+    void onAllocated(size_type nbBytes) noexcept { _size += nbBytes; }
+
+    /// Account for memory released by a derived manager to its own source.
+    void onReleased(size_type nbBytes) noexcept { _size -= nbBytes; }
+
 private:
 
     /** Amount of memeory in bytes allocatable by this manager */
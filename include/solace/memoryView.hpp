@@ -38,7 +38,13 @@ namespace Solace {
  * Check if Runtime platform is big or little endian.
  * @return True if running on a big endian system.
  */
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__)
+constexpr bool isBigendian() noexcept {
+	return (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__);
+}
+#else
 bool isBigendian() noexcept;
+#endif
 
 
 /* Read-only view into a fixed-length raw memory buffer.
@@ -158,7 +164,25 @@ public:
 		return begin() + _size;
     }
 
-	value_type operator[] (size_type index) const;
+	/**
+	 * Get byte at the given index.
+	 * Index is checked according to the bounds checking policy: @see SOLACE_BOUNDS_CHECK_LEVEL
+	 * @param index Index of a byte to get.
+	 * @return Value of the byte at the given index.
+	 */
+	value_type operator[] (size_type index) const {
+		return begin()[checkIndex(index, size(), "MemoryView[]")];
+	}
+
+	/**
+	 * Get byte at the given index without bounds checking.
+	 * @note The behavior is undefined if index is not less then size().
+	 * @param index Index of a byte to get.
+	 * @return Value of the byte at the given index.
+	 */
+	constexpr value_type unchecked_at(size_type index) const noexcept {
+		return begin()[index];
+	}
 
 	/**
 	 * @brief Get row memory address of this view.
@@ -217,6 +241,21 @@ public:
      */
     MemoryView slice(size_type from, size_type to) const noexcept;
 
+    /**  Create a slice/window view of this memory segment, checking that the requested range is within the view.
+     * Unlike @see slice that silently clamps the range, this method throws if the range is not valid.
+     * Use this to validate range once before iterating over it with unchecked access.
+     *
+     * @param from [in] Offset to begin the slice from: [0, size()]
+     * @param to [in] The index to slise up until: [from, size()]
+     *
+     * @return The slice of the memory segment.
+     */
+    MemoryView checkedSlice(size_type from, size_type to) const {
+		assertRangeInBounds(from, to, size(), "MemoryView.checkedSlice()");
+
+		return {begin() + from, to - from};
+	}
+
     template<typename T>
     MemoryView sliceFor(size_type offset, size_type count = 1) const noexcept {
         return slice(offset * sizeof(T), (offset + count) * sizeof(T));
@@ -0,0 +1,165 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: MessagePack serialization
+ *	@file		solace/messagePack.hpp
+ *	@brief		Writer and zero-copy reader of MessagePack encoded data.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_MESSAGEPACK_HPP
+#define SOLACE_MESSAGEPACK_HPP
+
+#include "solace/byteReader.hpp"
+#include "solace/byteWriter.hpp"
+#include "solace/stringView.hpp"
+
+
+namespace Solace {
+
+/// Type of a MessagePack encoded value.
+enum class MessagePackType : uint8 {
+	Nil,
+	Boolean,
+	Integer,
+	Float,
+	String,
+	Binary,
+	Array,
+	Map,
+	Extension
+};
+
+
+/// Extension value: application defined type and raw data.
+struct MessagePackExtension {
+	int8		type;
+	MemoryView	data;
+};
+
+
+/**
+ * Writer of MessagePack encoded values.
+ * Each value is written using the most compact encoding of the format.
+ * Values are written whole or not at all: if there is not enough room in the destination, nothing is written.
+ *
+ * Arrays and maps are written as a header followed by their elements:
+ * @code
+ * writer.writeMapHeader(1);
+ * writer.writeString("id");
+ * writer.writeUInt(42);
+ * @endcode
+ */
+class MessagePackWriter {
+public:
+
+	explicit MessagePackWriter(ByteWriter& dest) noexcept
+		: _dest{dest}
+	{}
+
+	Result<void, Error> writeNil() noexcept;
+	Result<void, Error> writeBool(bool value) noexcept;
+	Result<void, Error> writeInt(int64 value) noexcept;
+	Result<void, Error> writeUInt(uint64 value) noexcept;
+	Result<void, Error> writeFloat(float32 value) noexcept;
+	Result<void, Error> writeDouble(float64 value) noexcept;
+	Result<void, Error> writeString(StringView value) noexcept;
+	Result<void, Error> writeBinary(MemoryView value) noexcept;
+
+	/**
+	 * Write an extension value.
+	 * @param type Application defined type, negative types are reserved by the format.
+	 * @param data Content of the value.
+	 */
+	Result<void, Error> writeExtension(int8 type, MemoryView data) noexcept;
+
+	/// Write header of an array of a given number of elements. Elements are written next.
+	Result<void, Error> writeArrayHeader(uint32 size) noexcept;
+
+	/// Write header of a map of a given number of key-value pairs. Keys and values are written next, interleaved.
+	Result<void, Error> writeMapHeader(uint32 size) noexcept;
+
+private:
+	ByteWriter&	_dest;
+};
+
+
+/**
+ * Reader of MessagePack encoded values.
+ *
+ * Strings, binaries and extensions are returned as views into the source buffer: nothing is copied, so
+ * the buffer must outlive the values read.
+ * If a value can not be read, because of its type or malformed input, an error is returned and the
+ * position of the source is left unchanged.
+ */
+class MessagePackReader {
+public:
+
+	explicit MessagePackReader(ByteReader& src) noexcept
+		: _src{src}
+	{}
+
+	/// @return Type of the next value without consuming it.
+	Result<MessagePackType, Error> peekType() const noexcept;
+
+	Result<void, Error> readNil() noexcept;
+	Result<bool, Error> readBool() noexcept;
+
+	/// Read an integer value. @return The value or an error if it does not fit int64.
+	Result<int64, Error> readInt() noexcept;
+
+	/// Read an integer value. @return The value or an error if it is negative.
+	Result<uint64, Error> readUInt() noexcept;
+
+	/// Read a floating point value of either precision.
+	Result<float64, Error> readDouble() noexcept;
+
+	/// Read a string value. @return View of the string in the source or an error if it is too long for a StringView.
+	Result<StringView, Error> readString() noexcept;
+
+	/// Read a string value of any length. @return View of UTF-8 bytes of the string in the source.
+	Result<MemoryView, Error> readStringData() noexcept;
+
+	/// Read a binary value. @return View of the value in the source.
+	Result<MemoryView, Error> readBinary() noexcept;
+
+	/// Read an extension value. @return Type and view of data of the value in the source.
+	Result<MessagePackExtension, Error> readExtension() noexcept;
+
+	/// Read header of an array. @return Number of elements of the array, to be read next.
+	Result<uint32, Error> readArrayHeader() noexcept;
+
+	/// Read header of a map. @return Number of key-value pairs of the map, to be read next.
+	Result<uint32, Error> readMapHeader() noexcept;
+
+	/**
+	 * Skip the next value, including all elements if it is an array or a map.
+	 * Content of strings, binaries and extensions is skipped using their length without being read. Nested
+	 * containers are skipped iteratively, by counting pending elements, so deep nesting does not use stack.
+	 */
+	Result<void, Error> skip() noexcept;
+
+	/**
+	 * Check that the next value, including all its elements, is well-formed and complete. Nothing is consumed.
+	 * Once validated, the value can be read without checking each step for errors caused by malformed input.
+	 */
+	Result<void, Error> validate() const noexcept;
+
+private:
+	ByteReader&	_src;
+};
+
+}  // End of namespace Solace
+#endif  // SOLACE_MESSAGEPACK_HPP
@@ -110,9 +110,26 @@ public:
 
     using MemoryView::end;
 
-	reference operator[] (size_type index);
+	/**
+	 * Get reference to a byte at the given index.
+	 * Index is checked according to the bounds checking policy: @see SOLACE_BOUNDS_CHECK_LEVEL
+	 */
+	reference operator[] (size_type index) {
+		return begin()[checkIndex(index, size(), "MutableMemoryView[]")];
+	}
+
     using MemoryView::operator[];
 
+	/**
+	 * Get reference to a byte at the given index without bounds checking.
+	 * @note The behavior is undefined if index is not less then size().
+	 */
+	constexpr reference unchecked_at(size_type index) noexcept {
+		return begin()[index];
+	}
+
+    using MemoryView::unchecked_at;
+
     using MemoryView::dataAddress;
 
 	constexpr MutableMemoryAddress dataAddress() noexcept {
@@ -181,6 +198,16 @@ public:
     /// @see MemoryView::slice
     MutableMemoryView slice(size_type from, size_type to) noexcept;
 
+    /// @see MemoryView::checkedSlice
+    using MemoryView::checkedSlice;
+
+    /// @see MemoryView::checkedSlice
+    MutableMemoryView checkedSlice(size_type from, size_type to) {
+		assertRangeInBounds(from, to, size(), "MutableMemoryView.checkedSlice()");
+
+		return {begin() + from, to - from};
+	}
+
     template<typename T>
     MutableMemoryView sliceFor(size_type offset, size_type count = 1) noexcept {
         return slice(offset * sizeof(T), (offset + count) * sizeof(T));
@@ -0,0 +1,196 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: NUMA-aware memory manager
+ *	@file		solace/numaMemoryManager.hpp
+ *	@brief		Memory manager serving allocations from per-node memory pools.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_NUMAMEMORYMANAGER_HPP
+#define SOLACE_NUMAMEMORYMANAGER_HPP
+
+#include "solace/memoryManager.hpp"
+#include "solace/details/freelist_arena.hpp"
+
+#include <mutex>
+
+
+namespace Solace {
+
+/**
+ * Memory usage of a single NUMA node pool.
+ */
+struct NumaNodeUsage {
+	/// Id of the NUMA node.
+	uint32						node;
+	/// Size of the node pool in bytes.
+	MemoryView::size_type		capacity;
+	/// Number of bytes of the node pool currently allocated.
+	MemoryView::size_type		allocated;
+	/// Number of allocations served from the node pool.
+	uint64						nbAllocations;
+	/// Number of allocations for the node served from the heap because the pool was exhausted.
+	uint64						nbFallbacks;
+	/// True if the pool memory is bound to the node. False if the system did not allow binding.
+	bool						isBound;
+};
+
+
+/**
+ * Memory manager that keeps a separate memory pool for each NUMA node of the system.
+ *
+ * Pools are mapped when reserve() is called: memory of each pool is bound to its node with mbind(MPOL_BIND)
+ * and pre-faulted, so pages are physically allocated on that node.
+ * By default allocations are served from the pool of the node the calling thread is running on,
+ * allocateOnNode() serves an allocation from the pool of a specific node.
+ * Allocations that do not fit into their node pool fall back to the heap and are counted per node.
+ *
+ * On a system without NUMA, or where node binding is not permitted, the manager degrades to
+ * a single unbound pool that behaves as a plain arena.
+ *
+ * Allocations and releases are thread safe: each node pool is guarded by its own lock,
+ * so threads running on different nodes do not contend for a pool.
+ * @note reserve(), lock() and unlock() must not be called concurrently with allocations.
+ */
+class NumaMemoryManager : public MemoryManager {
+public:
+	/// Maximum number of NUMA nodes supported.
+	static constexpr uint32 kMaxNodes = 64;
+
+	/// Alignment and granularity of allocations served from node pools.
+	static constexpr size_type kAlignment = details::FreeListArena::kAlignment;
+
+public:
+	~NumaMemoryManager() override;
+
+	NumaMemoryManager(NumaMemoryManager const&) = delete;
+	NumaMemoryManager& operator= (NumaMemoryManager const&) = delete;
+	NumaMemoryManager(NumaMemoryManager&&) = delete;
+	NumaMemoryManager& operator= (NumaMemoryManager&&) = delete;
+
+	/**
+	 * Construct a new NUMA-aware memory manager.
+	 * No memory is reserved until reserve() is called.
+	 * @param allowedCapacity The memory capacity this manager allowed to allocate, including all node pools.
+	 */
+	explicit NumaMemoryManager(size_type allowedCapacity);
+
+	/**
+	 * Map a pool for each online NUMA node of the system.
+	 * @param poolSize Size of each node pool in bytes. It is rounded up to the page size.
+	 * @return Error if pools could not be mapped. Nothing is reserved in this case.
+	 */
+	Result<void, Error> reserve(size_type poolSize);
+
+	/**
+	 * Allocate memory from the pool of the node the calling thread is running on.
+	 * Allocations are served from the heap if no pools are reserved or the node pool is exhausted.
+	 */
+	[[nodiscard]]
+	Result<MemoryResource, Error> allocate(size_type nbBytes) noexcept override;
+
+	/**
+	 * Allocate memory from the pool of the given node.
+	 * @param node Id of the NUMA node to allocate memory on.
+	 * @param nbBytes The size of the memory segment in bytes to allocate.
+	 * @return A newly allocated memory segment or an error if there is no pool for the given node.
+	 */
+	[[nodiscard]]
+	Result<MemoryResource, Error> allocateOnNode(uint32 node, size_type nbBytes) noexcept;
+
+	/// @return Number of node pools reserved.
+	uint32 nbNodes() const noexcept { return _nbPools; }
+
+	/// @return Id of the NUMA node of the pool with the given index.
+	uint32 nodeId(uint32 index) const noexcept { return _pools[index].node; }
+
+	/// @return True if the pools are reserved.
+	bool isReserved() const noexcept { return (_nbPools != 0); }
+
+	/**
+	 * Get memory usage of a node pool.
+	 * @param node Id of the NUMA node.
+	 * @return Usage of the node pool or an error if there is no pool for the given node.
+	 */
+	Result<NumaNodeUsage, Error> nodeUsage(uint32 node) const noexcept;
+
+	/**
+	 * Get NUMA node the calling thread is currently running on.
+	 * Node is queried via vDSO where the C library supports it, so the call does not enter the kernel.
+	 * @return Id of the NUMA node the calling thread is currently running on, 0 if it is unknown.
+	 */
+	static uint32 currentNode() noexcept;
+
+protected:
+
+	/**
+	 * Disposer returning memory to a node pool, or to the heap for the allocations that fell back to it.
+	 */
+	class PoolDisposer : public MemoryResource::Disposer {
+	public:
+		PoolDisposer() noexcept = default;
+
+		PoolDisposer(NumaMemoryManager& self, uint32 index) noexcept
+			: _self{&self}
+			, _index{index}
+		{}
+
+		void dispose(MemoryView* view) const override;
+
+	private:
+		NumaMemoryManager*	_self{nullptr};
+		uint32				_index{0};
+	};
+
+	friend class PoolDisposer;
+
+	void release(uint32 index, MemoryView* view) noexcept;
+
+private:
+	/// Index of the disposer of allocations served from the heap.
+	static constexpr uint32 kHeapIndex = kMaxNodes;
+
+	struct NodePool {
+		mutable std::mutex		mutex;			//!< Guards the arena and the counters.
+		uint32					node{0};
+		bool					isBound{false};
+		details::FreeListArena	arena;
+		PoolDisposer			disposer;
+		uint64					nbAllocations{0};
+		uint64					nbFallbacks{0};
+	};
+
+	NodePool* findPool(uint32 node) noexcept;
+	NodePool const* findPool(uint32 node) const noexcept;
+
+	Result<MemoryResource, Error> allocateFrom(NodePool& pool, size_type nbBytes) noexcept;
+	Result<MemoryResource, Error> allocateFromHeap(size_type nbBytes) noexcept;
+
+	/// Account for an allocation of the given size if it is within the capacity of the manager.
+	Result<void, Error> charge(size_type nbBytes) noexcept;
+	void discharge(size_type nbBytes) noexcept;
+
+private:
+	std::mutex		_mutex;				//!< Guards memory accounting of the manager.
+	PoolDisposer	_heapDisposer{*this, kHeapIndex};
+	NodePool		_pools[kMaxNodes];
+	uint32			_nbPools{0};
+	void*			_mapping{nullptr};
+	size_type		_mappingSize{0};
+};
+
+}  // End of namespace Solace
+#endif  // SOLACE_NUMAMEMORYMANAGER_HPP
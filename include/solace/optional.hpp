@@ -58,6 +58,111 @@ inline constexpr None none { None::_Construct::_Token };
 template<typename T>
 class Optional;
 
+
+/**
+ * Niche type-trait: types that have a spare value which is never used to represent valid state
+ * can specialize this trait to allow Optional<T> to use that value to encode 'none'.
+ * Such Optional<T> has the same size as T, as no separate flag is stored.
+ *
+ * A specialization must derive from std::true_type and provide:
+ *  static constexpr T none() noexcept; - return the niche value.
+ *  static constexpr bool isNone(T const& value) noexcept; - check if the value is the niche.
+ *
+ * @note Only trivially copyable and trivially destructible types can have niche.
+ * @note Constructing Optional<T> with a niche value results in an empty optional.
+ */
+template <typename T>
+struct OptionalNiche : std::false_type {
+};
+
+
+namespace details {
+
+/// Storage of an optional value with a separate 'engaged' flag.
+template <typename T, typename Enable = void>
+struct OptionalStorage {
+	constexpr OptionalStorage() noexcept
+		: _engaged{false}
+		, _empty{}
+	{}
+
+	template<typename ...Args>
+	constexpr explicit OptionalStorage(InPlace, Args&&... args)
+		: _engaged{true}
+		, _payload{fwd<Args>(args)...}
+	{}
+
+	// Payload is destroyed by the owner of the storage
+	~OptionalStorage() {}
+
+	constexpr bool isEngaged() const noexcept { return _engaged; }
+
+	T& payload() noexcept { return _payload; }
+	constexpr T const& payload() const noexcept { return _payload; }
+
+	template<typename...Args>
+	constexpr void
+	construct(Args&&... args) noexcept(std::is_nothrow_constructible<T, Args...>()) {
+		ctor(_payload, fwd<Args>(args)...);
+		_engaged = true;
+	}
+
+	constexpr void
+	destroy() noexcept(std::is_nothrow_destructible_v<T>) {
+		if (_engaged) {
+			_engaged = false;
+			dtor(_payload);
+		}
+	}
+
+private:
+	struct Empty_type {};
+
+	bool _engaged;
+	union {
+		Empty_type		_empty;
+		T				_payload;
+	};
+};
+
+
+/// Storage of an optional value of a type with niche: 'none' is represented by the niche value.
+template <typename T>
+struct OptionalStorage<T, std::enable_if_t<OptionalNiche<T>::value>> {
+	static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+				  "Only trivial types can have a niche");
+
+	constexpr OptionalStorage() noexcept
+		: _payload{OptionalNiche<T>::none()}
+	{}
+
+	template<typename ...Args>
+	constexpr explicit OptionalStorage(InPlace, Args&&... args)
+		: _payload{fwd<Args>(args)...}
+	{}
+
+	constexpr bool isEngaged() const noexcept { return !OptionalNiche<T>::isNone(_payload); }
+
+	T& payload() noexcept { return _payload; }
+	constexpr T const& payload() const noexcept { return _payload; }
+
+	template<typename...Args>
+	constexpr void
+	construct(Args&&... args) noexcept(std::is_nothrow_constructible<T, Args...>()) {
+		_payload = T{fwd<Args>(args)...};
+	}
+
+	constexpr void
+	destroy() noexcept {
+		_payload = OptionalNiche<T>::none();
+	}
+
+private:
+	T	_payload;
+};
+
+}  // namespace details
+
 /// Optional type-trait
 template <typename MaybeOptional>
 struct is_optional : std::false_type {
@@ -98,51 +203,53 @@ public:
      * Construct an new empty optional value.
      */
     constexpr Optional() noexcept
-		: _engaged{false}
-		, _empty{}
+		: _storage{}
     {}
 
     constexpr Optional(None) noexcept
-		: _engaged{false}
-		, _empty{}
+		: _storage{}
 	{}
 
 	template<typename D>
 	constexpr Optional(Optional<D>& other) noexcept(std::is_nothrow_copy_constructible<T>::value)
-		: _engaged{other.isSome()
-				   ? construct(other._payload)
-				   : false}
+		: _storage{}
 	{
+		if (other.isSome()) {
+			construct(other._storage.payload());
+		}
 	}
 
 	template<typename D>
 	constexpr Optional(Optional<D> const& other) noexcept(std::is_nothrow_copy_constructible<T>::value)
-		: _engaged{other.isSome()
-				   ? construct(other._payload)
-				   : false}
+		: _storage{}
 	{
+		if (other.isSome()) {
+			construct(other._storage.payload());
+		}
 	}
 
 	template<typename D>
 	constexpr Optional(Optional<D>&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
-		: _engaged{other.isSome()
-				   ? construct(mv(other._payload))
-				   : false}
+		: _storage{}
     {
+		if (other.isSome()) {
+			construct(mv(other._storage.payload()));
+		}
     }
 
 	template<typename CanBeT>
 	constexpr Optional(CanBeT&& value) noexcept(std::is_nothrow_move_constructible<T>::value)
-		: _engaged{construct(fwd<CanBeT>(value))}
-	{}
+		: _storage{}
+	{
+		construct(fwd<CanBeT>(value));
+	}
 
     /**
      * Construct an non-empty optional in place.
      */
     template<typename ...ARGS>
     explicit Optional(InPlace, ARGS&&... args) noexcept(std::is_nothrow_move_constructible<T>::value)
-		: _engaged{true}
-		, _payload{fwd<ARGS>(args)...}
+		: _storage{in_place, fwd<ARGS>(args)...}
     {}
 
 
@@ -152,14 +259,14 @@ public:
 		auto const rhsSome = rhs.isSome();
         if (isSome()) {  // This has something inside:
 			if (rhsSome) {
-				swap(rhs._payload, _payload);
+				swap(rhs._storage.payload(), _storage.payload());
             } else {
-				rhs.construct(mv(_payload));
+				rhs.construct(mv(_storage.payload()));
 				destroy();
 			}
         } else {  // We got nothing:
 			if (rhsSome) {
-				construct(mv(rhs._payload));
+				construct(mv(rhs._storage.payload()));
 				rhs.destroy();
 			}
 			// Note: this.isNone() and rhs.isNone - no-op
@@ -193,9 +300,9 @@ public:
       return isSome();
     }
 
-    constexpr bool isSome() const noexcept { return _engaged; }
+    constexpr bool isSome() const noexcept { return _storage.isEngaged(); }
 
-    constexpr bool isNone() const noexcept { return !_engaged; }
+    constexpr bool isNone() const noexcept { return !_storage.isEngaged(); }
 
     T& operator* () noexcept { return get(); }
     T const& operator* () const noexcept { return get(); }
@@ -205,7 +312,7 @@ public:
 			raiseInvalidStateError("Optional<>::get");
         }
 
-        return _payload;
+        return _storage.payload();
     }
 
     T& get() {
@@ -213,7 +320,7 @@ public:
 			raiseInvalidStateError("Optional<>::get");
         }
 
-        return _payload;
+        return _storage.payload();
     }
 
 
@@ -222,7 +329,7 @@ public:
 			raiseInvalidStateError("Optional<>::move");
         }
 
-		return mv(_payload);
+		return mv(_storage.payload());
     }
 
     T const& orElse(T const& t) const noexcept {
@@ -230,14 +337,14 @@ public:
             return t;
         }
 
-        return _payload;
+        return _storage.payload();
     }
 
 	template <typename F,
 			  typename U = typename std::invoke_result<F, T&>::type>
 	Optional<U>	map(F&& f) {
         return (isSome())
-				? Optional<U>{f(_payload)}
+				? Optional<U>{f(_storage.payload())}
                 : none;
     }
 
@@ -245,7 +352,7 @@ public:
 			  typename U = typename std::invoke_result<F, T>::type>
 	Optional<U>	map(F&& f) const {
         return (isSome())
-				? Optional<U>{f(_payload)}
+				? Optional<U>{f(_storage.payload())}
                 : none;
     }
 
@@ -256,7 +363,7 @@ public:
     U >
 	flatMap(F&& f) const& {
         return (isSome())
-                ? f(_payload)
+                ? f(_storage.payload())
                 : none;
     }
 
@@ -267,7 +374,7 @@ public:
     U >
     flatMap(F&& f) && {
         return (isSome())
-				? f(mv(_payload))
+				? f(mv(_storage.payload()))
                 : none;
     }
 
@@ -277,13 +384,13 @@ public:
 	 U >
 	 flatMap(F&& f) & {
 		 return (isSome())
-				 ? f(mv(_payload))
+				 ? f(mv(_storage.payload()))
 				 : none;
 	 }
 
     template <typename F>
 	Optional<T> const& filter(F&& predicate) const {
-		return (isSome() && predicate(_payload))
+		return (isSome() && predicate(_storage.payload()))
 				? *this
 				: _kEmptyInstance;
     }
@@ -291,25 +398,19 @@ public:
 protected:
 	using mutable_value = std::remove_cv_t<value_type>;
 	using StoredValue_type = std::conditional_t<std::is_reference_v<value_type>,
-												std::reference_wrapper<std::decay_t<value_type>>,
+												std::reference_wrapper<std::remove_reference_t<value_type>>,
 												mutable_value>;
 
 
     template<typename...Args>
-    constexpr bool
+    constexpr void
 	construct(Args&&... args) noexcept(std::is_nothrow_constructible<StoredValue_type, Args...>()) {
-		ctor(_payload, fwd<Args>(args)...);
-        _engaged = true;
-
-        return _engaged;
+		_storage.construct(fwd<Args>(args)...);
     }
 
 	constexpr void
 	destroy() noexcept(std::is_nothrow_destructible_v<StoredValue_type>) {
-        if (_engaged) {
-            _engaged = false;
-			dtor(_payload);
-        }
+		_storage.destroy();
     }
 
 private:
@@ -319,13 +420,7 @@ private:
     template <class>
     friend class Optional;
 
-	struct Empty_type {};
-
-	bool _engaged;
-	union {
-		Empty_type			_empty;
-		StoredValue_type	_payload;
-    };
+	details::OptionalStorage<StoredValue_type>	_storage;
 
 };
 
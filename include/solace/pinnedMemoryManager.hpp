@@ -0,0 +1,145 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Pinned memory manager
+ *	@file		solace/pinnedMemoryManager.hpp
+ *	@brief		Memory manager serving allocations from a pre-faulted, locked arena.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_PINNEDMEMORYMANAGER_HPP
+#define SOLACE_PINNEDMEMORYMANAGER_HPP
+
+#include "solace/memoryManager.hpp"
+#include "solace/details/freelist_arena.hpp"
+
+
+namespace Solace {
+
+/**
+ * Configuration of a pinned memory manager.
+ */
+struct PinnedMemoryConfig {
+	/// Called for every allocation that could not be served from the pinned arena.
+	using FallbackObserver = void (*)(MemoryManager::size_type nbBytes, void* context) noexcept;
+
+	/// Back the arena with huge pages if the system has them reserved.
+	bool				useHugePages{false};
+	/// Serve allocations from the heap when the arena is exhausted. Otherwise such allocations fail.
+	bool				allowFallback{true};
+	/// Optional observer of fallback allocations.
+	FallbackObserver	onFallback{nullptr};
+	/// Context passed to the fallback observer.
+	void*				fallbackContext{nullptr};
+};
+
+
+/**
+ * Memory manager that reserves all of its capacity up front.
+ *
+ * Whole capacity is mapped with MAP_POPULATE and locked with mlock when reserve() is called,
+ * so memory allocated from the arena never takes a page fault on first touch and is never swapped out.
+ * Allocations are served from the arena with a first-fit free list, aligned to kAlignment bytes.
+ * Arena allocations are rounded up to a multiple of kAlignment: the returned view and the size charged
+ * against capacity are the rounded size, not the requested one.
+ * Allocations that do not fit into the arena fall back to the heap, and are counted and reported.
+ *
+ * @note Like MemoryManager, this class is not thread safe.
+ */
+class PinnedMemoryManager : public MemoryManager {
+public:
+	/// Alignment and granularity of allocations served from the arena.
+	static constexpr size_type kAlignment = details::FreeListArena::kAlignment;
+
+public:
+	~PinnedMemoryManager() override;
+
+	PinnedMemoryManager(PinnedMemoryManager const&) = delete;
+	PinnedMemoryManager& operator= (PinnedMemoryManager const&) = delete;
+	PinnedMemoryManager(PinnedMemoryManager&&) = delete;
+	PinnedMemoryManager& operator= (PinnedMemoryManager&&) = delete;
+
+	/**
+	 * Construct a new pinned memory manager.
+	 * No memory is reserved until reserve() is called.
+	 * @param allowedCapacity The memory capacity this manager allowed to allocate, including the arena.
+	 * @param config Manager configuration.
+	 */
+	explicit PinnedMemoryManager(size_type allowedCapacity, PinnedMemoryConfig const& config = {});
+
+	/**
+	 * Map, pre-fault and lock the arena.
+	 * @param arenaSize Size of the arena in bytes. It is rounded up to the page size.
+	 * @return Error if the rounded arena size exceeds capacity, or if the arena could not be mapped or locked.
+	 * Nothing is reserved in this case.
+	 */
+	Result<void, Error> reserve(size_type arenaSize);
+
+	[[nodiscard]]
+	Result<MemoryResource, Error> allocate(size_type nbBytes) noexcept override;
+
+	/// @return True if the arena is reserved and locked.
+	bool isPinned() const noexcept { return (_mapping != nullptr); }
+
+	/// @return True if the arena is backed by huge pages.
+	bool usesHugePages() const noexcept { return _usesHugePages; }
+
+	/// @return Size of the arena in bytes.
+	size_type arenaCapacity() const noexcept { return _arena.capacity(); }
+
+	/// @return Number of bytes of the arena not currently allocated.
+	size_type arenaAvailable() const noexcept { return _arena.available(); }
+
+	/// @return Number of allocations that have been served from the heap instead of the arena.
+	uint64 nbFallbackAllocations() const noexcept { return _nbFallbacks; }
+
+	/// @return Total number of bytes allocated from the heap instead of the arena.
+	uint64 fallbackBytes() const noexcept { return _fallbackBytes; }
+
+protected:
+
+	/**
+	 * Disposer returning memory to the arena.
+	 */
+	class ArenaDisposer : public MemoryResource::Disposer {
+	public:
+		explicit ArenaDisposer(PinnedMemoryManager& self) noexcept
+			: _self{&self}
+		{}
+
+		void dispose(MemoryView* view) const override;
+
+	private:
+		PinnedMemoryManager* _self;
+	};
+
+	friend class ArenaDisposer;
+
+	void release(MemoryView* view) noexcept;
+
+private:
+	PinnedMemoryConfig			_config;
+	ArenaDisposer				_arenaDisposer;
+
+	void*						_mapping{nullptr};
+	details::FreeListArena		_arena;
+	bool						_usesHugePages{false};
+
+	uint64						_nbFallbacks{0};
+	uint64						_fallbackBytes{0};
+};
+
+}  // End of namespace Solace
+#endif  // SOLACE_PINNEDMEMORYMANAGER_HPP
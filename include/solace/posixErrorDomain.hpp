@@ -24,6 +24,7 @@
 #include "solace/atom.hpp"
 #include "solace/error.hpp"
 #include "solace/errorDomain.hpp"
+#include "solace/errorStats.hpp"
 
 
 namespace Solace {
@@ -194,29 +195,29 @@ enum class SystemErrors : int {
 /// Create an error object representing given system error code.
 [[nodiscard]]
 inline Error makeSystemError(int errCode) noexcept {
-    return Error{kSystemCatergory, errCode};
+    return trackError(Error{kSystemCatergory, errCode});
 }
 
 /// Create an error object representing given system error code with a tag.
 [[nodiscard]]
 inline Error makeSystemError(int errCode, StringLiteral tag) noexcept {
-	return Error{kSystemCatergory, errCode, mv(tag)};
+	return trackError(Error{kSystemCatergory, errCode, mv(tag)});
 }
 
 
 [[nodiscard]]
 inline Error makeError(BasicError errCode, StringLiteral tag) noexcept {
-    return Error{kSystemCatergory, static_cast<int>(errCode), tag};
+    return trackError(Error{kSystemCatergory, static_cast<int>(errCode), tag});
 }
 
 [[nodiscard]]
 inline Error makeError(GenericError errCode, StringLiteral tag) noexcept {
-    return Error{kSystemCatergory, static_cast<int>(errCode), tag};
+    return trackError(Error{kSystemCatergory, static_cast<int>(errCode), tag});
 }
 
 [[nodiscard]]
 inline Error makeError(SystemErrors errCode, StringLiteral tag) noexcept {
-    return Error{kSystemCatergory, static_cast<int>(errCode), tag};
+    return trackError(Error{kSystemCatergory, static_cast<int>(errCode), tag});
 }
 
 
@@ -0,0 +1,160 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Latency probes
+ *	@file		solace/probe.hpp
+ *	@brief		Scoped timers recording into per-thread latency histograms.
+ *
+ * A probe is a named point of measurement. SOLACE_PROBE(name) times the enclosing scope and records
+ * the duration into a log-linear histogram of the probe. Histograms are kept per thread, so recording
+ * takes no locks and no read-modify-write atomics. probeStatsSnapshot() merges histograms of all threads
+ * and reports latency percentiles per probe.
+ *
+ * Library hot paths are instrumented with SOLACE_PROBE only when the library is built with
+ * SOLACE_PROBES defined (cmake -DPROBES=ON). Otherwise the macro expands to nothing.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_PROBE_HPP
+#define SOLACE_PROBE_HPP
+
+#include "solace/stringView.hpp"
+#include "solace/arrayView.hpp"
+
+#include <time.h>
+
+
+namespace Solace {
+
+/// Id of a registered probe.
+using ProbeId = uint32;
+
+/// Maximum number of distinct probes.
+inline constexpr uint32 kMaxProbes = 32;
+
+/// Id returned when the probe table is full. Recording to this probe is ignored.
+inline constexpr ProbeId kInvalidProbe = kMaxProbes;
+
+
+/**
+ * Latency statistics of a probe aggregated across all threads.
+ * Percentiles are accurate to within 1/16th of the value.
+ */
+struct ProbeStats {
+	StringView	name;
+	uint64		count;
+	uint64		meanNs;
+	uint64		minNs;
+	uint64		p50Ns;
+	uint64		p99Ns;
+	uint64		p999Ns;
+	uint64		maxNs;
+};
+
+
+namespace details {
+
+/// True if the time stamp counter is used as the probe clock. Decided once, when the first probe is registered.
+extern bool gProbeUsesTsc;
+
+}  // namespace details
+
+
+/**
+ * Read the probe clock.
+ * @return Current value of the probe clock in ticks. Ticks are converted to nanoseconds by snapshots only.
+ */
+inline uint64 probeTicks() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+	if (details::gProbeUsesTsc) {
+		return __builtin_ia32_rdtsc();
+	}
+#endif
+
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return static_cast<uint64>(ts.tv_sec) * 1000000000ULL + static_cast<uint64>(ts.tv_nsec);
+}
+
+
+/**
+ * Register a probe.
+ * @note Probes are identified by name, registering the same name again returns the same id.
+ * @param name Name of the probe, expected to be a string literal.
+ * @return Id of the probe or kInvalidProbe if there are already kMaxProbes probes registered.
+ */
+ProbeId registerProbe(StringLiteral name) noexcept;
+
+/**
+ * Record a duration into the calling thread's histogram of a probe.
+ * @param probe Id of the probe.
+ * @param ticks Duration in probe clock ticks.
+ */
+void recordProbe(ProbeId probe, uint64 ticks) noexcept;
+
+
+/**
+ * Take a snapshot of all registered probes merged across all threads.
+ * @param dest A buffer to write statistics into. Probes that do not fit into the buffer are not reported.
+ * @return Number of entries written into the buffer.
+ */
+uint32 probeStatsSnapshot(ArrayView<ProbeStats> dest) noexcept;
+
+/**
+ * Reset histograms of all probes. Probes remain registered.
+ * @note Durations recorded concurrently with the reset may or may not be counted.
+ */
+void probeStatsReset() noexcept;
+
+
+/**
+ * Timer recording time spent in its scope into a probe.
+ */
+class ScopedTimer {
+public:
+	explicit ScopedTimer(ProbeId probe) noexcept
+		: _probe{probe}
+		, _start{probeTicks()}
+	{}
+
+	~ScopedTimer() noexcept {
+		recordProbe(_probe, probeTicks() - _start);
+	}
+
+	ScopedTimer(ScopedTimer const&) = delete;
+	ScopedTimer& operator= (ScopedTimer const&) = delete;
+
+private:
+	ProbeId		_probe;
+	uint64		_start;
+};
+
+}  // End of namespace Solace
+
+
+#define SOLACE_PROBE_CONCAT_IMPL(a, b) a##b
+#define SOLACE_PROBE_CONCAT(a, b) SOLACE_PROBE_CONCAT_IMPL(a, b)
+
+#ifdef SOLACE_PROBES
+/// Time the rest of the enclosing scope into the named probe.
+#define SOLACE_PROBE(name) \
+	static ::Solace::ProbeId const SOLACE_PROBE_CONCAT(solaceProbeId_, __LINE__) = ::Solace::registerProbe(name); \
+	::Solace::ScopedTimer const SOLACE_PROBE_CONCAT(solaceProbeTimer_, __LINE__){SOLACE_PROBE_CONCAT(solaceProbeId_, __LINE__)}
+#else
+#define SOLACE_PROBE(name) static_cast<void>(0)
+#endif  // SOLACE_PROBES
+
+#endif  // SOLACE_PROBE_HPP
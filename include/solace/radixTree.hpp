@@ -0,0 +1,1092 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace:
+ *	@file		solace/radixTree.hpp
+ *	@brief		Ordered map of string keys implemented as an adaptive radix tree.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_RADIXTREE_HPP
+#define SOLACE_RADIXTREE_HPP
+
+#include "solace/types.hpp"
+#include "solace/utils.hpp"
+#include "solace/stringView.hpp"
+#include "solace/memoryManager.hpp"
+#include "solace/optional.hpp"
+#include "solace/result.hpp"
+
+#include "solace/details/size_class_arena.hpp"
+
+#include <cstring>  // memcmp, memcpy, memmove
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+namespace Solace {
+
+/**
+ * Ordered map of string keys, implemented as an adaptive radix tree (ART).
+ *
+ * Inner nodes branch on a single key byte and come in four sizes: Node4, Node16, Node48 and Node256,
+ * growing and shrinking as children are added and removed. Node16 is searched with a SIMD compare.
+ * Runs of bytes shared by all keys of a subtree are stored once in the node (path compression) and
+ * a subtree with a single entry is just a leaf, so memory used is proportional to the key bytes
+ * rather than to the key length times the node size.
+ *
+ * Keys are ordered lexicographically by unsigned bytes, a key preceding any key it is a prefix of.
+ * Leaves store a copy of the key and are linked in key order, which makes ordered and prefix iteration cheap.
+ * All nodes are allocated from an arena of chunks taken from a memory manager.
+ *
+ * @note Inserting or erasing invalidates iterators to erased entries only.
+ */
+template<typename T>
+class RadixTree {
+public:
+	using value_type = T;
+	using size_type = uint32;
+
+	struct EntryRef {
+		StringView	key;
+		T&			value;
+	};
+
+	struct EntryConstRef {
+		StringView	key;
+		T const&	value;
+	};
+
+private:
+
+	enum class NodeType : uint8 {
+		Leaf,
+		Node4,
+		Node16,
+		Node48,
+		Node256
+	};
+
+	struct Node {
+		NodeType	type;
+	};
+
+	struct Leaf : Node {
+		StringView::size_type	keyLength;
+		Leaf*					prev;
+		Leaf*					next;
+		alignas(T) byte			valueData[sizeof(T)];
+
+		T& value() noexcept { return *reinterpret_cast<T*>(valueData); }
+		T const& value() const noexcept { return *reinterpret_cast<T const*>(valueData); }
+
+		// Key bytes follow the leaf
+		byte* keyData() noexcept { return reinterpret_cast<byte*>(this + 1); }
+		byte const* keyData() const noexcept { return reinterpret_cast<byte const*>(this + 1); }
+		StringView key() const noexcept { return {reinterpret_cast<char const*>(keyData()), keyLength}; }
+	};
+
+	struct Inner : Node {
+		uint16	nbChildren;
+		uint16	prefixLength;	//!< Number of key bytes shared by all entries of the subtree.
+		uint16	prefixCapacity;	//!< Number of bytes allocated for the prefix, which follows the node.
+		Leaf*	terminal;		//!< Entry with the key ending at this node, if any.
+	};
+
+	/// Up to 4 children, keys sorted.
+	struct Node4 : Inner {
+		uint8	keys[4];
+		Node*	children[4];
+	};
+
+	/// Up to 16 children, keys sorted.
+	struct Node16 : Inner {
+		uint8	keys[16];
+		Node*	children[16];
+	};
+
+	/// Up to 48 children, indexed by the key byte: index holds the slot of the child + 1, 0 if there is none.
+	struct Node48 : Inner {
+		uint8	index[256];
+		Node*	children[48];
+	};
+
+	/// Up to 256 children, indexed by the key byte directly.
+	struct Node256 : Inner {
+		Node*	children[256];
+	};
+
+	template<typename LeafPtr, typename Ref>
+	struct Iterator_base {
+		constexpr Iterator_base(LeafPtr leaf) noexcept
+			: _leaf{leaf}
+		{}
+
+		constexpr bool operator!= (Iterator_base const& other) const noexcept { return (_leaf != other._leaf); }
+		constexpr bool operator== (Iterator_base const& other) const noexcept { return (_leaf == other._leaf); }
+
+		Ref operator* () const noexcept { return {_leaf->key(), _leaf->value()}; }
+
+		Iterator_base& operator++ () noexcept {
+			_leaf = _leaf->next;
+			return *this;
+		}
+
+	private:
+		LeafPtr		_leaf;
+	};
+
+public:
+	using Iterator = Iterator_base<Leaf*, EntryRef>;
+	using const_iterator = Iterator_base<Leaf const*, EntryConstRef>;
+
+	/// A range of entries between two iterators.
+	template<typename I>
+	struct Range {
+		I	first;
+		I	last;
+
+		constexpr I begin() const noexcept { return first; }
+		constexpr I end() const noexcept { return last; }
+		constexpr bool empty() const noexcept { return (first == last); }
+	};
+
+public:
+
+	~RadixTree() {
+		clear();
+	}
+
+	RadixTree(RadixTree const&) = delete;
+	RadixTree& operator= (RadixTree const&) = delete;
+
+	RadixTree(RadixTree&& rhs) noexcept
+		: _arena{mv(rhs._arena)}
+		, _root{exchange(rhs._root, nullptr)}
+		, _first{exchange(rhs._first, nullptr)}
+		, _last{exchange(rhs._last, nullptr)}
+		, _size{exchange(rhs._size, 0)}
+	{}
+
+	RadixTree& operator= (RadixTree&& rhs) noexcept {
+		return swap(rhs);
+	}
+
+	/**
+	 * Construct an empty tree. No memory is allocated until the first entry is inserted.
+	 * @param memoryManager Memory manager to allocate nodes from. Must outlive the tree.
+	 */
+	explicit RadixTree(MemoryManager& memoryManager) noexcept
+		: _arena{memoryManager}
+	{}
+
+	RadixTree& swap(RadixTree& rhs) noexcept {
+		using std::swap;
+		_arena.swap(rhs._arena);
+		swap(_root, rhs._root);
+		swap(_first, rhs._first);
+		swap(_last, rhs._last);
+		swap(_size, rhs._size);
+
+		return *this;
+	}
+
+	constexpr bool empty() const noexcept { return (_size == 0); }
+	constexpr size_type size() const noexcept { return _size; }
+
+	/// @return Number of bytes allocated for nodes, keys and values.
+	constexpr size_t memoryUsed() const noexcept { return _arena.allocated(); }
+
+	bool contains(StringView key) const noexcept {
+		return findLeaf(key) != nullptr;
+	}
+
+	Optional<T&> find(StringView key) noexcept {
+		auto leaf = const_cast<Leaf*>(findLeaf(key));
+		if (!leaf) {
+			return none;
+		}
+
+		return leaf->value();
+	}
+
+	Optional<T const&> find(StringView key) const noexcept {
+		auto leaf = findLeaf(key);
+		if (!leaf) {
+			return none;
+		}
+
+		return leaf->value();
+	}
+
+	/**
+	 * Insert a value with a given key. Value of an existing entry with the same key is replaced.
+	 * @return Reference to the value in the tree or an error if a node could not be allocated.
+	 */
+	Result<T&, Error>
+	put(StringView key, T&& value) {
+		return insert(key, mv(value));
+	}
+
+	template<typename... Args>
+	Result<T&, Error>
+	put(StringView key, Args&&... args) {
+		return insert(key, fwd<Args>(args)...);
+	}
+
+	/**
+	 * Remove an entry with a given key.
+	 * @return True if an entry was removed, false if there was no such key.
+	 */
+	bool erase(StringView key) {
+		auto const bytes = reinterpret_cast<byte const*>(key.data());
+		Node** ref = &_root;
+		Node** parentRef = nullptr;
+		size_type depth = 0;
+
+		while (*ref) {
+			auto node = *ref;
+			if (node->type == NodeType::Leaf) {
+				auto leaf = static_cast<Leaf*>(node);
+				if (!isKeyOf(leaf, key)) {
+					return false;
+				}
+
+				destroyLeaf(leaf);
+				if (!parentRef) {
+					*ref = nullptr;
+				} else {
+					auto parent = static_cast<Inner*>(*parentRef);
+					removeChild(parent, bytes[depth - 1]);
+					compact(parentRef);
+				}
+
+				return true;
+			}
+
+			auto inner = static_cast<Inner*>(node);
+			if (matchPrefix(inner, bytes + depth, key.size() - depth) != inner->prefixLength) {
+				return false;
+			}
+
+			depth += inner->prefixLength;
+			if (depth == key.size()) {
+				if (!inner->terminal) {
+					return false;
+				}
+
+				destroyLeaf(exchange(inner->terminal, nullptr));
+				compact(ref);
+
+				return true;
+			}
+
+			auto child = findChild(inner, bytes[depth]);
+			if (!child) {
+				return false;
+			}
+
+			parentRef = ref;
+			ref = child;
+			depth += 1;
+		}
+
+		return false;
+	}
+
+	/// Remove all entries and return memory to the memory manager.
+	void clear() noexcept {
+		for (auto leaf = _first; leaf; leaf = leaf->next) {
+			dtor(leaf->value());
+		}
+
+		// All nodes live in the arena: drop it as a whole instead of walking the tree
+		details::SizeClassArena{mv(_arena)};
+
+		_root = nullptr;
+		_first = nullptr;
+		_last = nullptr;
+		_size = 0;
+	}
+
+	Iterator begin() noexcept { return {_first}; }
+	Iterator end() noexcept { return {nullptr}; }
+	const_iterator begin() const noexcept { return {_first}; }
+	const_iterator end() const noexcept { return {nullptr}; }
+
+	/// @return Range of entries with keys starting with the given prefix, in key order.
+	Range<Iterator> withPrefix(StringView prefix) noexcept {
+		auto const subtree = const_cast<Node*>(findPrefix(prefix));
+		return subtree
+				? Range<Iterator>{{minLeaf(subtree)}, {maxLeaf(subtree)->next}}
+				: Range<Iterator>{end(), end()};
+	}
+
+	Range<const_iterator> withPrefix(StringView prefix) const noexcept {
+		auto const subtree = findPrefix(prefix);
+		return subtree
+				? Range<const_iterator>{{minLeaf(subtree)}, {maxLeaf(subtree)->next}}
+				: Range<const_iterator>{end(), end()};
+	}
+
+protected:
+
+	static constexpr size_type innerSize(NodeType type) noexcept {
+		switch (type) {
+		case NodeType::Node4:	return sizeof(Node4);
+		case NodeType::Node16:	return sizeof(Node16);
+		case NodeType::Node48:	return sizeof(Node48);
+		case NodeType::Node256:	return sizeof(Node256);
+		case NodeType::Leaf:	return sizeof(Leaf);
+		}
+
+		return 0;
+	}
+
+	static constexpr size_type innerCapacity(NodeType type) noexcept {
+		switch (type) {
+		case NodeType::Node4:	return 4;
+		case NodeType::Node16:	return 16;
+		case NodeType::Node48:	return 48;
+		case NodeType::Node256:	return 256;
+		case NodeType::Leaf:	return 0;
+		}
+
+		return 0;
+	}
+
+	static byte* prefixData(Inner* inner) noexcept {
+		return reinterpret_cast<byte*>(inner) + innerSize(inner->type);
+	}
+
+	static byte const* prefixData(Inner const* inner) noexcept {
+		return reinterpret_cast<byte const*>(inner) + innerSize(inner->type);
+	}
+
+	/// @return Number of leading bytes of the node prefix matching the given bytes.
+	static size_type matchPrefix(Inner const* inner, byte const* bytes, size_type nbBytes) noexcept {
+		auto const prefix = prefixData(inner);
+		auto const n = (inner->prefixLength < nbBytes) ? inner->prefixLength : nbBytes;
+		size_type i = 0;
+		while (i < n && prefix[i] == bytes[i]) {
+			++i;
+		}
+
+		return i;
+	}
+
+	static bool isKeyOf(Leaf const* leaf, StringView key) noexcept {
+		return (leaf->keyLength == key.size()) &&
+				(key.size() == 0 || std::memcmp(leaf->keyData(), key.data(), key.size()) == 0);
+	}
+
+	Leaf const* findLeaf(StringView key) const noexcept {
+		auto const bytes = reinterpret_cast<byte const*>(key.data());
+		Node const* node = _root;
+		size_type depth = 0;
+
+		while (node) {
+			if (node->type == NodeType::Leaf) {
+				auto leaf = static_cast<Leaf const*>(node);
+				return isKeyOf(leaf, key) ? leaf : nullptr;
+			}
+
+			auto inner = static_cast<Inner const*>(node);
+			if (inner->prefixLength > key.size() - depth ||
+				(inner->prefixLength && std::memcmp(prefixData(inner), bytes + depth, inner->prefixLength) != 0)) {
+				return nullptr;
+			}
+
+			depth += inner->prefixLength;
+			if (depth == key.size()) {
+				return inner->terminal;
+			}
+
+			auto child = findChild(const_cast<Inner*>(inner), bytes[depth]);
+			node = child ? *child : nullptr;
+			depth += 1;
+		}
+
+		return nullptr;
+	}
+
+	/// @return Root of the smallest subtree holding all keys starting with the given prefix, if any.
+	Node const* findPrefix(StringView prefix) const noexcept {
+		auto const bytes = reinterpret_cast<byte const*>(prefix.data());
+		Node const* node = _root;
+		size_type depth = 0;
+
+		while (node) {
+			if (node->type == NodeType::Leaf) {
+				auto leaf = static_cast<Leaf const*>(node);
+				return (leaf->keyLength >= prefix.size() &&
+						(prefix.size() == 0 || std::memcmp(leaf->keyData(), bytes, prefix.size()) == 0))
+						? node
+						: nullptr;
+			}
+
+			auto inner = static_cast<Inner const*>(node);
+			auto const matched = matchPrefix(inner, bytes + depth, prefix.size() - depth);
+			if (depth + matched == prefix.size()) {
+				return node;
+			}
+			if (matched != inner->prefixLength) {
+				return nullptr;
+			}
+
+			depth += inner->prefixLength;
+			auto child = findChild(const_cast<Inner*>(inner), bytes[depth]);
+			node = child ? *child : nullptr;
+			depth += 1;
+		}
+
+		return nullptr;
+	}
+
+	template<typename... Args>
+	Result<T&, Error>
+	insert(StringView key, Args&&... args) {
+		auto const bytes = reinterpret_cast<byte const*>(key.data());
+		Node** ref = &_root;
+		Node* predecessor = nullptr;  // Subtree which greatest entry precedes the key
+		size_type depth = 0;
+
+		if (!_root) {
+			auto maybeLeaf = newLeaf(key, fwd<Args>(args)...);
+			if (!maybeLeaf) {
+				return maybeLeaf.moveError();
+			}
+
+			_root = maybeLeaf.unwrap();
+			return link(maybeLeaf.unwrap(), predecessor);
+		}
+
+		while (true) {
+			auto node = *ref;
+			if (node->type == NodeType::Leaf) {
+				auto leaf = static_cast<Leaf*>(node);
+				if (isKeyOf(leaf, key)) {  // Replace existing value, keeping it intact if construction throws
+					leaf->value() = T(fwd<Args>(args)...);
+
+					return Result<T&, Error>{types::okTag, in_place, leaf->value()};
+				}
+
+				// Two keys in place of one: a new node for the bytes they share, branching on the first that differs
+				auto const existingKey = leaf->keyData();
+				auto const limit = ((leaf->keyLength < key.size()) ? leaf->keyLength : key.size()) - depth;
+				size_type common = 0;
+				while (common < limit && existingKey[depth + common] == bytes[depth + common]) {
+					++common;
+				}
+
+				auto const branchDepth = depth + common;
+				auto maybeSplit = split(bytes + depth, common, leaf,
+										(branchDepth < leaf->keyLength) ? existingKey[branchDepth] : -1,
+										key, branchDepth, fwd<Args>(args)...);
+				if (!maybeSplit) {
+					return maybeSplit.moveError();
+				}
+
+				*ref = maybeSplit.unwrap().node;
+				return link(maybeSplit.unwrap().leaf, maybeSplit.unwrap().isBefore ? predecessor : leaf);
+			}
+
+			auto inner = static_cast<Inner*>(node);
+			auto const matched = matchPrefix(inner, bytes + depth, key.size() - depth);
+			if (matched != inner->prefixLength) {
+				// Key diverges within the prefix: a new node for the matched part, branching on the next byte
+				auto const branchDepth = depth + matched;
+				auto const branchByte = prefixData(inner)[matched];
+				auto maybeSplit = split(bytes + depth, matched, inner, branchByte,
+										key, branchDepth, fwd<Args>(args)...);
+				if (!maybeSplit) {
+					return maybeSplit.moveError();
+				}
+
+				// Existing node keeps the part of the prefix after the branch byte
+				auto const rest = inner->prefixLength - matched - 1;
+				std::memmove(prefixData(inner), prefixData(inner) + matched + 1, rest);
+				inner->prefixLength = static_cast<uint16>(rest);
+
+				*ref = maybeSplit.unwrap().node;
+				return link(maybeSplit.unwrap().leaf, maybeSplit.unwrap().isBefore ? predecessor : inner);
+			}
+
+			depth += inner->prefixLength;
+			if (depth == key.size()) {
+				if (inner->terminal) {
+					auto& value = inner->terminal->value();
+					value = T(fwd<Args>(args)...);
+
+					return Result<T&, Error>{types::okTag, in_place, value};
+				}
+
+				auto maybeLeaf = newLeaf(key, fwd<Args>(args)...);
+				if (!maybeLeaf) {
+					return maybeLeaf.moveError();
+				}
+
+				// Terminal entry precedes all children
+				inner->terminal = maybeLeaf.unwrap();
+				return link(maybeLeaf.unwrap(), predecessor);
+			}
+
+			auto const keyByte = bytes[depth];
+			auto child = findChild(inner, keyByte);
+			if (child) {
+				if (auto before = childBefore(inner, keyByte)) {
+					predecessor = before;
+				} else if (inner->terminal) {
+					predecessor = inner->terminal;
+				}
+
+				ref = child;
+				depth += 1;
+				continue;
+			}
+
+			auto maybeLeaf = newLeaf(key, fwd<Args>(args)...);
+			if (!maybeLeaf) {
+				return maybeLeaf.moveError();
+			}
+
+			if (inner->nbChildren == innerCapacity(inner->type)) {
+				auto const grownType = static_cast<NodeType>(static_cast<uint8>(inner->type) + 1);
+				auto maybeGrown = copyNode(inner, grownType, inner->prefixLength);
+				if (!maybeGrown) {
+					destroyLeaf(maybeLeaf.unwrap());
+					return maybeGrown.moveError();
+				}
+
+				releaseNode(inner);
+				inner = maybeGrown.unwrap();
+				*ref = inner;
+			}
+
+			if (auto before = childBefore(inner, keyByte)) {
+				predecessor = before;
+			} else if (inner->terminal) {
+				predecessor = inner->terminal;
+			}
+
+			addChild(inner, keyByte, maybeLeaf.unwrap());
+			return link(maybeLeaf.unwrap(), predecessor);
+		}
+	}
+
+	struct SplitResult {
+		Inner*	node;		//!< New node to replace the existing one.
+		Leaf*	leaf;		//!< New entry.
+		bool	isBefore;	//!< True if the new entry precedes all entries of the existing subtree.
+	};
+
+	/**
+	 * Create a node with a given prefix and two entries: an existing subtree and a new leaf for the key.
+	 * @param existingByte Byte the existing subtree branches on or -1 if its key ends at the new node.
+	 */
+	template<typename... Args>
+	Result<SplitResult, Error>
+	split(byte const* prefix, size_type prefixLength, Node* existing, int existingByte,
+		  StringView key, size_type branchDepth, Args&&... args) {
+		auto maybeLeaf = newLeaf(key, fwd<Args>(args)...);
+		if (!maybeLeaf) {
+			return maybeLeaf.moveError();
+		}
+
+		auto maybeNode = newInner(NodeType::Node4, prefixLength);
+		if (!maybeNode) {
+			destroyLeaf(maybeLeaf.unwrap());
+			return maybeNode.moveError();
+		}
+
+		auto leaf = maybeLeaf.unwrap();
+		auto node = maybeNode.unwrap();
+		std::memcpy(prefixData(node), prefix, prefixLength);
+		node->prefixLength = static_cast<uint16>(prefixLength);
+
+		bool isBefore;
+		if (existingByte < 0) {  // Existing key ends here, new one is longer
+			node->terminal = static_cast<Leaf*>(existing);
+			addChild(node, reinterpret_cast<byte const*>(key.data())[branchDepth], leaf);
+			isBefore = false;
+		} else if (branchDepth == key.size()) {
+			node->terminal = leaf;
+			addChild(node, static_cast<uint8>(existingByte), existing);
+			isBefore = true;
+		} else {
+			auto const keyByte = reinterpret_cast<byte const*>(key.data())[branchDepth];
+			addChild(node, keyByte, leaf);
+			addChild(node, static_cast<uint8>(existingByte), existing);
+			isBefore = (keyByte < existingByte);
+		}
+
+		return Result<SplitResult, Error>{types::okTag, in_place, SplitResult{node, leaf, isBefore}};
+	}
+
+	/// Insert a new leaf into the list of leaves after the greatest entry of a given subtree.
+	Result<T&, Error> link(Leaf* leaf, Node* predecessor) noexcept {
+		auto prev = predecessor ? maxLeaf(predecessor) : nullptr;
+		leaf->prev = prev;
+		leaf->next = prev ? prev->next : _first;
+		(leaf->next ? leaf->next->prev : _last) = leaf;
+		(prev ? prev->next : _first) = leaf;
+		_size += 1;
+
+		return Result<T&, Error>{types::okTag, in_place, leaf->value()};
+	}
+
+	/**
+	 * Restore the shape of a node after an entry was removed from it: replace a node with a single entry by
+	 * that entry, merge a node with a single child into the child and shrink a node to a smaller type.
+	 * Allocation failures are ignored, leaving a valid but less compact tree.
+	 */
+	void compact(Node** ref) noexcept {
+		auto inner = static_cast<Inner*>(*ref);
+		if (inner->nbChildren == 0) {
+			*ref = inner->terminal;
+			releaseNode(inner);
+			return;
+		}
+
+		if (inner->nbChildren == 1 && !inner->terminal) {
+			uint8 childByte = 0;
+			Node* child = nullptr;
+			forEachChild(inner, [&](uint8 b, Node* c) {
+				childByte = b;
+				child = c;
+			});
+
+			if (child->type == NodeType::Leaf) {
+				*ref = child;
+				releaseNode(inner);
+				return;
+			}
+
+			// Child takes over the prefix of the node and the byte it branched on
+			auto childInner = static_cast<Inner*>(child);
+			auto const nbShifted = inner->prefixLength + 1;
+			auto const newLength = childInner->prefixLength + nbShifted;
+			if (newLength > childInner->prefixCapacity) {
+				auto maybeCopy = copyNode(childInner, childInner->type, newLength);
+				if (!maybeCopy) {
+					return;
+				}
+
+				releaseNode(childInner);
+				childInner = maybeCopy.unwrap();
+			}
+
+			std::memmove(prefixData(childInner) + nbShifted, prefixData(childInner), childInner->prefixLength);
+			std::memcpy(prefixData(childInner), prefixData(inner), inner->prefixLength);
+			prefixData(childInner)[inner->prefixLength] = childByte;
+			childInner->prefixLength = static_cast<uint16>(newLength);
+
+			*ref = childInner;
+			releaseNode(inner);
+			return;
+		}
+
+		// Shrink with some slack to avoid flapping between types on alternating insert and erase
+		auto const type = inner->type;
+		auto const shouldShrink = (type == NodeType::Node16 && inner->nbChildren <= 3) ||
+				(type == NodeType::Node48 && inner->nbChildren <= 12) ||
+				(type == NodeType::Node256 && inner->nbChildren <= 40);
+		if (shouldShrink) {
+			auto const smallerType = static_cast<NodeType>(static_cast<uint8>(type) - 1);
+			auto maybeCopy = copyNode(inner, smallerType, inner->prefixLength);
+			if (maybeCopy) {
+				*ref = maybeCopy.unwrap();
+				releaseNode(inner);
+			}
+		}
+	}
+
+	static Leaf* minLeaf(Node const* node) noexcept {
+		while (node->type != NodeType::Leaf) {
+			auto inner = static_cast<Inner const*>(node);
+			if (inner->terminal) {
+				return inner->terminal;
+			}
+
+			node = edgeChild<true>(inner);
+		}
+
+		return const_cast<Leaf*>(static_cast<Leaf const*>(node));
+	}
+
+	static Leaf* maxLeaf(Node const* node) noexcept {
+		while (node->type != NodeType::Leaf) {
+			auto inner = static_cast<Inner const*>(node);
+			if (inner->nbChildren == 0) {
+				return inner->terminal;
+			}
+
+			node = edgeChild<false>(inner);
+		}
+
+		return const_cast<Leaf*>(static_cast<Leaf const*>(node));
+	}
+
+protected:  // Child access by node type
+
+	/// @return Number of sorted keys of a Node4 or a Node16 less than the given byte.
+	template<typename N>
+	static size_type countKeysBelow(N const* node, uint8 keyByte) noexcept {
+#if defined(__SSE2__)
+		if constexpr (sizeof(node->keys) == 16) {
+			// Signed compare only: bias unsigned bytes into the signed range
+			auto const bias = _mm_set1_epi8(static_cast<char>(0x80));
+			auto const keys = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(node->keys)), bias);
+			auto const needle = _mm_xor_si128(_mm_set1_epi8(static_cast<char>(keyByte)), bias);
+			auto const mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmplt_epi8(keys, needle))) &
+					((1U << node->nbChildren) - 1);
+
+			return static_cast<size_type>(__builtin_popcount(mask));
+		}
+#endif
+		size_type count = 0;
+		for (size_type i = 0; i < node->nbChildren; ++i) {
+			count += static_cast<size_type>(node->keys[i] < keyByte);
+		}
+
+		return count;
+	}
+
+	/// @return Index of the given key byte in a Node4 or a Node16 or its number of children if there is none.
+	template<typename N>
+	static size_type indexOfKey(N const* node, uint8 keyByte) noexcept {
+#if defined(__SSE2__)
+		if constexpr (sizeof(node->keys) == 16) {
+			auto const keys = _mm_loadu_si128(reinterpret_cast<__m128i const*>(node->keys));
+			auto const mask = static_cast<unsigned>(
+						_mm_movemask_epi8(_mm_cmpeq_epi8(keys, _mm_set1_epi8(static_cast<char>(keyByte))))) &
+					((1U << node->nbChildren) - 1);
+
+			return mask ? static_cast<size_type>(__builtin_ctz(mask)) : node->nbChildren;
+		}
+#endif
+		size_type i = 0;
+		while (i < node->nbChildren && node->keys[i] != keyByte) {
+			++i;
+		}
+
+		return i;
+	}
+
+	/// @return Slot holding the child for the given key byte or nullptr if there is none.
+	static Node** findChild(Inner* inner, uint8 keyByte) noexcept {
+		switch (inner->type) {
+		case NodeType::Node4: {
+			auto node = static_cast<Node4*>(inner);
+			auto const i = indexOfKey(node, keyByte);
+			return (i < node->nbChildren) ? &node->children[i] : nullptr;
+		}
+		case NodeType::Node16: {
+			auto node = static_cast<Node16*>(inner);
+			auto const i = indexOfKey(node, keyByte);
+			return (i < node->nbChildren) ? &node->children[i] : nullptr;
+		}
+		case NodeType::Node48: {
+			auto node = static_cast<Node48*>(inner);
+			auto const slot = node->index[keyByte];
+			return slot ? &node->children[slot - 1] : nullptr;
+		}
+		case NodeType::Leaf:
+			break;
+		case NodeType::Node256: {
+			auto node = static_cast<Node256*>(inner);
+			return node->children[keyByte] ? &node->children[keyByte] : nullptr;
+		}
+		}
+
+		return nullptr;
+	}
+
+	/// @return Child with the greatest key byte less than the given one or nullptr if there is none.
+	static Node* childBefore(Inner const* inner, uint8 keyByte) noexcept {
+		switch (inner->type) {
+		case NodeType::Node4: {
+			auto node = static_cast<Node4 const*>(inner);
+			auto const n = countKeysBelow(node, keyByte);
+			return n ? node->children[n - 1] : nullptr;
+		}
+		case NodeType::Node16: {
+			auto node = static_cast<Node16 const*>(inner);
+			auto const n = countKeysBelow(node, keyByte);
+			return n ? node->children[n - 1] : nullptr;
+		}
+		case NodeType::Node48: {
+			auto node = static_cast<Node48 const*>(inner);
+			for (auto b = static_cast<int>(keyByte) - 1; b >= 0; --b) {
+				if (node->index[b]) {
+					return node->children[node->index[b] - 1];
+				}
+			}
+			return nullptr;
+		}
+		case NodeType::Leaf:
+			break;
+		case NodeType::Node256: {
+			auto node = static_cast<Node256 const*>(inner);
+			for (auto b = static_cast<int>(keyByte) - 1; b >= 0; --b) {
+				if (node->children[b]) {
+					return node->children[b];
+				}
+			}
+			return nullptr;
+		}
+		}
+
+		return nullptr;
+	}
+
+	/// @return First (or last) child in key order. Node must have children.
+	template<bool First>
+	static Node const* edgeChild(Inner const* inner) noexcept {
+		switch (inner->type) {
+		case NodeType::Node4:
+			return static_cast<Node4 const*>(inner)->children[First ? 0 : inner->nbChildren - 1];
+		case NodeType::Node16:
+			return static_cast<Node16 const*>(inner)->children[First ? 0 : inner->nbChildren - 1];
+		case NodeType::Node48: {
+			auto node = static_cast<Node48 const*>(inner);
+			for (int i = 0; i < 256; ++i) {
+				auto const slot = node->index[First ? i : 255 - i];
+				if (slot) {
+					return node->children[slot - 1];
+				}
+			}
+			return nullptr;
+		}
+		case NodeType::Leaf:
+			break;
+		case NodeType::Node256: {
+			auto node = static_cast<Node256 const*>(inner);
+			for (int i = 0; i < 256; ++i) {
+				auto const child = node->children[First ? i : 255 - i];
+				if (child) {
+					return child;
+				}
+			}
+			return nullptr;
+		}
+		}
+
+		return nullptr;
+	}
+
+	/// Call a visitor with each key byte and child, in key order.
+	template<typename F>
+	static void forEachChild(Inner const* inner, F&& visitor) {
+		switch (inner->type) {
+		case NodeType::Node4: {
+			auto node = static_cast<Node4 const*>(inner);
+			for (size_type i = 0; i < node->nbChildren; ++i) {
+				visitor(node->keys[i], node->children[i]);
+			}
+		} break;
+		case NodeType::Node16: {
+			auto node = static_cast<Node16 const*>(inner);
+			for (size_type i = 0; i < node->nbChildren; ++i) {
+				visitor(node->keys[i], node->children[i]);
+			}
+		} break;
+		case NodeType::Node48: {
+			auto node = static_cast<Node48 const*>(inner);
+			for (int b = 0; b < 256; ++b) {
+				if (node->index[b]) {
+					visitor(static_cast<uint8>(b), node->children[node->index[b] - 1]);
+				}
+			}
+		} break;
+		case NodeType::Leaf:
+			break;
+		case NodeType::Node256: {
+			auto node = static_cast<Node256 const*>(inner);
+			for (int b = 0; b < 256; ++b) {
+				if (node->children[b]) {
+					visitor(static_cast<uint8>(b), node->children[b]);
+				}
+			}
+		} break;
+		}
+	}
+
+	template<typename N>
+	static void insertSorted(N* node, uint8 keyByte, Node* child) noexcept {
+		auto const pos = countKeysBelow(node, keyByte);
+		for (auto i = static_cast<size_type>(node->nbChildren); i > pos; --i) {
+			node->keys[i] = node->keys[i - 1];
+			node->children[i] = node->children[i - 1];
+		}
+
+		node->keys[pos] = keyByte;
+		node->children[pos] = child;
+	}
+
+	template<typename N>
+	static void removeSorted(N* node, uint8 keyByte) noexcept {
+		for (auto i = indexOfKey(node, keyByte); i + 1 < node->nbChildren; ++i) {
+			node->keys[i] = node->keys[i + 1];
+			node->children[i] = node->children[i + 1];
+		}
+	}
+
+	/// Add a child for a key byte not yet in the node. Node must not be full.
+	static void addChild(Inner* inner, uint8 keyByte, Node* child) noexcept {
+		switch (inner->type) {
+		case NodeType::Node4:
+			insertSorted(static_cast<Node4*>(inner), keyByte, child);
+			break;
+		case NodeType::Node16:
+			insertSorted(static_cast<Node16*>(inner), keyByte, child);
+			break;
+		case NodeType::Node48: {
+			auto node = static_cast<Node48*>(inner);
+			uint8 slot = 0;
+			while (node->children[slot]) {
+				++slot;
+			}
+			node->children[slot] = child;
+			node->index[keyByte] = static_cast<uint8>(slot + 1);
+		} break;
+		case NodeType::Leaf:
+			break;
+		case NodeType::Node256:
+			static_cast<Node256*>(inner)->children[keyByte] = child;
+			break;
+		}
+
+		inner->nbChildren += 1;
+	}
+
+	static void removeChild(Inner* inner, uint8 keyByte) noexcept {
+		switch (inner->type) {
+		case NodeType::Node4:
+			removeSorted(static_cast<Node4*>(inner), keyByte);
+			break;
+		case NodeType::Node16:
+			removeSorted(static_cast<Node16*>(inner), keyByte);
+			break;
+		case NodeType::Node48: {
+			auto node = static_cast<Node48*>(inner);
+			node->children[node->index[keyByte] - 1] = nullptr;
+			node->index[keyByte] = 0;
+		} break;
+		case NodeType::Leaf:
+			break;
+		case NodeType::Node256:
+			static_cast<Node256*>(inner)->children[keyByte] = nullptr;
+			break;
+		}
+
+		inner->nbChildren -= 1;
+	}
+
+protected:  // Node allocation
+
+	Result<Inner*, Error>
+	newInner(NodeType type, size_type prefixCapacity) {
+		auto maybeMemory = _arena.allocate(innerSize(type) + prefixCapacity);
+		if (!maybeMemory) {
+			return maybeMemory.moveError();
+		}
+
+		auto memory = maybeMemory.unwrap();
+		std::memset(memory, 0, innerSize(type));
+
+		Inner* inner;
+		switch (type) {
+		case NodeType::Node4:	inner = new (_::PlacementNew(), memory) Node4; break;
+		case NodeType::Node16:	inner = new (_::PlacementNew(), memory) Node16; break;
+		case NodeType::Node48:	inner = new (_::PlacementNew(), memory) Node48; break;
+		case NodeType::Leaf:	// Not an inner node
+		case NodeType::Node256:	inner = new (_::PlacementNew(), memory) Node256; break;
+		}
+
+		inner->type = type;
+		inner->prefixCapacity = static_cast<uint16>(prefixCapacity);
+
+		return Result<Inner*, Error>{types::okTag, in_place, inner};
+	}
+
+	/// Copy a node into a new one of a given type, with room for a prefix of a given length.
+	Result<Inner*, Error>
+	copyNode(Inner const* inner, NodeType type, size_type prefixCapacity) {
+		auto maybeNode = newInner(type, prefixCapacity);
+		if (!maybeNode) {
+			return maybeNode;
+		}
+
+		auto node = maybeNode.unwrap();
+		node->terminal = inner->terminal;
+		node->prefixLength = inner->prefixLength;
+		std::memcpy(prefixData(node), prefixData(inner), inner->prefixLength);
+		forEachChild(inner, [node](uint8 keyByte, Node* child) {
+			addChild(node, keyByte, child);
+		});
+
+		return maybeNode;
+	}
+
+	void releaseNode(Inner* inner) noexcept {
+		_arena.release(inner, innerSize(inner->type) + inner->prefixCapacity);
+	}
+
+	template<typename... Args>
+	Result<Leaf*, Error>
+	newLeaf(StringView key, Args&&... args) {
+		auto maybeMemory = _arena.allocate(sizeof(Leaf) + key.size());
+		if (!maybeMemory) {
+			return maybeMemory.moveError();
+		}
+
+		auto leaf = new (_::PlacementNew(), maybeMemory.unwrap()) Leaf;
+		leaf->type = NodeType::Leaf;
+		leaf->keyLength = key.size();
+		leaf->prev = nullptr;
+		leaf->next = nullptr;
+		if (key.size()) {
+			std::memcpy(leaf->keyData(), key.data(), key.size());
+		}
+		ctor(leaf->value(), fwd<Args>(args)...);
+
+		return Result<Leaf*, Error>{types::okTag, in_place, leaf};
+	}
+
+	/// Unlink a leaf from the list of entries and release it.
+	void destroyLeaf(Leaf* leaf) noexcept {
+		if (leaf->next || leaf->prev || _first == leaf) {
+			(leaf->prev ? leaf->prev->next : _first) = leaf->next;
+			(leaf->next ? leaf->next->prev : _last) = leaf->prev;
+			_size -= 1;
+		}
+
+		dtor(leaf->value());
+		_arena.release(leaf, sizeof(Leaf) + leaf->keyLength);
+	}
+
+private:
+	details::SizeClassArena		_arena;
+	Node*						_root{nullptr};
+	Leaf*						_first{nullptr};	//!< Entry with the smallest key.
+	Leaf*						_last{nullptr};		//!< Entry with the greatest key.
+	size_type					_size{0};
+};
+
+}  // End of namespace Solace
+#endif  // SOLACE_RADIXTREE_HPP
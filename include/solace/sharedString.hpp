@@ -0,0 +1,213 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Shared immutable string
+ *	@file		solace/sharedString.hpp
+ *	@brief		Reference counted immutable string with constant time copies.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_SHAREDSTRING_HPP
+#define SOLACE_SHAREDSTRING_HPP
+
+#include "solace/string.hpp"
+
+#include <atomic>
+
+
+namespace Solace {
+
+namespace details {
+
+/// Header of a shared string buffer: reference count and the memory of the buffer itself, followed by the data.
+struct SharedStringBlock {
+	std::atomic<uint32>	refCount{1};
+	MemoryResource		memory;
+
+	explicit SharedStringBlock(MemoryResource&& mem) noexcept
+		: memory{mv(mem)}
+	{}
+};
+
+}  // namespace details
+
+
+/**
+ * Immutable string sharing its buffer between copies.
+ *
+ * Copies and substrings refer to the same buffer, kept alive by an atomic reference count, so copying takes
+ * constant time and never allocates. Content is allocated once, together with the reference count, when a
+ * shared string is made from a view or a String. Shared strings made from literals do not allocate at all.
+ *
+ * Content is never modified, so copies can be passed between threads freely.
+ */
+class SharedString {
+public:
+	using size_type = StringView::size_type;
+	using value_type = StringView::value_type;
+
+public:
+
+	~SharedString() {
+		release();
+	}
+
+	/// Construct an empty string.
+	constexpr SharedString() noexcept = default;
+
+	SharedString(SharedString const& rhs) noexcept
+		: _block{rhs._block}
+		, _data{rhs._data}
+		, _size{rhs._size}
+	{
+		retain();
+	}
+
+	SharedString(SharedString&& rhs) noexcept
+		: _block{exchange(rhs._block, nullptr)}
+		, _data{exchange(rhs._data, nullptr)}
+		, _size{exchange(rhs._size, size_type{0})}
+	{}
+
+	SharedString& operator= (SharedString const& rhs) noexcept {
+		SharedString copy{rhs};
+
+		return swap(copy);
+	}
+
+	SharedString& operator= (SharedString&& rhs) noexcept {
+		return swap(rhs);
+	}
+
+	SharedString& swap(SharedString& rhs) noexcept {
+		using std::swap;
+		swap(_block, rhs._block);
+		swap(_data, rhs._data);
+		swap(_size, rhs._size);
+
+		return *this;
+	}
+
+	constexpr bool empty() const noexcept { return (_size == 0); }
+	constexpr size_type size() const noexcept { return _size; }
+	constexpr size_type length() const noexcept { return _size; }
+
+	StringView view() const noexcept { return StringView{_data, _size}; }
+
+	bool equals(StringView other) const noexcept { return view().equals(other); }
+	int compareTo(StringView other) const noexcept { return view().compareTo(other); }
+	uint64 hashCode() const noexcept { return view().hashCode(); }
+
+	bool startsWith(StringView prefix) const noexcept { return view().startsWith(prefix); }
+	bool endsWith(StringView suffix) const noexcept { return view().endsWith(suffix); }
+
+	/**
+	 * Substring sharing the buffer of this string: the buffer stays alive as long as the substring does.
+	 * @param from Index of the first character of the substring, clamped to the size of this string.
+	 * @param len Length of the substring, clamped to the end of this string.
+	 */
+	SharedString substring(size_type from, size_type len) const noexcept;
+
+	/// Substring from a given index till the end, sharing the buffer of this string.
+	SharedString substring(size_type from) const noexcept {
+		return substring(from, _size);
+	}
+
+	/// @return Number of shared strings referring to the same buffer, 0 if the string owns no buffer.
+	uint32 useCount() const noexcept {
+		return _block ? _block->refCount.load(std::memory_order_relaxed) : 0;
+	}
+
+protected:
+
+	friend Result<SharedString, Error> makeSharedString(MemoryManager& memoryManager, StringView view);
+	friend SharedString makeSharedString(StringLiteral literal) noexcept;
+
+	constexpr SharedString(details::SharedStringBlock* block, char const* data, size_type size) noexcept
+		: _block{block}
+		, _data{data}
+		, _size{size}
+	{}
+
+	void retain() noexcept {
+		if (_block) {
+			_block->refCount.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	void release() noexcept;
+
+private:
+	details::SharedStringBlock*	_block{nullptr};
+	char const*					_data{nullptr};
+	size_type					_size{0};
+};
+
+
+inline void swap(SharedString& lhs, SharedString& rhs) noexcept {
+	lhs.swap(rhs);
+}
+
+inline bool operator== (SharedString const& lhs, SharedString const& rhs) noexcept { return lhs.equals(rhs.view()); }
+inline bool operator!= (SharedString const& lhs, SharedString const& rhs) noexcept { return !lhs.equals(rhs.view()); }
+inline bool operator== (SharedString const& lhs, StringView rhs) noexcept { return lhs.equals(rhs); }
+inline bool operator!= (SharedString const& lhs, StringView rhs) noexcept { return !lhs.equals(rhs); }
+inline bool operator== (StringView lhs, SharedString const& rhs) noexcept { return rhs.equals(lhs); }
+inline bool operator!= (StringView lhs, SharedString const& rhs) noexcept { return !rhs.equals(lhs); }
+inline bool operator== (SharedString const& lhs, char const* rhs) noexcept { return lhs.equals(rhs); }
+inline bool operator!= (SharedString const& lhs, char const* rhs) noexcept { return !lhs.equals(rhs); }
+
+
+/**
+ * Make a shared string from a string literal. Literal is referred to, not copied.
+ */
+[[nodiscard]]
+SharedString makeSharedString(StringLiteral literal) noexcept;
+
+/**
+ * Make a shared string with a copy of given content.
+ * @param memoryManager Memory manager to allocate the buffer from.
+ * @param view Content of the string.
+ * @return A new string or an error if memory could not be allocated.
+ */
+[[nodiscard]]
+Result<SharedString, Error> makeSharedString(MemoryManager& memoryManager, StringView view);
+
+/// Make a shared string with a copy of given content, allocated from the system heap.
+[[nodiscard]]
+inline Result<SharedString, Error> makeSharedString(StringView view) {
+	return makeSharedString(getSystemHeapMemoryManager(), view);
+}
+
+/// Make a shared string with a copy of a null-terminated string.
+[[nodiscard]]
+inline Result<SharedString, Error> makeSharedString(char const* str) {
+	return makeSharedString(StringView{str});
+}
+
+/// Make a shared string with a copy of content of a String.
+[[nodiscard]]
+inline Result<SharedString, Error> makeSharedString(String const& str) {
+	return makeSharedString(str.view());
+}
+
+/// Make a String with a copy of content of a shared string.
+[[nodiscard]]
+inline Result<String, Error> makeString(SharedString const& str) {
+	return makeString(str.view());
+}
+
+}  // End of namespace Solace
+#endif  // SOLACE_SHAREDSTRING_HPP
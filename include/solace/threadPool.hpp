@@ -0,0 +1,483 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Work-stealing thread pool
+ *	@file		solace/threadPool.hpp
+ *	@brief		Fixed-size pool of worker threads with per-worker work-stealing deques.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_THREADPOOL_HPP
+#define SOLACE_THREADPOOL_HPP
+
+#include "solace/types.hpp"
+#include "solace/utils.hpp"
+#include "solace/error.hpp"
+#include "solace/result.hpp"
+#include "solace/memoryManager.hpp"
+
+#include <atomic>
+#include <type_traits>
+
+
+namespace Solace {
+
+/**
+ * Configuration of a thread pool.
+ * All capacities must be powers of 2.
+ */
+struct ThreadPoolConfig {
+	/// Number of worker threads. 0 means one worker per online CPU as reported by sysconf.
+	uint32	nbWorkers{0};
+	/// Capacity of each worker's local task deque.
+	uint32	dequeCapacity{1024};
+	/// Capacity of the global queue used for tasks submitted from outside of the pool.
+	uint32	injectionQueueCapacity{1024};
+	/// Number of preallocated task frames. Limits the number of tasks in flight.
+	uint32	nbTaskFrames{4096};
+	/// Pin worker threads to CPUs available to the process in a round-robin order.
+	bool	pinWorkers{false};
+};
+
+
+class ThreadPool;
+
+
+namespace details {
+
+struct ThreadPoolState;
+
+/**
+ * Preallocated storage for a single task.
+ * Callable is constructed in the frame storage and replaced by its result once invoked.
+ */
+struct TaskFrame {
+	static constexpr uint32 kStorageSize = 96;
+
+	enum State : uint32 {
+		Pending = 0,
+		Done = 1
+	};
+
+	using RunFunction = void (*)(TaskFrame* frame) noexcept;
+	using DestroyFunction = void (*)(TaskFrame* frame) noexcept;
+
+	RunFunction				run{nullptr};
+	DestroyFunction			destroyResult{nullptr};
+	std::atomic<uint32>		state{Pending};
+	std::atomic<uint32>		nextFree{0};
+	bool					detached{false};
+
+	alignas(std::max_align_t) byte storage[kStorageSize];
+};
+
+
+template<typename R>
+struct TaskResult {
+	using type = Result<R, Error>;
+};
+
+template<typename V>
+struct TaskResult<Result<V, Error>> {
+	using type = Result<V, Error>;
+};
+
+
+template<typename F>
+typename TaskResult<std::invoke_result_t<F&>>::type
+invokeTask(F& f) {
+	using R = std::invoke_result_t<F&>;
+
+	if constexpr (std::is_void_v<R>) {
+		f();
+		return Result<void, Error>{types::okTag};
+	} else if constexpr (isSomeResult<R>::value) {
+		return f();
+	} else {
+		return Result<R, Error>{types::okTag, f()};
+	}
+}
+
+
+template<typename F, typename R>
+void runTask(TaskFrame* frame) noexcept {
+	auto* const f = reinterpret_cast<F*>(frame->storage);
+	R result = invokeTask(*f);
+	dtor(*f);
+	new (frame->storage) R{mv(result)};
+}
+
+template<typename F>
+void runDetachedTask(TaskFrame* frame) noexcept {
+	auto* const f = reinterpret_cast<F*>(frame->storage);
+	(*f)();
+	dtor(*f);
+}
+
+template<typename R>
+void destroyTaskResult(TaskFrame* frame) noexcept {
+	dtor(*reinterpret_cast<R*>(frame->storage));
+}
+
+/// Block until the given task has completed, executing other pending tasks of the pool meanwhile.
+void waitForTask(ThreadPoolState* pool, TaskFrame const* frame) noexcept;
+
+/// Return a frame of a completed task back into the pool.
+void releaseTaskFrame(ThreadPoolState* pool, TaskFrame* frame) noexcept;
+
+}  // namespace details
+
+
+/**
+ * Handle to a result of a task submitted into a thread pool.
+ * Handle is move-only and waits for the task to complete when destroyed.
+ * Handle refers to the state of the pool, so it stays valid when the ThreadPool object is moved,
+ * but it must not outlive the pool itself.
+ */
+template<typename T>
+class TaskHandle {
+public:
+	using value_type = T;
+	using result_type = Result<T, Error>;
+
+public:
+	~TaskHandle() {
+		reset();
+	}
+
+	TaskHandle(TaskHandle const&) = delete;
+	TaskHandle& operator= (TaskHandle const&) = delete;
+
+	constexpr TaskHandle() noexcept = default;
+
+	TaskHandle(TaskHandle&& rhs) noexcept
+		: _pool{exchange(rhs._pool, nullptr)}
+		, _frame{exchange(rhs._frame, nullptr)}
+	{}
+
+	TaskHandle& operator= (TaskHandle&& rhs) noexcept {
+		return swap(rhs);
+	}
+
+	TaskHandle& swap(TaskHandle& rhs) noexcept {
+		using std::swap;
+		swap(_pool, rhs._pool);
+		swap(_frame, rhs._frame);
+
+		return *this;
+	}
+
+	/// @return True if this handle refers to a task which result has not been taken yet.
+	constexpr bool valid() const noexcept { return (_frame != nullptr); }
+
+	/// @return True if the task has completed and get() will not block.
+	bool isReady() const noexcept {
+		return _frame && (_frame->state.load(std::memory_order_acquire) == details::TaskFrame::Done);
+	}
+
+	/// Block until the task has completed, executing other pending tasks meanwhile.
+	void wait() noexcept;
+
+	/**
+	 * Wait for the task to complete and take its result.
+	 * Handle is no longer valid after the call.
+	 */
+	result_type get();
+
+protected:
+	friend class ThreadPool;
+
+	TaskHandle(details::ThreadPoolState* pool, details::TaskFrame* frame) noexcept
+		: _pool{pool}
+		, _frame{frame}
+	{}
+
+	void reset() noexcept;
+
+private:
+	details::ThreadPoolState*	_pool{nullptr};
+	details::TaskFrame*			_frame{nullptr};
+};
+
+
+/**
+ * Work-stealing thread pool.
+ *
+ * Each worker owns a Chase-Lev deque: tasks submitted by a worker are pushed to its own deque,
+ * while tasks submitted from outside of the pool go into a global injection queue.
+ * Idle workers steal from other workers' deques.
+ * All memory, including task frames, is allocated once when the pool is created,
+ * so submitting a task does not allocate.
+ *
+ * @note Tasks must not throw. Callables and their results must fit into a task frame.
+ * @note Pool must not be destroyed by one of its own workers.
+ */
+class ThreadPool {
+public:
+	using size_type = uint32;
+
+public:
+	~ThreadPool();
+
+	ThreadPool(ThreadPool const&) = delete;
+	ThreadPool& operator= (ThreadPool const&) = delete;
+
+	ThreadPool(ThreadPool&& rhs) noexcept
+		: _memory{mv(rhs._memory)}
+		, _state{exchange(rhs._state, nullptr)}
+	{}
+
+	ThreadPool& operator= (ThreadPool&& rhs) noexcept {
+		return swap(rhs);
+	}
+
+	ThreadPool& swap(ThreadPool& rhs) noexcept {
+		using std::swap;
+		_memory.swap(rhs._memory);
+		swap(_state, rhs._state);
+
+		return *this;
+	}
+
+	/// @return Number of worker threads in the pool.
+	size_type size() const noexcept;
+
+	/**
+	 * Run a task without waiting for its result.
+	 * @param f A callable to execute.
+	 * @return Error if no task frame is available.
+	 */
+	template<typename F>
+	Result<void, Error> execute(F&& f) {
+		using Task = std::decay_t<F>;
+		static_assert(sizeof(Task) <= details::TaskFrame::kStorageSize,
+					  "Task callable is too large to fit into a task frame");
+		static_assert(alignof(Task) <= alignof(std::max_align_t), "Task callable is over-aligned");
+
+		auto maybeFrame = allocateFrame(true);
+		if (!maybeFrame) {
+			return maybeFrame.moveError();
+		}
+
+		auto frame = *maybeFrame;
+		new (frame->storage) Task{fwd<F>(f)};
+		frame->run = &details::runDetachedTask<Task>;
+		frame->destroyResult = nullptr;
+
+		schedule(frame);
+
+		return Ok();
+	}
+
+	/**
+	 * Submit a task which result can be retrieved using returned handle.
+	 * Task callable may return Result<T, Error>, a plain value or void.
+	 * @param f A callable to execute.
+	 * @return Handle to the result of the task or an error if no task frame is available.
+	 */
+	template<typename F,
+			 typename R = typename details::TaskResult<std::invoke_result_t<std::decay_t<F>&>>::type>
+	Result<TaskHandle<typename R::value_type>, Error>
+	submit(F&& f) {
+		using Task = std::decay_t<F>;
+		static_assert(sizeof(Task) <= details::TaskFrame::kStorageSize,
+					  "Task callable is too large to fit into a task frame");
+		static_assert(alignof(Task) <= alignof(std::max_align_t), "Task callable is over-aligned");
+		static_assert(sizeof(R) <= details::TaskFrame::kStorageSize,
+					  "Task result is too large to fit into a task frame");
+		static_assert(alignof(R) <= alignof(std::max_align_t), "Task result is over-aligned");
+
+		auto maybeFrame = allocateFrame(false);
+		if (!maybeFrame) {
+			return maybeFrame.moveError();
+		}
+
+		auto frame = *maybeFrame;
+		new (frame->storage) Task{fwd<F>(f)};
+		frame->run = &details::runTask<Task, R>;
+		frame->destroyResult = &details::destroyTaskResult<R>;
+
+		schedule(frame);
+
+		return Ok(TaskHandle<typename R::value_type>{_state, frame});
+	}
+
+	/**
+	 * Fork/join loop over index range [from, to).
+	 * The range is split into chunks of at most `grain` indices, each processed by a call body(chunkFrom, chunkTo).
+	 * Calling thread participates in the loop and the call returns once all chunks are processed.
+	 * If body returns Result<void, Error> the first error stops processing of the remaining chunks and is returned.
+	 *
+	 * @param from First index of the range.
+	 * @param to Index one past the last index of the range.
+	 * @param grain Maximum number of indices processed by a single call of the body.
+	 * @param body A callable to process a chunk of the range.
+	 */
+	template<typename F>
+	Result<void, Error> parallelFor(uint64 from, uint64 to, uint64 grain, F&& body);
+
+	/**
+	 * Execute one pending task on the calling thread, if any.
+	 * @return True if a task has been executed.
+	 */
+	bool tryRunPendingTask() noexcept;
+
+	/// Block until the given task has completed, executing other pending tasks meanwhile.
+	void waitFor(details::TaskFrame const* frame) noexcept;
+
+	/// Return a frame of a completed task back into the pool.
+	void releaseFrame(details::TaskFrame* frame) noexcept;
+
+protected:
+	friend Result<ThreadPool, Error> makeThreadPool(MemoryManager& memoryManager, ThreadPoolConfig const& config);
+
+	ThreadPool(MemoryResource&& memory, details::ThreadPoolState* state) noexcept
+		: _memory{mv(memory)}
+		, _state{state}
+	{}
+
+	Result<details::TaskFrame*, Error> allocateFrame(bool detached) noexcept;
+	void schedule(details::TaskFrame* frame) noexcept;
+
+	void waitForHelpers(std::atomic<uint32> const& nbActive) noexcept;
+
+private:
+	MemoryResource				_memory;
+	details::ThreadPoolState*	_state{nullptr};
+};
+
+
+/**
+ * Create a new thread pool.
+ * @param memoryManager Memory manager to allocate all of the pool memory from.
+ * @param config Pool configuration.
+ * @return A thread pool with all of its workers started or an error.
+ */
+Result<ThreadPool, Error>
+makeThreadPool(MemoryManager& memoryManager, ThreadPoolConfig const& config = {});
+
+
+template<typename T>
+void
+TaskHandle<T>::wait() noexcept {
+	if (_frame) {
+		details::waitForTask(_pool, _frame);
+	}
+}
+
+
+template<typename T>
+typename TaskHandle<T>::result_type
+TaskHandle<T>::get() {
+	assertTrue(valid(), "TaskHandle::get");
+	wait();
+
+	auto* const stored = reinterpret_cast<result_type*>(_frame->storage);
+	result_type result{mv(*stored)};
+	dtor(*stored);
+
+	details::releaseTaskFrame(_pool, exchange(_frame, nullptr));
+	_pool = nullptr;
+
+	return result;
+}
+
+
+template<typename T>
+void
+TaskHandle<T>::reset() noexcept {
+	if (!_frame) {
+		return;
+	}
+
+	wait();
+	_frame->destroyResult(_frame);
+	details::releaseTaskFrame(_pool, exchange(_frame, nullptr));
+	_pool = nullptr;
+}
+
+
+template<typename F>
+Result<void, Error>
+ThreadPool::parallelFor(uint64 from, uint64 to, uint64 grain, F&& body) {
+	if (from >= to) {
+		return Ok();
+	}
+
+	struct Loop {
+		uint64					from;
+		uint64					to;
+		uint64					grain;
+		uint64					nbChunks;
+		std::atomic<uint64>		nextChunk{0};
+		std::atomic<uint32>		nbActiveHelpers{0};
+		std::atomic<bool>		failed{false};
+		Optional<Error>			error;
+
+		void run(F& fn) {
+			while (!failed.load(std::memory_order_relaxed)) {
+				auto const chunk = nextChunk.fetch_add(1, std::memory_order_relaxed);
+				if (chunk >= nbChunks) {
+					return;
+				}
+
+				auto const chunkFrom = from + chunk * grain;
+				auto const chunkTo = (to - chunkFrom > grain) ? chunkFrom + grain : to;
+				if constexpr (std::is_void_v<std::invoke_result_t<F&, uint64, uint64>>) {
+					fn(chunkFrom, chunkTo);
+				} else {
+					auto result = fn(chunkFrom, chunkTo);
+					if (!result && !failed.exchange(true, std::memory_order_relaxed)) {
+						error = result.moveError();
+					}
+				}
+			}
+		}
+	};
+
+	grain = (grain == 0) ? 1 : grain;
+
+	Loop loop;
+	loop.from = from;
+	loop.to = to;
+	loop.grain = grain;
+	loop.nbChunks = (to - from) / grain + (((to - from) % grain) ? 1 : 0);
+
+	uint64 const nbHelpers = (loop.nbChunks - 1 < size()) ? loop.nbChunks - 1 : size();
+	for (uint64 i = 0; i < nbHelpers; ++i) {
+		loop.nbActiveHelpers.fetch_add(1, std::memory_order_relaxed);
+		auto helper = execute([&loop, &body]() {
+			loop.run(body);
+			loop.nbActiveHelpers.fetch_sub(1, std::memory_order_release);
+		});
+
+		if (!helper) {  // Out of frames: remaining chunks are processed by the calling thread
+			loop.nbActiveHelpers.fetch_sub(1, std::memory_order_relaxed);
+			break;
+		}
+	}
+
+	loop.run(body);
+	waitForHelpers(loop.nbActiveHelpers);
+
+	if (loop.error) {
+		return loop.error.move();
+	}
+
+	return Ok();
+}
+
+}  // End of namespace Solace
+#endif  // SOLACE_THREADPOOL_HPP
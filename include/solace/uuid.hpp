@@ -92,6 +92,13 @@ public:
 
     bool equals(UUID const& rhs) const noexcept;
 
+    /** Returns a hash code for this UUID.
+     * Bytes are mixed, so UUIDs that differ only in a few bytes, such as time-based v1 and v7 ones,
+     * still get well distributed hash codes.
+     * @return A hash code value for this object.
+     */
+    uint64 hashCode() const noexcept;
+
     /**
      * Test if this is a 'special' case of a nil UUID
      * @return True is this is a nil UUID
@@ -136,8 +143,21 @@ public:
     value_type first() const noexcept { return _bytes[0]; }
     value_type last()  const noexcept { return _bytes[size() - 1]; }
 
-    reference  operator[] (size_type index);
-    value_type operator[] (size_type index) const;
+    /**
+     * Get a byte of the UUID at the given index.
+     * Index is checked according to the bounds checking policy: @see SOLACE_BOUNDS_CHECK_LEVEL
+     */
+    reference operator[] (size_type index) {
+		return _bytes[checkIndex(index, size(), "UUID[]")];
+	}
+
+    value_type operator[] (size_type index) const {
+		return _bytes[checkIndex(index, size(), "UUID[]")];
+	}
+
+    /// Get a byte of the UUID at the given index without bounds checking.
+    reference unchecked_at(size_type index) noexcept { return _bytes[index]; }
+    value_type unchecked_at(size_type index) const noexcept { return _bytes[index]; }
 
     [[nodiscard]]
     constexpr MemoryView view() const noexcept {
@@ -104,6 +104,11 @@ uint16 Solace::assertIndexInRange(uint16 index, uint16 size, const char* message
 	return index;
 }
 
+[[noreturn]]
+void Solace::raiseIndexOutOfRange(uint64 index, uint64 size, const char* tag) {
+	Solace::raise<IndexOutOfRangeException>(index, decltype(size){0}, size, tag);
+}
+
 [[noreturn]]
 void Solace::raiseInvalidStateError() {
     Solace::raise<InvalidStateException>();
@@ -20,6 +20,7 @@
  ******************************************************************************/
 #include "solace/base16.hpp"
 #include "solace/posixErrorDomain.hpp"
+#include "solace/probe.hpp"
 
 
 using namespace Solace;
@@ -106,6 +107,7 @@ Base16Encoder::encodedSize(MemoryView data) const {
 
 Result<void, Error>
 Base16Encoder::encode(MemoryView src) {
+	SOLACE_PROBE("Base16Encoder::encode");
     auto& dest = *getDestBuffer();
 
     for (auto value : src) {
@@ -135,6 +137,7 @@ Base16Decoder::encodedSize(MemoryView data) const {
 
 Result<void, Error>
 Base16Decoder::encode(MemoryView src) {
+	SOLACE_PROBE("Base16Decoder::encode");
     if (src.size() % 2 != 0) {
 		return makeError(GenericError::DOM, "encode(): Input data size must be even");
     }
@@ -20,6 +20,7 @@
  ******************************************************************************/
 #include "solace/base64.hpp"
 #include "solace/posixErrorDomain.hpp"
+#include "solace/probe.hpp"
 
 #include <climits>
 
@@ -33,6 +34,7 @@ static constexpr byte kBase64UrlAlphabet[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdef
 
 Result<void, Error>
 base64encode(ByteWriter& dest, MemoryView const& src, byte const alphabet[65]) {
+	SOLACE_PROBE("base64encode");
     MemoryView::size_type i = 0;
 
     for (; i + 2 < src.size(); i += 3) {
@@ -119,6 +121,7 @@ static const byte prUrl2six[256] = {
 
 Result<void, Error>
 base64decode(ByteWriter& dest, MemoryView src, byte const* decodingTable) {
+	SOLACE_PROBE("base64decode");
 	if (src.empty()) {
 		return makeError(SystemErrors::NODATA, "base64decode");
     }
@@ -20,8 +20,8 @@
  ******************************************************************************/
 #include "solace/byteReader.hpp"
 #include "solace/posixErrorDomain.hpp"
+#include "solace/memoryCopy.hpp"
 
-#include <cstring>  // memmove
 
 using namespace Solace;
 
@@ -92,7 +92,7 @@ ByteReader::read(MemoryView::MutableMemoryAddress dest, size_type bytesToRead) n
 		return makeError(SystemErrors::Overflow, "ByteReader::read()");
 	}
 
-	std::memmove(dest, srcView.dataAddress(), bytesToRead);
+	copyMemory(dest, srcView.dataAddress(), bytesToRead);
     _position += bytesToRead;
 
     return Ok();
@@ -116,7 +116,7 @@ ByteReader::read(size_type offset, MutableMemoryView dest) const noexcept {
 		return makeError(SystemErrors::Overflow, "ByteReader::read()");
 	}
 
-	std::memmove(dest.dataAddress(), srcAddress.dataAddress(), bytesToRead);
+	copyMemory(dest.dataAddress(), srcAddress.dataAddress(), bytesToRead);
 
     return Ok();
 }
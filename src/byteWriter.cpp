@@ -20,8 +20,8 @@
  ******************************************************************************/
 #include "solace/byteWriter.hpp"
 #include "solace/posixErrorDomain.hpp"
+#include "solace/memoryCopy.hpp"
 
-#include <cstring>  // memmove
 
 
 using namespace Solace;
@@ -75,7 +75,7 @@ ByteWriter::write(MemoryView::MemoryAddress srcAddr, size_type count) noexcept {
 		return makeError(SystemErrors::Overflow, "ByteWriter::write()");
 	}
 
-	std::memmove(destView.dataAddress(), srcAddr, count);
+	copyMemory(destView.dataAddress(), srcAddr, count);
 
     return advance(count);
 }
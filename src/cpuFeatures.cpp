@@ -0,0 +1,244 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ *	@file		cpuFeatures.cpp
+ *	@brief		Implementation of CPU features detection
+ ******************************************************************************/
+#include "solace/cpuFeatures.hpp"
+
+#include <cstdlib>  // getenv
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SOLACE_CPU_X86
+#include <cpuid.h>
+#elif (defined(__aarch64__) || defined(__arm__)) && defined(SOLACE_PLATFORM_LINUX)
+#define SOLACE_CPU_ARM
+#include <sys/auxv.h>
+#endif
+
+
+using namespace Solace;
+
+
+namespace  {
+
+#if defined(SOLACE_CPU_X86)
+
+/// Read extended control register to check which register states are enabled by the OS
+uint64 readXcr0() noexcept {
+	uint32 eax = 0;
+	uint32 edx = 0;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+
+	return (uint64{edx} << 32) | eax;
+}
+
+
+CpuFeatureSet detectX86Features() noexcept {
+	CpuFeatureSet features;
+
+	unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+	auto const maxLeaf = __get_cpuid_max(0, nullptr);
+	if (maxLeaf < 1) {
+		return features;
+	}
+
+	__cpuid(1, eax, ebx, ecx, edx);
+	if (edx & bit_SSE2)		features = features.with(CpuFeature::SSE2);
+	if (ecx & bit_SSSE3)	features = features.with(CpuFeature::SSSE3);
+	if (ecx & bit_SSE4_1)	features = features.with(CpuFeature::SSE4_1);
+	if (ecx & bit_SSE4_2)	features = features.with(CpuFeature::SSE4_2);
+	if (ecx & bit_POPCNT)	features = features.with(CpuFeature::POPCNT);
+	if (ecx & bit_PCLMUL)	features = features.with(CpuFeature::PCLMUL);
+
+	// AVX state must be enabled by the OS for AVX instructions to be usable
+	bool const hasOsxsave = (ecx & bit_OSXSAVE) != 0;
+	auto const xcr0 = hasOsxsave ? readXcr0() : 0;
+	bool const osAvx = (xcr0 & 0x6) == 0x6;			// XMM and YMM state
+	bool const osAvx512 = (xcr0 & 0xE6) == 0xE6;	// XMM, YMM, opmask and ZMM state
+
+	if ((ecx & bit_AVX) && osAvx) {
+		features = features.with(CpuFeature::AVX);
+	}
+
+	if (maxLeaf >= 7) {
+		__cpuid_count(7, 0, eax, ebx, ecx, edx);
+		if ((ebx & bit_AVX2) && osAvx)			features = features.with(CpuFeature::AVX2);
+		if ((ebx & bit_AVX512F) && osAvx512)	features = features.with(CpuFeature::AVX512F);
+		if ((ebx & bit_AVX512BW) && osAvx512)	features = features.with(CpuFeature::AVX512BW);
+		if (ebx & bit_BMI)						features = features.with(CpuFeature::BMI1);
+		if (ebx & bit_BMI2)						features = features.with(CpuFeature::BMI2);
+		if (ebx & bit_SHA)						features = features.with(CpuFeature::SHA);
+		if (ebx & (1U << 9))					features = features.with(CpuFeature::ERMS);
+	}
+
+	return features;
+}
+
+#elif defined(SOLACE_CPU_ARM)
+
+CpuFeatureSet detectArmFeatures() noexcept {
+	CpuFeatureSet features;
+	auto const hwcap = getauxval(AT_HWCAP);
+
+#if defined(__aarch64__)
+	// AArch64 hwcap bits: linux/arch/arm64/include/uapi/asm/hwcap.h
+	if (hwcap & (1UL << 1))		features = features.with(CpuFeature::NEON);		// HWCAP_ASIMD
+	if (hwcap & (1UL << 3))		features = features.with(CpuFeature::ARM_AES);
+	if (hwcap & (1UL << 4))		features = features.with(CpuFeature::ARM_PMULL);
+	if (hwcap & (1UL << 5))		features = features.with(CpuFeature::ARM_SHA1);
+	if (hwcap & (1UL << 6))		features = features.with(CpuFeature::ARM_SHA2);
+	if (hwcap & (1UL << 7))		features = features.with(CpuFeature::ARM_CRC32);
+#else
+	// ARM hwcap bits: linux/arch/arm/include/uapi/asm/hwcap.h
+	if (hwcap & (1UL << 12))	features = features.with(CpuFeature::NEON);		// HWCAP_NEON
+
+	auto const hwcap2 = getauxval(AT_HWCAP2);
+	if (hwcap2 & (1UL << 0))	features = features.with(CpuFeature::ARM_AES);
+	if (hwcap2 & (1UL << 1))	features = features.with(CpuFeature::ARM_PMULL);
+	if (hwcap2 & (1UL << 2))	features = features.with(CpuFeature::ARM_SHA1);
+	if (hwcap2 & (1UL << 3))	features = features.with(CpuFeature::ARM_SHA2);
+	if (hwcap2 & (1UL << 4))	features = features.with(CpuFeature::ARM_CRC32);
+#endif
+
+	return features;
+}
+
+#endif
+
+
+constexpr CpuFeatureSet kSSE2Features{CpuFeature::SSE2, CpuFeature::ERMS};
+
+constexpr CpuFeatureSet kSSE42Features{CpuFeature::SSE2, CpuFeature::ERMS,
+			CpuFeature::SSSE3, CpuFeature::SSE4_1, CpuFeature::SSE4_2,
+			CpuFeature::POPCNT, CpuFeature::PCLMUL, CpuFeature::SHA};
+
+constexpr CpuFeatureSet kAVX2Features{CpuFeature::SSE2, CpuFeature::ERMS,
+			CpuFeature::SSSE3, CpuFeature::SSE4_1, CpuFeature::SSE4_2,
+			CpuFeature::POPCNT, CpuFeature::PCLMUL, CpuFeature::SHA,
+			CpuFeature::AVX, CpuFeature::AVX2, CpuFeature::BMI1, CpuFeature::BMI2};
+
+constexpr CpuFeatureSet kAVX512Features{CpuFeature::SSE2, CpuFeature::ERMS,
+			CpuFeature::SSSE3, CpuFeature::SSE4_1, CpuFeature::SSE4_2,
+			CpuFeature::POPCNT, CpuFeature::PCLMUL, CpuFeature::SHA,
+			CpuFeature::AVX, CpuFeature::AVX2, CpuFeature::BMI1, CpuFeature::BMI2,
+			CpuFeature::AVX512F, CpuFeature::AVX512BW};
+
+constexpr CpuFeatureSet kNEONFeatures{CpuFeature::NEON,
+			CpuFeature::ARM_AES, CpuFeature::ARM_PMULL,
+			CpuFeature::ARM_SHA1, CpuFeature::ARM_SHA2, CpuFeature::ARM_CRC32};
+
+
+constexpr char toLower(char c) noexcept {
+	return (c >= 'A' && c <= 'Z')
+			? static_cast<char>(c - 'A' + 'a')
+			: c;
+}
+
+bool equalsIgnoreCase(StringView lhs, StringView rhs) noexcept {
+	if (lhs.size() != rhs.size()) {
+		return false;
+	}
+
+	for (StringView::size_type i = 0; i < lhs.size(); ++i) {
+		if (toLower(lhs.data()[i]) != toLower(rhs.data()[i])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+CpuFeatureSet initCpuFeatures() noexcept {
+	auto const detectedFeatures = detectCpuFeatures();
+
+	auto const levelName = std::getenv(kCpuLevelEnvVar);
+	if (!levelName) {
+		return detectedFeatures;
+	}
+
+	auto const maybeLevel = parseCpuLevel(StringView{levelName});
+	return maybeLevel
+			? detectedFeatures.intersect(cpuLevelFeatures(*maybeLevel))
+			: detectedFeatures;
+}
+
+}  // namespace
+
+
+Optional<CpuLevel>
+Solace::parseCpuLevel(StringView name) noexcept {
+	struct LevelName {
+		StringLiteral	name;
+		CpuLevel		level;
+	};
+
+	static constexpr LevelName const kLevelNames[] = {
+		{"scalar", CpuLevel::Scalar},
+		{"sse2", CpuLevel::SSE2},
+		{"sse4.2", CpuLevel::SSE4_2},
+		{"sse42", CpuLevel::SSE4_2},
+		{"avx2", CpuLevel::AVX2},
+		{"avx512", CpuLevel::AVX512},
+		{"neon", CpuLevel::NEON},
+		{"native", CpuLevel::Native},
+	};
+
+	for (auto const& levelName : kLevelNames) {
+		if (equalsIgnoreCase(name, levelName.name)) {
+			return levelName.level;
+		}
+	}
+
+	return none;
+}
+
+
+CpuFeatureSet
+Solace::cpuLevelFeatures(CpuLevel level) noexcept {
+	switch (level) {
+	case CpuLevel::Scalar:	return CpuFeatureSet{};
+	case CpuLevel::SSE2:	return kSSE2Features;
+	case CpuLevel::SSE4_2:	return kSSE42Features;
+	case CpuLevel::AVX2:	return kAVX2Features;
+	case CpuLevel::AVX512:	return kAVX512Features;
+	case CpuLevel::NEON:	return kNEONFeatures;
+	case CpuLevel::Native:	return detectCpuFeatures();
+	}
+
+	return CpuFeatureSet{};
+}
+
+
+CpuFeatureSet
+Solace::detectCpuFeatures() noexcept {
+#if defined(SOLACE_CPU_X86)
+	return detectX86Features();
+#elif defined(SOLACE_CPU_ARM)
+	return detectArmFeatures();
+#else
+	return CpuFeatureSet{};
+#endif
+}
+
+
+CpuFeatureSet
+Solace::cpuFeatures() noexcept {
+	static CpuFeatureSet const kFeatures = initCpuFeatures();
+
+	return kFeatures;
+}
@@ -19,47 +19,98 @@
  ******************************************************************************/
 #include "solace/errorDomain.hpp"
 #include "solace/posixErrorDomain.hpp"
-#include "solace/dictionary.hpp"
+
+#include <atomic>
 
 
 using namespace Solace;
 
 namespace  {
 
-static const uint32 kNbErrorCategories = 128;
+/// Number of slots in the registry. Must be a power of 2.
+constexpr uint32 kNbErrorCategories = 128;
+constexpr uint32 kSlotMask = kNbErrorCategories - 1;
 
-Dictionary<AtomValue, ErrorDomain*>
-autoRegisterDomainMap() noexcept {
-	static byte kKeysBuffer[kNbErrorCategories * sizeof(AtomValue)];
-	static byte kValuesBuffer[kNbErrorCategories * sizeof(ErrorDomain*)];
+static_assert((kNbErrorCategories & kSlotMask) == 0, "Number of error categories must be a power of 2");
 
-	auto maybeDict = makeDictionary<AtomValue, ErrorDomain*>(
-				wrapMemory(kKeysBuffer), wrapMemory(kValuesBuffer));
+/**
+ * A slot in the open-addressing table of registered error domains.
+ * Key value of 0 (an empty atom) marks an unused slot.
+ * Once a key is claimed it never changes, thus readers only need to observe the domain pointer.
+ */
+struct DomainSlot {
+	std::atomic<std::uintmax_t>	categoryId{0};
+	std::atomic<ErrorDomain*>	domain{nullptr};
+};
+
+// Constant-initialized: safe to use from static initializers of other translation units.
+DomainSlot					kErrorDomainTable[kNbErrorCategories];
+std::atomic<uint32>			kNbRegisteredDomains{0};
 
-	return maybeDict.moveResult();
-}
 
-// Poor-man's singleton
-static Dictionary<AtomValue, ErrorDomain*> kErrorDomainMap = autoRegisterDomainMap();
+/// Fibonacci hashing of the atom value into a slot index.
+constexpr uint32
+slotIndex(std::uintmax_t key) noexcept {
+	return static_cast<uint32>((static_cast<uint64>(key) * 0x9E3779B97F4A7C15ULL) >> 57) & kSlotMask;
+}
 
 }  // namespace
 
 
 uint32
 Solace::registerErrorDomain(AtomValue categoryId, ErrorDomain& domain) noexcept {
-    kErrorDomainMap.put(categoryId, &domain);
+	auto const key = static_cast<std::uintmax_t>(categoryId);
+	if (key == 0) {  // Empty atom is reserved to mark unused slots
+		return 0;
+	}
+
+	auto index = slotIndex(key);
+	for (uint32 probe = 0; probe < kNbErrorCategories; ++probe, index = (index + 1) & kSlotMask) {
+		auto& slot = kErrorDomainTable[index];
+
+		std::uintmax_t expected = 0;
+		if (slot.categoryId.compare_exchange_strong(expected, key, std::memory_order_acq_rel)) {
+			slot.domain.store(&domain, std::memory_order_release);
 
-    return kErrorDomainMap.size();
+			return kNbRegisteredDomains.fetch_add(1, std::memory_order_relaxed) + 1;
+		}
+
+		if (expected == key) {  // Re-registration of the category replaces the domain
+			slot.domain.store(&domain, std::memory_order_release);
+
+			return kNbRegisteredDomains.load(std::memory_order_relaxed);
+		}
+	}
+
+	// No more room in the registry
+	return 0;
 }
 
 
 Optional<ErrorDomain&>
 Solace::findErrorDomain(AtomValue categoryId) noexcept {
-	auto maybePointer = kErrorDomainMap.find(categoryId);
-	if (!maybePointer)
+	auto const key = static_cast<std::uintmax_t>(categoryId);
+	if (key == 0) {
 		return none;
+	}
+
+	auto index = slotIndex(key);
+	for (uint32 probe = 0; probe < kNbErrorCategories; ++probe, index = (index + 1) & kSlotMask) {
+		auto const& slot = kErrorDomainTable[index];
+		auto const slotKey = slot.categoryId.load(std::memory_order_acquire);
+		if (slotKey == 0) {  // Reached an unused slot: the category was never registered
+			return none;
+		}
+
+		if (slotKey == key) {
+			auto domain = slot.domain.load(std::memory_order_acquire);
+			if (!domain) {  // Slot claimed but registration is not yet complete
+				return none;
+			}
+
+			return Optional<ErrorDomain&>{std::ref(*domain)};
+		}
+	}
 
-	ErrorDomain* p = *maybePointer;
-	ErrorDomain& ref = *p;
-	return Optional<ErrorDomain&>{std::ref(ref)};
+	return none;
 }
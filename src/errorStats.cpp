@@ -0,0 +1,202 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ *	@file		errorStats.cpp
+ *	@brief		Implementation of error counters
+ ******************************************************************************/
+#include "solace/errorStats.hpp"
+#include "solace/details/thread_tables.hpp"
+
+#include <algorithm>  // std::partial_sort
+#include <atomic>
+
+
+using namespace Solace;
+
+
+namespace  {
+
+constexpr uint32 kNbThreadTables = 32;
+/// Number of distinct errors a table can count. Must be a power of 2.
+constexpr uint32 kNbEntriesPerTable = 64;
+constexpr uint32 kEntryMask = kNbEntriesPerTable - 1;
+constexpr size_t kCacheLineSize = 64;
+
+static_assert((kNbEntriesPerTable & kEntryMask) == 0, "Number of table entries must be a power of 2");
+
+enum EntryState : uint8 {
+	Empty = 0,
+	Claimed,	//!< Key is being written by the thread that claimed the entry.
+	Ready		//!< Key is published and never changes.
+};
+
+/**
+ * Counter of a single error.
+ * Key fields are written once by the thread that claimed the entry and published by the release-store of the state.
+ */
+struct StatsEntry {
+	std::atomic<uint8>		state{Empty};
+	int						code{0};
+	AtomValue				domain{};
+	char const*				tagData{nullptr};
+	StringView::size_type	tagSize{0};
+	std::atomic<uint64>		count{0};
+
+	bool matches(AtomValue errorDomain, int errorCode, StringView tag) const noexcept {
+		return (domain == errorDomain)
+				&& (code == errorCode)
+				&& (tagData == tag.data())
+				&& (tagSize == tag.size());
+	}
+};
+
+
+/// Table of error counters, aligned to a cache line to avoid false sharing between threads.
+struct alignas(kCacheLineSize) StatsTable {
+	std::atomic<bool>	isOwned{false};
+	StatsEntry			entries[kNbEntriesPerTable];
+};
+
+
+/// Shared table also counts errors that do not fit into the table of a thread.
+details::ThreadTableRegistry<StatsTable, kNbThreadTables>	kStatsTables;
+
+
+constexpr uint32
+entryIndex(AtomValue domain, int code, StringView tag) noexcept {
+	auto const key = static_cast<uint64>(domain)
+			^ (static_cast<uint64>(reinterpret_cast<std::uintptr_t>(tag.data())) << 1)
+			^ static_cast<uint64>(static_cast<uint32>(code));
+
+	return static_cast<uint32>((key * 0x9E3779B97F4A7C15ULL) >> 58) & kEntryMask;
+}
+
+
+StatsEntry*
+findOrInsert(StatsTable& table, AtomValue domain, int code, StringView tag) noexcept {
+	auto index = entryIndex(domain, code, tag);
+	for (uint32 probe = 0; probe < kNbEntriesPerTable; ++probe, index = (index + 1) & kEntryMask) {
+		auto& entry = table.entries[index];
+
+		auto state = entry.state.load(std::memory_order_acquire);
+		if (state == Empty) {
+			uint8 expected = Empty;
+			if (entry.state.compare_exchange_strong(expected, Claimed, std::memory_order_acquire)) {
+				entry.domain = domain;
+				entry.code = code;
+				entry.tagData = tag.data();
+				entry.tagSize = tag.size();
+				entry.state.store(Ready, std::memory_order_release);
+
+				return &entry;
+			}
+
+			state = expected;
+		}
+
+		while (state == Claimed) {  // Another thread is publishing the key of this entry
+			state = entry.state.load(std::memory_order_acquire);
+		}
+
+		if (entry.matches(domain, code, tag)) {
+			return &entry;
+		}
+	}
+
+	return nullptr;
+}
+
+
+void
+aggregate(StatsTable const& table, ArrayView<ErrorStatsEntry> dest, uint32& nbEntries) noexcept {
+	for (auto const& entry : table.entries) {
+		if (entry.state.load(std::memory_order_acquire) != Ready) {
+			continue;
+		}
+
+		auto const count = entry.count.load(std::memory_order_relaxed);
+		if (count == 0) {
+			continue;
+		}
+
+		auto const tag = StringView{entry.tagData, entry.tagSize};
+		auto const end = dest.begin() + nbEntries;
+		auto it = std::find_if(dest.begin(), end, [&](ErrorStatsEntry const& e) {
+			return (e.domain == entry.domain) && (e.code == entry.code)
+					&& (e.tag.data() == tag.data()) && (e.tag.size() == tag.size());
+		});
+
+		if (it != end) {
+			it->count += count;
+		} else if (nbEntries < dest.size()) {
+			*it = ErrorStatsEntry{entry.domain, entry.code, tag, count};
+			nbEntries += 1;
+		}
+	}
+}
+
+}  // namespace
+
+
+void
+Solace::recordError(AtomValue domain, int code, StringView tag) noexcept {
+	auto& table = kStatsTables.threadTable();
+	auto isShared = kStatsTables.isShared(table);
+	auto entry = findOrInsert(table, domain, code, tag);
+	if (!entry) {  // Thread's table is full
+		isShared = true;
+		entry = findOrInsert(kStatsTables.shared, domain, code, tag);
+	}
+
+	if (entry) {
+		details::incrementCounter(entry->count, 1, isShared);
+	}
+}
+
+
+uint32
+Solace::errorStatsSnapshot(ArrayView<ErrorStatsEntry> dest) noexcept {
+	uint32 nbEntries = 0;
+	kStatsTables.forEach([&](StatsTable const& table) {
+		aggregate(table, dest, nbEntries);
+	});
+
+	return nbEntries;
+}
+
+
+ArrayView<ErrorStatsEntry>
+Solace::errorStatsTopN(ArrayView<ErrorStatsEntry> buffer, uint32 n) noexcept {
+	auto const nbEntries = errorStatsSnapshot(buffer);
+	auto const nbTop = std::min(n, nbEntries);
+
+	std::partial_sort(buffer.begin(), buffer.begin() + nbTop, buffer.begin() + nbEntries,
+					  [](ErrorStatsEntry const& lhs, ErrorStatsEntry const& rhs) {
+		return lhs.count > rhs.count;
+	});
+
+	return buffer.slice(0, nbTop);
+}
+
+
+void
+Solace::errorStatsReset() noexcept {
+	kStatsTables.forEach([](StatsTable& table) {
+		for (auto& entry : table.entries) {
+			entry.count.store(0, std::memory_order_relaxed);
+		}
+	});
+}
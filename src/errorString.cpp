@@ -16,12 +16,11 @@
 /*******************************************************************************
  * libSolace
  *	@file		errorString.cpp
- *	@brief		Implementation details of ErrorString
+ *	@brief		Implementation details of StringWriter
  ******************************************************************************/
 
 #include "solace/details/string_utils.hpp"
 
-#include <cstdlib>
 #include <cstring>
 #include <cstdio>  // snprintf etc
 #include <inttypes.h>  // Platform-independent format
@@ -32,92 +31,83 @@
 namespace Solace {
 namespace details {
 
-ErrorString::~ErrorString() noexcept {
-	if (_message) {
-		free(const_cast<char*>(_message));
-		_message = nullptr;
+StringWriter::StringWriter(value_type* buffer, size_type capacity) noexcept
+	: _size{capacity ? narrow_cast<size_type>(capacity - 1) : size_type{0}}
+	, _offset{0}
+	, _buffer{buffer}
+{
+	if (_buffer && capacity) {
+		_buffer[0] = 0;
+	} else {
+		_size = 0;
 	}
 }
 
 
+StringWriter&
+StringWriter::advance(int nbWritten) noexcept {
+	// snprintf returns number of characters that would have been written if there was enough room
+	if (nbWritten > 0) {
+		_offset += std::min(narrow_cast<size_type>(nbWritten), remaining());
+	}
 
-ErrorString::ErrorString(StringView view)
-	: _size{view.size()}
-	, _message{static_cast<value_type*>(calloc(view.size() + 1, 1))}
-{
-	memcpy(_message, view.data(), _size);
+	return *this;
 }
 
 
-
-StringWriter::size_type
-StringWriter::measure(uint16 value) noexcept { return narrow_cast<size_type>(snprintf(nullptr, 0, "%" PRIu16, value)); }
-StringWriter::size_type
-StringWriter::measure(uint32 value) noexcept { return narrow_cast<size_type>(snprintf(nullptr, 0, "%" PRIu32, value)); }
-StringWriter::size_type
-StringWriter::measure(uint64 value) noexcept { return narrow_cast<size_type>(snprintf(nullptr, 0, "%" PRIu64, value)); }
-
-StringWriter::size_type
-StringWriter::measure(int16 value) noexcept { return narrow_cast<size_type>(snprintf(nullptr, 0, "%" PRId16, value)); }
-StringWriter::size_type
-StringWriter::measure(int32 value) noexcept { return narrow_cast<size_type>(snprintf(nullptr, 0, "%" PRId32, value)); }
-StringWriter::size_type
-StringWriter::measure(int64 value) noexcept { return narrow_cast<size_type>(snprintf(nullptr, 0, "%" PRId64, value)); }
-
-
-
-StringWriter::StringWriter(size_type memSize) noexcept
-	: _size{memSize}
-	, _offset{0}
-	, _buffer{static_cast<details::ErrorString::value_type*>(calloc(memSize + 1, 1))}
-{
-	if (!_buffer) {
-		_size = 0;
-	}
-}
-
 StringWriter&
 StringWriter::append(StringView data) noexcept {
 	size_type const dataCopied = std::min(data.size(), remaining());
-	memcpy(currentBuffer(), data.data(), dataCopied);
-	_offset += dataCopied;
+	if (dataCopied) {
+		memcpy(currentBuffer(), data.data(), dataCopied);
+		_offset += dataCopied;
+		_buffer[_offset] = 0;
+	}
 
 	return *this;
 }
 
 StringWriter&
 StringWriter::appendFormated(uint16 value) noexcept {
-	_offset += snprintf(currentBuffer(), remaining(), "%" PRIu16, value); return *this;
+	if (!_buffer) return *this;
+	return advance(snprintf(currentBuffer(), remaining() + 1, "%" PRIu16, value));
 }
 
 StringWriter&
 StringWriter::appendFormated(uint32 value) noexcept {
-	_offset += snprintf(currentBuffer(), remaining(), "%" PRIu32, value); return *this;
+	if (!_buffer) return *this;
+	return advance(snprintf(currentBuffer(), remaining() + 1, "%" PRIu32, value));
 }
 
 StringWriter&
 StringWriter::appendFormated(uint64 value) noexcept {
-	_offset += snprintf(currentBuffer(), remaining(), "%" PRIu64, value);
-	return *this;
+	if (!_buffer) return *this;
+	return advance(snprintf(currentBuffer(), remaining() + 1, "%" PRIu64, value));
 }
 
 StringWriter&
 StringWriter::appendFormated(int16 value) noexcept {
-	_offset += snprintf(currentBuffer(), remaining(), "%" PRId16, value); return *this;
+	if (!_buffer) return *this;
+	return advance(snprintf(currentBuffer(), remaining() + 1, "%" PRId16, value));
 }
+
 StringWriter&
 StringWriter::appendFormated(int32 value) noexcept {
-	_offset += snprintf(currentBuffer(), remaining(), "%" PRId32, value); return *this;
+	if (!_buffer) return *this;
+	return advance(snprintf(currentBuffer(), remaining() + 1, "%" PRId32, value));
 }
+
 StringWriter&
 StringWriter::appendFormated(int64 value) noexcept {
-	_offset += snprintf(currentBuffer(), remaining(), "%" PRId64, value);
-	return *this;
+	if (!_buffer) return *this;
+	return advance(snprintf(currentBuffer(), remaining() + 1, "%" PRId64, value));
 }
 
 StringWriter&
 StringWriter::append(const char* value) noexcept {
-	_offset += snprintf(currentBuffer(), remaining(), "%s", value); return *this;
+	return value
+			? append(StringView{value})
+			: *this;
 }
 
 }  // namespace details
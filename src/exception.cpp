@@ -19,7 +19,8 @@
  ******************************************************************************/
 #include "solace/exception.hpp"
 
-#include <cstring>  // strerror
+#include <cstring>  // strerror_r, memcpy
+#include <thread>   // std::this_thread::yield
 
 
 using namespace Solace;
@@ -38,71 +39,31 @@ namespace /*anonymous*/ {
 
 using details::StringWriter;
 
-details::ErrorString formatErrorStringJoin(StringView lhs, StringView rhs, StringView delim = " ") {
-	auto const jointSize = lhs.size() + rhs.size() + delim.size();
-
-	return details::StringWriter{narrow_cast<StringWriter::size_type>(jointSize)}
-			.append(lhs)
-			.append(delim)
-			.append(rhs)
-			.build();
+// Handle both XSI-compliant (returns int) and GNU-specific (returns char*) versions of strerror_r
+[[maybe_unused]]
+const char* strerrorMessage(int result, const char* buffer) noexcept {
+	return (result == 0) ? buffer : "Unknown error";
 }
 
-details::ErrorString formatErrono(int errorCode, StringView msgex) {
-	auto const errorString = StringView{strerror(errorCode)};
-	auto const bufferSize = StringWriter::measure(msgex)
-			+ StringWriter::measure("[")
-			+ StringWriter::measure(errorCode)
-			+ StringWriter::measure("]: ")
-			+ StringWriter::measure(errorString);
-
-	return StringWriter{narrow_cast<StringWriter::size_type>(bufferSize)}
-			.append(msgex)
-			.append("[")
-			.appendFormated(errorCode)
-			.append("]: ")
-			.append(strerror(errorCode))
-			.build();
+[[maybe_unused]]
+const char* strerrorMessage(const char* result, const char* SOLACE_UNUSED(buffer)) noexcept {
+	return result;
 }
 
 
-details::ErrorString formatErrono(int errorCode) {
-	return formatErrono(errorCode, IOExceptionType);
-}
-
+void formatErrono(StringWriter& writer, int errorCode) noexcept {
+	char buffer[Exception::kMaxMessageSize + 1];
+	buffer[0] = 0;
 
-details::ErrorString formatIlligalArgName(StringLiteral argName) {
-	auto const bufferSize = StringWriter::measure("Illegal argument '")
-			+ StringWriter::measure(argName)
-			+ StringWriter::measure("'");
-
-	return StringWriter{narrow_cast<StringWriter::size_type>(bufferSize)}
-			.append("Illegal argument '")
-			.append(argName)
-			.append("'")
-			.build();
+	writer.append("[")
+			.appendFormated(errorCode)
+			.append("]: ")
+			.append(strerrorMessage(strerror_r(errorCode, buffer, sizeof(buffer)), buffer));
 }
 
 
-template<typename Index>
-details::ErrorString formatIndexOutOfRangeError(StringView messagePrefix, StringLiteral indexName, StringView reason,
-									   Index index, Index minValue, Index maxValue) {
-	auto const bufferSize = StringWriter::measure(messagePrefix)
-			+ StringWriter::measure(" '")
-			+ StringWriter::measure(indexName)
-			+ StringWriter::measure("'=")
-			+ StringWriter::measure(index)
-			+ StringWriter::measure(" ")
-			+ StringWriter::measure(reason)
-			+ StringWriter::measure(" [")
-			+ StringWriter::measure(minValue)
-			+ StringWriter::measure(", ")
-			+ StringWriter::measure(maxValue)
-			+ StringWriter::measure(")");
-
-
-	StringWriter writer{narrow_cast<StringWriter::size_type>(bufferSize)};
-
+void formatIndexOutOfRangeError(StringWriter& writer, StringView messagePrefix, StringLiteral indexName,
+								StringView reason, uint64 index, uint64 minValue, uint64 maxValue) noexcept {
 	writer.append(messagePrefix);
 	if (indexName) {
 		writer.append(" '");
@@ -120,55 +81,115 @@ details::ErrorString formatIndexOutOfRangeError(StringView messagePrefix, String
 	writer.append(", ");
 	writer.appendFormated(maxValue);
 	writer.append(")");
-
-	return writer.build();
 }
 
-details::ErrorString formatIndexOutOfRangeError(StringView messagePrefix, StringLiteral indexName,
-									   uint16 index, uint16 minValue, uint16 maxValue) {
-	return formatIndexOutOfRangeError(messagePrefix, indexName, "is out of range", index, minValue, maxValue);
+}  // anonymous namespace
+
+
+
+Exception::Exception(StringView message) noexcept
+	: _state{FormatState::Formatted}
+	, _prefixSize{0}
+	, _size{0}
+{
+	_size = StringWriter{_message, sizeof(_message)}
+			.append(message)
+			.size();
+	_prefixSize = _size;
 }
 
-details::ErrorString formatIndexOutOfRangeError(StringView messagePrefix, StringLiteral indexName,
-									   uint32 index, uint32 minValue, uint32 maxValue) {
-	return formatIndexOutOfRangeError(messagePrefix, indexName, "is out of range", index, minValue, maxValue);
+
+Exception::Exception(Exception const& other) noexcept
+	: _state{FormatState::Formatted}
+	, _prefixSize{0}
+	, _size{0}
+{
+	// Copy may be a slice that lacks the values the original formats its message from.
+	other.ensureFormatted();
+	copyMessage(other);
 }
 
-details::ErrorString formatIndexOutOfRangeError(StringView messagePrefix, StringLiteral indexName,
-									   uint64 index, uint64 minValue, uint64 maxValue) {
-	return formatIndexOutOfRangeError(messagePrefix, indexName, "is out of range", index, minValue, maxValue);
+
+Exception::Exception(DeferFormatting, StringView messagePrefix) noexcept
+	: _state{FormatState::Deferred}
+	, _prefixSize{0}
+	, _size{0}
+{
+	_size = StringWriter{_message, sizeof(_message)}
+			.append(messagePrefix)
+			.size();
+	_prefixSize = _size;
 }
 
 
-details::ErrorString formatOverflowError(StringLiteral indexName, uint16 index, uint16 minValue, uint16 maxValue) {
-	return formatIndexOutOfRangeError("Value", indexName, "overflows range", index, minValue, maxValue);
+Exception::Exception(DeferFormatting, Exception const& other) noexcept
+	: _state{FormatState::Deferred}
+	, _prefixSize{0}
+	, _size{0}
+{
+	copyMessage(other);
 }
 
 
-details::ErrorString formatOverflowError(StringLiteral indexName, uint32 index, uint32 minValue, uint32 maxValue) {
-	return formatIndexOutOfRangeError("Value", indexName, "overflows range", index, minValue, maxValue);
+void
+Exception::copyMessage(Exception const& other) noexcept {
+	auto state = other._state.load(std::memory_order_acquire);
+	if (state == FormatState::Formatting) {
+		other.ensureFormatted();
+		state = FormatState::Formatted;
+	}
+
+	// Only the prefix is stable while the original is not formatted: formatting appends past it.
+	_prefixSize = other._prefixSize;
+	_size = (state == FormatState::Formatted) ? other._size : other._prefixSize;
+	memcpy(_message, other._message, _size);
+	_message[_size] = 0;
+	_state.store(state, std::memory_order_relaxed);
 }
 
 
-details::ErrorString formatOverflowError(StringLiteral indexName, uint64 index, uint64 minValue, uint64 maxValue) {
-	return formatIndexOutOfRangeError("Value", indexName, "overflows range", index, minValue, maxValue);
+void
+Exception::formatMessage(StringWriter& SOLACE_UNUSED(writer)) const noexcept {
+	// Base exception message is fully formed at the construction time.
 }
 
 
-}  // anonymous namespace
+void
+Exception::ensureFormatted() const noexcept {
+	auto state = _state.load(std::memory_order_acquire);
+	while (state != FormatState::Formatted) {
+		if (state == FormatState::Formatting) {
+			// Another thread is formatting the message: wait for it to publish the result.
+			std::this_thread::yield();
+			state = _state.load(std::memory_order_acquire);
+			continue;
+		}
+
+		if (_state.compare_exchange_weak(state, FormatState::Formatting, std::memory_order_acquire)) {
+			StringWriter writer{_message + _prefixSize, narrow_cast<size_type>(sizeof(_message) - _prefixSize)};
+			formatMessage(writer);
+
+			_size = _prefixSize + writer.size();
+			_state.store(FormatState::Formatted, std::memory_order_release);
+			return;
+		}
+	}
+}
 
 
+StringView
+Exception::getMessage() const noexcept {
+	ensureFormatted();
 
-Exception::Exception(StringView message) noexcept
-	: _message{mv(message)}
-{
-    // Nothing else to do here
+	return StringView{_message, _size};
 }
 
 
+const char*
+Exception::what() const noexcept {
+	ensureFormatted();
 
-const char* Exception::what() const noexcept {
-    return _message.c_str();
+	return _message;
 }
 
 
@@ -180,73 +201,132 @@ IllegalArgumentException::IllegalArgumentException() noexcept
 
 
 IllegalArgumentException::IllegalArgumentException(StringLiteral argumentName) noexcept
-	: Exception{formatIlligalArgName(argumentName)}
+	: Exception{DeferFormatting{}}
+	, _argumentName{argumentName}
 {
     // Nothing to do here
 }
 
 
+IllegalArgumentException::IllegalArgumentException(IllegalArgumentException const& other) noexcept
+	: Exception{DeferFormatting{}, other}
+	, _argumentName{other._argumentName}
+{}
+
+
+void
+IllegalArgumentException::formatMessage(StringWriter& writer) const noexcept {
+	writer.append("Illegal argument '")
+			.append(_argumentName)
+			.append("'");
+}
+
+
 IndexOutOfRangeException::IndexOutOfRangeException() noexcept
 	: Exception{kIndexOutOfRangeMessage}
+	, _messagePrefix{nullptr}
+	, _index{0}
+	, _minValue{0}
+	, _maxValue{0}
 {
     // No-op
 }
 
 IndexOutOfRangeException::IndexOutOfRangeException(uint16 index, uint16 minValue, uint16 maxValue) noexcept
-	: Exception{formatIndexOutOfRangeError(kIndexOutOfRangeMessage, "", index, minValue, maxValue)}
+	: IndexOutOfRangeException{uint64{index}, uint64{minValue}, uint64{maxValue}}
 {}
 
 IndexOutOfRangeException::IndexOutOfRangeException(uint32 index, uint32 minValue, uint32 maxValue) noexcept
-	: Exception{formatIndexOutOfRangeError(kIndexOutOfRangeMessage, "", index, minValue, maxValue)}
+	: IndexOutOfRangeException{uint64{index}, uint64{minValue}, uint64{maxValue}}
 {}
 
 IndexOutOfRangeException::IndexOutOfRangeException(uint64 index, uint64 minValue, uint64 maxValue) noexcept
-	: Exception{formatIndexOutOfRangeError(kIndexOutOfRangeMessage, "", index, minValue, maxValue)}
+	: IndexOutOfRangeException{index, minValue, maxValue, kIndexOutOfRangeMessage.data()}
 {}
 
 IndexOutOfRangeException::IndexOutOfRangeException(uint16 index, uint16 minValue, uint16 maxValue,
 												   const char* messagePrefix) noexcept
-	: Exception{formatIndexOutOfRangeError(messagePrefix, "", index, minValue, maxValue)}
+	: IndexOutOfRangeException{uint64{index}, uint64{minValue}, uint64{maxValue}, messagePrefix}
 {}
 
 IndexOutOfRangeException::IndexOutOfRangeException(uint32 index, uint32 minValue, uint32 maxValue,
 												   const char* messagePrefix) noexcept
-	: Exception{formatIndexOutOfRangeError(messagePrefix, "", index, minValue, maxValue)}
+	: IndexOutOfRangeException{uint64{index}, uint64{minValue}, uint64{maxValue}, messagePrefix}
 {}
 
 IndexOutOfRangeException::IndexOutOfRangeException(uint64 index, uint64 minValue, uint64 maxValue,
 												   const char* messagePrefix) noexcept
-	: Exception{formatIndexOutOfRangeError(messagePrefix, "", index, minValue, maxValue)}
+	: Exception{DeferFormatting{}}
+	, _messagePrefix{messagePrefix}
+	, _index{index}
+	, _minValue{minValue}
+	, _maxValue{maxValue}
+{}
+
+
+IndexOutOfRangeException::IndexOutOfRangeException(IndexOutOfRangeException const& other) noexcept
+	: Exception{DeferFormatting{}, other}
+	, _messagePrefix{other._messagePrefix}
+	, _index{other._index}
+	, _minValue{other._minValue}
+	, _maxValue{other._maxValue}
 {}
 
 
+void
+IndexOutOfRangeException::formatMessage(StringWriter& writer) const noexcept {
+	formatIndexOutOfRangeError(writer, _messagePrefix ? StringView{_messagePrefix} : StringView{}, StringLiteral{},
+							   "is out of range", _index, _minValue, _maxValue);
+}
+
+
 OverflowException::OverflowException(StringLiteral indexName,
 									 uint16 index, uint16 minValue, uint16 maxValue) noexcept
-	: Exception{formatOverflowError(indexName, index, minValue, maxValue)}
+	: OverflowException{indexName, uint64{index}, uint64{minValue}, uint64{maxValue}}
 {}
 
 OverflowException::OverflowException(StringLiteral indexName,
 									 uint32 index, uint32 minValue, uint32 maxValue) noexcept
-	: Exception{formatOverflowError(indexName, index, minValue, maxValue)}
+	: OverflowException{indexName, uint64{index}, uint64{minValue}, uint64{maxValue}}
 {}
 
 OverflowException::OverflowException(StringLiteral indexName,
 									 uint64 index, uint64 minValue, uint64 maxValue) noexcept
-	: Exception{formatOverflowError(indexName, index, minValue, maxValue)}
+	: Exception{DeferFormatting{}}
+	, _indexName{indexName}
+	, _index{index}
+	, _minValue{minValue}
+	, _maxValue{maxValue}
 {}
 
 OverflowException::OverflowException(uint16 index, uint16 minValue, uint16 maxValue) noexcept
-	: Exception(formatOverflowError("", index, minValue, maxValue))
+	: OverflowException{StringLiteral{}, uint64{index}, uint64{minValue}, uint64{maxValue}}
 {}
 
 OverflowException::OverflowException(uint32 index, uint32 minValue, uint32 maxValue) noexcept
-	: Exception(formatOverflowError("", index, minValue, maxValue))
+	: OverflowException{StringLiteral{}, uint64{index}, uint64{minValue}, uint64{maxValue}}
 {}
 
 OverflowException::OverflowException(uint64 index, uint64 minValue, uint64 maxValue) noexcept
-	: Exception(formatOverflowError("", index, minValue, maxValue))
+	: OverflowException{StringLiteral{}, index, minValue, maxValue}
 {}
 
+
+OverflowException::OverflowException(OverflowException const& other) noexcept
+	: Exception{DeferFormatting{}, other}
+	, _indexName{other._indexName}
+	, _index{other._index}
+	, _minValue{other._minValue}
+	, _maxValue{other._maxValue}
+{}
+
+
+void
+OverflowException::formatMessage(StringWriter& writer) const noexcept {
+	formatIndexOutOfRangeError(writer, "Value", _indexName, "overflows range", _index, _minValue, _maxValue);
+}
+
+
 NoSuchElementException::NoSuchElementException() noexcept
 	: Exception{kNoSuchElementMessage}
 {
@@ -255,25 +335,54 @@ NoSuchElementException::NoSuchElementException() noexcept
 
 
 NoSuchElementException::NoSuchElementException(StringLiteral elementName) noexcept
-	: Exception{formatErrorStringJoin(kNoSuchElementMessage, elementName)}
+	: Exception{DeferFormatting{}, kNoSuchElementMessage}
+	, _elementName{elementName}
 {
     // Nothing else to do here
 }
 
 
+NoSuchElementException::NoSuchElementException(NoSuchElementException const& other) noexcept
+	: Exception{DeferFormatting{}, other}
+	, _elementName{other._elementName}
+{}
+
+
+void
+NoSuchElementException::formatMessage(StringWriter& writer) const noexcept {
+	writer.append(" ")
+			.append(_elementName);
+}
+
+
 InvalidStateException::InvalidStateException() noexcept
 	: Exception{kInvalidStateMessage}
+	, _tag{nullptr}
 {
 
 }
 
 InvalidStateException::InvalidStateException(const char* tag) noexcept
-	: Exception{formatErrorStringJoin(kInvalidStateMessage, tag)}
+	: Exception{DeferFormatting{}, kInvalidStateMessage}
+	, _tag{tag}
 {
 
 }
 
 
+InvalidStateException::InvalidStateException(InvalidStateException const& other) noexcept
+	: Exception{DeferFormatting{}, other}
+	, _tag{other._tag}
+{}
+
+
+void
+InvalidStateException::formatMessage(StringWriter& writer) const noexcept {
+	writer.append(" ")
+			.append(_tag);
+}
+
+
 IOException::IOException(StringView msg) noexcept
 	: Exception{msg}
 	, _errorCode{-1}
@@ -282,22 +391,33 @@ IOException::IOException(StringView msg) noexcept
 
 
 IOException::IOException(int errorCode) noexcept
-	: Exception{formatErrono(errorCode)}
+	: Exception{DeferFormatting{}, IOExceptionType}
 	, _errorCode{errorCode}
 {
 }
 
 
 IOException::IOException(int errorCode, StringView msg) noexcept
-	: Exception{formatErrono(errorCode, msg)}
+	: Exception{DeferFormatting{}, msg}
 	, _errorCode{errorCode}
 {
 }
 
 
+IOException::IOException(IOException const& other) noexcept
+	: Exception{DeferFormatting{}, other}
+	, _errorCode{other._errorCode}
+{}
+
+
+void
+IOException::formatMessage(StringWriter& writer) const noexcept {
+	formatErrono(writer, _errorCode);
+}
+
+
 NotOpen::NotOpen() noexcept
 	: IOException{"File descriptor not opened"}
 {
     // No-op
 }
-
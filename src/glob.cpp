@@ -0,0 +1,553 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace
+ *	@file		glob.cpp
+ *	@brief		Implementation of compiled glob patterns
+ ******************************************************************************/
+#include "solace/glob.hpp"
+#include "solace/posixErrorDomain.hpp"
+
+#include <cstring>  // memcmp, memchr
+#include <limits>
+
+
+using namespace Solace;
+using namespace Solace::details;
+
+
+namespace {
+
+constexpr char kDelimiter = '/';
+constexpr uint32 kNoStar = std::numeric_limits<uint16>::max();
+
+
+/// Components of a string delimited by '/', split the same way Path::parse() does.
+struct StringComponents {
+	using Position = uint32;
+
+	StringView text;
+
+	constexpr Position begin() const noexcept { return 0; }
+
+	/// Trailing empty component is not a component, so the string ends once the position reaches its size.
+	constexpr bool atEnd(Position position) const noexcept { return position >= text.size(); }
+
+	Position delimiter(Position position) const noexcept {
+		auto const* const data = text.data();
+		auto const* const found = static_cast<char const*>(memchr(data + position, kDelimiter, text.size() - position));
+
+		return found ? static_cast<Position>(found - data) : text.size();
+	}
+
+	StringView get(Position position) const noexcept {
+		return text.substring(position, delimiter(position));
+	}
+
+	Position next(Position position) const noexcept {
+		return delimiter(position) + 1;
+	}
+};
+
+
+/// Components of a Path.
+struct PathComponents {
+	using Position = Path::size_type;
+
+	Path const& path;
+
+	constexpr Position begin() const noexcept { return 0; }
+	constexpr bool atEnd(Position position) const noexcept { return position >= path.getComponentsCount(); }
+	StringView get(Position position) const { return path.getComponent(position); }
+	constexpr Position next(Position position) const noexcept { return position + 1; }
+};
+
+
+/**
+ * Compiler of glob patterns.
+ * Pattern is compiled in two passes: the first one only counts elements of the automaton to allocate memory for,
+ * the second one, with output arrays set, fills them in.
+ */
+struct GlobCompiler {
+	GlobCharClass*	classes{nullptr};
+	GlobSegment*	segments{nullptr};
+	GlobToken*		tokens{nullptr};
+	char*			literals{nullptr};
+
+	uint32	nbClasses{0};
+	uint32	nbSegments{0};
+	uint32	nbTokens{0};
+	uint32	nbLiterals{0};
+	uint32	minComponents{0};
+	bool	anySegments{false};
+
+	void emitToken(GlobToken::Kind kind, byte value = 0, uint16 classIndex = 0) noexcept {
+		if (tokens) {
+			tokens[nbTokens] = GlobToken{kind, value, classIndex};
+		}
+
+		nbTokens += 1;
+	}
+
+	Result<void, Error> compileClass(StringView text, StringView::size_type& i) noexcept {
+		GlobCharClass charClass{{0, 0, 0, 0}};
+		auto add = [&charClass](byte c) { charClass.bits[c >> 6] |= uint64{1} << (c & 63); };
+
+		auto const size = text.size();
+		bool const negated = (i < size && (text[i] == '!' || text[i] == '^'));
+		if (negated) {
+			++i;
+		}
+
+		bool first = true;
+		for (; i < size && (first || text[i] != ']'); first = false) {
+			auto from = static_cast<byte>(text[i++]);
+			if (from == '\\' && i < size) {
+				from = static_cast<byte>(text[i++]);
+			}
+
+			auto to = from;
+			if (i + 1 < size && text[i] == '-' && text[i + 1] != ']') {
+				to = static_cast<byte>(text[i + 1]);
+				i += 2;
+				if (to == '\\' && i < size) {
+					to = static_cast<byte>(text[i++]);
+				}
+			}
+
+			if (to < from) {
+				return makeError(BasicError::InvalidInput, "makeGlobPattern: invalid range");
+			}
+
+			for (uint32 c = from; c <= to; ++c) {
+				add(static_cast<byte>(c));
+			}
+		}
+
+		if (i >= size) {
+			return makeError(BasicError::InvalidInput, "makeGlobPattern: unterminated '['");
+		}
+		++i;  // Closing ']'
+
+		if (negated) {
+			for (auto& bits : charClass.bits) {
+				bits = ~bits;
+			}
+		}
+
+		if (classes) {
+			classes[nbClasses] = charClass;
+		}
+		emitToken(GlobToken::Class, 0, static_cast<uint16>(nbClasses));
+		nbClasses += 1;
+
+		return Ok();
+	}
+
+	Result<void, Error> compileSegment(StringView text) noexcept {
+		GlobSegment segment{};
+		segment.firstToken = nbTokens;
+
+		if (text == "**") {
+			segment.anySegments = true;
+			anySegments = true;
+		} else {
+			minComponents += 1;
+
+			bool lastIsStar = false;
+			StringView::size_type i = 0;
+			while (i < text.size()) {
+				auto const c = text[i++];
+				if (c == '*') {
+					if (!lastIsStar) {  // Consecutive stars are the same as one
+						emitToken(GlobToken::Star);
+					}
+				} else if (c == '?') {
+					emitToken(GlobToken::AnyChar);
+				} else if (c == '[') {
+					auto result = compileClass(text, i);
+					if (!result) {
+						return result.moveError();
+					}
+				} else if (c == '\\') {
+					if (i >= text.size()) {
+						return makeError(BasicError::InvalidInput, "makeGlobPattern: trailing escape");
+					}
+					emitToken(GlobToken::Char, static_cast<byte>(text[i++]));
+				} else {
+					emitToken(GlobToken::Char, static_cast<byte>(c));
+				}
+
+				lastIsStar = (c == '*');
+			}
+		}
+
+		if (nbTokens - segment.firstToken > std::numeric_limits<uint16>::max() - 1) {
+			return makeError(BasicError::Overflow, "makeGlobPattern: segment is too long");
+		}
+		segment.nbTokens = static_cast<uint16>(nbTokens - segment.firstToken);
+
+		if (tokens) {
+			finishSegment(segment);
+		} else {  // Literal prefix and suffix are never longer than the segment
+			nbLiterals += segment.nbTokens;
+		}
+
+		if (segments) {
+			segments[nbSegments] = segment;
+		}
+		nbSegments += 1;
+
+		return Ok();
+	}
+
+	/// Compute length limits and literal prefix and suffix of a compiled segment.
+	void finishSegment(GlobSegment& segment) noexcept {
+		auto const* const first = tokens + segment.firstToken;
+		auto const count = segment.nbTokens;
+
+		segment.firstStar = count;
+		segment.lastStar = count;
+		for (uint16 t = 0; t < count; ++t) {
+			if (first[t].kind == GlobToken::Star) {
+				segment.firstStar = (segment.firstStar == count) ? t : segment.firstStar;
+				segment.lastStar = t;
+			} else {
+				segment.minLength += 1;
+			}
+		}
+
+		segment.literalOffset = nbLiterals;
+		while (segment.prefixLength < segment.firstStar && first[segment.prefixLength].kind == GlobToken::Char) {
+			literals[nbLiterals++] = static_cast<char>(first[segment.prefixLength].value);
+			segment.prefixLength += 1;
+		}
+
+		// Literal characters following the last star are checked as the suffix
+		if (segment.lastStar != count) {
+			for (auto t = count; t > segment.lastStar + 1 && first[t - 1].kind == GlobToken::Char; --t) {
+				segment.suffixLength += 1;
+			}
+
+			for (auto t = count - segment.suffixLength; t < count; ++t) {
+				literals[nbLiterals++] = static_cast<char>(first[t].value);
+			}
+		}
+	}
+
+	Result<void, Error> compile(StringView pattern) noexcept {
+		StringComponents const components{pattern};
+		for (auto p = components.begin(); !components.atEnd(p); p = components.next(p)) {
+			auto result = compileSegment(components.get(p));
+			if (!result) {
+				return result;
+			}
+		}
+
+		return Ok();
+	}
+};
+
+
+constexpr bool
+tokenMatches(GlobToken const& token, GlobCharClass const* classes, byte c) noexcept {
+	switch (token.kind) {
+	case GlobToken::Char:		return (token.value == c);
+	case GlobToken::AnyChar:	return true;
+	case GlobToken::Class:		return classes[token.classIndex].contains(c);
+	case GlobToken::Star:		return false;
+	}
+
+	return false;
+}
+
+}  // namespace
+
+
+
+
+GlobSubject
+Solace::details::describeGlobSubject(Path const& path) noexcept {
+	auto const count = path.getComponentsCount();
+	return {count, (count > 0) ? path.getComponent(count - 1) : StringView{}};
+}
+
+
+GlobSubject
+Solace::details::describeGlobSubject(StringView path) noexcept {
+	if (path.empty()) {
+		return {0, StringView{}};
+	}
+
+	auto const* const data = path.data();
+	StringView::size_type end = path.size();
+	uint64 count = 1;
+	if (data[end - 1] == kDelimiter) {  // Trailing empty component is ignored
+		end -= 1;
+	}
+
+	Optional<StringView::size_type> lastDelimiter;
+	for (StringView::size_type i = 0; i < end; ++i) {
+		if (data[i] == kDelimiter) {
+			count += 1;
+			lastDelimiter = i;
+		}
+	}
+
+	auto const lastStart = lastDelimiter ? *lastDelimiter + 1 : 0;
+	return {count, path.substring(lastStart, end)};
+}
+
+
+GlobCharClass const*
+GlobPattern::classes() const noexcept {
+	return static_cast<GlobCharClass const*>(_memory.view().dataAddress());
+}
+
+GlobSegment const*
+GlobPattern::segments() const noexcept {
+	return reinterpret_cast<GlobSegment const*>(classes() + _nbClasses);
+}
+
+GlobToken const*
+GlobPattern::tokens() const noexcept {
+	return reinterpret_cast<GlobToken const*>(segments() + _nbSegments);
+}
+
+char const*
+GlobPattern::literals() const noexcept {
+	return reinterpret_cast<char const*>(tokens() + _nbTokens);
+}
+
+
+bool
+GlobPattern::matchesSegment(GlobSegment const& segment, StringView component) const noexcept {
+	auto const size = component.size();
+	if (size < segment.minLength) {
+		return false;
+	}
+
+	auto const* const text = component.data();
+	auto const* const prefix = literals() + segment.literalOffset;
+	if (segment.prefixLength && memcmp(text, prefix, segment.prefixLength) != 0) {
+		return false;
+	}
+
+	auto const* const first = tokens() + segment.firstToken;
+	auto const* const charClasses = classes();
+	auto const matchChar = [first, charClasses](uint32 t, char c) {
+		return tokenMatches(first[t], charClasses, static_cast<byte>(c));
+	};
+
+	if (segment.firstStar == segment.nbTokens) {  // No wildcards of variable length
+		if (size != segment.minLength) {
+			return false;
+		}
+
+		for (uint32 t = segment.prefixLength; t < segment.nbTokens; ++t) {
+			if (!matchChar(t, text[t])) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	if (segment.suffixLength &&
+		memcmp(text + size - segment.suffixLength, prefix + segment.prefixLength, segment.suffixLength) != 0) {
+		return false;
+	}
+
+	// Match tokens between the literal prefix and suffix, backtracking to the last star on a mismatch
+	uint32 t = segment.prefixLength;
+	uint32 const tokensEnd = segment.nbTokens - segment.suffixLength;
+	uint32 i = segment.prefixLength;
+	uint32 const textEnd = size - segment.suffixLength;
+
+	uint32 starToken = kNoStar;
+	uint32 starText = i;
+	while (i < textEnd) {
+		if (t < tokensEnd && first[t].kind == GlobToken::Star) {
+			starToken = t++;
+			starText = i;
+		} else if (t < tokensEnd && matchChar(t, text[i])) {
+			t += 1;
+			i += 1;
+		} else if (starToken != kNoStar) {
+			t = starToken + 1;
+			i = ++starText;
+		} else {
+			return false;
+		}
+	}
+
+	while (t < tokensEnd && first[t].kind == GlobToken::Star) {
+		t += 1;
+	}
+
+	return (t == tokensEnd);
+}
+
+
+/**
+ * Match components against segments of a pattern.
+ * '**' segments are matched with backtracking to the last one seen, the same way '*' is matched within a segment.
+ */
+template<typename Components>
+bool
+GlobPattern::matchComponents(Components const& components) const noexcept {
+	auto const* const patternSegments = segments();
+	auto const nbSegments = _nbSegments;
+
+	uint32 s = 0;
+	auto c = components.begin();
+	uint32 starSegment = nbSegments;
+	auto starComponent = c;
+
+	while (!components.atEnd(c)) {
+		if (s < nbSegments && patternSegments[s].anySegments) {
+			starSegment = s++;
+			starComponent = c;
+		} else if (s < nbSegments && matchesSegment(patternSegments[s], components.get(c))) {
+			s += 1;
+			c = components.next(c);
+		} else if (starSegment != nbSegments) {
+			s = starSegment + 1;
+			starComponent = components.next(starComponent);
+			c = starComponent;
+		} else {
+			return false;
+		}
+	}
+
+	while (s < nbSegments && patternSegments[s].anySegments) {
+		s += 1;
+	}
+
+	return (s == nbSegments);
+}
+
+
+bool
+GlobPattern::matchesSubject(GlobSubject const& subject) const noexcept {
+	if (subject.nbComponents < _minComponents) {
+		return false;
+	}
+
+	if (!_anySegments && subject.nbComponents != _nbSegments) {
+		return false;
+	}
+
+	if (_nbSegments == 0) {
+		return true;
+	}
+
+	// Last segment, unless it is '**', can only match the last component: it is usually the most selective check
+	auto const& last = segments()[_nbSegments - 1];
+	return last.anySegments || matchesSegment(last, subject.lastComponent);
+}
+
+
+bool
+GlobPattern::matches(GlobSubject const& subject, Path const& path) const noexcept {
+	return matchesSubject(subject) && matchComponents(PathComponents{path});
+}
+
+
+bool
+GlobPattern::matches(GlobSubject const& subject, StringView path) const noexcept {
+	return matchesSubject(subject) && matchComponents(StringComponents{path});
+}
+
+
+bool
+GlobPattern::matches(Path const& path) const noexcept {
+	return matches(describeGlobSubject(path), path);
+}
+
+
+bool
+GlobPattern::matches(StringView path) const noexcept {
+	return matches(describeGlobSubject(path), path);
+}
+
+
+Result<GlobPattern, Error>
+Solace::makeGlobPattern(MemoryManager& memoryManager, StringView pattern) {
+	GlobCompiler counter;
+	auto counted = counter.compile(pattern);
+	if (!counted) {
+		return counted.moveError();
+	}
+
+	auto const size = counter.nbClasses * sizeof(GlobCharClass) +
+			counter.nbSegments * sizeof(GlobSegment) +
+			counter.nbTokens * sizeof(GlobToken) +
+			counter.nbLiterals;
+
+	auto maybeMemory = memoryManager.allocate(size);
+	if (!maybeMemory) {
+		return maybeMemory.moveError();
+	}
+
+	auto memory = maybeMemory.moveResult();
+	auto* const base = static_cast<byte*>(memory.view().dataAddress());
+
+	GlobCompiler compiler;
+	compiler.classes = reinterpret_cast<GlobCharClass*>(base);
+	compiler.segments = reinterpret_cast<GlobSegment*>(compiler.classes + counter.nbClasses);
+	compiler.tokens = reinterpret_cast<GlobToken*>(compiler.segments + counter.nbSegments);
+	compiler.literals = reinterpret_cast<char*>(compiler.tokens + counter.nbTokens);
+
+	auto compiled = compiler.compile(pattern);
+	if (!compiled) {
+		return compiled.moveError();
+	}
+
+	return Result<GlobPattern, Error>{types::okTag, in_place,
+			GlobPattern{mv(memory), compiler.nbClasses, compiler.nbSegments, compiler.nbTokens,
+						compiler.minComponents, compiler.anySegments}};
+}
+
+
+Result<GlobPattern, Error>
+Solace::makeGlobPattern(StringView pattern) {
+	return makeGlobPattern(getSystemHeapMemoryManager(), pattern);
+}
+
+
+Result<GlobSet, Error>
+Solace::makeGlobSet(MemoryManager& memoryManager, ArrayView<StringView const> patterns) {
+	auto maybePatterns = makeVector<GlobPattern>(memoryManager, patterns.size());
+	if (!maybePatterns) {
+		return maybePatterns.moveError();
+	}
+
+	auto& compiled = maybePatterns.unwrap();
+	for (auto pattern : patterns) {
+		auto maybePattern = makeGlobPattern(memoryManager, pattern);
+		if (!maybePattern) {
+			return maybePattern.moveError();
+		}
+
+		auto added = compiled.emplace_back(maybePattern.moveResult());
+		if (!added) {
+			return added.moveError();
+		}
+	}
+
+	return Result<GlobSet, Error>{types::okTag, in_place, maybePatterns.moveResult()};
+}
@@ -0,0 +1,197 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace
+ *	@file		solace/hashing/crc32c.cpp
+ *	@brief		Implementation of CRC-32C checksum
+ ******************************************************************************/
+#include "solace/hashing/crc32c.hpp"
+#include "solace/cpuFeatures.hpp"
+#include "solace/byteWriter.hpp"
+#include "solace/probe.hpp"
+
+#include <cstring>  // memcpy
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#endif
+
+using namespace Solace;
+using namespace Solace::hashing;
+
+static const StringLiteral CRC32C_NAME = "CRC32C";
+
+
+namespace {
+
+/// Reversed Castagnoli polynomial 0x1EDC6F41
+constexpr uint32 kPolynomial = 0x82F63B78;
+
+/// Tables for slicing-by-8: table[k][b] is CRC of byte b followed by k zero bytes
+struct Crc32cTables {
+	uint32	table[8][256];
+
+	constexpr Crc32cTables() noexcept
+		: table{}
+	{
+		for (uint32 b = 0; b < 256; ++b) {
+			uint32 crc = b;
+			for (int i = 0; i < 8; ++i) {
+				crc = (crc >> 1) ^ ((crc & 1) ? kPolynomial : 0);
+			}
+			table[0][b] = crc;
+		}
+
+		for (uint32 b = 0; b < 256; ++b) {
+			for (int k = 1; k < 8; ++k) {
+				table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xFF];
+			}
+		}
+	}
+};
+
+constexpr Crc32cTables kTables{};
+
+
+uint32 crc32cScalar(byte const* data, size_t size, uint32 crc) {
+	auto const& t = kTables.table;
+	crc = ~crc;
+
+	while (size >= 8) {
+		uint32 low;
+		uint32 high;
+		memcpy(&low, data, sizeof(low));
+		memcpy(&high, data + sizeof(low), sizeof(high));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		low = __builtin_bswap32(low);
+		high = __builtin_bswap32(high);
+#endif
+		low ^= crc;
+		crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+			  t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+
+		data += 8;
+		size -= 8;
+	}
+
+	while (size--) {
+		crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+	}
+
+	return ~crc;
+}
+
+
+#if defined(__x86_64__)
+
+__attribute__((target("sse4.2")))
+uint32 crc32cSse42(byte const* data, size_t size, uint32 crc) {
+	uint64 crc64 = ~crc;
+
+	while (size >= 8) {
+		uint64 value;
+		memcpy(&value, data, sizeof(value));
+		crc64 = _mm_crc32_u64(crc64, value);
+
+		data += 8;
+		size -= 8;
+	}
+
+	auto crc32 = static_cast<uint32>(crc64);
+	while (size--) {
+		crc32 = _mm_crc32_u8(crc32, *data++);
+	}
+
+	return ~crc32;
+}
+
+KernelDispatch<uint32(byte const*, size_t, uint32)>::Candidate const kCandidates[] = {
+	{{CpuFeature::SSE4_2}, crc32cSse42},
+};
+
+KernelDispatch<uint32(byte const*, size_t, uint32)> const crc32cKernel{kCandidates, crc32cScalar};
+
+#elif defined(__aarch64__)
+
+__attribute__((target("+crc")))
+uint32 crc32cArm(byte const* data, size_t size, uint32 crc) {
+	crc = ~crc;
+
+	while (size >= 8) {
+		uint64 value;
+		memcpy(&value, data, sizeof(value));
+		crc = __crc32cd(crc, value);
+
+		data += 8;
+		size -= 8;
+	}
+
+	while (size--) {
+		crc = __crc32cb(crc, *data++);
+	}
+
+	return ~crc;
+}
+
+KernelDispatch<uint32(byte const*, size_t, uint32)>::Candidate const kCandidates[] = {
+	{{CpuFeature::ARM_CRC32}, crc32cArm},
+};
+
+KernelDispatch<uint32(byte const*, size_t, uint32)> const crc32cKernel{kCandidates, crc32cScalar};
+
+#else
+
+KernelDispatch<uint32(byte const*, size_t, uint32)> const crc32cKernel{crc32cScalar};
+
+#endif
+
+}  // namespace
+
+
+uint32
+Solace::hashing::crc32c(MemoryView data, uint32 crc) noexcept {
+	return crc32cKernel(data.begin(), data.size(), crc);
+}
+
+
+StringView CRC32C::getAlgorithm() const {
+    return CRC32C_NAME;
+}
+
+
+CRC32C::size_type
+CRC32C::getDigestLength() const {
+    return 32;
+}
+
+
+HashingAlgorithm& CRC32C::update(MemoryView input) {
+	SOLACE_PROBE("CRC32C::update");
+	_crc = crc32c(input, _crc);
+
+    return (*this);
+}
+
+
+MessageDigest CRC32C::digest() {
+    byte result[4];
+    ByteWriter writer{wrapMemory(result)};
+    writer.writeBE(_crc);
+
+    return MessageDigest(writer.viewWritten());
+}
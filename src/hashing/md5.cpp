@@ -19,6 +19,7 @@
  *	@brief		Implementation of MD5 hashing algorithm
  ******************************************************************************/
 #include "solace/hashing/md5.hpp"
+#include "solace/probe.hpp"
 
 #include <cstring>  // memcpy
 
@@ -203,6 +204,7 @@ MD5::size_type MD5::getDigestLength() const {
 
 HashingAlgorithm&
 MD5::update(MemoryView input) {
+	SOLACE_PROBE("MD5::update");
 	md5_update(_state, input.begin(), input.size());
 
     return (*this);
@@ -12,6 +12,7 @@
  *	@brief		Implementation of Murmur3 hashing algorithm.
  ******************************************************************************/
 #include "solace/hashing/murmur3.hpp"
+#include "solace/probe.hpp"
 
 using namespace Solace;
 using namespace Solace::hashing;
@@ -329,6 +330,7 @@ Murmur3_32::getDigestLength() const {
 
 
 HashingAlgorithm& Murmur3_32::update(MemoryView input) {
+	SOLACE_PROBE("Murmur3_32::update");
 	_hash[0] = murmurhash3_x86_32(input.begin(), input.size(), _seed);
 
     return (*this);
@@ -361,6 +363,7 @@ Murmur3_128::size_type Murmur3_128::getDigestLength() const {
 
 
 HashingAlgorithm& Murmur3_128::update(MemoryView input) {
+	SOLACE_PROBE("Murmur3_128::update");
 #if  defined(__i386__) || defined(__arm__)
 	MurmurHash3_x86_128(input.begin(), input.size(), _seed, _hash);
 #elif  defined(__x86_64__) ||  defined(__aarch64__)
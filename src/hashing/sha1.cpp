@@ -19,6 +19,7 @@
  *	@brief		Implementation of SHA-1 hashing algorithm
  ******************************************************************************/
 #include "solace/hashing/sha1.hpp"
+#include "solace/probe.hpp"
 
 #include <cstring>  // memcpy
 
@@ -240,6 +241,7 @@ Sha1::size_type Sha1::getDigestLength() const {
 
 
 HashingAlgorithm& Sha1::update(MemoryView input) {
+	SOLACE_PROBE("Sha1::update");
 	sha1_update(_state, input.begin(), input.size());
 
     return (*this);
@@ -19,6 +19,7 @@
  *	@brief		Implementation of SHA-2 hashing algorithm
  ******************************************************************************/
 #include "solace/hashing/sha2.hpp"
+#include "solace/probe.hpp"
 
 #include <cstring>  // memcpy
 
@@ -212,6 +213,7 @@ Sha256::size_type Sha256::getDigestLength() const {
 
 
 HashingAlgorithm& Sha256::update(MemoryView input) {
+	SOLACE_PROBE("Sha256::update");
 	sha256_update(_state, input.begin(), input.size());
 
     return (*this);
@@ -0,0 +1,219 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Asynchronous byte stream
+ *	@file		io/asyncStream.cpp
+ *	@brief		Implementation of asynchronous stream operations
+ ******************************************************************************/
+#include "solace/io/asyncStream.hpp"
+#include "solace/posixErrorDomain.hpp"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+
+using namespace Solace;
+using namespace Solace::io;
+
+
+namespace {
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+inline bool wouldBlock(int error) noexcept {
+#if EAGAIN != EWOULDBLOCK
+	return (error == EAGAIN) || (error == EWOULDBLOCK);
+#else
+	return (error == EAGAIN);
+#endif
+}
+
+}  // namespace
+
+
+AsyncStream::~AsyncStream() {
+	if (_reactor) {
+		_reactor->remove(_watch);
+	}
+}
+
+
+AsyncStream::AsyncStream(AsyncStream&& rhs) noexcept
+	: _reactor{exchange(rhs._reactor, nullptr)}
+	, _watch{exchange(rhs._watch, IoWatch{})}
+	, _isSocket{rhs._isSocket}
+	, _buffer{rhs._buffer}
+{
+	assertTrue(!_watch.reader && !_watch.writer, "AsyncStream: can not move a stream with operations pending");
+
+	if (_reactor && _watch.isRegistered) {
+		// Registration refers to the address of the watch: point it to the new location
+		if (!_reactor->rebind(_watch)) {
+			_watch.isRegistered = false;
+		}
+	}
+}
+
+
+bool
+AsyncStream::ReadSome::advance() {
+	if (_result) {
+		return true;
+	}
+
+	auto& watch = _stream->_watch;
+	for (;;) {
+		auto const nbRead = ::read(watch.fd, _destination.dataAddress(), _destination.size());
+		if (nbRead >= 0) {
+			_result = Result<MemoryView, Error>{types::okTag, _destination.slice(0, static_cast<size_type>(nbRead))};
+			return true;
+		}
+
+		if (errno == EINTR) {
+			continue;
+		}
+
+		if (!wouldBlock(errno)) {
+			_result = Result<MemoryView, Error>{types::errTag, makeErrno("read")};
+			return true;
+		}
+
+		auto waiting = _stream->_reactor->awaitReadable(watch, *this);
+		if (!waiting) {
+			_result = Result<MemoryView, Error>{types::errTag, waiting.moveError()};
+			return true;
+		}
+
+		return false;
+	}
+}
+
+
+bool
+AsyncStream::ReadExactly::advance() {
+	if (_result) {
+		return true;
+	}
+
+	auto& buffer = _stream->_buffer;
+	if (_nbBytes > buffer.size()) {
+		_result = Result<ByteReader, Error>{types::errTag, makeError(BasicError::Overflow, "readExactly")};
+		return true;
+	}
+
+	auto& watch = _stream->_watch;
+	while (_nbRead < _nbBytes) {
+		auto const nbRead = ::read(watch.fd, static_cast<byte*>(buffer.dataAddress()) + _nbRead, _nbBytes - _nbRead);
+		if (nbRead > 0) {
+			_nbRead += static_cast<size_type>(nbRead);
+			continue;
+		}
+
+		if (nbRead == 0) {
+			_result = Result<ByteReader, Error>{types::errTag, makeError(SystemErrors::NODATA, "readExactly")};
+			return true;
+		}
+
+		if (errno == EINTR) {
+			continue;
+		}
+
+		if (!wouldBlock(errno)) {
+			_result = Result<ByteReader, Error>{types::errTag, makeErrno("read")};
+			return true;
+		}
+
+		auto waiting = _stream->_reactor->awaitReadable(watch, *this);
+		if (!waiting) {
+			_result = Result<ByteReader, Error>{types::errTag, waiting.moveError()};
+			return true;
+		}
+
+		return false;
+	}
+
+	_result = Result<ByteReader, Error>{types::okTag, MemoryView{buffer.slice(0, _nbBytes)}};
+	return true;
+}
+
+
+bool
+AsyncStream::Write::advance() {
+	if (_result) {
+		return true;
+	}
+
+	auto& watch = _stream->_watch;
+	while (_nbWritten < _data.size()) {
+		auto const data = static_cast<byte const*>(_data.dataAddress()) + _nbWritten;
+		auto const size = _data.size() - _nbWritten;
+		auto const nbWritten = _stream->_isSocket
+				? ::send(watch.fd, data, size, kSendFlags)
+				: ::write(watch.fd, data, size);
+
+		if (nbWritten >= 0) {
+			_nbWritten += static_cast<size_type>(nbWritten);
+			continue;
+		}
+
+		if (errno == EINTR) {
+			continue;
+		}
+
+		if (!wouldBlock(errno)) {
+			_result = Result<void, Error>{types::errTag, makeErrno("write")};
+			return true;
+		}
+
+		auto waiting = _stream->_reactor->awaitWritable(watch, *this);
+		if (!waiting) {
+			_result = Result<void, Error>{types::errTag, waiting.moveError()};
+			return true;
+		}
+
+		return false;
+	}
+
+	_result = Result<void, Error>{types::okTag};
+	return true;
+}
+
+
+Result<AsyncStream, Error>
+Solace::io::makeAsyncStream(Reactor& reactor, int fd, MutableMemoryView buffer) {
+	auto const flags = fcntl(fd, F_GETFL);
+	if (flags < 0) {
+		return makeErrno("fcntl");
+	}
+
+	if (!(flags & O_NONBLOCK) && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+		return makeErrno("fcntl");
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		return makeErrno("fstat");
+	}
+
+	return Ok(AsyncStream{reactor, fd, S_ISSOCK(info.st_mode), buffer});
+}
@@ -0,0 +1,135 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Pool of I/O buffers
+ *	@file		io/bufferPool.cpp
+ *	@brief		Implementation of the buffer pool
+ ******************************************************************************/
+#include "solace/io/bufferPool.hpp"
+#include "solace/posixErrorDomain.hpp"
+
+
+using namespace Solace;
+using namespace Solace::io;
+
+
+namespace {
+
+constexpr uint64 kBufferAlignment = 64;
+
+constexpr uint64 alignUp(uint64 value, uint64 alignment) noexcept {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}  // namespace
+
+
+namespace Solace { namespace io { namespace details {
+
+/**
+ * Pool state lives at the start of the pool memory block so that buffers can refer to it
+ * regardless of the pool object being moved.
+ */
+struct BufferPoolState final : public MemoryResource::Disposer {
+	byte*		buffers{nullptr};
+	uint32*		freeList{nullptr};
+	uint32		bufferSize{0};
+	uint32		nbBuffers{0};
+	uint32		nbFree{0};
+
+	void dispose(MemoryView* view) const override {
+		auto const offset = static_cast<byte const*>(view->dataAddress()) - buffers;
+		auto self = const_cast<BufferPoolState*>(this);
+		self->freeList[self->nbFree++] = static_cast<uint32>(offset / bufferSize);
+	}
+};
+
+}}}  // namespace Solace::io::details
+
+
+BufferPool::~BufferPool() {
+	if (_state) {
+		assertTrue(_state->nbFree == _state->nbBuffers, "BufferPool: buffers in use when the pool is destroyed");
+		dtor(*exchange(_state, nullptr));
+	}
+}
+
+
+Result<MemoryResource, Error>
+BufferPool::acquire() noexcept {
+	if (!_state || _state->nbFree == 0) {
+		return makeError(GenericError::AGAIN, "BufferPool::acquire");
+	}
+
+	auto const index = _state->freeList[--_state->nbFree];
+	auto data = _state->buffers + uint64{index} * _state->bufferSize;
+
+	return Ok(MemoryResource{wrapMemory(data, _state->bufferSize), _state});
+}
+
+
+BufferPool::size_type
+BufferPool::bufferSize() const noexcept {
+	return _state ? _state->bufferSize : 0;
+}
+
+
+uint32
+BufferPool::capacity() const noexcept {
+	return _state ? _state->nbBuffers : 0;
+}
+
+
+uint32
+BufferPool::available() const noexcept {
+	return _state ? _state->nbFree : 0;
+}
+
+
+Result<BufferPool, Error>
+Solace::io::makeBufferPool(MemoryManager& memoryManager, BufferPool::size_type bufferSize, uint32 nbBuffers) {
+	if (bufferSize == 0 || nbBuffers == 0) {
+		return makeError(GenericError::INVAL, "makeBufferPool");
+	}
+
+	uint64 const freeListOffset = alignUp(sizeof(details::BufferPoolState), alignof(uint32));
+	uint64 const buffersOffset = alignUp(freeListOffset + uint64{nbBuffers} * sizeof(uint32), kBufferAlignment);
+	uint64 const totalSize = buffersOffset + uint64{nbBuffers} * bufferSize + kBufferAlignment;
+	if (totalSize > std::numeric_limits<MemoryManager::size_type>::max()) {
+		return makeError(GenericError::NOMEM, "makeBufferPool");
+	}
+
+	auto maybeMemory = memoryManager.allocate(static_cast<MemoryManager::size_type>(totalSize));
+	if (!maybeMemory) {
+		return maybeMemory.moveError();
+	}
+
+	auto& memory = *maybeMemory;
+	auto const baseAddress = reinterpret_cast<uintptr_t>(memory.view().dataAddress());
+	auto const base = reinterpret_cast<byte*>(alignUp(baseAddress, kBufferAlignment));
+
+	auto state = ctor(*reinterpret_cast<details::BufferPoolState*>(base));
+	state->freeList = reinterpret_cast<uint32*>(base + freeListOffset);
+	state->buffers = base + buffersOffset;
+	state->bufferSize = bufferSize;
+	state->nbBuffers = nbBuffers;
+	state->nbFree = nbBuffers;
+	for (uint32 i = 0; i < nbBuffers; ++i) {
+		state->freeList[i] = nbBuffers - i - 1;
+	}
+
+	return Ok(BufferPool{mv(memory), state});
+}
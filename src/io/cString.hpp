@@ -0,0 +1,53 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Null-terminated strings for system calls
+ *	@file		io/cString.hpp
+ *	@brief		Helpers shared by io implementation files. Not a part of the public interface.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_IO_CSTRING_HPP
+#define SOLACE_IO_CSTRING_HPP
+
+#include "solace/stringView.hpp"
+
+#include <cstring>  // memcpy
+
+
+namespace Solace {
+namespace io {
+namespace details {
+
+/**
+ * Copy a string view into a null-terminated buffer, as expected by system calls.
+ * @return False if the string does not fit into the buffer along with the terminator.
+ */
+inline bool
+copyCString(StringView value, char* dest, size_t destSize) noexcept {
+	if (value.size() >= destSize) {
+		return false;
+	}
+
+	memcpy(dest, value.data(), value.size());
+	dest[value.size()] = 0;
+
+	return true;
+}
+
+}  // namespace details
+}  // namespace io
+}  // namespace Solace
+#endif  // SOLACE_IO_CSTRING_HPP
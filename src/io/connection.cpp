@@ -0,0 +1,439 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Connections
+ *	@file		io/connection.cpp
+ *	@brief		Implementation of reactor driven connections
+ ******************************************************************************/
+#include "solace/io/connection.hpp"
+#include "solace/posixErrorDomain.hpp"
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <sys/socket.h>
+
+
+using namespace Solace;
+using namespace Solace::io;
+
+
+namespace {
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+inline bool wouldBlock(int error) noexcept {
+#if EAGAIN != EWOULDBLOCK
+	return (error == EAGAIN) || (error == EWOULDBLOCK);
+#else
+	return (error == EAGAIN);
+#endif
+}
+
+}  // namespace
+
+
+SocketChannel::~SocketChannel() {
+	if (_reactor && _socket) {
+		_reactor->remove(_watch);
+	}
+}
+
+
+SocketChannel::SocketChannel(SocketChannel&& rhs) noexcept
+	: _reactor{exchange(rhs._reactor, nullptr)}
+	, _socket{mv(rhs._socket)}
+	, _watch{exchange(rhs._watch, IoWatch{})}
+{
+	assertTrue(!_watch.reader && !_watch.writer, "SocketChannel: can not move a channel with operations pending");
+
+	if (_reactor && _watch.isRegistered) {
+		// Registration refers to the address of the watch: point it to the new location
+		if (!_reactor->rebind(_watch)) {
+			_watch.isRegistered = false;
+		}
+	}
+}
+
+
+StreamConnection::StreamConnection(StreamConnection&& rhs) noexcept
+	: SocketChannel{mv(rhs)}
+	, _pool{rhs._pool}
+	, _queueHead{exchange(rhs._queueHead, 0)}
+	, _queueSize{exchange(rhs._queueSize, 0)}
+{
+	memcpy(_queue, rhs._queue, sizeof(_queue));
+}
+
+
+Result<void, Error>
+StreamConnection::queue(MemoryView data) noexcept {
+	if (data.empty()) {
+		return Ok();
+	}
+
+	if (_queueSize == kMaxQueuedWrites) {
+		return makeError(BasicError::Overflow, "StreamConnection::queue");
+	}
+
+	if (_queueHead + _queueSize == kMaxQueuedWrites) {  // Compact the queue to the front
+		memmove(_queue, _queue + _queueHead, _queueSize * sizeof(iovec));
+		_queueHead = 0;
+	}
+
+	auto& entry = _queue[_queueHead + _queueSize];
+	entry.iov_base = const_cast<void*>(data.dataAddress());
+	entry.iov_len = data.size();
+	_queueSize += 1;
+
+	return Ok();
+}
+
+
+bool
+StreamConnection::Connect::advance() {
+	if (_result) {
+		return true;
+	}
+
+	auto& connection = *_connection;
+	int error = 0;
+	socklen_t errorSize = sizeof(error);
+	if (getsockopt(connection.fd(), SOL_SOCKET, SO_ERROR, &error, &errorSize) != 0) {
+		_result = Result<void, Error>{types::errTag, makeErrno("getsockopt")};
+		return true;
+	}
+
+	if (error != 0 && error != EINPROGRESS) {
+		_result = Result<void, Error>{types::errTag, makeSystemError(error, "connect")};
+		return true;
+	}
+
+	// Connected once the peer address is known
+	sockaddr_storage peer;
+	socklen_t peerSize = sizeof(peer);
+	if (getpeername(connection.fd(), reinterpret_cast<sockaddr*>(&peer), &peerSize) == 0) {
+		_result = Result<void, Error>{types::okTag};
+		return true;
+	}
+
+	if (errno != ENOTCONN) {
+		_result = Result<void, Error>{types::errTag, makeErrno("getpeername")};
+		return true;
+	}
+
+	auto waiting = connection._reactor->awaitWritable(connection._watch, *this);
+	if (!waiting) {
+		_result = Result<void, Error>{types::errTag, waiting.moveError()};
+		return true;
+	}
+
+	return false;
+}
+
+
+bool
+StreamConnection::Read::advance() {
+	if (_result) {
+		return true;
+	}
+
+	auto& connection = *_connection;
+	auto maybeBuffer = connection._pool->acquire();
+	if (!maybeBuffer) {
+		_result = Result<ByteReader, Error>{types::errTag, maybeBuffer.moveError()};
+		return true;
+	}
+
+	auto& buffer = *maybeBuffer;
+	for (;;) {
+		auto const nbRead = ::recv(connection.fd(), buffer.view().dataAddress(), buffer.size(), 0);
+		if (nbRead >= 0) {
+			ByteReader reader{mv(buffer)};
+			reader.limit(static_cast<ByteReader::size_type>(nbRead));
+			_result = Result<ByteReader, Error>{types::okTag, mv(reader)};
+			return true;
+		}
+
+		if (errno == EINTR) {
+			continue;
+		}
+
+		if (!wouldBlock(errno)) {
+			_result = Result<ByteReader, Error>{types::errTag, makeErrno("recv")};
+			return true;
+		}
+
+		// Buffer goes back into the pool while waiting
+		auto waiting = connection._reactor->awaitReadable(connection._watch, *this);
+		if (!waiting) {
+			_result = Result<ByteReader, Error>{types::errTag, waiting.moveError()};
+			return true;
+		}
+
+		return false;
+	}
+}
+
+
+bool
+StreamConnection::Flush::advance() {
+	if (_result) {
+		return true;
+	}
+
+	auto& connection = *_connection;
+	while (connection._queueSize > 0) {
+		auto const batch = (connection._queueSize < IOV_MAX) ? connection._queueSize : IOV_MAX;
+
+		msghdr message{};
+		message.msg_iov = connection._queue + connection._queueHead;
+		message.msg_iovlen = batch;
+
+		auto nbWritten = ::sendmsg(connection.fd(), &message, kSendFlags);
+		if (nbWritten < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			if (!wouldBlock(errno)) {
+				_result = Result<void, Error>{types::errTag, makeErrno("sendmsg")};
+				return true;
+			}
+
+			auto waiting = connection._reactor->awaitWritable(connection._watch, *this);
+			if (!waiting) {
+				_result = Result<void, Error>{types::errTag, waiting.moveError()};
+				return true;
+			}
+
+			return false;
+		}
+
+		// Drop fully written views and adjust partially written one
+		while (connection._queueSize > 0) {
+			auto& head = connection._queue[connection._queueHead];
+			if (static_cast<size_t>(nbWritten) < head.iov_len) {
+				head.iov_base = static_cast<byte*>(head.iov_base) + nbWritten;
+				head.iov_len -= static_cast<size_t>(nbWritten);
+				break;
+			}
+
+			nbWritten -= static_cast<ssize_t>(head.iov_len);
+			connection._queueHead += 1;
+			connection._queueSize -= 1;
+		}
+	}
+
+	connection._queueHead = 0;
+	_result = Result<void, Error>{types::okTag};
+
+	return true;
+}
+
+
+bool
+Listener::Accept::advance() {
+	if (_result) {
+		return true;
+	}
+
+	auto& listener = *_listener;
+	for (;;) {
+		Socket socket{::accept4(listener.fd(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)};
+		if (socket) {
+			_result = Result<Socket, Error>{types::okTag, mv(socket)};
+			return true;
+		}
+
+		if (errno == EINTR || errno == ECONNABORTED) {
+			continue;
+		}
+
+		if (!wouldBlock(errno)) {
+			_result = Result<Socket, Error>{types::errTag, makeErrno("accept")};
+			return true;
+		}
+
+		auto waiting = listener._reactor->awaitReadable(listener._watch, *this);
+		if (!waiting) {
+			_result = Result<Socket, Error>{types::errTag, waiting.moveError()};
+			return true;
+		}
+
+		return false;
+	}
+}
+
+
+bool
+DatagramChannel::ReceiveBatch::advance() {
+	if (_result) {
+		return true;
+	}
+
+	auto& channel = *_channel;
+	uint32 const maxBatch = (_datagrams.size() < kMaxBatchSize) ? _datagrams.size() : kMaxBatchSize;
+	uint32 const batchSize = (maxBatch < channel._pool->available()) ? maxBatch : channel._pool->available();
+	if (batchSize == 0) {
+		_result = Result<uint32, Error>{types::errTag,
+				makeError(_datagrams.empty() ? GenericError::INVAL : GenericError::AGAIN, "receive")};
+		return true;
+	}
+
+	MemoryResource buffers[kMaxBatchSize];
+	iovec vectors[kMaxBatchSize];
+	mmsghdr messages[kMaxBatchSize];
+	memset(messages, 0, sizeof(messages));
+
+	for (uint32 i = 0; i < batchSize; ++i) {
+		buffers[i] = channel._pool->acquire().moveResult();
+		vectors[i].iov_base = buffers[i].view().dataAddress();
+		vectors[i].iov_len = buffers[i].size();
+
+		auto& header = messages[i].msg_hdr;
+		header.msg_iov = &vectors[i];
+		header.msg_iovlen = 1;
+		header.msg_name = _datagrams[i].peer.address();
+		header.msg_namelen = sizeof(_datagrams[i].peer.storage);
+	}
+
+	for (;;) {
+		auto const nbReceived = ::recvmmsg(channel.fd(), messages, batchSize, MSG_DONTWAIT, nullptr);
+		if (nbReceived > 0) {
+			for (int i = 0; i < nbReceived; ++i) {
+				auto& datagram = _datagrams[static_cast<uint32>(i)];
+				datagram.peer.size = messages[i].msg_hdr.msg_namelen;
+				datagram.peer.type = SOCK_DGRAM;
+				datagram.data = ByteReader{mv(buffers[i])};
+				datagram.data.limit(static_cast<ByteReader::size_type>(messages[i].msg_len));
+			}
+
+			_result = Result<uint32, Error>{types::okTag, static_cast<uint32>(nbReceived)};
+			return true;
+		}
+
+		if (nbReceived < 0 && errno == EINTR) {
+			continue;
+		}
+
+		if (nbReceived < 0 && !wouldBlock(errno)) {
+			_result = Result<uint32, Error>{types::errTag, makeErrno("recvmmsg")};
+			return true;
+		}
+
+		auto waiting = channel._reactor->awaitReadable(channel._watch, *this);
+		if (!waiting) {
+			_result = Result<uint32, Error>{types::errTag, waiting.moveError()};
+			return true;
+		}
+
+		return false;
+	}
+}
+
+
+bool
+DatagramChannel::SendBatch::advance() {
+	if (_result) {
+		return true;
+	}
+
+	auto& channel = *_channel;
+	while (_nbSent < _datagrams.size()) {
+		uint32 const remaining = _datagrams.size() - _nbSent;
+		uint32 const batchSize = (remaining < kMaxBatchSize) ? remaining : kMaxBatchSize;
+
+		iovec vectors[kMaxBatchSize];
+		mmsghdr messages[kMaxBatchSize];
+		memset(messages, 0, sizeof(messages));
+
+		for (uint32 i = 0; i < batchSize; ++i) {
+			auto const& datagram = _datagrams[_nbSent + i];
+			vectors[i].iov_base = const_cast<void*>(datagram.data.dataAddress());
+			vectors[i].iov_len = datagram.data.size();
+
+			auto& header = messages[i].msg_hdr;
+			header.msg_iov = &vectors[i];
+			header.msg_iovlen = 1;
+			if (datagram.peer) {
+				header.msg_name = const_cast<sockaddr*>(datagram.peer->address());
+				header.msg_namelen = datagram.peer->size;
+			}
+		}
+
+		auto const nbSent = ::sendmmsg(channel.fd(), messages, batchSize, kSendFlags);
+		if (nbSent > 0) {
+			_nbSent += static_cast<uint32>(nbSent);
+			continue;
+		}
+
+		if (nbSent < 0 && errno == EINTR) {
+			continue;
+		}
+
+		if (nbSent < 0 && !wouldBlock(errno)) {
+			_result = Result<void, Error>{types::errTag, makeErrno("sendmmsg")};
+			return true;
+		}
+
+		auto waiting = channel._reactor->awaitWritable(channel._watch, *this);
+		if (!waiting) {
+			_result = Result<void, Error>{types::errTag, waiting.moveError()};
+			return true;
+		}
+
+		return false;
+	}
+
+	_result = Result<void, Error>{types::okTag};
+
+	return true;
+}
+
+
+Result<StreamConnection, Error>
+Solace::io::makeConnection(Reactor& reactor, BufferPool& pool, Socket&& socket) {
+	if (!socket) {
+		return makeError(GenericError::BADF, "makeConnection");
+	}
+
+	return Ok(StreamConnection{reactor, pool, mv(socket)});
+}
+
+
+Result<Listener, Error>
+Solace::io::makeListener(Reactor& reactor, Socket&& socket) {
+	if (!socket) {
+		return makeError(GenericError::BADF, "makeListener");
+	}
+
+	return Ok(Listener{reactor, mv(socket)});
+}
+
+
+Result<DatagramChannel, Error>
+Solace::io::makeDatagramChannel(Reactor& reactor, BufferPool& pool, Socket&& socket) {
+	if (!socket) {
+		return makeError(GenericError::BADF, "makeDatagramChannel");
+	}
+
+	return Ok(DatagramChannel{reactor, pool, mv(socket)});
+}
@@ -0,0 +1,147 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Memory mapped file
+ *	@file		io/mappedFile.cpp
+ *	@brief		Implementation of the memory mapped file
+ ******************************************************************************/
+#include "solace/io/mappedFile.hpp"
+#include "solace/posixErrorDomain.hpp"
+
+#include "cString.hpp"
+
+#include <climits>  // PATH_MAX
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+using namespace Solace;
+using namespace Solace::io;
+
+
+namespace {
+
+int adviceFor(MappedFile::Access access) noexcept {
+	switch (access) {
+	case MappedFile::Access::Normal:		return MADV_NORMAL;
+	case MappedFile::Access::Sequential:	return MADV_SEQUENTIAL;
+	case MappedFile::Access::Random:		return MADV_RANDOM;
+	}
+
+	return MADV_NORMAL;
+}
+
+
+/// Disposer of memory resources owning a mapping.
+class UnmapDisposer final : public MemoryResource::Disposer {
+public:
+	void dispose(MemoryView* view) const override {
+		munmap(const_cast<void*>(view->dataAddress()), view->size());
+	}
+};
+
+UnmapDisposer unmapDisposer;
+
+}  // namespace
+
+
+MappedFile::~MappedFile() {
+	if (_address) {
+		munmap(_address, _size);
+	}
+}
+
+
+Result<MappedFile, Error>
+MappedFile::open(StringView path, Access access) noexcept {
+	char pathBuffer[PATH_MAX];
+	if (path.empty() || !io::details::copyCString(path, pathBuffer, sizeof(pathBuffer))) {
+		return makeError(BasicError::InvalidInput, "MappedFile::open");
+	}
+
+	auto const fd = ::open(pathBuffer, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return makeErrno("open");
+	}
+
+	auto result = map(fd, access);
+	close(fd);
+
+	return result;
+}
+
+
+Result<MappedFile, Error>
+MappedFile::map(int fd, Access access) noexcept {
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0) {
+		return makeErrno("fstat");
+	}
+
+	auto const size = static_cast<size_type>(fileStat.st_size);
+	if (size == 0) {  // Zero length mapping is an error
+		return Result<MappedFile, Error>{types::okTag, in_place, MappedFile{nullptr, 0}};
+	}
+
+	auto address = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	if (address == MAP_FAILED) {
+		return makeErrno("mmap");
+	}
+
+	MappedFile file{address, size};
+	if (access != Access::Normal) {
+		auto advised = file.advise(access);
+		if (!advised) {
+			return advised.moveError();
+		}
+	}
+
+	return Result<MappedFile, Error>{types::okTag, in_place, mv(file)};
+}
+
+
+Result<void, Error>
+MappedFile::advise(Access access, size_type offset, size_type length) noexcept {
+	if (offset >= _size) {
+		return Ok();
+	}
+
+	// Advice applies to whole pages
+	auto const pageSize = static_cast<size_type>(sysconf(_SC_PAGESIZE));
+	auto const start = offset & ~(pageSize - 1);
+	auto const end = (length < _size - offset) ? offset + length : _size;
+
+	if (madvise(static_cast<byte*>(_address) + start, end - start, adviceFor(access)) != 0) {
+		return makeErrno("madvise");
+	}
+
+	return Ok();
+}
+
+
+MemoryResource
+MappedFile::release() noexcept {
+	if (!_address) {
+		return MemoryResource{};
+	}
+
+	auto const size = exchange(_size, 0);
+
+	return MemoryResource{wrapMemory(exchange(_address, nullptr), size), &unmapDisposer};
+}
@@ -0,0 +1,249 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: I/O readiness reactor
+ *	@file		io/reactor.cpp
+ *	@brief		Implementation of the epoll based reactor
+ ******************************************************************************/
+#include "solace/io/reactor.hpp"
+#include "solace/posixErrorDomain.hpp"
+
+#include <cerrno>
+#include <unistd.h>
+
+#ifdef SOLACE_PLATFORM_LINUX
+#include <sys/epoll.h>
+#endif
+
+
+using namespace Solace;
+using namespace Solace::io;
+
+
+namespace {
+
+#ifdef SOLACE_PLATFORM_LINUX
+constexpr int kMaxEventsPerPoll = 64;
+
+constexpr uint32 kWatchEvents = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+constexpr uint32 kReadableEvents = EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR;
+constexpr uint32 kWritableEvents = EPOLLOUT | EPOLLHUP | EPOLLERR;
+
+
+Result<void, Error>
+control(int pollFd, int op, IoWatch& watch) {
+	epoll_event event{};
+	event.events = kWatchEvents;
+	event.data.ptr = &watch;
+
+	if (epoll_ctl(pollFd, op, watch.fd, &event) != 0) {
+		return makeErrno("epoll_ctl");
+	}
+
+	return Ok();
+}
+#endif
+
+}  // namespace
+
+
+struct Reactor::ReadyWaiter {
+	IoWatch const*	watch;
+	IoWaiter*		waiter;
+};
+
+
+Reactor::~Reactor() {
+	if (_pollFd != -1) {
+		::close(exchange(_pollFd, -1));
+	}
+}
+
+
+Result<void, Error>
+Reactor::add(IoWatch& watch) {
+#ifdef SOLACE_PLATFORM_LINUX
+	if (watch.isRegistered) {
+		return Ok();
+	}
+
+	auto result = control(_pollFd, EPOLL_CTL_ADD, watch);
+	if (result) {
+		watch.isRegistered = true;
+	}
+
+	return result;
+#else
+	(void)watch;
+	return makeError(SystemErrors::NoSys, "Reactor::add");
+#endif
+}
+
+
+Result<void, Error>
+Reactor::rebind(IoWatch& watch) {
+#ifdef SOLACE_PLATFORM_LINUX
+	if (!watch.isRegistered) {
+		return Ok();
+	}
+
+	return control(_pollFd, EPOLL_CTL_MOD, watch);
+#else
+	(void)watch;
+	return makeError(SystemErrors::NoSys, "Reactor::rebind");
+#endif
+}
+
+
+Result<void, Error>
+Reactor::remove(IoWatch& watch) {
+	_nbWaiting -= (exchange(watch.reader, nullptr) != nullptr) + (exchange(watch.writer, nullptr) != nullptr);
+	for (uint32 i = 0; i < _nbReady; ++i) {
+		if (_ready[i].watch == &watch) {
+			_ready[i].waiter = nullptr;
+		}
+	}
+
+	if (!watch.isRegistered) {
+		return Ok();
+	}
+
+	watch.isRegistered = false;
+#ifdef SOLACE_PLATFORM_LINUX
+	if (epoll_ctl(_pollFd, EPOLL_CTL_DEL, watch.fd, nullptr) != 0) {
+		return makeErrno("epoll_ctl");
+	}
+#endif
+
+	return Ok();
+}
+
+
+Result<void, Error>
+Reactor::awaitReadable(IoWatch& watch, IoWaiter& waiter) {
+	assertTrue(watch.reader == nullptr, "Reactor::awaitReadable: watch already has a reader");
+
+	auto registration = add(watch);
+	if (!registration) {
+		return registration;
+	}
+
+	watch.reader = &waiter;
+	_nbWaiting += 1;
+
+	return Ok();
+}
+
+
+Result<void, Error>
+Reactor::awaitWritable(IoWatch& watch, IoWaiter& waiter) {
+	assertTrue(watch.writer == nullptr, "Reactor::awaitWritable: watch already has a writer");
+
+	auto registration = add(watch);
+	if (!registration) {
+		return registration;
+	}
+
+	watch.writer = &waiter;
+	_nbWaiting += 1;
+
+	return Ok();
+}
+
+
+Result<uint32, Error>
+Reactor::poll(int timeoutMs) {
+#ifdef SOLACE_PLATFORM_LINUX
+	// Checked before epoll_wait: edge-triggered events taken by a nested poll would be lost
+	assertTrue(_ready == nullptr, "Reactor::poll: called from a waiter");
+
+	epoll_event events[kMaxEventsPerPoll];
+	auto const nbEvents = epoll_wait(_pollFd, events, kMaxEventsPerPoll, timeoutMs);
+	if (nbEvents < 0) {
+		if (errno == EINTR) {
+			return Ok<uint32>(0);
+		}
+
+		return makeErrno("epoll_wait");
+	}
+
+	// Detach all of the ready waiters before resuming any: a resumed operation may remove and destroy
+	// any watch of the batch, or the other waiter of the same watch.
+	ReadyWaiter ready[2 * kMaxEventsPerPoll];
+	uint32 nbReady = 0;
+	for (int i = 0; i < nbEvents; ++i) {
+		auto& watch = *static_cast<IoWatch*>(events[i].data.ptr);
+		auto const flags = events[i].events;
+
+		if ((flags & kReadableEvents) && watch.reader) {
+			ready[nbReady++] = {&watch, exchange(watch.reader, nullptr)};
+		}
+
+		if ((flags & kWritableEvents) && watch.writer) {
+			ready[nbReady++] = {&watch, exchange(watch.writer, nullptr)};
+		}
+	}
+
+	_nbWaiting -= nbReady;
+	_ready = ready;
+	_nbReady = nbReady;
+
+	uint32 nbResumed = 0;
+	for (uint32 i = 0; i < nbReady; ++i) {
+		auto* const waiter = exchange(ready[i].waiter, nullptr);
+		if (waiter) {  // Waiter is dropped if its watch has been removed by a waiter resumed before it
+			nbResumed += 1;
+			waiter->onReady(waiter);
+		}
+	}
+
+	_ready = nullptr;
+	_nbReady = 0;
+
+	return Ok(nbResumed);
+#else
+	(void)timeoutMs;
+	return makeError(SystemErrors::NoSys, "Reactor::poll");
+#endif
+}
+
+
+Result<void, Error>
+Reactor::run() {
+	while (_nbWaiting > 0) {
+		auto result = poll(-1);
+		if (!result) {
+			return result.moveError();
+		}
+	}
+
+	return Ok();
+}
+
+
+Result<Reactor, Error>
+Solace::io::makeReactor() {
+#ifdef SOLACE_PLATFORM_LINUX
+	auto const pollFd = epoll_create1(EPOLL_CLOEXEC);
+	if (pollFd < 0) {
+		return makeErrno("epoll_create1");
+	}
+
+	return Ok(Reactor{pollFd});
+#else
+	return makeError(SystemErrors::NoSys, "makeReactor");
+#endif
+}
@@ -0,0 +1,385 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Append-only record log
+ *	@file		io/recordLog.cpp
+ *	@brief		Implementation of the record log reader and writer
+ ******************************************************************************/
+#include "solace/io/recordLog.hpp"
+#include "solace/hashing/crc32c.hpp"
+#include "solace/byteReader.hpp"
+#include "solace/byteWriter.hpp"
+#include "solace/variableSpan.hpp"
+#include "solace/posixErrorDomain.hpp"
+
+#include "cString.hpp"
+
+#include <algorithm>  // std::min
+#include <climits>  // PATH_MAX
+#include <cstring>  // memcmp
+#include <cerrno>
+#include <condition_variable>
+#include <mutex>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+
+using namespace Solace;
+using namespace Solace::io;
+
+
+namespace Solace { namespace io { namespace details {
+
+/**
+ * Writer state lives at the start of the writer memory block, followed by two batch buffers,
+ * so that the writer object can be moved while other threads wait on the state.
+ */
+struct RecordLogState {
+	std::mutex				mutex;
+	std::condition_variable	synced;
+	int						fd{-1};
+	ByteWriter				batch;				//!< Records being appended.
+	ByteWriter				flushing;			//!< Records being written by the thread leading a commit.
+	uint64					size{0};			//!< End of appended records.
+	uint64					durableSize{0};		//!< End of records written and synced.
+	int						error{0};			//!< Error of a failed write. Writer is unusable after it.
+	bool					isSyncing{false};
+};
+
+}}}  // namespace Solace::io::details
+
+
+namespace {
+
+constexpr uint64 kStateAlignment = 64;
+
+constexpr uint64 alignUp(uint64 value, uint64 alignment) noexcept {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+
+/// Checksum of a record frame: chunk size bytes followed by the payload
+uint32 frameChecksum(MemoryView sizeBytes, MemoryView payload) noexcept {
+	return hashing::crc32c(payload, hashing::crc32c(sizeBytes));
+}
+
+
+/// Write all the data at a given offset. @return 0 on success or errno.
+int writeFully(int fd, MemoryView data, uint64 offset) noexcept {
+	auto remaining = data;
+	while (!remaining.empty()) {
+		auto const nbWritten = pwrite(fd, remaining.dataAddress(), remaining.size(), static_cast<off_t>(offset));
+		if (nbWritten < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return errno;
+		}
+
+		offset += static_cast<uint64>(nbWritten);
+		remaining = remaining.slice(static_cast<MemoryView::size_type>(nbWritten), remaining.size());
+	}
+
+	return 0;
+}
+
+
+Error closeOnError(int fd, Error&& error) noexcept {
+	close(fd);
+
+	return mv(error);
+}
+
+
+/// Write batch of records in the flushing buffer: one thread leads, others wait for the result.
+Result<void, Error>
+syncLocked(io::details::RecordLogState& state, std::unique_lock<std::mutex>& lock, uint64 target) noexcept {
+	while (state.durableSize < target) {
+		if (state.error) {
+			return makeSystemError(state.error, "RecordLogWriter::sync");
+		}
+
+		if (state.isSyncing) {  // Records will be synced by the current leader or the next one
+			state.synced.wait(lock);
+			continue;
+		}
+
+		// Lead the commit of the current batch. Others append to the other buffer in the meantime.
+		state.isSyncing = true;
+		state.batch.swap(state.flushing);
+		auto const batchStart = state.durableSize;
+		auto const batchEnd = state.size;
+
+		lock.unlock();
+		auto error = writeFully(state.fd, state.flushing.viewWritten(), batchStart);
+		if (!error && fdatasync(state.fd) != 0) {
+			error = errno;
+		}
+		lock.lock();
+
+		state.flushing.clear();
+		state.isSyncing = false;
+		if (error) {
+			state.error = error;
+		} else {
+			state.durableSize = batchEnd;
+		}
+		state.synced.notify_all();
+	}
+
+	return Ok();
+}
+
+}  // namespace
+
+
+void
+RecordLogView::Iterator::parse() noexcept {
+	_frameSize = 0;
+	_payload = MemoryView{};
+	if (_offset == kEnd) {
+		return;
+	}
+
+	auto const segmentSize = _segment.size();
+	if (_offset > segmentSize || segmentSize - _offset < RecordLogFormat::kFrameHeaderSize) {
+		_offset = kEnd;
+		return;
+	}
+
+	uint32 chunkSize = 0;
+	auto const frame = _segment.slice(_offset, segmentSize);
+	auto const chunk = TypedChunkReader<uint32, EncoderType::LittleEndian>::readChunk(frame, chunkSize);
+	if (chunkSize < sizeof(uint32) || chunk.size() < chunkSize) {  // Torn write
+		_offset = kEnd;
+		return;
+	}
+
+	uint32 checksum = 0;
+	ByteReader reader{chunk};
+	reader.readLE(checksum);
+
+	auto const payload = chunk.slice(sizeof(uint32), chunkSize);
+	if (checksum != frameChecksum(frame.slice(0, sizeof(uint32)), payload)) {
+		_offset = kEnd;
+		return;
+	}
+
+	_frameSize = sizeof(uint32) + chunkSize;
+	_payload = payload;
+}
+
+
+bool
+RecordLogView::hasValidHeader() const noexcept {
+	if (_segment.size() < RecordLogFormat::kHeaderSize ||
+		memcmp(_segment.dataAddress(), RecordLogFormat::kMagic, sizeof(RecordLogFormat::kMagic)) != 0) {
+		return false;
+	}
+
+	uint32 version = 0;
+	ByteReader reader{_segment.slice(sizeof(RecordLogFormat::kMagic), RecordLogFormat::kHeaderSize)};
+	reader.readLE(version);
+
+	return (version == RecordLogFormat::kVersion);
+}
+
+
+RecordLogView::size_type
+RecordLogView::validSize() const noexcept {
+	if (!hasValidHeader()) {
+		return 0;
+	}
+
+	size_type size = RecordLogFormat::kHeaderSize;
+	for (auto i = begin(); i != end(); ++i) {
+		size = i.endOffset();
+	}
+
+	return size;
+}
+
+
+Result<RecordLogReader, Error>
+RecordLogReader::open(StringView path) noexcept {
+	auto maybeFile = MappedFile::open(path, MappedFile::Access::Sequential);
+	if (!maybeFile) {
+		return maybeFile.moveError();
+	}
+
+	if (!RecordLogView{maybeFile.unwrap().view()}.hasValidHeader()) {
+		return makeError(BasicError::InvalidInput, "RecordLogReader::open");
+	}
+
+	return Result<RecordLogReader, Error>{types::okTag, in_place, RecordLogReader{maybeFile.moveResult()}};
+}
+
+
+RecordLogWriter::~RecordLogWriter() {
+	if (!_state) {
+		return;
+	}
+
+	sync();
+	close(_state->fd);
+	dtor(*_state);
+}
+
+
+Result<RecordLogWriter, Error>
+RecordLogWriter::open(StringView path, MemoryManager& memoryManager, size_type batchSize) noexcept {
+	if (batchSize <= RecordLogFormat::kFrameHeaderSize) {
+		return makeError(BasicError::InvalidInput, "RecordLogWriter::open");
+	}
+
+	char pathBuffer[PATH_MAX];
+	if (path.empty() || !io::details::copyCString(path, pathBuffer, sizeof(pathBuffer))) {
+		return makeError(BasicError::InvalidInput, "RecordLogWriter::open");
+	}
+
+	uint64 const batchOffset = alignUp(sizeof(io::details::RecordLogState), kStateAlignment);
+	auto maybeMemory = memoryManager.allocate(kStateAlignment + batchOffset + 2 * uint64{batchSize});
+	if (!maybeMemory) {
+		return maybeMemory.moveError();
+	}
+
+	auto const fd = ::open(pathBuffer, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (fd < 0) {
+		return makeErrno("open");
+	}
+
+	// Recover: find the end of intact records
+	auto maybeFile = MappedFile::map(fd, MappedFile::Access::Sequential);
+	if (!maybeFile) {
+		return closeOnError(fd, maybeFile.moveError());
+	}
+
+	auto const fileSize = maybeFile.unwrap().size();
+	auto const segment = RecordLogView{maybeFile.unwrap().view()};
+	uint64 validSize = segment.validSize();
+	if (fileSize < RecordLogFormat::kHeaderSize) {  // New file or one torn while being created
+		byte header[RecordLogFormat::kHeaderSize];
+		ByteWriter headerWriter{wrapMemory(header)};
+		headerWriter.write(wrapMemory(RecordLogFormat::kMagic));
+		headerWriter.writeLE(RecordLogFormat::kVersion);
+
+		auto const error = writeFully(fd, headerWriter.viewWritten(), 0);
+		if (error) {
+			return closeOnError(fd, makeSystemError(error, "write"));
+		}
+		validSize = RecordLogFormat::kHeaderSize;
+	} else if (validSize == 0) {
+		return closeOnError(fd, makeError(BasicError::InvalidInput, "RecordLogWriter::open"));
+	}
+
+	if (validSize != fileSize) {  // Drop torn tail
+		if (ftruncate(fd, static_cast<off_t>(validSize)) != 0) {
+			return closeOnError(fd, makeErrno("ftruncate"));
+		}
+	}
+
+	if (fdatasync(fd) != 0) {
+		return closeOnError(fd, makeErrno("fdatasync"));
+	}
+
+	auto const address = reinterpret_cast<uintptr_t>(maybeMemory.unwrap().view().dataAddress());
+	auto const base = reinterpret_cast<byte*>(alignUp(address, kStateAlignment));
+	auto state = ctor(*reinterpret_cast<io::details::RecordLogState*>(base));
+	state->fd = fd;
+	state->batch = ByteWriter{wrapMemory(base + batchOffset, batchSize)};
+	state->flushing = ByteWriter{wrapMemory(base + batchOffset + batchSize, batchSize)};
+	state->size = validSize;
+	state->durableSize = validSize;
+
+	return Result<RecordLogWriter, Error>{types::okTag, in_place, RecordLogWriter{maybeMemory.moveResult(), state}};
+}
+
+
+Result<uint64, Error>
+RecordLogWriter::append(MemoryView payload) noexcept {
+	if (payload.size() > maxPayloadSize()) {
+		return makeError(BasicError::Overflow, "RecordLogWriter::append");
+	}
+
+	auto const chunkSize = static_cast<uint32>(sizeof(uint32) + payload.size());
+	auto const frameSize = RecordLogFormat::kFrameHeaderSize + payload.size();
+
+	// Frame header: chunk size and checksum
+	byte frameHeader[RecordLogFormat::kFrameHeaderSize];
+	ByteWriter headerWriter{wrapMemory(frameHeader)};
+	headerWriter.writeLE(chunkSize);
+	headerWriter.writeLE(frameChecksum(headerWriter.viewWritten(), payload));
+
+	auto& state = *_state;
+	std::unique_lock<std::mutex> lock{state.mutex};
+	while (state.batch.remaining() < frameSize) {  // Batch is full: commit it
+		auto synced = syncLocked(state, lock, state.size);
+		if (!synced) {
+			return synced.moveError();
+		}
+	}
+
+	if (state.error) {
+		return makeSystemError(state.error, "RecordLogWriter::append");
+	}
+
+	state.batch.write(headerWriter.viewWritten());
+	state.batch.write(payload);
+	state.size += frameSize;
+
+	return Result<uint64, Error>{types::okTag, in_place, state.size};
+}
+
+
+Result<void, Error>
+RecordLogWriter::sync() noexcept {
+	std::unique_lock<std::mutex> lock{_state->mutex};
+
+	return syncLocked(*_state, lock, _state->size);
+}
+
+
+Result<void, Error>
+RecordLogWriter::sync(uint64 offset) noexcept {
+	std::unique_lock<std::mutex> lock{_state->mutex};
+
+	return syncLocked(*_state, lock, std::min(offset, _state->size));
+}
+
+
+uint64
+RecordLogWriter::size() const noexcept {
+	std::lock_guard<std::mutex> lock{_state->mutex};
+
+	return _state->size;
+}
+
+
+uint64
+RecordLogWriter::durableSize() const noexcept {
+	std::lock_guard<std::mutex> lock{_state->mutex};
+
+	return _state->durableSize;
+}
+
+
+RecordLogWriter::size_type
+RecordLogWriter::maxPayloadSize() const noexcept {
+	auto const capacity = _state->batch.capacity() - RecordLogFormat::kFrameHeaderSize;
+
+	return std::min<size_type>(capacity, RecordLogFormat::kMaxPayloadSize);
+}
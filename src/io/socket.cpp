@@ -0,0 +1,216 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Sockets
+ *	@file		io/socket.cpp
+ *	@brief		Implementation of sockets created from dial strings
+ ******************************************************************************/
+#include "solace/io/socket.hpp"
+#include "solace/posixErrorDomain.hpp"
+
+#include "cString.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+using namespace Solace;
+using namespace Solace::io;
+
+
+namespace {
+
+Result<SocketAddress, Error>
+resolveUnix(StringView path) {
+	SocketAddress result;
+	result.type = SOCK_STREAM;
+
+	auto& address = *reinterpret_cast<sockaddr_un*>(&result.storage);
+	address.sun_family = AF_UNIX;
+	if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+		return makeError(BasicError::InvalidInput, "resolve");
+	}
+
+	memcpy(address.sun_path, path.data(), path.size());
+	if (path[0] == '@') {  // Abstract namespace: name is not null-terminated
+		address.sun_path[0] = 0;
+		result.size = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size());
+	} else {
+		result.size = static_cast<socklen_t>(sizeof(address));
+	}
+
+	return Ok(result);
+}
+
+
+Result<SocketAddress, Error>
+resolveInet(StringView host, StringView service, int type) {
+	char hostName[NI_MAXHOST];
+	char serviceName[NI_MAXSERV];
+
+	bool const anyHost = host.empty() || host == StringView{"*"};
+	if ((!anyHost && !io::details::copyCString(host, hostName, sizeof(hostName))) ||
+		!io::details::copyCString(service.empty() ? StringView{"0"} : service, serviceName, sizeof(serviceName))) {
+		return makeError(BasicError::InvalidInput, "resolve");
+	}
+
+	addrinfo hints{};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = type;
+	hints.ai_flags = anyHost ? AI_PASSIVE : 0;
+
+	addrinfo* info = nullptr;
+	auto const status = getaddrinfo(anyHost ? nullptr : hostName, serviceName, &hints, &info);
+	if (status != 0) {
+		if (status == EAI_SYSTEM) {
+			return makeErrno("getaddrinfo");
+		}
+
+		return makeError(SystemErrors::NODATA, "getaddrinfo");
+	}
+
+	SocketAddress result;
+	result.type = type;
+	result.size = info->ai_addrlen;
+	memcpy(&result.storage, info->ai_addr, info->ai_addrlen);
+	freeaddrinfo(info);
+
+	return Ok(result);
+}
+
+
+Result<Socket, Error>
+openSocket(SocketAddress const& address) {
+	Socket socket{::socket(address.family(), address.type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)};
+	if (!socket) {
+		return makeErrno("socket");
+	}
+
+	return Ok(mv(socket));
+}
+
+}  // namespace
+
+
+Socket::~Socket() {
+	if (_fd != -1) {
+		::close(exchange(_fd, -1));
+	}
+}
+
+
+uint16
+SocketAddress::port() const noexcept {
+	switch (family()) {
+	case AF_INET: return ntohs(reinterpret_cast<sockaddr_in const*>(&storage)->sin_port);
+	case AF_INET6: return ntohs(reinterpret_cast<sockaddr_in6 const*>(&storage)->sin6_port);
+	default: return 0;
+	}
+}
+
+
+Result<SocketAddress, Error>
+Solace::io::resolve(DialString const& endpoint) {
+	if (endpoint.protocol == kProtocolUnix) {
+		return resolveUnix(endpoint.address);
+	}
+
+	if (endpoint.protocol == kProtocolTCP) {
+		return resolveInet(endpoint.address, endpoint.service, SOCK_STREAM);
+	}
+
+	if (endpoint.protocol == kProtocolUDP) {
+		return resolveInet(endpoint.address, endpoint.service, SOCK_DGRAM);
+	}
+
+	return makeError(SystemErrors::PROTONOSUPPORT, "resolve");
+}
+
+
+Result<Socket, Error>
+Solace::io::listen(DialString const& endpoint, int backlog) {
+	auto maybeAddress = resolve(endpoint);
+	if (!maybeAddress) {
+		return maybeAddress.moveError();
+	}
+
+	auto& address = *maybeAddress;
+	auto maybeSocket = openSocket(address);
+	if (!maybeSocket) {
+		return maybeSocket.moveError();
+	}
+
+	auto& socket = *maybeSocket;
+	if (address.family() != AF_UNIX) {
+		int const enable = 1;
+		if (setsockopt(socket.fd(), SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) != 0) {
+			return makeErrno("setsockopt");
+		}
+	}
+
+	if (::bind(socket.fd(), address.address(), address.size) != 0) {
+		return makeErrno("bind");
+	}
+
+	if (address.type == SOCK_STREAM && ::listen(socket.fd(), backlog) != 0) {
+		return makeErrno("listen");
+	}
+
+	return maybeSocket;
+}
+
+
+Result<Socket, Error>
+Solace::io::connect(DialString const& endpoint) {
+	auto maybeAddress = resolve(endpoint);
+	if (!maybeAddress) {
+		return maybeAddress.moveError();
+	}
+
+	auto& address = *maybeAddress;
+	auto maybeSocket = openSocket(address);
+	if (!maybeSocket) {
+		return maybeSocket.moveError();
+	}
+
+	auto& socket = *maybeSocket;
+	if (::connect(socket.fd(), address.address(), address.size) != 0 && errno != EINPROGRESS) {
+		return makeErrno("connect");
+	}
+
+	return maybeSocket;
+}
+
+
+Result<SocketAddress, Error>
+Solace::io::localAddress(Socket const& socket) {
+	SocketAddress result;
+	result.size = sizeof(result.storage);
+	if (getsockname(socket.fd(), result.address(), &result.size) != 0) {
+		return makeErrno("getsockname");
+	}
+
+	socklen_t typeSize = sizeof(result.type);
+	if (getsockopt(socket.fd(), SOL_SOCKET, SO_TYPE, &result.type, &typeSize) != 0) {
+		return makeErrno("getsockopt");
+	}
+
+	return Ok(result);
+}
@@ -0,0 +1,187 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace
+ *	@file		lineScanner.cpp
+ *	@brief		Implementation of the line scanner
+ ******************************************************************************/
+#include "solace/lineScanner.hpp"
+#include "solace/cpuFeatures.hpp"
+
+#include <cstring>  // memchr
+#include <limits>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+
+using namespace Solace;
+
+
+namespace {
+
+constexpr uint64 kMaxLineSize = std::numeric_limits<StringView::size_type>::max();
+
+/**
+ * Find offsets of newlines in data[from, size).
+ * @return Number of offsets stored, not more than the capacity.
+ */
+using FindNewlinesFunction = uint32 (*)(byte const* data, uint64 size, uint64 from, uint64* offsets, uint32 capacity);
+
+
+uint32 findNewlinesScalar(byte const* data, uint64 size, uint64 from, uint64* offsets, uint32 capacity) {
+	uint32 count = 0;
+
+	while (count < capacity && from < size) {
+		auto const found = static_cast<byte const*>(memchr(data + from, '\n', size - from));
+		if (!found) {
+			break;
+		}
+
+		from = static_cast<uint64>(found - data);
+		offsets[count++] = from++;
+	}
+
+	return count;
+}
+
+
+#if defined(__x86_64__)
+
+__attribute__((target("avx2")))
+uint32 findNewlinesAvx2(byte const* data, uint64 size, uint64 from, uint64* offsets, uint32 capacity) {
+	auto const newline = _mm256_set1_epi8('\n');
+	uint32 count = 0;
+
+	while (from + 64 <= size) {
+		auto const low = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + from));
+		auto const high = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + from + 32));
+		auto const lowMask = static_cast<uint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, newline)));
+		auto const highMask = static_cast<uint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, newline)));
+
+		uint64 mask = (uint64{highMask} << 32) | lowMask;
+		while (mask) {
+			offsets[count++] = from + static_cast<uint64>(__builtin_ctzll(mask));
+			if (count == capacity) {
+				return count;
+			}
+
+			mask &= mask - 1;
+		}
+
+		from += 64;
+	}
+
+	return count + findNewlinesScalar(data, size, from, offsets + count, capacity - count);
+}
+
+KernelDispatch<uint32(byte const*, uint64, uint64, uint64*, uint32)>::Candidate const kCandidates[] = {
+	{{CpuFeature::AVX2}, findNewlinesAvx2},
+};
+
+KernelDispatch<uint32(byte const*, uint64, uint64, uint64*, uint32)> const findNewlinesKernel{
+	kCandidates, findNewlinesScalar};
+
+#else
+
+KernelDispatch<uint32(byte const*, uint64, uint64, uint64*, uint32)> const findNewlinesKernel{findNewlinesScalar};
+
+#endif
+
+
+/// Offset of the first line starting at or after the given offset.
+MemoryView::size_type
+lineStart(MemoryView data, uint64 offset) noexcept {
+	if (offset == 0) {
+		return 0;
+	}
+
+	if (offset >= data.size()) {
+		return data.size();
+	}
+
+	auto const newline = findNewline(data, offset - 1);
+	return (newline < data.size()) ? newline + 1 : data.size();
+}
+
+}  // namespace
+
+
+MemoryView::size_type
+Solace::findNewline(MemoryView data, MemoryView::size_type from) noexcept {
+	uint64 offset = data.size();
+	if (from < data.size()) {
+		findNewlinesKernel(data.begin(), data.size(), from, &offset, 1);
+	}
+
+	return offset;
+}
+
+
+MemoryView
+Solace::lineChunk(MemoryView data, uint64 index, MemoryView::size_type chunkSize) noexcept {
+	if (chunkSize == 0 || index >= data.size() / chunkSize + 1) {
+		return data.slice(data.size(), data.size());
+	}
+
+	auto const from = lineStart(data, index * chunkSize);
+	auto const to = lineStart(data, (index + 1) * chunkSize);
+
+	return data.slice(from, to);
+}
+
+
+StringView::size_type
+LineScanner::next(ArrayView<StringView> lines) noexcept {
+	auto const capacity = static_cast<uint32>((lines.size() < kBatchSize) ? lines.size() : kBatchSize);
+	auto const* const text = _data.begin();
+	auto const size = _data.size();
+
+	StringView::size_type count = 0;
+	auto addLine = [&](uint64 end) {
+		auto const length = end - _position;
+		if (length > kMaxLineSize) {
+			_nbSkipped += 1;
+		} else {
+			lines[count++] = StringView{reinterpret_cast<char const*>(text + _position),
+										static_cast<StringView::size_type>(length)};
+		}
+
+		_position = end + 1;
+	};
+
+	uint64 offsets[kBatchSize];
+	// Skipped lines take no room in the batch: keep scanning until it is full or the data ends
+	while (count < capacity && !done()) {
+		auto const nbWanted = capacity - count;
+		auto const nbNewlines = findNewlinesKernel(text, size, _position, offsets, nbWanted);
+		for (uint32 i = 0; i < nbNewlines; ++i) {
+			addLine(offsets[i]);
+		}
+
+		// No newlines left: the rest of the text is the last, not terminated, line
+		if (nbNewlines < nbWanted) {
+			if (_position < size) {
+				addLine(size);
+			}
+
+			_position = size;
+		}
+	}
+
+	return count;
+}
@@ -0,0 +1,461 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace
+ *	@file		mappedDictionary.cpp
+ *	@brief		Implementation of the immutable memory mappable dictionary.
+ ******************************************************************************/
+#include "solace/mappedDictionary.hpp"
+#include "solace/io/mappedFile.hpp"
+#include "solace/posixErrorDomain.hpp"
+#include "solace/probe.hpp"
+
+#include <algorithm>  // std::max
+#include <cstring>  // memcmp, memcpy
+
+
+using namespace Solace;
+
+
+namespace {
+
+constexpr uint64 kMultiplier = 0x9E3779B97F4A7C15ULL;
+
+/// Number of seeds of the hash to try before giving up on building the index.
+constexpr uint64 kMaxSeedAttempts = 8;
+
+/// Average number of keys per bucket of the index.
+constexpr uint64 kKeysPerBucket = 4;
+
+// Offsets of the fields of the header
+constexpr uint64 kVersionOffset = 4;
+constexpr uint64 kSizeOffset = 8;
+constexpr uint64 kBucketsCountOffset = 16;
+constexpr uint64 kSeedOffset = 24;
+constexpr uint64 kTotalSizeOffset = 32;
+
+
+constexpr uint64 alignUp(uint64 value) noexcept {
+	return (value + MappedDictionaryFormat::kAlignment - 1) & ~(MappedDictionaryFormat::kAlignment - 1);
+}
+
+constexpr uint64 bucketsSize(uint64 nbBuckets) noexcept {
+	return alignUp(nbBuckets * sizeof(uint32));
+}
+
+constexpr uint64 entriesOffset(uint64 nbBuckets) noexcept {
+	return MappedDictionaryFormat::kHeaderSize + bucketsSize(nbBuckets);
+}
+
+constexpr uint64 nbBucketsFor(uint64 nbKeys) noexcept {
+	return (nbKeys + kKeysPerBucket - 1) / kKeysPerBucket;
+}
+
+
+template<typename T>
+T loadLE(byte const* data) noexcept {
+	T value;
+	memcpy(&value, data, sizeof(value));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	if (sizeof(T) == 8) {
+		value = static_cast<T>(__builtin_bswap64(value));
+	} else {
+		value = static_cast<T>(__builtin_bswap32(static_cast<uint32>(value)));
+	}
+#endif
+
+	return value;
+}
+
+
+constexpr uint64 fmix64(uint64 h) noexcept {
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+
+	return h;
+}
+
+constexpr uint64 rotl(uint64 x, int r) noexcept {
+	return (x << r) | (x >> (64 - r));
+}
+
+
+/// Seeded hash of a key. Part of the format: must not change without changing the version.
+uint64 hashKey(MemoryView key, uint64 seed) noexcept {
+	auto data = key.begin();
+	auto remaining = key.size();
+
+	uint64 h = seed ^ (uint64{remaining} * kMultiplier);
+	for (; remaining >= 8; remaining -= 8, data += 8) {
+		h = rotl(h ^ fmix64(loadLE<uint64>(data)), 29) * kMultiplier;
+	}
+
+	uint64 tail = 0;
+	for (decltype(remaining) i = 0; i < remaining; ++i) {
+		tail |= uint64{data[i]} << (8 * i);
+	}
+
+	return fmix64(h ^ tail ^ (tail << 32));
+}
+
+
+/// Map a 32 bit value uniformly onto [0, range).
+constexpr uint32 fastRange(uint64 value, uint64 range) noexcept {
+	return static_cast<uint32>(((value & 0xffffffff) * range) >> 32);
+}
+
+constexpr uint32 bucketOf(uint64 hash, uint64 nbBuckets) noexcept {
+	return fastRange(hash >> 32, nbBuckets);
+}
+
+constexpr uint32 slotOf(uint64 hash, uint32 displacement, uint64 nbSlots) noexcept {
+	return fastRange(fmix64(hash ^ ((displacement + uint64{1}) * kMultiplier)), nbSlots);
+}
+
+
+Result<void, Error>
+writePadding(ByteWriter& dest, uint64 size) noexcept {
+	byte const zeros[MappedDictionaryFormat::kAlignment] = {0};
+
+	auto const padding = alignUp(size) - size;
+	if (padding == 0) {
+		return Ok();
+	}
+
+	return dest.write(wrapMemory(zeros, padding));
+}
+
+
+/// Scratch arrays used to build the index.
+struct IndexBuilder {
+	uint64*	hashes;			//!< Hash of each entry
+	uint32*	keysByBucket;	//!< Entries sorted by bucket
+	uint32*	bucketStart;	//!< Start of the keys of each bucket in keysByBucket, nbBuckets + 1 elements
+	uint32*	bucketOrder;	//!< Buckets sorted by decreasing size
+	uint32*	displacement;	//!< Displacement of each bucket
+	uint32*	slotEntry;		//!< Entry in each slot
+	uint32	nbKeys;
+	uint32	nbBuckets;
+
+	static constexpr uint32 kFree = ~uint32{0};
+
+	/// Largest bucket that is placed. Buckets can only get that large if the hash is degenerate.
+	static constexpr uint32 kMaxBucketSize = 64;
+
+	static uint64 memorySize(uint64 nbKeys, uint64 nbBuckets) noexcept {
+		return nbKeys * sizeof(uint64) + (3 * nbKeys + 3 * nbBuckets + 1) * sizeof(uint32);
+	}
+
+	IndexBuilder(MutableMemoryView memory, uint32 keys, uint32 buckets) noexcept
+		: hashes{static_cast<uint64*>(memory.dataAddress())}
+		, keysByBucket{reinterpret_cast<uint32*>(hashes + keys)}
+		, bucketStart{keysByBucket + keys}
+		, bucketOrder{bucketStart + buckets + 1}
+		, displacement{bucketOrder + buckets}
+		, slotEntry{displacement + buckets}
+		, nbKeys{keys}
+		, nbBuckets{buckets}
+	{}
+
+	/// Group keys by bucket and sort buckets by size. @return Size of the largest bucket.
+	uint32 sortBuckets() noexcept {
+		for (uint32 b = 0; b <= nbBuckets; ++b) {
+			bucketStart[b] = 0;
+		}
+		for (uint32 i = 0; i < nbKeys; ++i) {
+			bucketStart[bucketOf(hashes[i], nbBuckets) + 1] += 1;
+		}
+
+		uint32 maxBucketSize = 0;
+		for (uint32 b = 0; b < nbBuckets; ++b) {
+			maxBucketSize = std::max(maxBucketSize, bucketStart[b + 1]);
+			bucketStart[b + 1] += bucketStart[b];
+		}
+
+		// Place keys: slotEntry is used as a cursor per bucket here
+		for (uint32 b = 0; b < nbBuckets; ++b) {
+			slotEntry[b] = bucketStart[b];
+		}
+		for (uint32 i = 0; i < nbKeys; ++i) {
+			keysByBucket[slotEntry[bucketOf(hashes[i], nbBuckets)]++] = i;
+		}
+
+		if (maxBucketSize > kMaxBucketSize) {
+			return maxBucketSize;
+		}
+
+		// Counting sort of buckets by decreasing size
+		uint32 position[kMaxBucketSize + 1] = {0};
+		for (uint32 b = 0; b < nbBuckets; ++b) {
+			position[maxBucketSize - bucketSize(b)] += 1;
+		}
+		uint32 start = 0;
+		for (uint32 size = 0; size <= maxBucketSize; ++size) {
+			start += exchange(position[size], start);
+		}
+		for (uint32 b = 0; b < nbBuckets; ++b) {
+			bucketOrder[position[maxBucketSize - bucketSize(b)]++] = b;
+		}
+
+		return maxBucketSize;
+	}
+
+	uint32 bucketSize(uint32 bucket) const noexcept {
+		return bucketStart[bucket + 1] - bucketStart[bucket];
+	}
+
+	/// Find displacement of each bucket such that keys of all buckets go to distinct slots.
+	bool place(uint64 maxAttempts) noexcept {
+		for (uint32 i = 0; i < nbKeys; ++i) {
+			slotEntry[i] = kFree;
+		}
+		for (uint32 b = 0; b < nbBuckets; ++b) {
+			displacement[b] = 0;
+		}
+
+		uint32 slots[kMaxBucketSize];
+		for (uint32 i = 0; i < nbBuckets; ++i) {
+			auto const bucket = bucketOrder[i];
+			auto const keys = keysByBucket + bucketStart[bucket];
+			auto const nbBucketKeys = bucketSize(bucket);
+			if (nbBucketKeys == 0) {
+				break;  // Buckets are sorted by size: all the rest are empty
+			}
+			bool isPlaced = false;
+			for (uint64 d = 0; d < maxAttempts && !isPlaced; ++d) {
+				isPlaced = true;
+				for (uint32 k = 0; k < nbBucketKeys && isPlaced; ++k) {
+					slots[k] = slotOf(hashes[keys[k]], static_cast<uint32>(d), nbKeys);
+					isPlaced = (slotEntry[slots[k]] == kFree);
+					for (uint32 j = 0; j < k && isPlaced; ++j) {
+						isPlaced = (slots[j] != slots[k]);
+					}
+				}
+
+				if (isPlaced) {
+					displacement[bucket] = static_cast<uint32>(d);
+					for (uint32 k = 0; k < nbBucketKeys; ++k) {
+						slotEntry[slots[k]] = keys[k];
+					}
+				}
+			}
+
+			if (!isPlaced) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+};
+
+}  // namespace
+
+
+Result<MappedDictionary, Error>
+MappedDictionary::open(MemoryResource&& data) noexcept {
+	auto const bytes = data.view().begin();
+	auto const dataSize = data.size();
+	if (dataSize < MappedDictionaryFormat::kHeaderSize ||
+		memcmp(bytes, MappedDictionaryFormat::kMagic, sizeof(MappedDictionaryFormat::kMagic)) != 0 ||
+		loadLE<uint32>(bytes + kVersionOffset) != MappedDictionaryFormat::kVersion) {
+		return makeError(BasicError::InvalidInput, "MappedDictionary::open");
+	}
+
+	auto const size = loadLE<uint64>(bytes + kSizeOffset);
+	auto const nbBuckets = loadLE<uint64>(bytes + kBucketsCountOffset);
+	auto const seed = loadLE<uint64>(bytes + kSeedOffset);
+	auto const totalSize = loadLE<uint64>(bytes + kTotalSizeOffset);
+	if (totalSize != dataSize ||
+		size > std::numeric_limits<size_type>::max() ||
+		nbBuckets != nbBucketsFor(size) ||
+		entriesOffset(nbBuckets) + size * MappedDictionaryFormat::kEntrySize > dataSize) {
+		return makeError(BasicError::InvalidInput, "MappedDictionary::open");
+	}
+
+	return Result<MappedDictionary, Error>{types::okTag, in_place,
+				MappedDictionary{mv(data), static_cast<size_type>(size), static_cast<uint32>(nbBuckets), seed}};
+}
+
+
+Result<MappedDictionary, Error>
+MappedDictionary::open(StringView path) noexcept {
+	auto maybeFile = io::MappedFile::open(path, io::MappedFile::Access::Random);
+	if (!maybeFile) {
+		return maybeFile.moveError();
+	}
+
+	return open(maybeFile.unwrap().release());
+}
+
+
+Optional<MemoryView>
+MappedDictionary::find(StringView key) const noexcept {
+	if (_size == 0) {
+		return none;
+	}
+
+	auto const data = _data.view();
+	auto const bytes = data.begin();
+	auto const hash = hashKey(key.view(), _seed);
+	auto const bucket = bucketOf(hash, _nbBuckets);
+	auto const displacement = loadLE<uint32>(bytes + MappedDictionaryFormat::kHeaderSize + bucket * sizeof(uint32));
+
+	auto const slot = slotOf(hash, displacement, _size);
+	auto const entry = bytes + entriesOffset(_nbBuckets) + slot * MappedDictionaryFormat::kEntrySize;
+	auto const keyOffset = loadLE<uint64>(entry);
+	auto const keySize = loadLE<uint32>(entry + 8);
+	auto const valueSize = loadLE<uint32>(entry + 12);
+
+	// Offsets are not validated on open: check that the record is within the data
+	auto const valueOffset = alignUp(keyOffset + keySize);
+	if (keySize != key.size() || keyOffset > data.size() || valueOffset > data.size() ||
+		data.size() - valueOffset < valueSize ||
+		memcmp(bytes + keyOffset, key.data(), keySize) != 0) {
+		return none;
+	}
+
+	return data.slice(valueOffset, valueOffset + valueSize);
+}
+
+
+Result<void, Error>
+MappedDictionaryBuilder::add(StringView key, MemoryView value) noexcept {
+	if (value.size() > std::numeric_limits<uint32>::max()) {
+		return makeError(BasicError::Overflow, "MappedDictionaryBuilder::add");
+	}
+
+	auto result = _entries.emplace_back(Entry{key, value});
+	if (!result) {
+		return result.moveError();
+	}
+
+	return Ok();
+}
+
+
+uint64
+MappedDictionaryBuilder::encodedSize() const noexcept {
+	uint64 size = entriesOffset(nbBucketsFor(_entries.size())) + _entries.size() * MappedDictionaryFormat::kEntrySize;
+	for (auto const& entry : _entries) {
+		size += alignUp(entry.key.size()) + alignUp(entry.value.size());
+	}
+
+	return size;
+}
+
+
+Result<void, Error>
+MappedDictionaryBuilder::build(ByteWriter& dest) const noexcept {
+	SOLACE_PROBE("MappedDictionaryBuilder::build");
+
+	auto const totalSize = encodedSize();
+	if (dest.remaining() < totalSize) {
+		return makeError(BasicError::Overflow, "MappedDictionaryBuilder::build");
+	}
+
+	auto const nbKeys = size();
+	auto const nbBuckets = static_cast<uint32>(nbBucketsFor(nbKeys));
+	auto maybeMemory = _memoryManager->allocate(IndexBuilder::memorySize(nbKeys, nbBuckets));
+	if (!maybeMemory) {
+		return maybeMemory.moveError();
+	}
+
+	IndexBuilder index{maybeMemory.unwrap().view(), nbKeys, nbBuckets};
+
+	// Find a seed with which all keys can be placed
+	uint64 seed = 0;
+	bool isBuilt = (nbKeys == 0);
+	for (uint64 attempt = 0; attempt < kMaxSeedAttempts && !isBuilt; ++attempt) {
+		seed = fmix64(attempt + 1);
+		for (uint32 i = 0; i < nbKeys; ++i) {
+			index.hashes[i] = hashKey(_entries[i].key.view(), seed);
+		}
+
+		auto const maxBucketSize = index.sortBuckets();
+		if (attempt == 0) {  // Identical keys have identical hashes: check once
+			for (uint32 b = 0; b < nbBuckets; ++b) {
+				auto const keys = index.keysByBucket + index.bucketStart[b];
+				for (uint32 i = 0; i < index.bucketSize(b); ++i) {
+					for (uint32 j = 0; j < i; ++j) {
+						if (_entries[keys[i]].key == _entries[keys[j]].key) {
+							return makeError(BasicError::InvalidInput, "MappedDictionaryBuilder::build");
+						}
+					}
+				}
+			}
+		}
+
+		isBuilt = (maxBucketSize <= IndexBuilder::kMaxBucketSize) && index.place(uint64{16} * nbKeys + 1024);
+	}
+
+	if (!isBuilt) {
+		return makeError(BasicError::Overflow, "MappedDictionaryBuilder::build");
+	}
+
+	// Header
+	dest.write(wrapMemory(MappedDictionaryFormat::kMagic));
+	dest.writeLE(MappedDictionaryFormat::kVersion);
+	dest.writeLE(uint64{nbKeys});
+	dest.writeLE(uint64{nbBuckets});
+	dest.writeLE(seed);
+	dest.writeLE(totalSize);
+	byte const reserved[MappedDictionaryFormat::kHeaderSize - kTotalSizeOffset - sizeof(uint64)] = {0};
+	dest.write(wrapMemory(reserved));
+
+	// Index
+	for (uint32 b = 0; b < nbBuckets; ++b) {
+		dest.writeLE(index.displacement[b]);
+	}
+	writePadding(dest, nbBuckets * sizeof(uint32));
+
+	uint64 offset = entriesOffset(nbBuckets) + nbKeys * MappedDictionaryFormat::kEntrySize;
+	for (uint32 slot = 0; slot < nbKeys; ++slot) {
+		auto const& entry = _entries[index.slotEntry[slot]];
+		dest.writeLE(offset);
+		dest.writeLE(uint32{entry.key.size()});
+		dest.writeLE(static_cast<uint32>(entry.value.size()));
+
+		offset += alignUp(entry.key.size()) + alignUp(entry.value.size());
+	}
+
+	// Records, in the order of entries
+	for (uint32 slot = 0; slot < nbKeys; ++slot) {
+		auto const& entry = _entries[index.slotEntry[slot]];
+		dest.write(entry.key.view());
+		writePadding(dest, entry.key.size());
+		dest.write(entry.value);
+		writePadding(dest, entry.value.size());
+	}
+
+	return Ok();
+}
+
+
+Result<MappedDictionaryBuilder, Error>
+Solace::makeMappedDictionaryBuilder(MemoryManager& memoryManager,
+									MappedDictionaryBuilder::size_type capacity) noexcept {
+	auto maybeEntries = makeVector<MappedDictionaryBuilder::Entry>(memoryManager, capacity);
+	if (!maybeEntries) {
+		return maybeEntries.moveError();
+	}
+
+	return Result<MappedDictionaryBuilder, Error>{types::okTag, in_place,
+				MappedDictionaryBuilder{memoryManager, maybeEntries.moveResult()}};
+}
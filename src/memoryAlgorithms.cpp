@@ -0,0 +1,437 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace
+ *	@file		memoryAlgorithms.cpp
+ *	@brief		Implementation of vectorized memory algorithms
+ ******************************************************************************/
+#include "solace/memoryAlgorithms.hpp"
+#include "solace/cpuFeatures.hpp"
+
+#include <cstring>  // memchr, memcmp
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+
+using namespace Solace;
+
+
+namespace {
+
+/// Size of the window of a repeated mask handed to XOR kernels: enough for the widest vector.
+constexpr size_t kMaskWindow = 32;
+/// Longest mask that is expanded into a repeated pattern for vector kernels.
+constexpr size_t kMaxVectorMask = 256;
+
+
+/*
+ * Portable implementations.
+ * All of the kernels return the size of the data if nothing is found.
+ */
+
+size_t findByteScalar(byte const* data, size_t size, byte value) {
+	auto const found = static_cast<byte const*>(memchr(data, value, size));
+	return found ? static_cast<size_t>(found - data) : size;
+}
+
+
+size_t findPatternScalar(byte const* data, size_t size, byte const* pattern, size_t patternSize) {
+	if (patternSize > size) {
+		return size;
+	}
+
+	auto const last = size - patternSize;
+	for (size_t i = 0; i <= last; ++i) {
+		i += findByteScalar(data + i, last + 1 - i, pattern[0]);
+		if (i > last) {
+			break;
+		}
+
+		if (memcmp(data + i + 1, pattern + 1, patternSize - 1) == 0) {
+			return i;
+		}
+	}
+
+	return size;
+}
+
+
+size_t countScalar(byte const* data, size_t size, byte value) {
+	size_t result = 0;
+	for (size_t i = 0; i < size; ++i) {
+		result += (data[i] == value);
+	}
+
+	return result;
+}
+
+
+size_t firstMismatchScalar(byte const* lhs, byte const* rhs, size_t size) {
+	size_t i = 0;
+	for (; i + sizeof(uint64) <= size; i += sizeof(uint64)) {
+		uint64 a;
+		uint64 b;
+		memcpy(&a, lhs + i, sizeof(a));
+		memcpy(&b, rhs + i, sizeof(b));
+		if (a != b) {
+			break;
+		}
+	}
+
+	while (i < size && lhs[i] == rhs[i]) {
+		++i;
+	}
+
+	return i;
+}
+
+
+/**
+ * XOR data with a repeating pattern.
+ * @param pattern Mask repeated over period + kMaskWindow bytes, period being a multiple of the mask size.
+ * @param period Period of the pattern, not less than kMaskWindow.
+ */
+void xorScalar(byte* data, size_t size, byte const* pattern, size_t period) {
+	size_t phase = 0;
+	for (size_t i = 0; i < size; ++i) {
+		data[i] ^= pattern[phase];
+		phase = (phase + 1 == period) ? 0 : phase + 1;
+	}
+}
+
+
+#if defined(__x86_64__)
+
+/*
+ * SSE2 is a part of x86-64 baseline, but is still dispatched so that SOLACE_CPU_LEVEL=scalar selects portable code.
+ */
+
+__attribute__((target("sse2")))
+size_t countSse2(byte const* data, size_t size, byte value) {
+	auto const needle = _mm_set1_epi8(static_cast<char>(value));
+	auto const zero = _mm_setzero_si128();
+	auto total = _mm_setzero_si128();
+
+	size_t i = 0;
+	while (i + 16 <= size) {
+		// Byte counters are summed into 64-bit ones before they can overflow
+		auto const nbBlocks = ((size - i) / 16 < 255) ? (size - i) / 16 : 255;
+		auto counters = _mm_setzero_si128();
+		for (size_t b = 0; b < nbBlocks; ++b, i += 16) {
+			auto const block = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i));
+			counters = _mm_sub_epi8(counters, _mm_cmpeq_epi8(block, needle));
+		}
+
+		total = _mm_add_epi64(total, _mm_sad_epu8(counters, zero));
+	}
+
+	auto const result = static_cast<size_t>(_mm_cvtsi128_si64(total)) +
+			static_cast<size_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(total, total)));
+
+	return result + countScalar(data + i, size - i, value);
+}
+
+
+__attribute__((target("sse2")))
+size_t firstMismatchSse2(byte const* lhs, byte const* rhs, size_t size) {
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16) {
+		auto const a = _mm_loadu_si128(reinterpret_cast<__m128i const*>(lhs + i));
+		auto const b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(rhs + i));
+		auto const equal = static_cast<uint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+		if (equal != 0xFFFF) {
+			return i + static_cast<size_t>(__builtin_ctz(~equal));
+		}
+	}
+
+	return i + firstMismatchScalar(lhs + i, rhs + i, size - i);
+}
+
+
+__attribute__((target("sse2")))
+void xorSse2(byte* data, size_t size, byte const* pattern, size_t period) {
+	size_t phase = 0;
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16) {
+		auto const block = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i));
+		auto const mask = _mm_loadu_si128(reinterpret_cast<__m128i const*>(pattern + phase));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), _mm_xor_si128(block, mask));
+
+		phase += 16;
+		phase = (phase >= period) ? phase - period : phase;
+	}
+
+	// Pattern extends a whole window past its period: the tail is masked without wrapping around
+	for (; i < size; ++i, ++phase) {
+		data[i] ^= pattern[phase];
+	}
+}
+
+
+__attribute__((target("avx2,bmi")))
+size_t findByteAvx2(byte const* data, size_t size, byte value) {
+	auto const needle = _mm256_set1_epi8(static_cast<char>(value));
+
+	size_t i = 0;
+	for (; i + 64 <= size; i += 64) {
+		auto const low = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i));
+		auto const high = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i + 32));
+		auto const lowEqual = _mm256_cmpeq_epi8(low, needle);
+		auto const highEqual = _mm256_cmpeq_epi8(high, needle);
+		if (_mm256_testz_si256(_mm256_or_si256(lowEqual, highEqual), _mm256_set1_epi8(-1))) {
+			continue;
+		}
+
+		auto const mask = (uint64{static_cast<uint32>(_mm256_movemask_epi8(highEqual))} << 32) |
+				static_cast<uint32>(_mm256_movemask_epi8(lowEqual));
+
+		return i + static_cast<size_t>(__builtin_ctzll(mask));
+	}
+
+	return i + findByteScalar(data + i, size - i, value);
+}
+
+
+/// Compare the first and the last bytes of the pattern at 32 positions at a time, and the rest only on a match.
+__attribute__((target("avx2,bmi")))
+size_t findPatternAvx2(byte const* data, size_t size, byte const* pattern, size_t patternSize) {
+	if (patternSize > size) {
+		return size;
+	}
+
+	auto const first = _mm256_set1_epi8(static_cast<char>(pattern[0]));
+	auto const last = _mm256_set1_epi8(static_cast<char>(pattern[patternSize - 1]));
+
+	size_t i = 0;
+	for (; i + patternSize - 1 + 32 <= size; i += 32) {
+		auto const head = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i));
+		auto const tail = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i + patternSize - 1));
+		auto const candidates = _mm256_and_si256(_mm256_cmpeq_epi8(head, first), _mm256_cmpeq_epi8(tail, last));
+
+		auto mask = static_cast<uint32>(_mm256_movemask_epi8(candidates));
+		while (mask) {
+			auto const offset = i + static_cast<size_t>(__builtin_ctz(mask));
+			if (patternSize <= 2 || memcmp(data + offset + 1, pattern + 1, patternSize - 2) == 0) {
+				return offset;
+			}
+
+			mask &= mask - 1;
+		}
+	}
+
+	auto const found = findPatternScalar(data + i, size - i, pattern, patternSize);
+	return (found == size - i) ? size : i + found;
+}
+
+
+__attribute__((target("avx2")))
+size_t countAvx2(byte const* data, size_t size, byte value) {
+	auto const needle = _mm256_set1_epi8(static_cast<char>(value));
+	auto const zero = _mm256_setzero_si256();
+	auto total = _mm256_setzero_si256();
+
+	size_t i = 0;
+	while (i + 32 <= size) {
+		auto const nbBlocks = ((size - i) / 32 < 255) ? (size - i) / 32 : 255;
+		auto counters = _mm256_setzero_si256();
+		for (size_t b = 0; b < nbBlocks; ++b, i += 32) {
+			auto const block = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i));
+			counters = _mm256_sub_epi8(counters, _mm256_cmpeq_epi8(block, needle));
+		}
+
+		total = _mm256_add_epi64(total, _mm256_sad_epu8(counters, zero));
+	}
+
+	auto const sum = _mm_add_epi64(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+	auto const result = static_cast<size_t>(_mm_cvtsi128_si64(sum)) +
+			static_cast<size_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(sum, sum)));
+
+	return result + countScalar(data + i, size - i, value);
+}
+
+
+__attribute__((target("avx2,bmi")))
+size_t firstMismatchAvx2(byte const* lhs, byte const* rhs, size_t size) {
+	size_t i = 0;
+	for (; i + 32 <= size; i += 32) {
+		auto const a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(lhs + i));
+		auto const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(rhs + i));
+		auto const equal = static_cast<uint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+		if (equal != 0xFFFFFFFF) {
+			return i + static_cast<size_t>(__builtin_ctz(~equal));
+		}
+	}
+
+	return i + firstMismatchScalar(lhs + i, rhs + i, size - i);
+}
+
+
+__attribute__((target("avx2")))
+void xorAvx2(byte* data, size_t size, byte const* pattern, size_t period) {
+	size_t phase = 0;
+	size_t i = 0;
+	for (; i + 32 <= size; i += 32) {
+		auto const block = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i));
+		auto const mask = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(pattern + phase));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), _mm256_xor_si256(block, mask));
+
+		phase += 32;
+		phase = (phase >= period) ? phase - period : phase;
+	}
+
+	// Pattern extends a whole window past its period: the tail is masked without wrapping around
+	for (; i < size; ++i, ++phase) {
+		data[i] ^= pattern[phase];
+	}
+}
+
+
+KernelDispatch<size_t(byte const*, size_t, byte)>::Candidate const kFindByteCandidates[] = {
+	{{CpuFeature::AVX2, CpuFeature::BMI1}, findByteAvx2},
+};
+
+KernelDispatch<size_t(byte const*, size_t, byte const*, size_t)>::Candidate const kFindPatternCandidates[] = {
+	{{CpuFeature::AVX2, CpuFeature::BMI1}, findPatternAvx2},
+};
+
+KernelDispatch<size_t(byte const*, size_t, byte)>::Candidate const kCountCandidates[] = {
+	{{CpuFeature::AVX2}, countAvx2},
+	{{CpuFeature::SSE2}, countSse2},
+};
+
+KernelDispatch<size_t(byte const*, byte const*, size_t)>::Candidate const kFirstMismatchCandidates[] = {
+	{{CpuFeature::AVX2, CpuFeature::BMI1}, firstMismatchAvx2},
+	{{CpuFeature::SSE2}, firstMismatchSse2},
+};
+
+KernelDispatch<void(byte*, size_t, byte const*, size_t)>::Candidate const kXorCandidates[] = {
+	{{CpuFeature::AVX2}, xorAvx2},
+	{{CpuFeature::SSE2}, xorSse2},
+};
+
+KernelDispatch<size_t(byte const*, size_t, byte)> const findByteKernel{kFindByteCandidates, findByteScalar};
+KernelDispatch<size_t(byte const*, size_t, byte const*, size_t)> const findPatternKernel{
+	kFindPatternCandidates, findPatternScalar};
+KernelDispatch<size_t(byte const*, size_t, byte)> const countKernel{kCountCandidates, countScalar};
+KernelDispatch<size_t(byte const*, byte const*, size_t)> const firstMismatchKernel{
+	kFirstMismatchCandidates, firstMismatchScalar};
+KernelDispatch<void(byte*, size_t, byte const*, size_t)> const xorKernel{kXorCandidates, xorScalar};
+
+#else
+
+KernelDispatch<size_t(byte const*, size_t, byte)> const findByteKernel{findByteScalar};
+KernelDispatch<size_t(byte const*, size_t, byte const*, size_t)> const findPatternKernel{findPatternScalar};
+KernelDispatch<size_t(byte const*, size_t, byte)> const countKernel{countScalar};
+KernelDispatch<size_t(byte const*, byte const*, size_t)> const firstMismatchKernel{firstMismatchScalar};
+KernelDispatch<void(byte*, size_t, byte const*, size_t)> const xorKernel{xorScalar};
+
+#endif
+
+}  // namespace
+
+
+Optional<MemoryView::size_type>
+Solace::find(MemoryView data, byte value, MemoryView::size_type fromIndex) noexcept {
+	if (fromIndex >= data.size()) {
+		return none;
+	}
+
+	auto const size = data.size() - fromIndex;
+	auto const found = findByteKernel(data.begin() + fromIndex, size, value);
+
+	return (found < size)
+			? Optional<MemoryView::size_type>{fromIndex + found}
+			: none;
+}
+
+
+Optional<MemoryView::size_type>
+Solace::find(MemoryView data, MemoryView pattern, MemoryView::size_type fromIndex) noexcept {
+	if (fromIndex > data.size() || pattern.size() > data.size() - fromIndex) {
+		return none;
+	}
+
+	if (pattern.empty()) {
+		return fromIndex;
+	}
+
+	if (pattern.size() == 1) {
+		return find(data, pattern[0], fromIndex);
+	}
+
+	auto const size = data.size() - fromIndex;
+	auto const found = findPatternKernel(data.begin() + fromIndex, size, pattern.begin(), pattern.size());
+
+	return (found < size)
+			? Optional<MemoryView::size_type>{fromIndex + found}
+			: none;
+}
+
+
+MemoryView::size_type
+Solace::count(MemoryView data, byte value) noexcept {
+	return countKernel(data.begin(), data.size(), value);
+}
+
+
+Optional<MemoryView::size_type>
+Solace::firstMismatch(MemoryView lhs, MemoryView rhs) noexcept {
+	auto const size = (lhs.size() < rhs.size()) ? lhs.size() : rhs.size();
+	auto const mismatch = (size != 0)
+			? firstMismatchKernel(lhs.begin(), rhs.begin(), size)
+			: 0;
+
+	if (mismatch == size && lhs.size() == rhs.size()) {
+		return none;
+	}
+
+	return mismatch;
+}
+
+
+MutableMemoryView
+Solace::xorWith(MutableMemoryView data, MemoryView mask, MemoryView::size_type maskOffset) noexcept {
+	auto const maskSize = mask.size();
+	if (maskSize == 0 || data.empty()) {
+		return data;
+	}
+
+	auto* const target = data.begin();
+	auto phase = maskOffset % maskSize;
+
+	if (maskSize > kMaxVectorMask) {
+		for (MemoryView::size_type i = 0; i < data.size(); ++i) {
+			target[i] ^= mask.begin()[phase];
+			phase = (phase + 1 == maskSize) ? 0 : phase + 1;
+		}
+
+		return data;
+	}
+
+	// Mask is repeated, starting from the given phase, over a period that is a multiple of its size
+	// and followed by a window of one vector, so that a vector of mask bytes can be loaded at any phase.
+	auto const period = maskSize * ((kMaskWindow + maskSize - 1) / maskSize);
+	byte pattern[kMaxVectorMask + kMaskWindow + kMaskWindow];
+	for (size_t i = 0; i < period + kMaskWindow; ++i) {
+		pattern[i] = mask.begin()[(phase + i) % maskSize];
+	}
+
+	xorKernel(target, data.size(), pattern, period);
+
+	return data;
+}
@@ -0,0 +1,246 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace
+ *	@file		memoryCopy.cpp
+ *	@brief		Implementation of bulk memory copy
+ ******************************************************************************/
+#include "solace/memoryCopy.hpp"
+#include "solace/cpuFeatures.hpp"
+#include "solace/posixErrorDomain.hpp"
+
+#include <atomic>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+
+using namespace Solace;
+
+
+namespace {
+
+std::atomic<MemoryView::size_type> gNonTemporalThreshold{kDefaultNonTemporalThreshold};
+
+/// Smallest copy worth aligning the destination for streaming stores.
+constexpr size_t kMinStreamSize = 256;
+
+
+bool overlap(void* dest, void const* src, size_t count) noexcept {
+	auto const d = reinterpret_cast<uintptr_t>(dest);
+	auto const s = reinterpret_cast<uintptr_t>(src);
+
+	return (d < s) ? (s - d < count) : (d - s < count);
+}
+
+
+void copyLibc(void* dest, void const* src, size_t count) {
+	std::memmove(dest, src, count);
+}
+
+void fillLibc(void* dest, byte value, size_t count) {
+	std::memset(dest, value, count);
+}
+
+
+#if defined(__x86_64__)
+
+/// Forward copy with a fast string instruction. Regions must not overlap.
+void copyRepMovsb(void* dest, void const* src, size_t count) {
+	__asm__ volatile("rep movsb"
+					 : "+D"(dest), "+S"(src), "+c"(count)
+					 :
+					 : "memory");
+}
+
+void fillRepStosb(void* dest, byte value, size_t count) {
+	__asm__ volatile("rep stosb"
+					 : "+D"(dest), "+c"(count)
+					 : "a"(value)
+					 : "memory");
+}
+
+
+/*
+ * Streaming kernels. Regions must not overlap and count must be at least the size of a vector.
+ * Head of the destination is copied up to the vector alignment with regular stores,
+ * so that the rest is written with aligned non-temporal stores that bypass the cache.
+ */
+
+__attribute__((target("sse2")))
+void copyStreamSse2(void* dest, void const* src, size_t count) {
+	auto* d = static_cast<byte*>(dest);
+	auto const* s = static_cast<byte const*>(src);
+
+	auto const head = (16 - (reinterpret_cast<uintptr_t>(d) & 15)) & 15;
+	std::memcpy(d, s, head);
+	d += head;
+	s += head;
+	count -= head;
+
+	for (; count >= 64; count -= 64, d += 64, s += 64) {
+		auto const a = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s));
+		auto const b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + 16));
+		auto const c = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + 32));
+		auto const e = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + 48));
+		_mm_stream_si128(reinterpret_cast<__m128i*>(d), a);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(d + 16), b);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(d + 32), c);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(d + 48), e);
+	}
+	_mm_sfence();
+
+	std::memcpy(d, s, count);
+}
+
+__attribute__((target("avx2")))
+void copyStreamAvx2(void* dest, void const* src, size_t count) {
+	auto* d = static_cast<byte*>(dest);
+	auto const* s = static_cast<byte const*>(src);
+
+	auto const head = (32 - (reinterpret_cast<uintptr_t>(d) & 31)) & 31;
+	std::memcpy(d, s, head);
+	d += head;
+	s += head;
+	count -= head;
+
+	for (; count >= 128; count -= 128, d += 128, s += 128) {
+		auto const a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(s));
+		auto const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(s + 32));
+		auto const c = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(s + 64));
+		auto const e = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(s + 96));
+		_mm256_stream_si256(reinterpret_cast<__m256i*>(d), a);
+		_mm256_stream_si256(reinterpret_cast<__m256i*>(d + 32), b);
+		_mm256_stream_si256(reinterpret_cast<__m256i*>(d + 64), c);
+		_mm256_stream_si256(reinterpret_cast<__m256i*>(d + 96), e);
+	}
+	_mm_sfence();
+
+	std::memcpy(d, s, count);
+}
+
+__attribute__((target("sse2")))
+void fillStreamSse2(void* dest, byte value, size_t count) {
+	auto* d = static_cast<byte*>(dest);
+	auto const v = _mm_set1_epi8(static_cast<char>(value));
+
+	auto const head = (16 - (reinterpret_cast<uintptr_t>(d) & 15)) & 15;
+	std::memset(d, value, head);
+	d += head;
+	count -= head;
+
+	for (; count >= 64; count -= 64, d += 64) {
+		_mm_stream_si128(reinterpret_cast<__m128i*>(d), v);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(d + 16), v);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(d + 32), v);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(d + 48), v);
+	}
+	_mm_sfence();
+
+	std::memset(d, value, count);
+}
+
+
+KernelDispatch<void(void*, void const*, size_t)>::Candidate const kCopyCandidates[] = {
+	{{CpuFeature::ERMS}, copyRepMovsb},
+};
+
+KernelDispatch<void(void*, byte, size_t)>::Candidate const kFillCandidates[] = {
+	{{CpuFeature::ERMS}, fillRepStosb},
+};
+
+KernelDispatch<void(void*, void const*, size_t)>::Candidate const kCopyStreamCandidates[] = {
+	{{CpuFeature::AVX2}, copyStreamAvx2},
+	{{CpuFeature::SSE2}, copyStreamSse2},
+};
+
+KernelDispatch<void(void*, byte, size_t)>::Candidate const kFillStreamCandidates[] = {
+	{{CpuFeature::SSE2}, fillStreamSse2},
+};
+
+KernelDispatch<void(void*, void const*, size_t)> const copyKernel{kCopyCandidates, copyLibc};
+KernelDispatch<void(void*, byte, size_t)> const fillKernel{kFillCandidates, fillLibc};
+KernelDispatch<void(void*, void const*, size_t)> const copyStreamKernel{kCopyStreamCandidates, copyLibc};
+KernelDispatch<void(void*, byte, size_t)> const fillStreamKernel{kFillStreamCandidates, fillLibc};
+
+#else
+
+KernelDispatch<void(void*, void const*, size_t)> const copyKernel{copyLibc};
+KernelDispatch<void(void*, byte, size_t)> const fillKernel{fillLibc};
+KernelDispatch<void(void*, void const*, size_t)> const copyStreamKernel{copyLibc};
+KernelDispatch<void(void*, byte, size_t)> const fillStreamKernel{fillLibc};
+
+#endif
+
+}  // namespace
+
+
+MemoryView::size_type
+Solace::nonTemporalThreshold() noexcept {
+	return gNonTemporalThreshold.load(std::memory_order_relaxed);
+}
+
+
+void
+Solace::setNonTemporalThreshold(MemoryView::size_type threshold) noexcept {
+	gNonTemporalThreshold.store((threshold < kBulkCopyThreshold) ? kBulkCopyThreshold : threshold,
+								std::memory_order_relaxed);
+}
+
+
+void
+Solace::details::copyBulk(void* dest, void const* src, MemoryView::size_type count) noexcept {
+	if (overlap(dest, src, count)) {
+		std::memmove(dest, src, count);
+	} else if (count >= nonTemporalThreshold()) {
+		copyStreamKernel(dest, src, count);
+	} else {
+		copyKernel(dest, src, count);
+	}
+}
+
+
+void
+Solace::details::fillBulk(void* dest, byte value, MemoryView::size_type count) noexcept {
+	if (count >= nonTemporalThreshold()) {
+		fillStreamKernel(dest, value, count);
+	} else {
+		fillKernel(dest, value, count);
+	}
+}
+
+
+void
+Solace::copyNonTemporal(void* dest, void const* src, MemoryView::size_type count) noexcept {
+	if (count < kMinStreamSize || overlap(dest, src, count)) {
+		std::memmove(dest, src, count);
+	} else {
+		copyStreamKernel(dest, src, count);
+	}
+}
+
+
+Result<void, Error>
+Solace::copyNonTemporal(MutableMemoryView dest, MemoryView source) noexcept {
+	if (dest.size() < source.size()) {
+		return makeError(BasicError::Overflow, "copyNonTemporal: dest is too small");
+	}
+
+	copyNonTemporal(dest.dataAddress(), source.dataAddress(), source.size());
+
+	return Ok();
+}
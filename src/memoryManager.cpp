@@ -20,6 +20,7 @@
  ******************************************************************************/
 #include "solace/memoryManager.hpp"
 #include "solace/posixErrorDomain.hpp"
+#include "solace/probe.hpp"
 
 #include <unistd.h>
 #include <cstdlib>
@@ -96,6 +97,8 @@ void MemoryManager::free(MemoryView* view) {
 
 Result<MemoryResource, Error>
 MemoryManager::allocate(size_type nbBytes) noexcept {
+	SOLACE_PROBE("MemoryManager::allocate");
+
 	if (limit() < nbBytes) {
 		return makeError(GenericError::NOMEM, "allocate dataSize");
 	}
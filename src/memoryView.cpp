@@ -32,19 +32,13 @@
 using namespace Solace;
 
 
+#if !(defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__))
 constexpr int kOne = 1;
 
 bool Solace::isBigendian() noexcept {
     return *reinterpret_cast<const char*>(&kOne) == 0;
 }
-
-
-MemoryView::value_type
-MemoryView::operator[] (size_type index) const {
-	assertIndexInRange(index, size(), "MemoryView[]");
-
-	return begin()[index];
-}
+#endif
 
 
 MemoryView
@@ -0,0 +1,708 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace
+ *	@file		messagePack.cpp
+ *	@brief		Implementation of MessagePack writer and reader.
+ ******************************************************************************/
+#include "solace/messagePack.hpp"
+#include "solace/posixErrorDomain.hpp"
+#include "solace/probe.hpp"
+
+#include <cstring>  // memcpy
+
+
+using namespace Solace;
+
+
+namespace {
+
+// Tags of the format, except for fixed ranges
+constexpr byte kNil = 0xc0;
+constexpr byte kFalse = 0xc2;
+constexpr byte kTrue = 0xc3;
+constexpr byte kBin8 = 0xc4;
+constexpr byte kExt8 = 0xc7;
+constexpr byte kFloat32 = 0xca;
+constexpr byte kFloat64 = 0xcb;
+constexpr byte kUInt8 = 0xcc;
+constexpr byte kInt8 = 0xd0;
+constexpr byte kFixExt1 = 0xd4;
+constexpr byte kStr8 = 0xd9;
+constexpr byte kArray16 = 0xdc;
+constexpr byte kMap16 = 0xde;
+
+constexpr byte kFixMap = 0x80;
+constexpr byte kFixArray = 0x90;
+constexpr byte kFixStr = 0xa0;
+
+
+/// Decoded header of a value.
+struct Header {
+	MessagePackType	type;
+	uint64			size;			//!< Size of the header in bytes
+	uint64			value;			//!< Integer or boolean value, length of content or number of elements
+	bool			isNegative;		//!< Integer value is negative, stored as two's complement in value
+	float64			real;			//!< Floating point value
+	int8			extensionType;
+};
+
+
+template<typename T>
+T loadBE(byte const* data) noexcept {
+	T value = 0;
+	for (size_t i = 0; i < sizeof(T); ++i) {
+		value = static_cast<T>((uint64{value} << 8) | data[i]);
+	}
+
+	return value;
+}
+
+template<typename T>
+byte* storeBE(byte* dest, T value) noexcept {
+	for (size_t i = sizeof(T); i > 0; --i) {
+		dest[i - 1] = static_cast<byte>(value & 0xff);
+		value = static_cast<T>(uint64{value} >> 8);
+	}
+
+	return dest + sizeof(T);
+}
+
+
+/// Load unsigned integer of a given width in bytes.
+uint64 loadBE(byte const* data, uint64 width) noexcept {
+	switch (width) {
+	case 1: return loadBE<uint8>(data);
+	case 2: return loadBE<uint16>(data);
+	case 4: return loadBE<uint32>(data);
+	default: return loadBE<uint64>(data);
+	}
+}
+
+
+Result<Header, Error>
+truncated() noexcept {
+	return makeError(BasicError::Overflow, "MessagePackReader");
+}
+
+
+/**
+ * Decode header of the value at the beginning of the data.
+ * Only the header is checked to be complete, content is not.
+ */
+Result<Header, Error>
+parseHeader(MemoryView data) noexcept {
+	if (data.empty()) {
+		return truncated();
+	}
+
+	auto const bytes = data.begin();
+	auto const tag = bytes[0];
+	Header header{MessagePackType::Integer, 1, tag, false, 0, 0};
+
+	if (tag < kFixMap) {
+		return Result<Header, Error>{types::okTag, in_place, header};
+	}
+	if (tag < kFixArray) {
+		header.type = MessagePackType::Map;
+		header.value = tag & 0x0f;
+		return Result<Header, Error>{types::okTag, in_place, header};
+	}
+	if (tag < kFixStr) {
+		header.type = MessagePackType::Array;
+		header.value = tag & 0x0f;
+		return Result<Header, Error>{types::okTag, in_place, header};
+	}
+	if (tag < kNil) {
+		header.type = MessagePackType::String;
+		header.value = tag & 0x1f;
+		return Result<Header, Error>{types::okTag, in_place, header};
+	}
+	if (tag >= 0xe0) {  // Negative fixint
+		header.value = static_cast<uint64>(int64{static_cast<int8>(tag)});
+		header.isNegative = true;
+		return Result<Header, Error>{types::okTag, in_place, header};
+	}
+
+	// Tags with a length or a value following: type and width of the length
+	uint64 width = 0;
+	switch (tag) {
+	case kNil:
+		header.type = MessagePackType::Nil;
+		header.value = 0;
+		return Result<Header, Error>{types::okTag, in_place, header};
+	case kFalse:
+	case kTrue:
+		header.type = MessagePackType::Boolean;
+		header.value = (tag == kTrue);
+		return Result<Header, Error>{types::okTag, in_place, header};
+
+	case 0xc4: case 0xc5: case 0xc6:
+		header.type = MessagePackType::Binary;
+		width = uint64{1} << (tag - kBin8);
+		break;
+	case 0xc7: case 0xc8: case 0xc9:
+		header.type = MessagePackType::Extension;
+		width = uint64{1} << (tag - kExt8);
+		break;
+	case kFloat32:
+	case kFloat64:
+		header.type = MessagePackType::Float;
+		width = (tag == kFloat32) ? 4 : 8;
+		break;
+	case 0xcc: case 0xcd: case 0xce: case 0xcf:
+		width = uint64{1} << (tag - kUInt8);
+		break;
+	case 0xd0: case 0xd1: case 0xd2: case 0xd3:
+		width = uint64{1} << (tag - kInt8);
+		break;
+	case 0xd4: case 0xd5: case 0xd6: case 0xd7: case 0xd8:
+		header.type = MessagePackType::Extension;
+		break;
+	case 0xd9: case 0xda: case 0xdb:
+		header.type = MessagePackType::String;
+		width = uint64{1} << (tag - kStr8);
+		break;
+	case 0xdc: case 0xdd:
+		header.type = MessagePackType::Array;
+		width = uint64{2} << (tag - kArray16);
+		break;
+	case 0xde: case 0xdf:
+		header.type = MessagePackType::Map;
+		width = uint64{2} << (tag - kMap16);
+		break;
+
+	default:  // 0xc1 is never used
+		return makeError(BasicError::InvalidInput, "MessagePackReader");
+	}
+
+	bool const isExtension = (header.type == MessagePackType::Extension);
+	header.size = 1 + width + (isExtension ? 1 : 0);
+	if (data.size() < header.size) {
+		return truncated();
+	}
+
+	if (header.type == MessagePackType::Float) {
+		if (width == 4) {
+			auto const bits = loadBE<uint32>(bytes + 1);
+			float32 real;
+			memcpy(&real, &bits, sizeof(real));
+			header.real = real;
+		} else {
+			auto const bits = loadBE<uint64>(bytes + 1);
+			memcpy(&header.real, &bits, sizeof(header.real));
+		}
+	} else if (tag >= kInt8 && tag < kFixExt1) {
+		auto const value = loadBE(bytes + 1, width);
+		auto const shift = 64 - 8 * width;  // Sign extend
+		auto const signedValue = static_cast<int64>(value << shift) >> shift;
+		header.value = static_cast<uint64>(signedValue);
+		header.isNegative = (signedValue < 0);
+	} else if (tag >= kFixExt1 && tag < kStr8) {
+		header.value = uint64{1} << (tag - kFixExt1);
+		header.extensionType = static_cast<int8>(bytes[1]);
+	} else {
+		header.value = loadBE(bytes + 1, width);
+		if (isExtension) {
+			header.extensionType = static_cast<int8>(bytes[1 + width]);
+		}
+	}
+
+	return Result<Header, Error>{types::okTag, in_place, header};
+}
+
+
+/// Decode header of the next value and check that it is of the expected type.
+Result<Header, Error>
+expectHeader(ByteReader const& src, MessagePackType type, StringLiteral tag) noexcept {
+	auto header = parseHeader(src.viewRemaining());
+	if (header && header.unwrap().type != type) {
+		return makeError(BasicError::InvalidInput, tag);
+	}
+
+	return header;
+}
+
+
+/// Consume the value of a given header, @return View of the content of the value.
+Result<MemoryView, Error>
+consume(ByteReader& src, Header const& header) noexcept {
+	auto const remaining = src.remaining();
+	bool const hasContent = (header.type == MessagePackType::String ||
+							 header.type == MessagePackType::Binary ||
+							 header.type == MessagePackType::Extension);
+	auto const contentSize = hasContent ? header.value : 0;
+	if (remaining - header.size < contentSize) {
+		return makeError(BasicError::Overflow, "MessagePackReader");
+	}
+
+	auto const content = src.viewRemaining().slice(header.size, header.size + contentSize);
+	src.advance(header.size + contentSize);
+
+	return Result<MemoryView, Error>{types::okTag, in_place, content};
+}
+
+
+Result<void, Error>
+skipValue(ByteReader& src) noexcept {
+	auto const start = src.position();
+
+	uint64 pending = 1;
+	while (pending > 0) {
+		pending -= 1;
+
+		auto maybeHeader = parseHeader(src.viewRemaining());
+		if (!maybeHeader) {
+			src.position(start);
+			return maybeHeader.moveError();
+		}
+
+		auto const& header = maybeHeader.unwrap();
+		uint64 valueSize = header.size;
+		switch (header.type) {
+		case MessagePackType::String:
+		case MessagePackType::Binary:
+		case MessagePackType::Extension:
+			valueSize += header.value;
+			break;
+		case MessagePackType::Array:
+			pending += header.value;
+			break;
+		case MessagePackType::Map:
+			pending += 2 * header.value;
+			break;
+		case MessagePackType::Nil:
+		case MessagePackType::Boolean:
+		case MessagePackType::Integer:
+		case MessagePackType::Float:
+			break;
+		}
+
+		// Each pending element takes at least one byte: fail early on truncated containers
+		auto const remaining = src.remaining();
+		if (remaining < valueSize || remaining - valueSize < pending) {
+			src.position(start);
+			return makeError(BasicError::Overflow, "MessagePackReader::skip");
+		}
+
+		src.advance(valueSize);
+	}
+
+	return Ok();
+}
+
+
+Result<void, Error>
+writeValue(ByteWriter& dest, byte const* header, byte const* headerEnd, MemoryView content = {}) noexcept {
+	auto const headerSize = static_cast<MemoryView::size_type>(headerEnd - header);
+	if (dest.remaining() < headerSize || dest.remaining() - headerSize < content.size()) {
+		return makeError(BasicError::Overflow, "MessagePackWriter");
+	}
+
+	dest.write(wrapMemory(header, headerSize));
+	if (!content.empty()) {
+		dest.write(content);
+	}
+
+	return Ok();
+}
+
+
+/**
+ * Write a value with a length prefix.
+ * @param tag8 Tag of the encoding with 8 bit length, followed by tags of 16 and 32 bit lengths.
+ * @param fixTag Tag of the encoding with length in the tag or 0 if there is none.
+ * @param fixLimit Maximum length that can be encoded in the tag.
+ */
+Result<void, Error>
+writeSized(ByteWriter& dest, uint64 length, byte tag8, byte fixTag, uint64 fixLimit, MemoryView content) noexcept {
+	byte header[5];
+	byte* end = header;
+	if (fixTag && length <= fixLimit) {
+		*end++ = static_cast<byte>(fixTag | length);
+	} else if (length <= 0xff) {
+		*end++ = tag8;
+		end = storeBE(end, static_cast<uint8>(length));
+	} else if (length <= 0xffff) {
+		*end++ = static_cast<byte>(tag8 + 1);
+		end = storeBE(end, static_cast<uint16>(length));
+	} else if (length <= 0xffffffff) {
+		*end++ = static_cast<byte>(tag8 + 2);
+		end = storeBE(end, static_cast<uint32>(length));
+	} else {
+		return makeError(BasicError::Overflow, "MessagePackWriter");
+	}
+
+	return writeValue(dest, header, end, content);
+}
+
+
+/// Write header of a container, which has no 8 bit length encoding.
+Result<void, Error>
+writeContainerHeader(ByteWriter& dest, uint32 size, byte tag16, byte fixTag) noexcept {
+	byte header[5];
+	byte* end = header;
+	if (size < 16) {
+		*end++ = static_cast<byte>(fixTag | size);
+	} else if (size <= 0xffff) {
+		*end++ = tag16;
+		end = storeBE(end, static_cast<uint16>(size));
+	} else {
+		*end++ = static_cast<byte>(tag16 + 1);
+		end = storeBE(end, size);
+	}
+
+	return writeValue(dest, header, end);
+}
+
+}  // namespace
+
+
+Result<void, Error>
+MessagePackWriter::writeNil() noexcept {
+	return writeValue(_dest, &kNil, &kNil + 1);
+}
+
+
+Result<void, Error>
+MessagePackWriter::writeBool(bool value) noexcept {
+	byte const tag = value ? kTrue : kFalse;
+
+	return writeValue(_dest, &tag, &tag + 1);
+}
+
+
+Result<void, Error>
+MessagePackWriter::writeUInt(uint64 value) noexcept {
+	byte header[9];
+	byte* end = header;
+	if (value < 0x80) {
+		*end++ = static_cast<byte>(value);
+	} else if (value <= 0xff) {
+		*end++ = kUInt8;
+		end = storeBE(end, static_cast<uint8>(value));
+	} else if (value <= 0xffff) {
+		*end++ = kUInt8 + 1;
+		end = storeBE(end, static_cast<uint16>(value));
+	} else if (value <= 0xffffffff) {
+		*end++ = kUInt8 + 2;
+		end = storeBE(end, static_cast<uint32>(value));
+	} else {
+		*end++ = kUInt8 + 3;
+		end = storeBE(end, value);
+	}
+
+	return writeValue(_dest, header, end);
+}
+
+
+Result<void, Error>
+MessagePackWriter::writeInt(int64 value) noexcept {
+	if (value >= 0) {
+		return writeUInt(static_cast<uint64>(value));
+	}
+
+	byte header[9];
+	byte* end = header;
+	if (value >= -32) {
+		*end++ = static_cast<byte>(value);
+	} else if (value >= std::numeric_limits<int8>::min()) {
+		*end++ = kInt8;
+		end = storeBE(end, static_cast<uint8>(value));
+	} else if (value >= std::numeric_limits<int16>::min()) {
+		*end++ = kInt8 + 1;
+		end = storeBE(end, static_cast<uint16>(value));
+	} else if (value >= std::numeric_limits<int32>::min()) {
+		*end++ = kInt8 + 2;
+		end = storeBE(end, static_cast<uint32>(value));
+	} else {
+		*end++ = kInt8 + 3;
+		end = storeBE(end, static_cast<uint64>(value));
+	}
+
+	return writeValue(_dest, header, end);
+}
+
+
+Result<void, Error>
+MessagePackWriter::writeFloat(float32 value) noexcept {
+	uint32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	byte header[5] = {kFloat32};
+	return writeValue(_dest, header, storeBE(header + 1, bits));
+}
+
+
+Result<void, Error>
+MessagePackWriter::writeDouble(float64 value) noexcept {
+	uint64 bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	byte header[9] = {kFloat64};
+	return writeValue(_dest, header, storeBE(header + 1, bits));
+}
+
+
+Result<void, Error>
+MessagePackWriter::writeString(StringView value) noexcept {
+	return writeSized(_dest, value.size(), kStr8, kFixStr, 31, value.view());
+}
+
+
+Result<void, Error>
+MessagePackWriter::writeBinary(MemoryView value) noexcept {
+	return writeSized(_dest, value.size(), kBin8, 0, 0, value);
+}
+
+
+Result<void, Error>
+MessagePackWriter::writeExtension(int8 type, MemoryView data) noexcept {
+	auto const size = data.size();
+	switch (size) {
+	case 1: case 2: case 4: case 8: case 16: {
+		byte const header[] = {
+			static_cast<byte>(kFixExt1 + __builtin_ctzll(size)),
+			static_cast<byte>(type)
+		};
+		return writeValue(_dest, header, header + sizeof(header), data);
+	}
+	default:
+		break;
+	}
+
+	// Extension type follows the length
+	byte header[6];
+	byte* end = header;
+	if (size <= 0xff) {
+		*end++ = kExt8;
+		end = storeBE(end, static_cast<uint8>(size));
+	} else if (size <= 0xffff) {
+		*end++ = kExt8 + 1;
+		end = storeBE(end, static_cast<uint16>(size));
+	} else if (size <= 0xffffffff) {
+		*end++ = kExt8 + 2;
+		end = storeBE(end, static_cast<uint32>(size));
+	} else {
+		return makeError(BasicError::Overflow, "MessagePackWriter::writeExtension");
+	}
+	*end++ = static_cast<byte>(type);
+
+	return writeValue(_dest, header, end, data);
+}
+
+
+Result<void, Error>
+MessagePackWriter::writeArrayHeader(uint32 size) noexcept {
+	return writeContainerHeader(_dest, size, kArray16, kFixArray);
+}
+
+
+Result<void, Error>
+MessagePackWriter::writeMapHeader(uint32 size) noexcept {
+	return writeContainerHeader(_dest, size, kMap16, kFixMap);
+}
+
+
+
+Result<MessagePackType, Error>
+MessagePackReader::peekType() const noexcept {
+	auto header = parseHeader(_src.viewRemaining());
+	if (!header) {
+		return header.moveError();
+	}
+
+	return Result<MessagePackType, Error>{types::okTag, in_place, header.unwrap().type};
+}
+
+
+Result<void, Error>
+MessagePackReader::readNil() noexcept {
+	auto header = expectHeader(_src, MessagePackType::Nil, "MessagePackReader::readNil");
+	if (!header) {
+		return header.moveError();
+	}
+
+	_src.advance(header.unwrap().size);
+
+	return Ok();
+}
+
+
+Result<bool, Error>
+MessagePackReader::readBool() noexcept {
+	auto header = expectHeader(_src, MessagePackType::Boolean, "MessagePackReader::readBool");
+	if (!header) {
+		return header.moveError();
+	}
+
+	_src.advance(header.unwrap().size);
+
+	return Result<bool, Error>{types::okTag, in_place, header.unwrap().value != 0};
+}
+
+
+Result<int64, Error>
+MessagePackReader::readInt() noexcept {
+	auto header = expectHeader(_src, MessagePackType::Integer, "MessagePackReader::readInt");
+	if (!header) {
+		return header.moveError();
+	}
+
+	auto const& value = header.unwrap();
+	if (!value.isNegative && value.value > static_cast<uint64>(std::numeric_limits<int64>::max())) {
+		return makeError(BasicError::Overflow, "MessagePackReader::readInt");
+	}
+
+	_src.advance(value.size);
+
+	return Result<int64, Error>{types::okTag, in_place, static_cast<int64>(value.value)};
+}
+
+
+Result<uint64, Error>
+MessagePackReader::readUInt() noexcept {
+	auto header = expectHeader(_src, MessagePackType::Integer, "MessagePackReader::readUInt");
+	if (!header) {
+		return header.moveError();
+	}
+
+	auto const& value = header.unwrap();
+	if (value.isNegative) {
+		return makeError(BasicError::Overflow, "MessagePackReader::readUInt");
+	}
+
+	_src.advance(value.size);
+
+	return Result<uint64, Error>{types::okTag, in_place, value.value};
+}
+
+
+Result<float64, Error>
+MessagePackReader::readDouble() noexcept {
+	auto header = expectHeader(_src, MessagePackType::Float, "MessagePackReader::readDouble");
+	if (!header) {
+		return header.moveError();
+	}
+
+	_src.advance(header.unwrap().size);
+
+	return Result<float64, Error>{types::okTag, in_place, header.unwrap().real};
+}
+
+
+Result<MemoryView, Error>
+MessagePackReader::readStringData() noexcept {
+	auto header = expectHeader(_src, MessagePackType::String, "MessagePackReader::readString");
+	if (!header) {
+		return header.moveError();
+	}
+
+	return consume(_src, header.unwrap());
+}
+
+
+Result<StringView, Error>
+MessagePackReader::readString() noexcept {
+	auto header = expectHeader(_src, MessagePackType::String, "MessagePackReader::readString");
+	if (!header) {
+		return header.moveError();
+	}
+
+	if (header.unwrap().value > std::numeric_limits<StringView::size_type>::max()) {
+		return makeError(BasicError::Overflow, "MessagePackReader::readString");
+	}
+
+	auto content = consume(_src, header.unwrap());
+	if (!content) {
+		return content.moveError();
+	}
+
+	return Result<StringView, Error>{types::okTag, in_place, StringView{content.unwrap()}};
+}
+
+
+Result<MemoryView, Error>
+MessagePackReader::readBinary() noexcept {
+	auto header = expectHeader(_src, MessagePackType::Binary, "MessagePackReader::readBinary");
+	if (!header) {
+		return header.moveError();
+	}
+
+	return consume(_src, header.unwrap());
+}
+
+
+Result<MessagePackExtension, Error>
+MessagePackReader::readExtension() noexcept {
+	auto header = expectHeader(_src, MessagePackType::Extension, "MessagePackReader::readExtension");
+	if (!header) {
+		return header.moveError();
+	}
+
+	auto content = consume(_src, header.unwrap());
+	if (!content) {
+		return content.moveError();
+	}
+
+	return Result<MessagePackExtension, Error>{types::okTag, in_place,
+				MessagePackExtension{header.unwrap().extensionType, content.unwrap()}};
+}
+
+
+Result<uint32, Error>
+MessagePackReader::readArrayHeader() noexcept {
+	auto header = expectHeader(_src, MessagePackType::Array, "MessagePackReader::readArrayHeader");
+	if (!header) {
+		return header.moveError();
+	}
+
+	_src.advance(header.unwrap().size);
+
+	return Result<uint32, Error>{types::okTag, in_place, static_cast<uint32>(header.unwrap().value)};
+}
+
+
+Result<uint32, Error>
+MessagePackReader::readMapHeader() noexcept {
+	auto header = expectHeader(_src, MessagePackType::Map, "MessagePackReader::readMapHeader");
+	if (!header) {
+		return header.moveError();
+	}
+
+	_src.advance(header.unwrap().size);
+
+	return Result<uint32, Error>{types::okTag, in_place, static_cast<uint32>(header.unwrap().value)};
+}
+
+
+Result<void, Error>
+MessagePackReader::skip() noexcept {
+	SOLACE_PROBE("MessagePackReader::skip");
+
+	return skipValue(_src);
+}
+
+
+Result<void, Error>
+MessagePackReader::validate() const noexcept {
+	SOLACE_PROBE("MessagePackReader::validate");
+
+	// Skip on a reader of its own: the source shared with the caller is not touched
+	ByteReader reader{_src.viewRemaining()};
+
+	return skipValue(reader);
+}
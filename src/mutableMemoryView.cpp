@@ -20,22 +20,14 @@
  ******************************************************************************/
 #include "solace/mutableMemoryView.hpp"
 #include "solace/posixErrorDomain.hpp"
+#include "solace/memoryCopy.hpp"
 
-#include <cstring>  // std::memmove
 #include <algorithm>    // std::min/max
 
 
 using namespace Solace;
 
 
-MutableMemoryView::reference
-MutableMemoryView::operator[] (size_type index) {
-	assertIndexInRange(index, size(), "MutableMemoryView[]");
-
-	return begin()[index];
-}
-
-
 Result<void, Error>
 MutableMemoryView::write(MemoryView source) noexcept {
 	auto const thisSize = size();
@@ -52,7 +44,7 @@ MutableMemoryView::write(MemoryView source) noexcept {
 	}
 
     if (srcSize > 0) {
-		std::memmove(destAddress, source.dataAddress(), srcSize);
+		copyMemory(destAddress, source.dataAddress(), srcSize);
     }
 
 	return Ok();
@@ -68,14 +60,14 @@ MutableMemoryView::read(MutableMemoryView& dest) const noexcept {
 		return makeError(BasicError::Overflow, "dest is too small");
     }
 
-    std::memmove(dest.dataAddress(), dataAddress(), destSize);
+    copyMemory(dest.dataAddress(), dataAddress(), destSize);
 	return Ok();
 }
 
 
 MutableMemoryView&
 MutableMemoryView::fill(byte value) noexcept {
-	std::memset(dataAddress(), value, size());
+	fillMemory(dataAddress(), value, size());
 
     return (*this);
 }
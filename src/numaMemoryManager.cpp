@@ -0,0 +1,342 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+#include "solace/numaMemoryManager.hpp"
+#include "solace/posixErrorDomain.hpp"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <cstdlib>  // malloc, free
+
+
+using namespace Solace;
+
+
+namespace {
+
+// Memory policy mode from <linux/mempolicy.h>
+constexpr int kMpolBind = 2;
+
+constexpr uint64 kBitsPerMaskWord = 8 * sizeof(unsigned long);  // NOLINT(runtime/int)
+
+constexpr uint64 alignUp(uint64 value, uint64 alignment) noexcept {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+
+/**
+ * Read ids of the online NUMA nodes from sysfs. The list has a form of "0-3,5,7".
+ * @return Number of node ids written, 0 if the list is not available.
+ */
+uint32
+readOnlineNodes(uint32* nodes, uint32 maxNodes) noexcept {
+	auto const fd = open("/sys/devices/system/node/online", O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return 0;
+	}
+
+	char buffer[256];
+	auto const nbRead = read(fd, buffer, sizeof(buffer) - 1);
+	close(fd);
+	if (nbRead <= 0) {
+		return 0;
+	}
+	buffer[nbRead] = 0;
+
+	uint32 nbNodes = 0;
+	char const* c = buffer;
+	while (*c >= '0' && *c <= '9') {
+		uint32 first = 0;
+		for (; *c >= '0' && *c <= '9'; ++c) {
+			first = first * 10 + static_cast<uint32>(*c - '0');
+		}
+
+		uint32 last = first;
+		if (*c == '-') {
+			last = 0;
+			for (++c; *c >= '0' && *c <= '9'; ++c) {
+				last = last * 10 + static_cast<uint32>(*c - '0');
+			}
+		}
+
+		for (auto node = first; node <= last && node < maxNodes && nbNodes < maxNodes; ++node) {
+			nodes[nbNodes++] = node;
+		}
+
+		if (*c == ',') {
+			++c;
+		}
+	}
+
+	return nbNodes;
+}
+
+
+/// Bind memory range to the given node. Not all systems permit it, so failure is not an error.
+bool
+bindToNode(void* address, uint64 size, uint32 node) noexcept {
+#ifdef SYS_mbind
+	unsigned long mask[NumaMemoryManager::kMaxNodes / kBitsPerMaskWord] = {};  // NOLINT(runtime/int)
+	mask[node / kBitsPerMaskWord] = 1UL << (node % kBitsPerMaskWord);
+
+	// Kernel treats maxnode as a number of bits plus one
+	return syscall(SYS_mbind, address, size, kMpolBind, mask, NumaMemoryManager::kMaxNodes + 1, 0) == 0;
+#else
+	return false;
+#endif
+}
+
+}  // namespace
+
+
+NumaMemoryManager::NumaMemoryManager(size_type allowedCapacity)
+	: MemoryManager{allowedCapacity}
+{
+}
+
+
+NumaMemoryManager::~NumaMemoryManager() {
+	if (_mapping) {
+		munmap(_mapping, _mappingSize);
+	}
+}
+
+
+uint32
+NumaMemoryManager::currentNode() noexcept {
+	unsigned cpu = 0;
+	unsigned node = 0;
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+	if (getcpu(&cpu, &node) == 0) {  // vDSO call
+		return node;
+	}
+#elif defined(SYS_getcpu)
+	if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+		return node;
+	}
+#endif
+
+	return 0;
+}
+
+
+Result<void, Error>
+NumaMemoryManager::reserve(size_type poolSize) {
+	if (_mapping) {
+		return makeError(GenericError::BUSY, "NumaMemoryManager::reserve");
+	}
+
+	uint32 nodes[kMaxNodes];
+	auto nbNodes = readOnlineNodes(nodes, kMaxNodes);
+	if (nbNodes == 0) {  // No NUMA support: single pool
+		nodes[0] = 0;
+		nbNodes = 1;
+	}
+
+	auto const pageSize = getPageSize();
+	auto const alignedPoolSize = alignUp(poolSize, pageSize);
+	auto const mappingSize = alignedPoolSize * nbNodes;
+	if (poolSize == 0 || mappingSize > capacity()) {
+		return makeError(GenericError::INVAL, "NumaMemoryManager::reserve");
+	}
+
+	auto mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mapping == MAP_FAILED) {
+		return makeErrno("mmap");
+	}
+
+	for (uint32 i = 0; i < nbNodes; ++i) {
+		auto const poolBase = static_cast<byte*>(mapping) + i * alignedPoolSize;
+
+		auto& pool = _pools[i];
+		pool.node = nodes[i];
+		pool.isBound = (nbNodes > 1) && bindToNode(poolBase, alignedPoolSize, pool.node);
+		pool.disposer = PoolDisposer{*this, i};
+		pool.nbAllocations = 0;
+		pool.nbFallbacks = 0;
+
+		// Fault pages in after the policy is set so that they are placed on the node
+		for (uint64 offset = 0; offset < alignedPoolSize; offset += pageSize) {
+			poolBase[offset] = 0;
+		}
+
+		pool.arena.reset(poolBase, static_cast<size_type>(alignedPoolSize));
+	}
+
+	_mapping = mapping;
+	_mappingSize = static_cast<size_type>(mappingSize);
+	_nbPools = nbNodes;
+
+	return Ok();
+}
+
+
+NumaMemoryManager::NodePool*
+NumaMemoryManager::findPool(uint32 node) noexcept {
+	for (uint32 i = 0; i < _nbPools; ++i) {
+		if (_pools[i].node == node) {
+			return &_pools[i];
+		}
+	}
+
+	return nullptr;
+}
+
+
+NumaMemoryManager::NodePool const*
+NumaMemoryManager::findPool(uint32 node) const noexcept {
+	for (uint32 i = 0; i < _nbPools; ++i) {
+		if (_pools[i].node == node) {
+			return &_pools[i];
+		}
+	}
+
+	return nullptr;
+}
+
+
+Result<MemoryResource, Error>
+NumaMemoryManager::allocate(size_type nbBytes) noexcept {
+	if (_nbPools == 0) {
+		return allocateFromHeap(nbBytes);
+	}
+
+	auto pool = findPool(currentNode());
+
+	return allocateFrom(pool ? *pool : _pools[0], nbBytes);
+}
+
+
+Result<MemoryResource, Error>
+NumaMemoryManager::allocateOnNode(uint32 node, size_type nbBytes) noexcept {
+	auto pool = findPool(node);
+	if (!pool) {
+		return makeError(GenericError::INVAL, "NumaMemoryManager::allocateOnNode");
+	}
+
+	return allocateFrom(*pool, nbBytes);
+}
+
+
+Result<void, Error>
+NumaMemoryManager::charge(size_type nbBytes) noexcept {
+	std::lock_guard<std::mutex> lock{_mutex};
+	if (limit() < nbBytes) {
+		return makeError(GenericError::NOMEM, "allocate dataSize");
+	}
+
+	if (isLocked()) {
+		return makeError(GenericError::PERM, "locked");
+	}
+
+	onAllocated(nbBytes);
+
+	return Ok();
+}
+
+
+void
+NumaMemoryManager::discharge(size_type nbBytes) noexcept {
+	std::lock_guard<std::mutex> lock{_mutex};
+	onReleased(nbBytes);
+}
+
+
+Result<MemoryResource, Error>
+NumaMemoryManager::allocateFrom(NodePool& pool, size_type nbBytes) noexcept {
+	auto const blockSize = details::FreeListArena::blockSize(nbBytes);
+	auto charged = charge(blockSize);
+	if (!charged) {
+		return charged.moveError();
+	}
+
+	MutableMemoryView block;
+	{
+		std::lock_guard<std::mutex> lock{pool.mutex};
+		block = pool.arena.allocate(nbBytes);
+		if (block.empty()) {
+			pool.nbFallbacks += 1;
+		} else {
+			pool.nbAllocations += 1;
+		}
+	}
+
+	if (block.empty()) {
+		discharge(blockSize);
+
+		return allocateFromHeap(nbBytes);
+	}
+
+	return {types::okTag, in_place, block, &pool.disposer};
+}
+
+
+Result<MemoryResource, Error>
+NumaMemoryManager::allocateFromHeap(size_type nbBytes) noexcept {
+	auto charged = charge(nbBytes);
+	if (!charged) {
+		return charged.moveError();
+	}
+
+	auto data = ::malloc(nbBytes);
+	if (!data && nbBytes) {
+		discharge(nbBytes);
+
+		return makeError(GenericError::NOMEM, "malloc failed");
+	}
+
+	return {types::okTag, in_place, wrapMemory(data, nbBytes), &_heapDisposer};
+}
+
+
+Result<NumaNodeUsage, Error>
+NumaMemoryManager::nodeUsage(uint32 node) const noexcept {
+	auto pool = findPool(node);
+	if (!pool) {
+		return makeError(GenericError::INVAL, "NumaMemoryManager::nodeUsage");
+	}
+
+	std::lock_guard<std::mutex> lock{pool->mutex};
+	return Ok(NumaNodeUsage{pool->node,
+							pool->arena.capacity(),
+							pool->arena.capacity() - pool->arena.available(),
+							pool->nbAllocations,
+							pool->nbFallbacks,
+							pool->isBound});
+}
+
+
+void
+NumaMemoryManager::PoolDisposer::dispose(MemoryView* view) const {
+	_self->release(_index, view);
+}
+
+
+void
+NumaMemoryManager::release(uint32 index, MemoryView* view) noexcept {
+	if (index == kHeapIndex) {
+		::free(const_cast<MemoryView::MutableMemoryAddress>(view->dataAddress()));
+	} else {
+		auto& pool = _pools[index];
+		std::lock_guard<std::mutex> lock{pool.mutex};
+		pool.arena.release(*view);
+	}
+
+	discharge(view->size());
+}
@@ -0,0 +1,161 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Pinned memory manager
+ *	@file		pinnedMemoryManager.cpp
+ *	@brief		Implementation of the pinned memory manager
+ ******************************************************************************/
+#include "solace/pinnedMemoryManager.hpp"
+#include "solace/posixErrorDomain.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+using namespace Solace;
+
+
+namespace {
+
+constexpr uint64 kHugePageSize = 2 * 1024 * 1024;
+
+constexpr uint64 alignUp(uint64 value, uint64 alignment) noexcept {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}  // namespace
+
+
+PinnedMemoryManager::PinnedMemoryManager(size_type allowedCapacity, PinnedMemoryConfig const& config)
+	: MemoryManager{allowedCapacity}
+	, _config{config}
+	, _arenaDisposer{*this}
+{
+}
+
+
+PinnedMemoryManager::~PinnedMemoryManager() {
+	if (_mapping) {
+		munlock(_mapping, _arena.capacity());
+		munmap(_mapping, _arena.capacity());
+	}
+}
+
+
+Result<void, Error>
+PinnedMemoryManager::reserve(size_type arenaSize) {
+	if (_mapping) {
+		return makeError(GenericError::BUSY, "PinnedMemoryManager::reserve");
+	}
+
+	if (arenaSize == 0 || arenaSize > capacity()) {
+		return makeError(GenericError::INVAL, "PinnedMemoryManager::reserve");
+	}
+
+	void* arena = MAP_FAILED;
+	uint64 mappedSize = 0;
+	bool usesHugePages = false;
+
+#ifdef MAP_HUGETLB
+	if (_config.useHugePages) {
+		mappedSize = alignUp(arenaSize, kHugePageSize);
+		if (mappedSize <= capacity()) {
+			arena = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE,
+						 MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE | MAP_HUGETLB, -1, 0);
+			usesHugePages = (arena != MAP_FAILED);
+		}
+	}
+#endif
+
+	if (arena == MAP_FAILED) {  // No huge pages reserved by the system: use normal pages
+		mappedSize = alignUp(arenaSize, getPageSize());
+		if (mappedSize > capacity()) {
+			return makeError(GenericError::INVAL, "PinnedMemoryManager::reserve");
+		}
+
+		arena = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE,
+					 MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+		if (arena == MAP_FAILED) {
+			return makeErrno("mmap");
+		}
+
+#ifdef MADV_HUGEPAGE
+		if (_config.useHugePages) {
+			madvise(arena, mappedSize, MADV_HUGEPAGE);
+		}
+#endif
+	}
+
+	if (mlock(arena, mappedSize) != 0) {
+		auto error = makeErrno("mlock");
+		munmap(arena, mappedSize);
+
+		return error;
+	}
+
+	_mapping = arena;
+	_arena.reset(static_cast<byte*>(arena), static_cast<size_type>(mappedSize));
+	_usesHugePages = usesHugePages;
+
+	return Ok();
+}
+
+
+Result<MemoryResource, Error>
+PinnedMemoryManager::allocate(size_type nbBytes) noexcept {
+	if (limit() < nbBytes) {
+		return makeError(GenericError::NOMEM, "allocate dataSize");
+	}
+
+	if (isLocked()) {
+		return makeError(GenericError::PERM, "locked");
+	}
+
+	// Arena blocks are charged at their rounded size, so the limit is checked against the same value
+	if (limit() >= details::FreeListArena::blockSize(nbBytes)) {
+		auto block = _arena.allocate(nbBytes);
+		if (!block.empty()) {
+			onAllocated(block.size());
+
+			return {types::okTag, in_place, block, &_arenaDisposer};
+		}
+	}
+
+	if (!_config.allowFallback) {
+		return makeError(GenericError::NOMEM, "PinnedMemoryManager::allocate");
+	}
+
+	_nbFallbacks += 1;
+	_fallbackBytes += nbBytes;
+	if (_config.onFallback) {
+		_config.onFallback(nbBytes, _config.fallbackContext);
+	}
+
+	return MemoryManager::allocate(nbBytes);
+}
+
+
+void
+PinnedMemoryManager::ArenaDisposer::dispose(MemoryView* view) const {
+	_self->release(view);
+}
+
+
+void
+PinnedMemoryManager::release(MemoryView* view) noexcept {
+	_arena.release(*view);
+	onReleased(view->size());
+}
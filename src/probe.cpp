@@ -0,0 +1,299 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ *	@file		probe.cpp
+ *	@brief		Implementation of latency probes and their histograms
+ ******************************************************************************/
+#include "solace/probe.hpp"
+#include "solace/details/thread_tables.hpp"
+
+#include <atomic>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+
+using namespace Solace;
+
+
+bool Solace::details::gProbeUsesTsc = false;
+
+
+namespace  {
+
+constexpr uint32 kNbThreadTables = 16;
+constexpr size_t kCacheLineSize = 64;
+
+/**
+ * Histogram layout: values below kNbSubBuckets are counted exactly, every following power of two range
+ * is split into kNbSubBuckets linear buckets. Values above 2^kMaxExponent ticks are counted in the last bucket.
+ */
+constexpr uint32 kSubBucketBits = 4;
+constexpr uint32 kNbSubBuckets = 1 << kSubBucketBits;
+constexpr uint32 kMaxExponent = 40;
+constexpr uint32 kNbBuckets = (kMaxExponent - kSubBucketBits + 2) * kNbSubBuckets;
+
+
+constexpr uint32
+bucketIndex(uint64 value) noexcept {
+	if (value < kNbSubBuckets) {
+		return static_cast<uint32>(value);
+	}
+
+	auto const exponent = static_cast<uint32>(63 - __builtin_clzll(value));
+	if (exponent > kMaxExponent) {
+		return kNbBuckets - 1;
+	}
+
+	auto const shift = exponent - kSubBucketBits;
+	auto const subBucket = static_cast<uint32>(value >> shift) & (kNbSubBuckets - 1);
+
+	return (shift + 1) * kNbSubBuckets + subBucket;
+}
+
+
+/// @return Lowest value counted in the bucket.
+constexpr uint64
+bucketLowestValue(uint32 index) noexcept {
+	return (index < kNbSubBuckets)
+			? index
+			: static_cast<uint64>(kNbSubBuckets + index % kNbSubBuckets) << (index / kNbSubBuckets - 1);
+}
+
+
+/// @return Highest value counted in the bucket.
+constexpr uint64
+bucketValue(uint32 index) noexcept {
+	return (index < kNbSubBuckets)
+			? index
+			: bucketLowestValue(index) + (uint64{1} << (index / kNbSubBuckets - 1)) - 1;
+}
+
+static_assert(bucketIndex(kNbSubBuckets - 1) == kNbSubBuckets - 1, "Small values are counted exactly");
+static_assert(bucketValue(bucketIndex(1000)) >= 1000 && bucketValue(bucketIndex(1000) - 1) < 1000,
+			  "Bucket value is the highest value of the bucket");
+static_assert(bucketIndex(uint64{1} << (kMaxExponent + 1)) == kNbBuckets - 1, "Last bucket counts overflow");
+
+
+struct Histogram {
+	std::atomic<uint64>		totalTicks{0};
+	std::atomic<uint64>		buckets[kNbBuckets];
+};
+
+
+/// Histograms of all probes recorded by a thread, aligned to a cache line to avoid false sharing.
+struct alignas(kCacheLineSize) ProbeTable {
+	std::atomic<bool>	isOwned{false};
+	Histogram			histograms[kMaxProbes];
+};
+
+
+details::ThreadTableRegistry<ProbeTable, kNbThreadTables>	kProbeTables;
+
+
+/// Registry of probe names.
+struct ProbeRegistry {
+	std::mutex		mutex;
+	std::atomic<uint32>	size{0};
+	StringLiteral	names[kMaxProbes];
+
+	// Reference point to calibrate time stamp counter against the monotonic clock
+	uint64			startTicks{0};
+	uint64			startNs{0};
+};
+
+ProbeRegistry&
+registry() noexcept {
+	static ProbeRegistry instance;
+	return instance;
+}
+
+
+uint64
+monotonicNs() noexcept {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return static_cast<uint64>(ts.tv_sec) * 1000000000ULL + static_cast<uint64>(ts.tv_nsec);
+}
+
+
+/// Time stamp counter is only usable as a clock if it runs at a constant rate, regardless of CPU power states.
+bool
+hasInvariantTsc() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+	unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+	if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007) {
+		return false;
+	}
+
+	__cpuid(0x80000007, eax, ebx, ecx, edx);
+	return (edx & (1U << 8)) != 0;
+#else
+	return false;
+#endif
+}
+
+
+/**
+ * Get the number of nanoseconds per probe clock tick.
+ * Time stamp counter frequency is measured against the monotonic clock over the time since the first probe
+ * was registered, but for no less than a few milliseconds.
+ */
+double
+nanosecondsPerTick(ProbeRegistry& reg) noexcept {
+	if (!details::gProbeUsesTsc) {
+		return 1.0;
+	}
+
+	constexpr uint64 kMinCalibrationNs = 5 * 1000 * 1000;
+	auto nowNs = monotonicNs();
+	while (nowNs - reg.startNs < kMinCalibrationNs) {
+		nowNs = monotonicNs();
+	}
+
+	auto const elapsedTicks = probeTicks() - reg.startTicks;
+	return static_cast<double>(nowNs - reg.startNs) / static_cast<double>(elapsedTicks ? elapsedTicks : 1);
+}
+
+
+/// @return Value of the histogram at the given quantile, in ticks.
+uint64
+quantile(uint64 const (&buckets)[kNbBuckets], uint64 count, double q) noexcept {
+	auto const rank = static_cast<uint64>(q * static_cast<double>(count));
+	uint64 seen = 0;
+	for (uint32 i = 0; i < kNbBuckets; ++i) {
+		seen += buckets[i];
+		if (seen > rank) {
+			return bucketValue(i);
+		}
+	}
+
+	return bucketValue(kNbBuckets - 1);
+}
+
+}  // namespace
+
+
+ProbeId
+Solace::registerProbe(StringLiteral name) noexcept {
+	auto& reg = registry();
+	std::lock_guard<std::mutex> lock{reg.mutex};
+
+	auto const size = reg.size.load(std::memory_order_relaxed);
+	for (uint32 i = 0; i < size; ++i) {
+		if (reg.names[i] == name) {
+			return i;
+		}
+	}
+
+	if (size == 0) {  // Clock source is chosen before any probe can record a duration
+		details::gProbeUsesTsc = hasInvariantTsc();
+		reg.startNs = monotonicNs();
+		reg.startTicks = probeTicks();
+	}
+
+	if (size >= kMaxProbes) {
+		return kInvalidProbe;
+	}
+
+	reg.names[size] = name;
+	reg.size.store(size + 1, std::memory_order_release);
+
+	return size;
+}
+
+
+void
+Solace::recordProbe(ProbeId probe, uint64 ticks) noexcept {
+	if (probe >= kMaxProbes) {
+		return;
+	}
+
+	auto& table = kProbeTables.threadTable();
+	auto const isShared = kProbeTables.isShared(table);
+	auto& histogram = table.histograms[probe];
+
+	details::incrementCounter(histogram.buckets[bucketIndex(ticks)], 1, isShared);
+	details::incrementCounter(histogram.totalTicks, ticks, isShared);
+}
+
+
+uint32
+Solace::probeStatsSnapshot(ArrayView<ProbeStats> dest) noexcept {
+	auto& reg = registry();
+	auto const nbProbes = reg.size.load(std::memory_order_acquire);
+	auto const nsPerTick = (nbProbes != 0) ? nanosecondsPerTick(reg) : 1.0;
+	auto const toNs = [nsPerTick](uint64 ticks) { return static_cast<uint64>(static_cast<double>(ticks) * nsPerTick); };
+
+	uint32 nbEntries = 0;
+	for (uint32 probe = 0; probe < nbProbes && nbEntries < dest.size(); ++probe) {
+		uint64 buckets[kNbBuckets] = {};
+		uint64 count = 0;
+		uint64 totalTicks = 0;
+
+		auto const merge = [&](ProbeTable const& table) {
+			auto const& histogram = table.histograms[probe];
+			totalTicks += histogram.totalTicks.load(std::memory_order_relaxed);
+			for (uint32 i = 0; i < kNbBuckets; ++i) {
+				auto const n = histogram.buckets[i].load(std::memory_order_relaxed);
+				buckets[i] += n;
+				count += n;
+			}
+		};
+
+		kProbeTables.forEach(merge);
+
+		ProbeStats stats{reg.names[probe], count, 0, 0, 0, 0, 0, 0};
+		if (count != 0) {
+			uint32 first = 0;
+			while (buckets[first] == 0) {
+				++first;
+			}
+
+			uint32 last = kNbBuckets - 1;
+			while (buckets[last] == 0) {
+				--last;
+			}
+
+			stats.meanNs = toNs(totalTicks / count);
+			stats.minNs = toNs(bucketLowestValue(first));
+			stats.p50Ns = toNs(quantile(buckets, count, 0.5));
+			stats.p99Ns = toNs(quantile(buckets, count, 0.99));
+			stats.p999Ns = toNs(quantile(buckets, count, 0.999));
+			stats.maxNs = toNs(bucketValue(last));
+		}
+
+		dest[nbEntries++] = stats;
+	}
+
+	return nbEntries;
+}
+
+
+void
+Solace::probeStatsReset() noexcept {
+	kProbeTables.forEach([](ProbeTable& table) {
+		for (auto& histogram : table.histograms) {
+			histogram.totalTicks.store(0, std::memory_order_relaxed);
+			for (auto& bucket : histogram.buckets) {
+				bucket.store(0, std::memory_order_relaxed);
+			}
+		}
+	});
+}
@@ -0,0 +1,87 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace
+ *	@file		sharedString.cpp
+ *	@brief		Implementation of the shared immutable string.
+ ******************************************************************************/
+#include "solace/sharedString.hpp"
+
+#include <cstring>  // memcpy
+
+
+using namespace Solace;
+
+
+namespace {
+
+/// Offset of string data in a block: data follows the header.
+constexpr size_t kDataOffset = sizeof(details::SharedStringBlock);
+
+}  // namespace
+
+
+void
+SharedString::release() noexcept {
+	auto const block = exchange(_block, nullptr);
+	if (block && block->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		// Memory of the block is moved out of it before the block is destroyed, and freed last
+		auto memory = mv(block->memory);
+		dtor(*block);
+	}
+
+	_data = nullptr;
+	_size = 0;
+}
+
+
+SharedString
+SharedString::substring(size_type from, size_type len) const noexcept {
+	auto const start = (from < _size) ? from : _size;
+	auto const count = (len < _size - start) ? len : static_cast<size_type>(_size - start);
+
+	SharedString result{_block, _data + start, count};
+	result.retain();
+
+	return result;
+}
+
+
+SharedString
+Solace::makeSharedString(StringLiteral literal) noexcept {
+	return SharedString{nullptr, literal.data(), literal.size()};
+}
+
+
+Result<SharedString, Error>
+Solace::makeSharedString(MemoryManager& memoryManager, StringView view) {
+	if (view.empty()) {
+		return Result<SharedString, Error>{types::okTag, in_place};
+	}
+
+	auto maybeMemory = memoryManager.allocate(kDataOffset + view.size());
+	if (!maybeMemory) {
+		return maybeMemory.moveError();
+	}
+
+	auto const address = static_cast<byte*>(maybeMemory.unwrap().view().dataAddress());
+	auto const data = reinterpret_cast<char*>(address + kDataOffset);
+	memcpy(data, view.data(), view.size());
+
+	auto const block = ctor(*reinterpret_cast<details::SharedStringBlock*>(address), maybeMemory.moveResult());
+
+	return Result<SharedString, Error>{types::okTag, in_place, SharedString{block, data, view.size()}};
+}
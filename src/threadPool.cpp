@@ -0,0 +1,623 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace: Work-stealing thread pool
+ *	@file		threadPool.cpp
+ *	@brief		Implementation of the work-stealing thread pool
+ ******************************************************************************/
+#include "solace/threadPool.hpp"
+#include "solace/posixErrorDomain.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+#include <unistd.h>
+#ifdef SOLACE_PLATFORM_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+
+using namespace Solace;
+using details::TaskFrame;
+
+
+namespace {
+
+constexpr uint32 kCacheLineSize = 64;
+constexpr uint32 kSpinsBeforeSleep = 128;
+
+
+inline void cpuRelax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+	_mm_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield" ::: "memory");
+#endif
+}
+
+constexpr bool isPowerOf2(uint32 x) noexcept {
+	return x && !(x & (x - 1));
+}
+
+constexpr uint64 alignUp(uint64 value, uint64 alignment) noexcept {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+
+/**
+ * Fixed capacity Chase-Lev work-stealing deque.
+ * Owner pushes and takes from the bottom, thieves steal from the top.
+ * Memory orderings follow "Correct and Efficient Work-Stealing for Weak Memory Models" by Le et al.
+ */
+struct ChaseLevDeque {
+	alignas(kCacheLineSize) std::atomic<int64>	top{0};
+	alignas(kCacheLineSize) std::atomic<int64>	bottom{0};
+	std::atomic<TaskFrame*>*					buffer{nullptr};
+	int64										mask{0};
+
+	bool push(TaskFrame* frame) noexcept {
+		auto const b = bottom.load(std::memory_order_relaxed);
+		auto const t = top.load(std::memory_order_acquire);
+		if (b - t > mask) {
+			return false;
+		}
+
+		buffer[b & mask].store(frame, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+
+		return true;
+	}
+
+	TaskFrame* take() noexcept {
+		auto const b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		auto t = top.load(std::memory_order_relaxed);
+
+		if (t > b) {  // Deque was empty
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		auto frame = buffer[b & mask].load(std::memory_order_relaxed);
+		if (t == b) {  // Last element: race against thieves
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				frame = nullptr;
+			}
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+
+		return frame;
+	}
+
+	TaskFrame* steal() noexcept {
+		auto t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		auto const b = bottom.load(std::memory_order_acquire);
+		if (t >= b) {
+			return nullptr;
+		}
+
+		auto frame = buffer[t & mask].load(std::memory_order_relaxed);
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return nullptr;
+		}
+
+		return frame;
+	}
+};
+
+
+/**
+ * Bounded multi-producer multi-consumer queue by D. Vyukov.
+ * Used to inject tasks submitted by threads that are not pool workers.
+ */
+struct InjectionQueue {
+	struct Cell {
+		std::atomic<uint64>	sequence;
+		TaskFrame*			frame;
+	};
+
+	alignas(kCacheLineSize) std::atomic<uint64>	enqueuePos{0};
+	alignas(kCacheLineSize) std::atomic<uint64>	dequeuePos{0};
+	Cell*										cells{nullptr};
+	uint64										mask{0};
+
+	bool push(TaskFrame* frame) noexcept {
+		Cell* cell;
+		auto pos = enqueuePos.load(std::memory_order_relaxed);
+		for (;;) {
+			cell = &cells[pos & mask];
+			auto const seq = cell->sequence.load(std::memory_order_acquire);
+			auto const diff = static_cast<int64>(seq) - static_cast<int64>(pos);
+			if (diff == 0) {
+				if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (diff < 0) {  // Full
+				return false;
+			} else {
+				pos = enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		cell->frame = frame;
+		cell->sequence.store(pos + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	TaskFrame* pop() noexcept {
+		Cell* cell;
+		auto pos = dequeuePos.load(std::memory_order_relaxed);
+		for (;;) {
+			cell = &cells[pos & mask];
+			auto const seq = cell->sequence.load(std::memory_order_acquire);
+			auto const diff = static_cast<int64>(seq) - static_cast<int64>(pos + 1);
+			if (diff == 0) {
+				if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (diff < 0) {  // Empty
+				return nullptr;
+			} else {
+				pos = dequeuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		auto frame = cell->frame;
+		cell->sequence.store(pos + mask + 1, std::memory_order_release);
+
+		return frame;
+	}
+};
+
+
+/**
+ * Lock-free stack of free task frames.
+ * Head packs an ABA tag in the upper 32 bits and index + 1 of the top frame in the lower 32 bits.
+ */
+struct FramePool {
+	alignas(kCacheLineSize) std::atomic<uint64>	head{0};
+	TaskFrame*									frames{nullptr};
+
+	static constexpr uint64 kIndexMask = 0xFFFFFFFF;
+
+	TaskFrame* pop() noexcept {
+		auto h = head.load(std::memory_order_acquire);
+		for (;;) {
+			auto const index = h & kIndexMask;
+			if (index == 0) {
+				return nullptr;
+			}
+
+			auto frame = frames + (index - 1);
+			auto const next = frame->nextFree.load(std::memory_order_relaxed);
+			auto const newHead = (((h >> 32) + 1) << 32) | next;
+			if (head.compare_exchange_weak(h, newHead, std::memory_order_acquire, std::memory_order_acquire)) {
+				return frame;
+			}
+		}
+	}
+
+	void push(TaskFrame* frame) noexcept {
+		auto const index = static_cast<uint64>(frame - frames) + 1;
+		auto h = head.load(std::memory_order_relaxed);
+		do {
+			frame->nextFree.store(static_cast<uint32>(h & kIndexMask), std::memory_order_relaxed);
+		} while (!head.compare_exchange_weak(h, (((h >> 32) + 1) << 32) | index,
+											 std::memory_order_release, std::memory_order_relaxed));
+	}
+};
+
+
+struct Worker {
+	ChaseLevDeque					deque;
+	details::ThreadPoolState*		pool{nullptr};
+	uint32							index{0};
+	uint32							rngState{1};
+	std::thread						thread;
+
+	uint32 nextRandom() noexcept {  // xorshift32
+		auto x = rngState;
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		rngState = x;
+
+		return x;
+	}
+};
+
+
+thread_local Worker* tCurrentWorker = nullptr;
+
+}  // namespace
+
+
+namespace Solace { namespace details {
+
+struct ThreadPoolState {
+	Worker*						workers{nullptr};
+	uint32						nbWorkers{0};
+	uint32						nbFrames{0};
+	InjectionQueue				injectionQueue;
+	FramePool					framePool;
+
+	alignas(kCacheLineSize) std::atomic<uint64>		nbPendingTasks{0};
+	alignas(kCacheLineSize) std::atomic<uint64>		epoch{0};
+	std::atomic<uint32>								nbSleeping{0};
+	std::atomic<bool>								stop{false};
+	std::mutex										mutex;
+	std::condition_variable							wakeup;
+
+	void notify() noexcept {
+		epoch.fetch_add(1, std::memory_order_seq_cst);
+		if (nbSleeping.load(std::memory_order_seq_cst) > 0) {
+			std::lock_guard<std::mutex> lock{mutex};
+			wakeup.notify_one();
+		}
+	}
+
+	void shutdown() noexcept {
+		{
+			std::lock_guard<std::mutex> lock{mutex};
+			stop.store(true, std::memory_order_release);
+		}
+		wakeup.notify_all();
+	}
+
+	TaskFrame* findTask(Worker* self) noexcept {
+		if (self && self->pool == this) {
+			if (auto frame = self->deque.take()) {
+				return frame;
+			}
+		}
+
+		if (auto frame = injectionQueue.pop()) {
+			return frame;
+		}
+
+		uint32 const start = self ? self->nextRandom() : static_cast<uint32>(epoch.load(std::memory_order_relaxed));
+		for (uint32 i = 0; i < nbWorkers; ++i) {
+			auto& victim = workers[(start + i) % nbWorkers];
+			if (&victim == self) {
+				continue;
+			}
+
+			if (auto frame = victim.deque.steal()) {
+				return frame;
+			}
+		}
+
+		return nullptr;
+	}
+
+	void run(TaskFrame* frame) noexcept {
+		bool const detached = frame->detached;
+		frame->run(frame);
+
+		if (detached) {
+			framePool.push(frame);
+		} else {
+			frame->state.store(TaskFrame::Done, std::memory_order_release);
+		}
+
+		nbPendingTasks.fetch_sub(1, std::memory_order_release);
+	}
+
+	void workerLoop(Worker* self) noexcept {
+		tCurrentWorker = self;
+
+		uint32 spins = 0;
+		for (;;) {
+			if (auto frame = findTask(self)) {
+				run(frame);
+				spins = 0;
+				continue;
+			}
+
+			if (stop.load(std::memory_order_acquire)) {
+				break;
+			}
+
+			if (++spins < kSpinsBeforeSleep) {
+				cpuRelax();
+				continue;
+			}
+
+			// Check for work once more after taking an epoch snapshot: any task submitted after the snapshot
+			// bumps the epoch and is noticed below before going to sleep.
+			auto const snapshot = epoch.load(std::memory_order_seq_cst);
+			if (auto frame = findTask(self)) {
+				run(frame);
+				spins = 0;
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock{mutex};
+			nbSleeping.fetch_add(1, std::memory_order_seq_cst);
+			while (epoch.load(std::memory_order_seq_cst) == snapshot && !stop.load(std::memory_order_acquire)) {
+				wakeup.wait(lock);
+			}
+			nbSleeping.fetch_sub(1, std::memory_order_relaxed);
+			spins = 0;
+		}
+
+		tCurrentWorker = nullptr;
+	}
+};
+
+}}  // namespace Solace::details
+
+
+namespace {
+
+void pinThread(std::thread& thread, uint32 index) noexcept {
+#ifdef SOLACE_PLATFORM_LINUX
+	cpu_set_t available;
+	CPU_ZERO(&available);
+	if (sched_getaffinity(0, sizeof(available), &available) != 0) {
+		return;
+	}
+
+	auto const nbCpus = CPU_COUNT(&available);
+	if (nbCpus <= 0) {
+		return;
+	}
+
+	// Pick index-th CPU out of those the process is allowed to run on
+	int target = static_cast<int>(index % static_cast<uint32>(nbCpus));
+	for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+		if (CPU_ISSET(cpu, &available) && target-- == 0) {
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(cpu, &set);
+			pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+			return;
+		}
+	}
+#else
+	(void)thread;
+	(void)index;
+#endif
+}
+
+
+void stopWorkers(details::ThreadPoolState* state, uint32 nbStarted) noexcept {
+	state->shutdown();
+	for (uint32 i = 0; i < nbStarted; ++i) {
+		if (state->workers[i].thread.joinable()) {
+			state->workers[i].thread.join();
+		}
+	}
+}
+
+
+void destroyState(details::ThreadPoolState* state) noexcept {
+	for (uint32 i = 0; i < state->nbFrames; ++i) {
+		dtor(state->framePool.frames[i]);
+	}
+	for (uint32 i = 0; i < state->nbWorkers; ++i) {
+		dtor(state->workers[i]);
+	}
+
+	dtor(*state);
+}
+
+bool runPendingTask(details::ThreadPoolState* pool) noexcept {
+	auto frame = pool->findTask(tCurrentWorker);
+	if (!frame) {
+		return false;
+	}
+
+	pool->run(frame);
+
+	return true;
+}
+
+}  // namespace
+
+
+ThreadPool::~ThreadPool() {
+	if (!_state) {
+		return;
+	}
+
+	// Let all the tasks submitted so far complete
+	while (_state->nbPendingTasks.load(std::memory_order_acquire) != 0) {
+		if (!tryRunPendingTask()) {
+			std::this_thread::yield();
+		}
+	}
+
+	stopWorkers(_state, _state->nbWorkers);
+	destroyState(_state);
+	_state = nullptr;
+}
+
+
+ThreadPool::size_type
+ThreadPool::size() const noexcept {
+	return _state ? _state->nbWorkers : 0;
+}
+
+
+Result<TaskFrame*, Error>
+ThreadPool::allocateFrame(bool detached) noexcept {
+	auto frame = _state->framePool.pop();
+	if (!frame) {
+		return makeError(GenericError::AGAIN, "ThreadPool::allocateFrame");
+	}
+
+	frame->state.store(TaskFrame::Pending, std::memory_order_relaxed);
+	frame->detached = detached;
+
+	return Ok(frame);
+}
+
+
+void
+ThreadPool::releaseFrame(TaskFrame* frame) noexcept {
+	releaseTaskFrame(_state, frame);
+}
+
+
+void
+Solace::details::releaseTaskFrame(ThreadPoolState* pool, TaskFrame* frame) noexcept {
+	pool->framePool.push(frame);
+}
+
+
+void
+ThreadPool::schedule(TaskFrame* frame) noexcept {
+	_state->nbPendingTasks.fetch_add(1, std::memory_order_relaxed);
+
+	auto const self = tCurrentWorker;
+	bool const queued = (self && self->pool == _state && self->deque.push(frame))
+			|| _state->injectionQueue.push(frame);
+
+	if (queued) {
+		_state->notify();
+	} else {  // All queues are full: the best we can do is to run the task right away
+		_state->run(frame);
+	}
+}
+
+
+bool
+ThreadPool::tryRunPendingTask() noexcept {
+	return runPendingTask(_state);
+}
+
+
+void
+ThreadPool::waitFor(TaskFrame const* frame) noexcept {
+	waitForTask(_state, frame);
+}
+
+
+void
+Solace::details::waitForTask(ThreadPoolState* pool, TaskFrame const* frame) noexcept {
+	while (frame->state.load(std::memory_order_acquire) != TaskFrame::Done) {
+		if (!runPendingTask(pool)) {
+			cpuRelax();
+		}
+	}
+}
+
+
+void
+ThreadPool::waitForHelpers(std::atomic<uint32> const& nbActive) noexcept {
+	while (nbActive.load(std::memory_order_acquire) != 0) {
+		if (!tryRunPendingTask()) {
+			cpuRelax();
+		}
+	}
+}
+
+
+Result<ThreadPool, Error>
+Solace::makeThreadPool(MemoryManager& memoryManager, ThreadPoolConfig const& config) {
+	if (!isPowerOf2(config.dequeCapacity) ||
+		!isPowerOf2(config.injectionQueueCapacity) ||
+		config.nbTaskFrames == 0 || config.nbTaskFrames == FramePool::kIndexMask) {
+		return makeError(GenericError::INVAL, "makeThreadPool");
+	}
+
+	uint32 nbWorkers = config.nbWorkers;
+	if (nbWorkers == 0) {
+		auto const nbCpus = sysconf(_SC_NPROCESSORS_ONLN);
+		nbWorkers = (nbCpus > 0) ? static_cast<uint32>(nbCpus) : 1;
+	}
+
+	// Layout of a single memory block holding all of the pool state
+	uint64 const stateOffset = 0;
+	uint64 const workersOffset = alignUp(stateOffset + sizeof(details::ThreadPoolState), kCacheLineSize);
+	uint64 const dequesOffset = alignUp(workersOffset + uint64{nbWorkers} * sizeof(Worker), kCacheLineSize);
+	uint64 const dequeSize = uint64{config.dequeCapacity} * sizeof(std::atomic<TaskFrame*>);
+	uint64 const cellsOffset = alignUp(dequesOffset + nbWorkers * dequeSize, kCacheLineSize);
+	uint64 const framesOffset = alignUp(cellsOffset +
+										uint64{config.injectionQueueCapacity} * sizeof(InjectionQueue::Cell),
+										kCacheLineSize);
+	uint64 const totalSize = framesOffset + uint64{config.nbTaskFrames} * sizeof(TaskFrame) + kCacheLineSize;
+
+	if (totalSize > std::numeric_limits<MemoryManager::size_type>::max()) {
+		return makeError(GenericError::NOMEM, "makeThreadPool");
+	}
+
+	auto maybeMemory = memoryManager.allocate(static_cast<MemoryManager::size_type>(totalSize));
+	if (!maybeMemory) {
+		return maybeMemory.moveError();
+	}
+
+	auto& memory = *maybeMemory;
+	auto const baseAddress = reinterpret_cast<uintptr_t>(memory.view().dataAddress());
+	auto const base = reinterpret_cast<byte*>(alignUp(baseAddress, kCacheLineSize));
+
+	auto state = ctor(*reinterpret_cast<details::ThreadPoolState*>(base + stateOffset));
+	state->nbWorkers = nbWorkers;
+	state->workers = reinterpret_cast<Worker*>(base + workersOffset);
+	for (uint32 i = 0; i < nbWorkers; ++i) {
+		auto worker = ctor(state->workers[i]);
+		worker->pool = state;
+		worker->index = i;
+		worker->rngState = 0x9E3779B9u * (i + 1);
+		worker->deque.buffer = reinterpret_cast<std::atomic<TaskFrame*>*>(base + dequesOffset + i * dequeSize);
+		worker->deque.mask = config.dequeCapacity - 1;
+	}
+
+	state->injectionQueue.cells = reinterpret_cast<InjectionQueue::Cell*>(base + cellsOffset);
+	state->injectionQueue.mask = config.injectionQueueCapacity - 1;
+	for (uint32 i = 0; i < config.injectionQueueCapacity; ++i) {
+		state->injectionQueue.cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	state->nbFrames = config.nbTaskFrames;
+	state->framePool.frames = reinterpret_cast<TaskFrame*>(base + framesOffset);
+	for (uint32 i = 0; i < config.nbTaskFrames; ++i) {
+		ctor(state->framePool.frames[i]);
+		state->framePool.frames[i].nextFree.store((i + 1 < config.nbTaskFrames) ? i + 2 : 0,
+												  std::memory_order_relaxed);
+	}
+	state->framePool.head.store(1, std::memory_order_release);
+
+	for (uint32 i = 0; i < nbWorkers; ++i) {
+		auto worker = &state->workers[i];
+		try {
+			worker->thread = std::thread{[state, worker]() noexcept { state->workerLoop(worker); }};
+		} catch (std::system_error const&) {
+			stopWorkers(state, i);
+			destroyState(state);
+
+			return makeError(GenericError::AGAIN, "makeThreadPool");
+		}
+
+		if (config.pinWorkers) {
+			pinThread(worker->thread, i);
+		}
+	}
+
+	return Ok(ThreadPool{mv(memory), state});
+}
@@ -28,6 +28,22 @@
 using namespace Solace;
 
 
+namespace {
+
+/// Finalization step of Murmur3: every input bit affects every output bit.
+constexpr uint64 fmix64(uint64 h) noexcept {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+}  // namespace
+
+
 UUID::UUID() noexcept
     : _bytes{0}
 {
@@ -68,19 +84,13 @@ bool UUID::equals(UUID const& rhs) const noexcept {
     return memcmp(_bytes, rhs._bytes, size()) == 0;
 }
 
+uint64 UUID::hashCode() const noexcept {
+    uint64 high;
+    uint64 low;
+    memcpy(&high, _bytes, sizeof(high));
+    memcpy(&low, _bytes + sizeof(high), sizeof(low));
 
-UUID::reference
-UUID::operator[] (size_type index) {
-	index = assertIndexInRange(index, size(), "UUID[]");
-
-    return _bytes[index];
-}
-
-UUID::value_type
-UUID::operator[] (size_type index) const {
-	index = assertIndexInRange(index, size(), "UUID[]");
-
-    return _bytes[index];
+    return fmix64(high ^ fmix64(low));
 }
 
 
@@ -0,0 +1,41 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace test and benchmark support
+ *	@file support/randomSequence.hpp
+ *	@brief		Deterministic pseudo-random sequence shared by randomized tests and benchmarks.
+ ******************************************************************************/
+#pragma once
+#ifndef SOLACE_SUPPORT_RANDOMSEQUENCE_HPP
+#define SOLACE_SUPPORT_RANDOMSEQUENCE_HPP
+
+#include <solace/types.hpp>
+
+
+namespace Solace {
+
+/**
+ * Advance a 64-bit linear congruential generator.
+ * Sequence is fully defined by the seed, so a failing randomized test can be reproduced.
+ * @return Next pseudo-random 31-bit value of the sequence.
+ */
+inline uint64 nextRandom(uint64& seed) noexcept {
+	seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+	return seed >> 33;
+}
+
+}  // namespace Solace
+#endif  // SOLACE_SUPPORT_RANDOMSEQUENCE_HPP
@@ -0,0 +1,110 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ * @file: test/hashing/test_crc32c.cpp
+*******************************************************************************/
+#include <solace/hashing/crc32c.hpp>  // Class being tested
+#include <solace/output_utils.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace Solace;
+using namespace Solace::hashing;
+
+
+namespace {
+
+/// Bit at a time reference implementation
+uint32 crc32cReference(MemoryView data, uint32 crc = 0) {
+    crc = ~crc;
+    for (auto b : data) {
+        crc ^= b;
+        for (int i = 0; i < 8; ++i) {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0x82F63B78 : 0);
+        }
+    }
+
+    return ~crc;
+}
+
+}  // namespace
+
+
+TEST(TestHashingCrc32c, testAlgorithmName) {
+    EXPECT_EQ(StringLiteral("CRC32C"), CRC32C().getAlgorithm());
+}
+
+TEST(TestHashingCrc32c, checksumEmptyMessage) {
+    EXPECT_EQ(0U, crc32c(MemoryView{}));
+    EXPECT_EQ(std::initializer_list<byte>({0x0, 0x0, 0x0, 0x0}), CRC32C().update(MemoryView{}).digest());
+}
+
+TEST(TestHashingCrc32c, checkValue) {
+    char message[] = "123456789";
+    EXPECT_EQ(0xE3069283, crc32c(wrapMemory(message, sizeof(message) - 1)));
+    EXPECT_EQ(std::initializer_list<byte>({0xE3, 0x06, 0x92, 0x83}),
+              CRC32C().update(wrapMemory(message, sizeof(message) - 1)).digest());
+}
+
+// Test vectors of RFC 3720, B.4
+TEST(TestHashingCrc32c, iscsiTestVectors) {
+    byte data[32];
+
+    memset(data, 0, sizeof(data));
+    EXPECT_EQ(0x8A9136AA, crc32c(wrapMemory(data)));
+
+    memset(data, 0xFF, sizeof(data));
+    EXPECT_EQ(0x62A8AB43, crc32c(wrapMemory(data)));
+
+    for (int i = 0; i < 32; ++i) {
+        data[i] = static_cast<byte>(i);
+    }
+    EXPECT_EQ(0x46DD794E, crc32c(wrapMemory(data)));
+
+    for (int i = 0; i < 32; ++i) {
+        data[i] = static_cast<byte>(31 - i);
+    }
+    EXPECT_EQ(0x113FDB5C, crc32c(wrapMemory(data)));
+}
+
+TEST(TestHashingCrc32c, matchesReferenceForAllSizesAndAlignments) {
+    byte data[300];
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = static_cast<byte>(i * 131 + 7);
+    }
+
+    for (MemoryView::size_type offset = 0; offset < 8; ++offset) {
+        for (MemoryView::size_type size = 0; offset + size <= sizeof(data); size += 13) {
+            auto const view = wrapMemory(data).slice(offset, offset + size);
+            ASSERT_EQ(crc32cReference(view), crc32c(view)) << "offset " << offset << ", size " << size;
+        }
+    }
+}
+
+TEST(TestHashingCrc32c, incrementalUpdateMatchesWholeMessage) {
+    char message[] = "The quick brown fox jumps over the lazy dog";
+    auto const whole = wrapMemory(message, sizeof(message) - 1);
+
+    for (MemoryView::size_type split = 0; split <= whole.size(); ++split) {
+        auto const head = whole.slice(0, split);
+        auto const tail = whole.slice(split, whole.size());
+        ASSERT_EQ(crc32c(whole), crc32c(tail, crc32c(head)));
+    }
+
+    EXPECT_EQ(CRC32C().update(whole).digest(),
+              CRC32C().update(whole.slice(0, 10)).update(whole.slice(10, whole.size())).digest());
+}
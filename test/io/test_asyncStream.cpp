@@ -0,0 +1,245 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/io/test_asyncStream.cpp
+ *	@brief		Test suit for asynchronous byte streams
+ ******************************************************************************/
+#include <solace/io/asyncStream.hpp>    // Class being tested.
+#include <solace/io/task.hpp>
+#include <solace/posixErrorDomain.hpp>
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+using namespace Solace;
+using namespace Solace::io;
+
+
+namespace {
+
+void markDone(void* context) noexcept {
+	*static_cast<bool*>(context) = true;
+}
+
+}  // namespace
+
+
+class TestAsyncStream : public ::testing::Test {
+protected:
+	void SetUp() override {
+		ASSERT_EQ(0, pipe2(_pipe, O_CLOEXEC));
+		ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, _sockets));
+		_reactor = makeReactor().moveResult();
+	}
+
+	void TearDown() override {
+		close(_pipe[0]);
+		close(_pipe[1]);
+		close(_sockets[0]);
+		close(_sockets[1]);
+	}
+
+	Reactor& reactor() { return *_reactor; }
+
+	int					_pipe[2];
+	int					_sockets[2];
+	Optional<Reactor>	_reactor;
+	byte				_readBuffer[64];
+	byte				_writeBuffer[64];
+};
+
+
+TEST_F(TestAsyncStream, readSomeCompletesWhenDataArrives) {
+	auto reader = makeAsyncStream(reactor(), _pipe[0], wrapMemory(_readBuffer)).moveResult();
+
+	bool done = false;
+	auto op = reader.readSome();
+	EXPECT_FALSE(op.start(&markDone, &done));
+	EXPECT_FALSE(op.isReady());
+
+	ASSERT_EQ(5, write(_pipe[1], "hello", 5));
+	EXPECT_TRUE(reactor().run().isOk());
+	ASSERT_TRUE(done);
+
+	auto result = op.takeResult();
+	ASSERT_TRUE(result.isOk());
+	EXPECT_EQ(wrapMemory("hello", 5), result.unwrap());
+}
+
+TEST_F(TestAsyncStream, readSomeReportsEndOfStream) {
+	auto reader = makeAsyncStream(reactor(), _pipe[0], wrapMemory(_readBuffer)).moveResult();
+	close(_pipe[1]);
+	_pipe[1] = -1;
+
+	auto op = reader.readSome();
+	EXPECT_TRUE(op.start(nullptr, nullptr));
+
+	auto result = op.takeResult();
+	ASSERT_TRUE(result.isOk());
+	EXPECT_TRUE(result.unwrap().empty());
+}
+
+TEST_F(TestAsyncStream, readExactlyResumesAcrossPartialReads) {
+	auto reader = makeAsyncStream(reactor(), _sockets[0], wrapMemory(_readBuffer)).moveResult();
+
+	bool done = false;
+	auto op = reader.readExactly(6);
+	EXPECT_FALSE(op.start(&markDone, &done));
+
+	ASSERT_EQ(2, write(_sockets[1], "\x01\x02", 2));
+	EXPECT_TRUE(reactor().poll(-1).isOk());
+	EXPECT_FALSE(done);
+
+	ASSERT_EQ(4, write(_sockets[1], "\x03\x04\x05\x06", 4));
+	EXPECT_TRUE(reactor().run().isOk());
+	ASSERT_TRUE(done);
+
+	auto result = op.takeResult();
+	ASSERT_TRUE(result.isOk());
+
+	uint16 a = 0;
+	uint32 b = 0;
+	auto& byteReader = result.unwrap();
+	EXPECT_EQ(6U, byteReader.remaining());
+	EXPECT_TRUE(byteReader.readLE(a).isOk());
+	EXPECT_TRUE(byteReader.readLE(b).isOk());
+	EXPECT_EQ(0x0201, a);
+	EXPECT_EQ(0x06050403U, b);
+}
+
+TEST_F(TestAsyncStream, readExactlyFailsOnEarlyEndOfStream) {
+	auto reader = makeAsyncStream(reactor(), _pipe[0], wrapMemory(_readBuffer)).moveResult();
+	ASSERT_EQ(3, write(_pipe[1], "abc", 3));
+	close(_pipe[1]);
+	_pipe[1] = -1;
+
+	auto op = reader.readExactly(8);
+	EXPECT_TRUE(op.start(nullptr, nullptr));
+
+	auto result = op.takeResult();
+	ASSERT_TRUE(result.isError());
+	EXPECT_EQ(makeError(SystemErrors::NODATA, "readExactly"), result.getError());
+}
+
+TEST_F(TestAsyncStream, readExactlyMoreThanBufferIsAnError) {
+	auto reader = makeAsyncStream(reactor(), _pipe[0], wrapMemory(_readBuffer)).moveResult();
+
+	auto op = reader.readExactly(sizeof(_readBuffer) + 1);
+	EXPECT_TRUE(op.start(nullptr, nullptr));
+	EXPECT_TRUE(op.takeResult().isError());
+}
+
+TEST_F(TestAsyncStream, writeWaitsForPeerToDrain) {
+	int sendBufferSize = 4096;
+	setsockopt(_sockets[0], SOL_SOCKET, SO_SNDBUF, &sendBufferSize, sizeof(sendBufferSize));
+
+	auto writer = makeAsyncStream(reactor(), _sockets[0], wrapMemory(_writeBuffer)).moveResult();
+	auto peer = makeAsyncStream(reactor(), _sockets[1], wrapMemory(_readBuffer)).moveResult();
+
+	static byte payload[1 << 20];
+	for (uint32 i = 0; i < sizeof(payload); ++i) {
+		payload[i] = static_cast<byte>(i * 7);
+	}
+
+	bool written = false;
+	auto writeOp = writer.write(wrapMemory(payload));
+	ASSERT_FALSE(writeOp.start(&markDone, &written));
+
+	uint32 nbReceived = 0;
+	bool matches = true;
+	while (nbReceived < sizeof(payload)) {
+		bool received = false;
+		auto readOp = peer.readSome();
+		if (!readOp.start(&markDone, &received)) {
+			while (!received) {
+				ASSERT_TRUE(reactor().poll(-1).isOk());
+			}
+		}
+
+		auto chunk = readOp.takeResult();
+		ASSERT_TRUE(chunk.isOk());
+		ASSERT_FALSE(chunk.unwrap().empty());
+		for (auto b : chunk.unwrap()) {
+			matches &= (b == payload[nbReceived++]);
+		}
+	}
+
+	EXPECT_TRUE(reactor().run().isOk());
+	EXPECT_TRUE(written);
+	EXPECT_TRUE(writeOp.takeResult().isOk());
+	EXPECT_TRUE(matches);
+}
+
+TEST_F(TestAsyncStream, writeToClosedPeerIsAnError) {
+	auto writer = makeAsyncStream(reactor(), _sockets[0], wrapMemory(_writeBuffer)).moveResult();
+	close(_sockets[1]);
+	_sockets[1] = -1;
+
+	auto op = writer.write(wrapMemory("data", 4));
+	EXPECT_TRUE(op.start(nullptr, nullptr));
+	EXPECT_TRUE(op.takeResult().isError());
+}
+
+
+#if SOLACE_HAS_COROUTINES
+
+namespace {
+
+Task<Result<uint32, Error>>
+readFramedMessage(AsyncStream& stream) {
+	auto header = co_await stream.readExactly(2);
+	if (!header) {
+		co_return header.moveError();
+	}
+
+	uint16 length = 0;
+	header.unwrap().readLE(length);
+
+	auto body = co_await stream.readExactly(length);
+	if (!body) {
+		co_return body.moveError();
+	}
+
+	co_return Ok<uint32>(body.unwrap().remaining());
+}
+
+}  // namespace
+
+
+TEST_F(TestAsyncStream, coroutineParser) {
+	auto stream = makeAsyncStream(reactor(), _sockets[0], wrapMemory(_readBuffer)).moveResult();
+
+	auto task = readFramedMessage(stream);
+	EXPECT_FALSE(task.isDone());
+
+	ASSERT_EQ(3, write(_sockets[1], "\x05\x00h", 3));
+	ASSERT_TRUE(reactor().poll(-1).isOk());
+	EXPECT_FALSE(task.isDone());
+
+	ASSERT_EQ(4, write(_sockets[1], "ello", 4));
+	EXPECT_TRUE(reactor().run().isOk());
+	ASSERT_TRUE(task.isDone());
+
+	auto result = task.takeResult();
+	ASSERT_TRUE(result.isOk());
+	EXPECT_EQ(5U, result.unwrap());
+}
+
+#endif  // SOLACE_HAS_COROUTINES
@@ -0,0 +1,71 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/io/test_bufferPool.cpp
+ *	@brief		Test suit for the pool of I/O buffers
+ ******************************************************************************/
+#include <solace/io/bufferPool.hpp>    // Class being tested.
+
+#include <gtest/gtest.h>
+
+using namespace Solace;
+using namespace Solace::io;
+
+
+class TestBufferPool : public ::testing::Test {
+protected:
+	MemoryManager	_memoryManager{1 << 20};
+};
+
+
+TEST_F(TestBufferPool, invalidParametersAreAnError) {
+	EXPECT_TRUE(makeBufferPool(_memoryManager, 0, 4).isError());
+	EXPECT_TRUE(makeBufferPool(_memoryManager, 128, 0).isError());
+	EXPECT_TRUE(_memoryManager.empty());
+}
+
+TEST_F(TestBufferPool, buffersReturnToPool) {
+	auto pool = makeBufferPool(_memoryManager, 128, 2).moveResult();
+	EXPECT_EQ(128U, pool.bufferSize());
+	EXPECT_EQ(2U, pool.capacity());
+	EXPECT_EQ(2U, pool.available());
+	{
+		auto first = pool.acquire();
+		auto second = pool.acquire();
+		ASSERT_TRUE(first.isOk());
+		ASSERT_TRUE(second.isOk());
+		EXPECT_EQ(128U, first.unwrap().size());
+		EXPECT_NE(first.unwrap().view().dataAddress(), second.unwrap().view().dataAddress());
+		EXPECT_EQ(0U, pool.available());
+
+		auto third = pool.acquire();
+		ASSERT_TRUE(third.isError());
+	}
+
+	EXPECT_EQ(2U, pool.available());
+}
+
+TEST_F(TestBufferPool, buffersOutliveMovedPool) {
+	auto pool = makeBufferPool(_memoryManager, 64, 1).moveResult();
+	auto buffer = pool.acquire().moveResult();
+
+	auto movedPool = mv(pool);
+	EXPECT_EQ(0U, movedPool.available());
+
+	buffer = MemoryResource{};
+	EXPECT_EQ(1U, movedPool.available());
+}
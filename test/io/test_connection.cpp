@@ -0,0 +1,188 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/io/test_connection.cpp
+ *	@brief		Test suit for reactor driven connections
+ ******************************************************************************/
+#include <solace/io/connection.hpp>    // Class being tested.
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <unistd.h>
+
+using namespace Solace;
+using namespace Solace::io;
+
+
+namespace {
+
+/// Run a reactor until the operation completes
+template<typename Op>
+typename Op::result_type
+await(Reactor& reactor, Op& op) {
+	bool done = false;
+	if (!op.start([](void* context) noexcept { *static_cast<bool*>(context) = true; }, &done)) {
+		while (!done) {
+			EXPECT_TRUE(reactor.poll(1000).isOk());
+		}
+	}
+
+	return op.takeResult();
+}
+
+}  // namespace
+
+
+class TestConnection : public ::testing::Test {
+protected:
+	void SetUp() override {
+		_reactor = makeReactor().moveResult();
+		_pool = makeBufferPool(_memoryManager, 256, 8).moveResult();
+	}
+
+	Reactor& reactor() { return *_reactor; }
+	BufferPool& pool() { return *_pool; }
+
+	/// Establish a pair of connected stream connections via a listener
+	void connectPair(DialString const& endpoint, Optional<StreamConnection>& client, Optional<StreamConnection>& server) {
+		auto listener = makeListener(reactor(), listen(endpoint).moveResult()).moveResult();
+
+		DialString target = endpoint;
+		char port[8];
+		if (endpoint.protocol == kProtocolTCP) {
+			auto const address = localAddress(listener.socket()).moveResult();
+			snprintf(port, sizeof(port), "%u", address.port());
+			target.service = StringView{port};
+		}
+
+		client = makeConnection(reactor(), pool(), connect(target).moveResult()).moveResult();
+
+		auto acceptOp = listener.accept();
+		auto accepted = await(reactor(), acceptOp);
+		ASSERT_TRUE(accepted.isOk());
+		server = makeConnection(reactor(), pool(), accepted.moveResult()).moveResult();
+
+		auto connectOp = (*client).connected();
+		ASSERT_TRUE(await(reactor(), connectOp).isOk());
+	}
+
+	void exchangeMessages(StreamConnection& client, StreamConnection& server) {
+		ASSERT_TRUE(client.queue(wrapMemory("Hello, ", 7)).isOk());
+		ASSERT_TRUE(client.queue(wrapMemory("world", 5)).isOk());
+		EXPECT_EQ(2U, client.nbQueued());
+
+		auto flushOp = client.flush();
+		ASSERT_TRUE(await(reactor(), flushOp).isOk());
+		EXPECT_EQ(0U, client.nbQueued());
+
+		char received[16] = {0};
+		uint32 nbReceived = 0;
+		while (nbReceived < 12) {
+			auto readOp = server.read();
+			auto maybeData = await(reactor(), readOp);
+			ASSERT_TRUE(maybeData.isOk());
+
+			auto& data = maybeData.unwrap();
+			ASSERT_TRUE(data.hasRemaining());
+			auto const size = data.remaining();
+			ASSERT_TRUE(data.read(wrapMemory(received + nbReceived, size)).isOk());
+			nbReceived += size;
+		}
+
+		EXPECT_STREQ("Hello, world", received);
+		EXPECT_EQ(pool().capacity(), pool().available());
+	}
+
+	MemoryManager			_memoryManager{1 << 20};
+	Optional<Reactor>		_reactor;
+	Optional<BufferPool>	_pool;
+};
+
+
+TEST_F(TestConnection, unixStream) {
+	Optional<StreamConnection> client;
+	Optional<StreamConnection> server;
+	connectPair(DialString{kProtocolUnix, "@solace-test-connection"}, client, server);
+	ASSERT_TRUE(client.isSome());
+	ASSERT_TRUE(server.isSome());
+
+	exchangeMessages(*client, *server);
+}
+
+TEST_F(TestConnection, loopbackTcp) {
+	Optional<StreamConnection> client;
+	Optional<StreamConnection> server;
+	connectPair(DialString{kProtocolTCP, "127.0.0.1", "0"}, client, server);
+	ASSERT_TRUE(client.isSome());
+	ASSERT_TRUE(server.isSome());
+
+	exchangeMessages(*client, *server);
+
+	// Closing the peer is reported as end of stream
+	server = none;
+	auto readOp = (*client).read();
+	auto maybeData = await(reactor(), readOp);
+	ASSERT_TRUE(maybeData.isOk());
+	EXPECT_FALSE(maybeData.unwrap().hasRemaining());
+}
+
+TEST_F(TestConnection, writeQueueIsBounded) {
+	Optional<StreamConnection> client;
+	Optional<StreamConnection> server;
+	connectPair(DialString{kProtocolUnix, "@solace-test-queue"}, client, server);
+	ASSERT_TRUE(client.isSome());
+
+	for (uint32 i = 0; i < StreamConnection::kMaxQueuedWrites; ++i) {
+		ASSERT_TRUE((*client).queue(wrapMemory("x", 1)).isOk());
+	}
+	EXPECT_TRUE((*client).queue(wrapMemory("x", 1)).isError());
+}
+
+TEST_F(TestConnection, udpBatches) {
+	auto receiver = makeDatagramChannel(reactor(), pool(),
+										listen(DialString{kProtocolUDP, "127.0.0.1", "0"}).moveResult()).moveResult();
+	auto const receiverAddress = localAddress(receiver.socket()).moveResult();
+
+	auto sender = makeDatagramChannel(reactor(), pool(),
+									  listen(DialString{kProtocolUDP, "127.0.0.1", "0"}).moveResult()).moveResult();
+
+	OutgoingDatagram const outgoing[] = {
+		{wrapMemory("one", 3), &receiverAddress},
+		{wrapMemory("two", 3), &receiverAddress},
+		{wrapMemory("three", 5), &receiverAddress},
+	};
+
+	auto sendOp = sender.send(outgoing);
+	ASSERT_TRUE(await(reactor(), sendOp).isOk());
+
+	Datagram incoming[4];
+	uint32 nbReceived = 0;
+	while (nbReceived < 3) {
+		auto receiveOp = receiver.receive(ArrayView<Datagram>{wrapMemory(incoming).slice(nbReceived * sizeof(Datagram),
+																							sizeof(incoming))});
+		auto maybeCount = await(reactor(), receiveOp);
+		ASSERT_TRUE(maybeCount.isOk());
+		nbReceived += maybeCount.unwrap();
+	}
+
+	EXPECT_EQ(3U, incoming[0].data.remaining());
+	EXPECT_EQ(3U, incoming[1].data.remaining());
+	EXPECT_EQ(5U, incoming[2].data.remaining());
+	EXPECT_EQ(localAddress(sender.socket()).unwrap().port(), incoming[0].peer.port());
+	EXPECT_EQ(pool().capacity() - 3, pool().available());
+}
@@ -0,0 +1,108 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/io/test_mappedFile.cpp
+ *	@brief		Test suit for read-only file mappings
+ ******************************************************************************/
+#include <solace/io/mappedFile.hpp>    // Class being tested.
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+using namespace Solace;
+using namespace Solace::io;
+
+
+class TestMappedFile : public ::testing::Test {
+protected:
+	void SetUp() override {
+		_path = ::testing::TempDir() + "solace_mappedFile_" + std::to_string(getpid());
+	}
+
+	void TearDown() override {
+		std::remove(_path.c_str());
+	}
+
+	void writeFile(char const* content, size_t size) {
+		auto file = std::fopen(_path.c_str(), "wb");
+		ASSERT_NE(nullptr, file);
+		ASSERT_EQ(size, std::fwrite(content, 1, size, file));
+		std::fclose(file);
+	}
+
+	StringView path() const noexcept {
+		return StringView{_path.c_str()};
+	}
+
+	std::string _path;
+};
+
+
+TEST_F(TestMappedFile, mapsContentOfFile) {
+	char const content[] = "Some content of a file";
+	writeFile(content, sizeof(content));
+
+	auto maybeFile = MappedFile::open(path(), MappedFile::Access::Sequential);
+	ASSERT_TRUE(maybeFile.isOk());
+
+	auto& file = maybeFile.unwrap();
+	ASSERT_EQ(sizeof(content), file.size());
+	EXPECT_FALSE(file.empty());
+	EXPECT_EQ(wrapMemory(content), file.view());
+	EXPECT_TRUE(file.advise(MappedFile::Access::Random, 3, 5).isOk());
+}
+
+TEST_F(TestMappedFile, emptyFileMapsToEmptyView) {
+	writeFile("", 0);
+
+	auto maybeFile = MappedFile::open(path());
+	ASSERT_TRUE(maybeFile.isOk());
+	EXPECT_TRUE(maybeFile.unwrap().empty());
+	EXPECT_TRUE(maybeFile.unwrap().view().empty());
+}
+
+TEST_F(TestMappedFile, mappingOutlivesMove) {
+	char const content[] = "0123456789";
+	writeFile(content, sizeof(content));
+
+	auto file = MappedFile::open(path()).moveResult();
+	MappedFile other{mv(file)};
+	EXPECT_TRUE(file.empty());
+	EXPECT_EQ(wrapMemory(content), other.view());
+}
+
+TEST_F(TestMappedFile, releasedMappingIsOwnedByResource) {
+	char const content[] = "0123456789";
+	writeFile(content, sizeof(content));
+
+	auto file = MappedFile::open(path()).moveResult();
+	auto const address = file.view().dataAddress();
+	{
+		auto resource = file.release();
+		EXPECT_TRUE(file.empty());
+		EXPECT_EQ(address, resource.view().dataAddress());
+		EXPECT_EQ(wrapMemory(content), resource.view());
+	}
+	EXPECT_TRUE(file.release().empty());
+}
+
+TEST_F(TestMappedFile, openingMissingFileIsAnError) {
+	EXPECT_TRUE(MappedFile::open(path()).isError());
+}
@@ -0,0 +1,176 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/io/test_reactor.cpp
+ *	@brief		Test suit for the epoll reactor
+ ******************************************************************************/
+#include <solace/io/reactor.hpp>    // Class being tested.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace Solace;
+using namespace Solace::io;
+
+
+namespace {
+
+struct CountingWaiter : public IoWaiter {
+	int nbCalls{0};
+
+	CountingWaiter() noexcept
+		: IoWaiter{[](IoWaiter* self) noexcept { static_cast<CountingWaiter*>(self)->nbCalls += 1; }}
+	{}
+};
+
+/// Waiter that removes and destroys a watch of another waiter when resumed
+struct DestroyingWaiter : public IoWaiter {
+	Reactor*					reactor{nullptr};
+	std::unique_ptr<IoWatch>*	victim{nullptr};
+	int							nbCalls{0};
+
+	DestroyingWaiter() noexcept
+		: IoWaiter{[](IoWaiter* self) noexcept {
+			auto* const waiter = static_cast<DestroyingWaiter*>(self);
+			waiter->nbCalls += 1;
+			if (*waiter->victim) {
+				EXPECT_TRUE(waiter->reactor->remove(**waiter->victim).isOk());
+				waiter->victim->reset();
+			}
+		}}
+	{}
+};
+
+}  // namespace
+
+
+class TestReactor : public ::testing::Test {
+protected:
+	void SetUp() override {
+		ASSERT_EQ(0, pipe2(_pipe, O_NONBLOCK | O_CLOEXEC));
+	}
+
+	void TearDown() override {
+		close(_pipe[0]);
+		close(_pipe[1]);
+	}
+
+	int _pipe[2];
+};
+
+
+TEST_F(TestReactor, pollWithoutWaitersTimesOut) {
+	auto maybeReactor = makeReactor();
+	ASSERT_TRUE(maybeReactor.isOk());
+
+	auto& reactor = maybeReactor.unwrap();
+	auto result = reactor.poll(0);
+	ASSERT_TRUE(result.isOk());
+	EXPECT_EQ(0U, result.unwrap());
+	EXPECT_TRUE(reactor.run().isOk());
+}
+
+TEST_F(TestReactor, readinessResumesWaiter) {
+	auto reactor = makeReactor().moveResult();
+
+	IoWatch watch;
+	watch.fd = _pipe[0];
+
+	CountingWaiter waiter;
+	ASSERT_TRUE(reactor.awaitReadable(watch, waiter).isOk());
+	EXPECT_TRUE(watch.isRegistered);
+	EXPECT_EQ(1U, reactor.nbWaiting());
+
+	EXPECT_EQ(0U, reactor.poll(0).unwrap());
+	EXPECT_EQ(0, waiter.nbCalls);
+
+	ASSERT_EQ(1, write(_pipe[1], "x", 1));
+	EXPECT_TRUE(reactor.run().isOk());
+	EXPECT_EQ(1, waiter.nbCalls);
+	EXPECT_EQ(0U, reactor.nbWaiting());
+	EXPECT_EQ(nullptr, watch.reader);
+
+	EXPECT_TRUE(reactor.remove(watch).isOk());
+	EXPECT_FALSE(watch.isRegistered);
+}
+
+TEST_F(TestReactor, removeDropsWaiters) {
+	auto reactor = makeReactor().moveResult();
+
+	IoWatch watch;
+	watch.fd = _pipe[1];
+
+	CountingWaiter waiter;
+	ASSERT_TRUE(reactor.awaitWritable(watch, waiter).isOk());
+	EXPECT_EQ(1U, reactor.nbWaiting());
+
+	EXPECT_TRUE(reactor.remove(watch).isOk());
+	EXPECT_EQ(0U, reactor.nbWaiting());
+	EXPECT_EQ(0, waiter.nbCalls);
+}
+
+TEST_F(TestReactor, invalidDescriptorIsAnError) {
+	auto reactor = makeReactor().moveResult();
+
+	IoWatch watch;
+	watch.fd = -1;
+
+	CountingWaiter waiter;
+	EXPECT_TRUE(reactor.awaitReadable(watch, waiter).isError());
+	EXPECT_EQ(0U, reactor.nbWaiting());
+}
+
+TEST_F(TestReactor, waiterCanDestroyWatchReadyInTheSameBatch) {
+	auto reactor = makeReactor().moveResult();
+
+	int otherPipe[2];
+	ASSERT_EQ(0, pipe2(otherPipe, O_NONBLOCK | O_CLOEXEC));
+
+	std::unique_ptr<IoWatch> watches[2] = {std::make_unique<IoWatch>(), std::make_unique<IoWatch>()};
+	watches[0]->fd = _pipe[0];
+	watches[1]->fd = otherPipe[0];
+
+	DestroyingWaiter waiters[2];
+	for (int i = 0; i < 2; ++i) {
+		waiters[i].reactor = &reactor;
+		waiters[i].victim = &watches[1 - i];
+		ASSERT_TRUE(reactor.awaitReadable(*watches[i], waiters[i]).isOk());
+	}
+
+	// Both descriptors are ready in the same poll: the first waiter resumed destroys the other watch
+	ASSERT_EQ(1, write(_pipe[1], "x", 1));
+	ASSERT_EQ(1, write(otherPipe[1], "x", 1));
+
+	auto result = reactor.poll(100);
+	ASSERT_TRUE(result.isOk());
+	EXPECT_EQ(1U, *result);
+	EXPECT_EQ(1, waiters[0].nbCalls + waiters[1].nbCalls);
+	EXPECT_EQ(0U, reactor.nbWaiting());
+
+	for (auto& watch : watches) {
+		if (watch) {
+			EXPECT_TRUE(reactor.remove(*watch).isOk());
+		}
+	}
+
+	close(otherPipe[0]);
+	close(otherPipe[1]);
+}
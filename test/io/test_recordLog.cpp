@@ -0,0 +1,277 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/io/test_recordLog.cpp
+ *	@brief		Test suit for the append-only record log
+ ******************************************************************************/
+#include <solace/io/recordLog.hpp>    // Class being tested.
+#include <solace/hashing/crc32c.hpp>
+#include <solace/variableSpan.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace Solace;
+using namespace Solace::io;
+
+
+class TestRecordLog : public ::testing::Test {
+protected:
+	void SetUp() override {
+		_path = ::testing::TempDir() + "solace_recordLog_" + std::to_string(getpid());
+		std::remove(_path.c_str());
+	}
+
+	void TearDown() override {
+		std::remove(_path.c_str());
+	}
+
+	StringView path() const noexcept {
+		return StringView{_path.c_str()};
+	}
+
+	long fileSize() const {
+		auto file = std::fopen(_path.c_str(), "rb");
+		std::fseek(file, 0, SEEK_END);
+		auto const size = std::ftell(file);
+		std::fclose(file);
+
+		return size;
+	}
+
+	std::vector<std::string> readAll() {
+		std::vector<std::string> records;
+		auto maybeReader = RecordLogReader::open(path());
+		EXPECT_TRUE(maybeReader.isOk());
+		if (maybeReader) {
+			for (auto record : maybeReader.unwrap()) {
+				records.emplace_back(static_cast<char const*>(record.dataAddress()), record.size());
+			}
+		}
+
+		return records;
+	}
+
+	MemoryManager	_memoryManager{1 << 20};
+	std::string		_path;
+};
+
+
+TEST_F(TestRecordLog, newLogHasOnlyHeader) {
+	{
+		auto maybeWriter = RecordLogWriter::open(path(), _memoryManager, 256);
+		ASSERT_TRUE(maybeWriter.isOk());
+		EXPECT_EQ(RecordLogFormat::kHeaderSize, maybeWriter.unwrap().size());
+		EXPECT_EQ(RecordLogFormat::kHeaderSize, maybeWriter.unwrap().durableSize());
+		EXPECT_EQ(256U - RecordLogFormat::kFrameHeaderSize, maybeWriter.unwrap().maxPayloadSize());
+	}
+	EXPECT_TRUE(_memoryManager.empty());
+
+	auto reader = RecordLogReader::open(path()).moveResult();
+	EXPECT_EQ(RecordLogFormat::kHeaderSize, reader.size());
+	EXPECT_EQ(RecordLogFormat::kHeaderSize, reader.validSize());
+	EXPECT_EQ(reader.end(), reader.begin());
+}
+
+TEST_F(TestRecordLog, appendedRecordsReadBackInOrder) {
+	{
+		auto writer = RecordLogWriter::open(path(), _memoryManager, 256).moveResult();
+		EXPECT_EQ(RecordLogFormat::kHeaderSize + 8 + 5, writer.append(wrapMemory("first", 5)).unwrap());
+		EXPECT_TRUE(writer.append(MemoryView{}).isOk());
+		EXPECT_TRUE(writer.append(wrapMemory("third", 5)).isOk());
+		EXPECT_EQ(RecordLogFormat::kHeaderSize, writer.durableSize());
+
+		ASSERT_TRUE(writer.sync().isOk());
+		EXPECT_EQ(writer.size(), writer.durableSize());
+		EXPECT_EQ(static_cast<uint64>(fileSize()), writer.durableSize());
+	}
+
+	EXPECT_EQ((std::vector<std::string>{"first", "", "third"}), readAll());
+}
+
+TEST_F(TestRecordLog, writerSyncsOnClose) {
+	{
+		auto writer = RecordLogWriter::open(path(), _memoryManager, 256).moveResult();
+		writer.append(wrapMemory("record", 6));
+	}
+
+	EXPECT_EQ(std::vector<std::string>{"record"}, readAll());
+}
+
+TEST_F(TestRecordLog, reopenedWriterAppendsAfterExistingRecords) {
+	{
+		auto writer = RecordLogWriter::open(path(), _memoryManager, 256).moveResult();
+		writer.append(wrapMemory("one", 3));
+	}
+	{
+		auto writer = RecordLogWriter::open(path(), _memoryManager, 256).moveResult();
+		EXPECT_EQ(static_cast<uint64>(fileSize()), writer.size());
+		writer.append(wrapMemory("two", 3));
+	}
+
+	EXPECT_EQ((std::vector<std::string>{"one", "two"}), readAll());
+}
+
+TEST_F(TestRecordLog, fullBatchIsFlushed) {
+	{
+		auto writer = RecordLogWriter::open(path(), _memoryManager, 64).moveResult();
+		char payload[40];
+		memset(payload, 'x', sizeof(payload));
+
+		for (int i = 0; i < 10; ++i) {
+			ASSERT_TRUE(writer.append(wrapMemory(payload)).isOk());
+		}
+		EXPECT_LT(RecordLogFormat::kHeaderSize, writer.durableSize());
+	}
+
+	auto const records = readAll();
+	ASSERT_EQ(10U, records.size());
+	EXPECT_EQ(std::string(40, 'x'), records.back());
+}
+
+TEST_F(TestRecordLog, recordLargerThanBatchIsAnError) {
+	auto writer = RecordLogWriter::open(path(), _memoryManager, 64).moveResult();
+	char payload[64];
+	memset(payload, 'x', sizeof(payload));
+
+	EXPECT_TRUE(writer.append(wrapMemory(payload)).isError());
+	EXPECT_TRUE(writer.append(wrapMemory(payload, writer.maxPayloadSize())).isOk());
+}
+
+TEST_F(TestRecordLog, readerStopsAtTornTail) {
+	{
+		auto writer = RecordLogWriter::open(path(), _memoryManager, 256).moveResult();
+		writer.append(wrapMemory("intact", 6));
+		writer.append(wrapMemory("torn record", 11));
+	}
+	auto const fullSize = fileSize();
+	ASSERT_EQ(0, truncate(_path.c_str(), fullSize - 3));
+
+	{
+		auto reader = RecordLogReader::open(path()).moveResult();
+		EXPECT_EQ(RecordLogFormat::kHeaderSize + 8 + 6, reader.validSize());
+	}
+	EXPECT_EQ(std::vector<std::string>{"intact"}, readAll());
+
+	// Writer drops the torn tail on open
+	{
+		auto writer = RecordLogWriter::open(path(), _memoryManager, 256).moveResult();
+		EXPECT_EQ(RecordLogFormat::kHeaderSize + 8 + 6, writer.size());
+		EXPECT_EQ(static_cast<long>(writer.size()), fileSize());
+		writer.append(wrapMemory("next", 4));
+	}
+	EXPECT_EQ((std::vector<std::string>{"intact", "next"}), readAll());
+}
+
+TEST_F(TestRecordLog, readerStopsAtCorruptedRecord) {
+	{
+		auto writer = RecordLogWriter::open(path(), _memoryManager, 256).moveResult();
+		writer.append(wrapMemory("first", 5));
+		writer.append(wrapMemory("second", 6));
+		writer.append(wrapMemory("third", 5));
+	}
+
+	// Flip a byte of the payload of the second record
+	auto file = std::fopen(_path.c_str(), "r+b");
+	std::fseek(file, RecordLogFormat::kHeaderSize + 8 + 5 + 8 + 2, SEEK_SET);
+	std::fputc('X', file);
+	std::fclose(file);
+
+	EXPECT_EQ(std::vector<std::string>{"first"}, readAll());
+}
+
+TEST_F(TestRecordLog, framesAreReadableAsVariableSpan) {
+	{
+		auto writer = RecordLogWriter::open(path(), _memoryManager, 256).moveResult();
+		writer.append(wrapMemory("alpha", 5));
+		writer.append(wrapMemory("beta", 4));
+	}
+
+	auto reader = RecordLogReader::open(path()).moveResult();
+	auto const frames = reader.records().begin();
+	auto const segment = MappedFile::open(path()).moveResult();
+	auto const data = segment.view().slice(RecordLogFormat::kHeaderSize, segment.size());
+
+	std::vector<std::string> payloads;
+	VariableSpan<MemoryView, uint32, EncoderType::LittleEndian> span{2, data};
+	for (auto chunk : span) {
+		// Chunk is checksum followed by the payload
+		ByteReader chunkReader{chunk};
+		uint32 crc = 0;
+		chunkReader.readLE(crc);
+
+		auto const payload = chunkReader.viewRemaining();
+		payloads.emplace_back(static_cast<char const*>(payload.dataAddress()), payload.size());
+		EXPECT_NE(0U, crc);
+	}
+	EXPECT_EQ((std::vector<std::string>{"alpha", "beta"}), payloads);
+	EXPECT_EQ(5U, (*frames).size());
+}
+
+TEST_F(TestRecordLog, concurrentAppendsShareSyncs) {
+	constexpr int kThreads = 4;
+	constexpr int kRecordsPerThread = 50;
+	{
+		auto writer = RecordLogWriter::open(path(), _memoryManager, 512).moveResult();
+
+		std::vector<std::thread> threads;
+		for (int t = 0; t < kThreads; ++t) {
+			threads.emplace_back([&writer, t]() {
+				for (int i = 0; i < kRecordsPerThread; ++i) {
+					auto const record = std::to_string(t) + ":" + std::to_string(i);
+					auto maybeOffset = writer.append(wrapMemory(record.data(), record.size()));
+					ASSERT_TRUE(maybeOffset.isOk());
+					ASSERT_TRUE(writer.sync(maybeOffset.unwrap()).isOk());
+					ASSERT_LE(maybeOffset.unwrap(), writer.durableSize());
+				}
+			});
+		}
+
+		for (auto& thread : threads) {
+			thread.join();
+		}
+	}
+
+	auto const records = readAll();
+	ASSERT_EQ(static_cast<size_t>(kThreads * kRecordsPerThread), records.size());
+
+	// Records of each thread are in order
+	std::vector<int> next(kThreads, 0);
+	for (auto const& record : records) {
+		auto const separator = record.find(':');
+		auto const t = std::stoi(record.substr(0, separator));
+		EXPECT_EQ(next[t], std::stoi(record.substr(separator + 1)));
+		next[t] += 1;
+	}
+}
+
+TEST_F(TestRecordLog, openingFileOfOtherFormatIsAnError) {
+	auto file = std::fopen(_path.c_str(), "wb");
+	std::fputs("Not a log segment", file);
+	std::fclose(file);
+
+	EXPECT_TRUE(RecordLogReader::open(path()).isError());
+	EXPECT_TRUE(RecordLogWriter::open(path(), _memoryManager, 256).isError());
+	EXPECT_TRUE(_memoryManager.empty());
+}
@@ -0,0 +1,81 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/io/test_socket.cpp
+ *	@brief		Test suit for sockets created from dial strings
+ ******************************************************************************/
+#include <solace/io/socket.hpp>    // Class being tested.
+#include <solace/posixErrorDomain.hpp>
+
+#include <gtest/gtest.h>
+
+#include <netinet/in.h>
+#include <sys/un.h>
+
+using namespace Solace;
+using namespace Solace::io;
+
+
+TEST(TestSocket, resolveUnixAddress) {
+	auto maybeAddress = resolve(DialString{kProtocolUnix, "/tmp/solace.sock"});
+	ASSERT_TRUE(maybeAddress.isOk());
+
+	auto& address = maybeAddress.unwrap();
+	EXPECT_EQ(AF_UNIX, address.family());
+	EXPECT_EQ(SOCK_STREAM, address.type);
+	EXPECT_STREQ("/tmp/solace.sock", reinterpret_cast<sockaddr_un const*>(address.address())->sun_path);
+}
+
+TEST(TestSocket, resolveAbstractUnixAddress) {
+	auto maybeAddress = resolve(DialString{kProtocolUnix, "@solace"});
+	ASSERT_TRUE(maybeAddress.isOk());
+
+	auto& address = maybeAddress.unwrap();
+	EXPECT_EQ(0, reinterpret_cast<sockaddr_un const*>(address.address())->sun_path[0]);
+	EXPECT_EQ(offsetof(sockaddr_un, sun_path) + 7, address.size);
+}
+
+TEST(TestSocket, resolveLoopbackAddress) {
+	auto maybeAddress = resolve(DialString{kProtocolUDP, "127.0.0.1", "5353"});
+	ASSERT_TRUE(maybeAddress.isOk());
+
+	auto& address = maybeAddress.unwrap();
+	EXPECT_EQ(AF_INET, address.family());
+	EXPECT_EQ(SOCK_DGRAM, address.type);
+	EXPECT_EQ(5353, address.port());
+}
+
+TEST(TestSocket, resolveUnsupportedProtocol) {
+	auto maybeAddress = resolve(DialString{kProtocolTIPC, "0.2.117", "81"});
+	ASSERT_TRUE(maybeAddress.isError());
+	EXPECT_EQ(makeError(SystemErrors::PROTONOSUPPORT, "resolve"), maybeAddress.getError());
+}
+
+TEST(TestSocket, listenOnEphemeralPort) {
+	auto maybeSocket = listen(DialString{kProtocolTCP, "127.0.0.1", "0"});
+	ASSERT_TRUE(maybeSocket.isOk());
+
+	auto maybeAddress = localAddress(maybeSocket.unwrap());
+	ASSERT_TRUE(maybeAddress.isOk());
+	EXPECT_EQ(SOCK_STREAM, maybeAddress.unwrap().type);
+	EXPECT_NE(0, maybeAddress.unwrap().port());
+}
+
+TEST(TestSocket, connectWithoutListenerFails) {
+	auto maybeSocket = connect(DialString{kProtocolUnix, "@solace-test-nobody-listens"});
+	EXPECT_TRUE(maybeSocket.isError());
+}
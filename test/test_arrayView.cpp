@@ -997,6 +997,34 @@ TEST_F(TestArrayView, testMap) {
 */
 
 
+TEST_F(TestArrayView, uncheckedAccess) {
+	int src[] = {1, 2, 3, 4, 5};
+	auto array = arrayView(src);
+
+	EXPECT_EQ(3, array.unchecked_at(2));
+	array.unchecked_at(2) = 17;
+	EXPECT_EQ(17, array[2]);
+
+#if SOLACE_BOUNDS_CHECK_ENABLED
+	EXPECT_THROW(array[5], IndexOutOfRangeException);
+#endif
+}
+
+
+TEST_F(TestArrayView, checkedSlice) {
+	int src[] = {1, 2, 3, 4, 5};
+	auto array = arrayView(src);
+
+	auto slice = array.checkedSlice(1, 3);
+	ASSERT_EQ(2U, slice.size());
+	EXPECT_EQ(2, slice.unchecked_at(0));
+	EXPECT_EQ(3, slice.unchecked_at(1));
+
+	EXPECT_THROW(array.checkedSlice(3, 6), IndexOutOfRangeException);
+	EXPECT_THROW(array.checkedSlice(3, 1), IndexOutOfRangeException);
+}
+
+
 const ArrayView<int>::size_type TestArrayView::ZERO = 0;
 const ArrayView<int>::size_type TestArrayView::TEST_SIZE_0 = 7;
 const ArrayView<int>::size_type TestArrayView::TEST_SIZE_1 = 35;
@@ -0,0 +1,427 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/test_btreeMap.cpp
+ *	@brief		Test suit for Solace::BTreeMap
+ ******************************************************************************/
+#include <solace/btreeMap.hpp>  // Class being tested
+#include <solace/stringView.hpp>
+#include <solace/vector.hpp>
+
+#include "mockTypes.hpp"
+#include "randomSequence.hpp"
+
+#include <gtest/gtest.h>
+
+#include <map>
+
+using namespace Solace;
+
+
+namespace {
+
+template<typename M, typename K, typename V>
+void expectSameEntries(M const& map, std::map<K, V> const& expected) {
+	ASSERT_EQ(expected.size(), map.size());
+
+	auto it = expected.begin();
+	for (auto entry : map) {
+		ASSERT_TRUE(it != expected.end());
+		EXPECT_EQ(it->first, entry.key);
+		EXPECT_EQ(it->second, entry.value);
+		++it;
+	}
+	EXPECT_TRUE(it == expected.end());
+}
+
+}  // namespace
+
+
+class TestBTreeMap : public ::testing::Test {
+protected:
+	MemoryManager _memoryManager{16 * 1024 * 1024};
+};
+
+
+TEST_F(TestBTreeMap, emptyMapDoesNotAllocate) {
+	BTreeMap<uint64, uint64> map{_memoryManager};
+
+	EXPECT_TRUE(map.empty());
+	EXPECT_EQ(0U, map.size());
+	EXPECT_EQ(0U, map.height());
+	EXPECT_TRUE(map.begin() == map.end());
+	EXPECT_TRUE(map.find(1).isNone());
+	EXPECT_TRUE(map.range(0, 100).empty());
+	EXPECT_FALSE(map.erase(1));
+	EXPECT_EQ(0U, _memoryManager.size());
+}
+
+TEST_F(TestBTreeMap, putAndFind) {
+	BTreeMap<uint64, uint64> map{_memoryManager};
+	ASSERT_TRUE(map.put(42, 1U).isOk());
+	ASSERT_TRUE(map.put(7, 2U).isOk());
+
+	EXPECT_EQ(2U, map.size());
+	EXPECT_TRUE(map.contains(42));
+	EXPECT_TRUE(map.contains(7));
+	EXPECT_FALSE(map.contains(8));
+	EXPECT_EQ(1U, *map.find(42));
+	EXPECT_EQ(2U, *map.find(7));
+}
+
+TEST_F(TestBTreeMap, putReplacesExistingValue) {
+	BTreeMap<uint64, uint64> map{_memoryManager};
+	ASSERT_TRUE(map.put(42, 1U).isOk());
+
+	auto maybeValue = map.put(42, 2U);
+	ASSERT_TRUE(maybeValue.isOk());
+	EXPECT_EQ(2U, maybeValue.unwrap());
+	EXPECT_EQ(1U, map.size());
+	EXPECT_EQ(2U, *map.find(42));
+}
+
+TEST_F(TestBTreeMap, failedReplaceKeepsExistingValue) {
+	/// Value counting its live instances that can not be constructed from a negative number
+	struct Checked {
+		Checked(int x, int& nbLive) : value{x}, liveCounter{&nbLive} {
+			if (x < 0) {
+				raise<IllegalArgumentException>("x");
+			}
+			*liveCounter += 1;
+		}
+
+		Checked(Checked&& other) noexcept : value{other.value}, liveCounter{other.liveCounter} {
+			*liveCounter += 1;
+		}
+
+		Checked& operator= (Checked&& other) noexcept {
+			value = other.value;
+			return *this;
+		}
+
+		~Checked() {
+			*liveCounter -= 1;
+		}
+
+		int value;
+		int* liveCounter;
+	};
+
+	int nbLive = 0;
+	{
+		BTreeMap<uint64, Checked> map{_memoryManager};
+		ASSERT_TRUE(map.put(1, 10, nbLive).isOk());
+		EXPECT_EQ(1, nbLive);
+
+		EXPECT_THROW(map.put(1, -1, nbLive), IllegalArgumentException);
+		EXPECT_EQ(1, nbLive);
+		EXPECT_EQ(10, (*map.find(1)).value);
+
+		ASSERT_TRUE(map.put(1, 20, nbLive).isOk());
+		EXPECT_EQ(1, nbLive);
+		EXPECT_EQ(20, (*map.find(1)).value);
+	}
+	EXPECT_EQ(0, nbLive);
+}
+
+TEST_F(TestBTreeMap, sequentialInsertBuildsMultipleLevels) {
+	constexpr uint64 kNbEntries = 10000;
+	BTreeMap<uint64, uint64> map{_memoryManager};
+	for (uint64 i = 0; i < kNbEntries; ++i) {
+		ASSERT_TRUE(map.put(i, i * 10).isOk());
+	}
+
+	EXPECT_EQ(kNbEntries, map.size());
+	EXPECT_LT(2U, map.height());
+
+	uint64 expectedKey = 0;
+	for (auto entry : map) {
+		ASSERT_EQ(expectedKey, entry.key);
+		ASSERT_EQ(expectedKey * 10, entry.value);
+		++expectedKey;
+	}
+	EXPECT_EQ(kNbEntries, expectedKey);
+
+	for (uint64 i = 0; i < kNbEntries; ++i) {
+		ASSERT_TRUE(map.find(i).isSome());
+	}
+	EXPECT_TRUE(map.find(kNbEntries).isNone());
+}
+
+TEST_F(TestBTreeMap, fullLeafSplitsIntoTwo) {
+	using Map = BTreeMap<uint64, uint64>;
+	auto const capacity = Map::kLeafCapacity;
+	Map map{_memoryManager};
+
+	// Descending keys are inserted at the front of the leaf: split moves half of the entries into a new leaf
+	for (uint64 i = 0; i < capacity; ++i) {
+		ASSERT_TRUE(map.put(2 * (capacity - i), i).isOk());
+	}
+	EXPECT_EQ(1U, map.height());
+
+	ASSERT_TRUE(map.put(1, 100U).isOk());
+	EXPECT_EQ(2U, map.height());
+	EXPECT_EQ(capacity + 1, map.size());
+
+	// Insert into the gaps on both sides of the split
+	for (uint64 i = 1; i < capacity; ++i) {
+		ASSERT_TRUE(map.put(2 * i + 1, 100 + i).isOk());
+	}
+
+	uint64 previous = 0;
+	for (auto entry : map) {
+		EXPECT_LT(previous, entry.key);
+		previous = entry.key;
+	}
+	EXPECT_EQ(2 * capacity, previous);
+	EXPECT_EQ(100U, *map.find(1));
+	EXPECT_EQ(101U, *map.find(3));
+}
+
+TEST_F(TestBTreeMap, innerNodeSplitsGrowTheTree) {
+	using Map = BTreeMap<uint64, uint64>;
+	Map map{_memoryManager};
+
+	// Root inner node splits once it holds more than kInnerCapacity keys, one per leaf but the first
+	Map::size_type previousHeight = 0;
+	uint64 nbEntries = 0;
+	while (map.height() < 3) {
+		ASSERT_TRUE(map.put(nbEntries, nbEntries).isOk());
+		nbEntries += 1;
+
+		EXPECT_LE(previousHeight, map.height());
+		EXPECT_GE(previousHeight + 1, map.height());
+		previousHeight = map.height();
+	}
+	EXPECT_LT(uint64{Map::kLeafCapacity} * Map::kInnerCapacity, nbEntries);
+
+	for (uint64 i = 0; i < nbEntries; ++i) {
+		ASSERT_EQ(i, *map.find(i));
+	}
+}
+
+TEST_F(TestBTreeMap, emptiedLeavesAreRemovedAndRootCollapses) {
+	using Map = BTreeMap<uint64, uint64>;
+	auto const capacity = Map::kLeafCapacity;
+	Map map{_memoryManager};
+	for (uint64 i = 0; i < 4 * capacity; ++i) {
+		ASSERT_TRUE(map.put(i, i).isOk());
+	}
+	ASSERT_EQ(2U, map.height());
+	auto const memoryUsed = _memoryManager.size();
+
+	// Emptying the first leaf removes it from the parent, links of neighbours are kept intact
+	for (uint64 i = 0; i < capacity; ++i) {
+		ASSERT_TRUE(map.erase(i));
+	}
+	EXPECT_EQ(capacity, (*map.begin()).key);
+	EXPECT_EQ(2U, map.height());
+
+	// Parent left with a single leaf collapses into it
+	for (uint64 i = capacity; i < 4 * capacity - 1; ++i) {
+		ASSERT_TRUE(map.erase(i));
+	}
+	EXPECT_EQ(1U, map.height());
+	EXPECT_EQ(1U, map.size());
+	EXPECT_EQ(4 * capacity - 1, (*map.begin()).key);
+
+	// Freed nodes are recycled, not returned to the memory manager
+	EXPECT_EQ(memoryUsed, _memoryManager.size());
+	for (uint64 i = 0; i < 4 * capacity - 1; ++i) {
+		ASSERT_TRUE(map.put(i, i).isOk());
+	}
+	EXPECT_EQ(memoryUsed, _memoryManager.size());
+}
+
+TEST_F(TestBTreeMap, randomInsertAndEraseMatchesStdMap) {
+	BTreeMap<uint64, uint64, 128> map{_memoryManager};
+	std::map<uint64, uint64> expected;
+
+	uint64 seed = 17;
+	for (uint32 i = 0; i < 20000; ++i) {
+		auto const key = nextRandom(seed) % 5000;
+		if (nextRandom(seed) % 3 == 0) {
+			EXPECT_EQ(expected.erase(key) != 0, map.erase(key));
+		} else {
+			ASSERT_TRUE(map.put(key, uint64{i}).isOk());
+			expected[key] = i;
+		}
+	}
+
+	expectSameEntries(map, expected);
+}
+
+TEST_F(TestBTreeMap, eraseAllEntries) {
+	BTreeMap<uint32, uint32, 128> map{_memoryManager};
+	for (uint32 i = 0; i < 1000; ++i) {
+		ASSERT_TRUE(map.put(i, i).isOk());
+	}
+
+	for (uint32 i = 0; i < 1000; i += 2) {
+		EXPECT_TRUE(map.erase(i));
+	}
+	EXPECT_EQ(500U, map.size());
+	EXPECT_FALSE(map.erase(0));
+
+	for (uint32 i = 1; i < 1000; i += 2) {
+		EXPECT_TRUE(map.erase(i));
+	}
+
+	EXPECT_TRUE(map.empty());
+	EXPECT_EQ(1U, map.height());
+	EXPECT_TRUE(map.begin() == map.end());
+
+	ASSERT_TRUE(map.put(5, 5U).isOk());
+	EXPECT_EQ(5U, *map.find(5));
+}
+
+TEST_F(TestBTreeMap, rangeQueries) {
+	BTreeMap<uint64, uint64> map{_memoryManager};
+	for (uint64 i = 0; i < 1000; i += 2) {
+		ASSERT_TRUE(map.put(i, i).isOk());
+	}
+
+	uint64 count = 0;
+	uint64 expectedKey = 100;
+	for (auto entry : map.range(100, 200)) {
+		EXPECT_EQ(expectedKey, entry.key);
+		expectedKey += 2;
+		++count;
+	}
+	EXPECT_EQ(50U, count);
+
+	EXPECT_EQ(102U, (*map.lowerBound(101)).key);
+	EXPECT_EQ(102U, (*map.lowerBound(102)).key);
+	EXPECT_EQ(104U, (*map.upperBound(102)).key);
+	EXPECT_TRUE(map.lowerBound(999) == map.end());
+	EXPECT_TRUE(map.range(200, 100).empty());
+	EXPECT_TRUE(map.range(101, 102).empty());
+}
+
+TEST_F(TestBTreeMap, signedAndUnsignedIntegerKeys) {
+	BTreeMap<int32, int32> signedMap{_memoryManager};
+	for (int32 i = -500; i < 500; ++i) {
+		ASSERT_TRUE(signedMap.put(i * 3, i).isOk());
+	}
+
+	int32 previous = -2000;
+	for (auto entry : signedMap) {
+		EXPECT_LT(previous, entry.key);
+		previous = entry.key;
+	}
+	EXPECT_EQ(-500, *signedMap.find(-1500));
+	EXPECT_TRUE(signedMap.find(-1501).isNone());
+
+	BTreeMap<uint32, uint32> unsignedMap{_memoryManager};
+	for (uint32 i = 0; i < 1000; ++i) {
+		ASSERT_TRUE(unsignedMap.put(0xFFFFFFFFU - i * 7, i).isOk());
+	}
+	EXPECT_EQ(0U, *unsignedMap.find(0xFFFFFFFFU));
+	EXPECT_EQ(0xFFFFFFFFU - 999 * 7, (*unsignedMap.begin()).key);
+}
+
+TEST_F(TestBTreeMap, nonIntegerKeys) {
+	StringView const words[] = {"delta", "alpha", "oscar", "hotel", "bravo", "tango"};
+
+	BTreeMap<StringView, int, 128> map{_memoryManager};
+	int i = 0;
+	for (auto word : words) {
+		ASSERT_TRUE(map.put(word, i++).isOk());
+	}
+
+	EXPECT_EQ(1, *map.find("alpha"));
+	EXPECT_TRUE(map.find("golf").isNone());
+
+	auto first = map.begin();
+	EXPECT_EQ(StringView{"alpha"}, (*first).key);
+	EXPECT_EQ(StringView{"bravo"}, (*(++first)).key);
+}
+
+TEST_F(TestBTreeMap, valuesAreDestroyed) {
+	ASSERT_EQ(0, SimpleType::InstanceCount);
+	{
+		BTreeMap<uint32, SimpleType, 128> map{_memoryManager};
+		for (uint32 i = 0; i < 500; ++i) {
+			ASSERT_TRUE(map.put(i, static_cast<int>(i), 0, 0).isOk());
+		}
+		EXPECT_EQ(500, SimpleType::InstanceCount);
+
+		for (uint32 i = 0; i < 500; i += 5) {
+			EXPECT_TRUE(map.erase(i));
+		}
+		EXPECT_EQ(400, SimpleType::InstanceCount);
+		EXPECT_EQ(7, (*map.find(7)).x);
+	}
+
+	EXPECT_EQ(0, SimpleType::InstanceCount);
+	EXPECT_EQ(0U, _memoryManager.size());
+}
+
+TEST_F(TestBTreeMap, bulkLoadFromSortedInput) {
+	constexpr uint32 kNbEntries = 100000;
+	auto keys = makeVector<uint64>(kNbEntries).unwrap();
+	auto values = makeVector<uint32>(kNbEntries).unwrap();
+	for (uint32 i = 0; i < kNbEntries; ++i) {
+		keys.emplace_back(uint64{i} * 3);
+		values.emplace_back(i);
+	}
+
+	auto maybeMap = makeBTreeMap<uint64, uint32>(_memoryManager, keys.view(), values.view());
+	ASSERT_TRUE(maybeMap.isOk());
+
+	auto& map = maybeMap.unwrap();
+	EXPECT_EQ(kNbEntries, map.size());
+	EXPECT_LT(2U, map.height());
+
+	for (uint32 i = 0; i < kNbEntries; ++i) {
+		auto value = map.find(uint64{i} * 3);
+		ASSERT_TRUE(value.isSome());
+		ASSERT_EQ(i, *value);
+		ASSERT_TRUE(map.find(uint64{i} * 3 + 1).isNone());
+	}
+
+	uint32 expected = 0;
+	for (auto entry : map) {
+		ASSERT_EQ(expected, entry.value);
+		++expected;
+	}
+	EXPECT_EQ(kNbEntries, expected);
+
+	// Bulk loaded map remains updatable
+	ASSERT_TRUE(map.put(1, 7U).isOk());
+	EXPECT_TRUE(map.erase(3));
+	EXPECT_EQ(7U, *map.find(1));
+	EXPECT_EQ(kNbEntries, map.size());
+}
+
+TEST_F(TestBTreeMap, bulkLoadRejectsUnsortedInput) {
+	uint64 const keys[] = {1, 3, 2};
+	uint64 const duplicateKeys[] = {1, 2, 2};
+	uint64 const values[] = {1, 2, 3};
+
+	EXPECT_TRUE((makeBTreeMap<uint64, uint64>(_memoryManager, arrayView(keys), arrayView(values)).isError()));
+	EXPECT_TRUE((makeBTreeMap<uint64, uint64>(_memoryManager, arrayView(duplicateKeys), arrayView(values)).isError()));
+	EXPECT_TRUE((makeBTreeMap<uint64, uint64>(_memoryManager, arrayView(keys, 2), arrayView(values)).isError()));
+}
+
+TEST_F(TestBTreeMap, allocationFailureIsReported) {
+	MemoryManager tinyManager{64};
+	BTreeMap<uint64, uint64> map{tinyManager};
+
+	EXPECT_TRUE(map.put(1, 1U).isError());
+	EXPECT_TRUE(map.empty());
+}
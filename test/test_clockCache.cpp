@@ -0,0 +1,216 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/test_clockCache.cpp
+ *	@brief		Test suit for Solace::ClockCache
+ ******************************************************************************/
+#include <solace/clockCache.hpp>  // Class being tested
+#include <solace/string.hpp>
+#include <solace/uuid.hpp>
+
+#include "mockTypes.hpp"
+#include "randomSequence.hpp"
+
+#include <gtest/gtest.h>
+
+#include <map>
+
+using namespace Solace;
+
+
+namespace {
+
+}  // namespace
+
+
+class TestClockCache : public ::testing::Test {
+protected:
+	MemoryManager _memoryManager{1024 * 1024};
+};
+
+
+TEST_F(TestClockCache, emptyCache) {
+	auto maybeCache = makeClockCache<uint64, int>(_memoryManager, 16);
+	ASSERT_TRUE(maybeCache.isOk());
+
+	auto& cache = maybeCache.unwrap();
+	EXPECT_TRUE(cache.empty());
+	EXPECT_EQ(0U, cache.size());
+	EXPECT_EQ(16U, cache.capacity());
+	EXPECT_EQ(0U, cache.bytesUsed());
+	EXPECT_FALSE(cache.contains(1));
+	EXPECT_TRUE(cache.get(1).isNone());
+	EXPECT_FALSE(cache.erase(1));
+
+	EXPECT_EQ(0U, cache.stats().hits);
+	EXPECT_EQ(1U, cache.stats().misses);
+}
+
+TEST_F(TestClockCache, putAndGet) {
+	auto cache = makeClockCache<uint64, int>(_memoryManager, 16).unwrap();
+	for (uint64 i = 0; i < 10; ++i) {
+		ASSERT_TRUE(cache.put(i * 1000, static_cast<int>(i)).isOk());
+	}
+	EXPECT_EQ(10U, cache.size());
+
+	for (uint64 i = 0; i < 10; ++i) {
+		auto value = cache.get(i * 1000);
+		ASSERT_TRUE(value.isSome());
+		EXPECT_EQ(static_cast<int>(i), *value);
+	}
+	EXPECT_TRUE(cache.get(1).isNone());
+
+	// Existing value is replaced
+	ASSERT_TRUE(cache.put(3000, 33).isOk());
+	EXPECT_EQ(10U, cache.size());
+	EXPECT_EQ(33, *cache.get(3000));
+
+	EXPECT_EQ(11U, cache.stats().hits);
+	EXPECT_EQ(1U, cache.stats().misses);
+	EXPECT_EQ(11U, cache.stats().insertions);
+	EXPECT_EQ(0U, cache.stats().evictions);
+
+	cache.resetStats();
+	EXPECT_EQ(0U, cache.stats().hits);
+}
+
+TEST_F(TestClockCache, evictsEntriesNotUsedRecently) {
+	auto cache = makeClockCache<int, int>(_memoryManager, 3).unwrap();
+	ASSERT_TRUE(cache.put(1, 1).isOk());
+	ASSERT_TRUE(cache.put(2, 2).isOk());
+	ASSERT_TRUE(cache.put(3, 3).isOk());
+
+	EXPECT_TRUE(cache.get(1).isSome());
+	EXPECT_TRUE(cache.get(3).isSome());
+
+	// Full: the only entry not looked up goes
+	ASSERT_TRUE(cache.put(4, 4).isOk());
+	EXPECT_EQ(3U, cache.size());
+	EXPECT_FALSE(cache.contains(2));
+	EXPECT_TRUE(cache.contains(1));
+	EXPECT_TRUE(cache.contains(3));
+	EXPECT_TRUE(cache.contains(4));
+	EXPECT_EQ(1U, cache.stats().evictions);
+}
+
+TEST_F(TestClockCache, byteBudget) {
+	auto cache = makeClockCache<int, int>(_memoryManager, 100, 1000).unwrap();
+	EXPECT_EQ(1000U, cache.maxBytes());
+
+	ASSERT_TRUE(cache.put(1, 1, 400).isOk());
+	ASSERT_TRUE(cache.put(2, 2, 400).isOk());
+	EXPECT_EQ(800U, cache.bytesUsed());
+
+	ASSERT_TRUE(cache.put(3, 3, 300).isOk());
+	EXPECT_EQ(2U, cache.size());
+	EXPECT_EQ(700U, cache.bytesUsed());
+	EXPECT_EQ(1U, cache.stats().evictions);
+
+	// Replacement is charged anew
+	ASSERT_TRUE(cache.put(3, 4, 100).isOk());
+	EXPECT_EQ(500U, cache.bytesUsed());
+
+	// Entry larger than the whole budget is rejected
+	EXPECT_TRUE(cache.put(5, 5, 1001).isError());
+	EXPECT_FALSE(cache.contains(5));
+
+	EXPECT_TRUE(cache.erase(3));
+	EXPECT_EQ(400U, cache.bytesUsed());
+}
+
+TEST_F(TestClockCache, randomOperationsMatchModel) {
+	constexpr uint32 kCapacity = 64;
+	auto cache = makeClockCache<uint64, uint64>(_memoryManager, kCapacity).unwrap();
+	std::map<uint64, uint64> lastValue;
+
+	uint64 seed = 11;
+	for (uint64 i = 0; i < 50000; ++i) {
+		auto const key = nextRandom(seed) % 200;
+		switch (nextRandom(seed) % 4) {
+		case 0:
+			cache.erase(key);
+			lastValue.erase(key);
+			break;
+		case 1:
+		case 2: {
+			auto value = cache.get(key);
+			if (value.isSome()) {
+				ASSERT_EQ(lastValue[key], *value);
+			}
+		} break;
+		default:
+			ASSERT_TRUE(cache.put(key, i).isOk());
+			lastValue[key] = i;
+			break;
+		}
+
+		ASSERT_LE(cache.size(), kCapacity);
+	}
+
+	for (auto const& entry : lastValue) {
+		auto value = cache.get(entry.first);
+		if (value.isSome()) {
+			EXPECT_EQ(entry.second, *value);
+		}
+	}
+
+	auto const& stats = cache.stats();
+	EXPECT_LT(0U, stats.evictions);
+	EXPECT_LT(0U, stats.hits);
+}
+
+TEST_F(TestClockCache, stringAndUuidKeys) {
+	auto strings = makeClockCache<String, int>(_memoryManager, 4).unwrap();
+	ASSERT_TRUE(strings.put(makeString("one").unwrap(), 1).isOk());
+	ASSERT_TRUE(strings.put(makeString("two").unwrap(), 2).isOk());
+	EXPECT_EQ(2, *strings.get(makeString("two").unwrap()));
+	EXPECT_TRUE(strings.get(makeString("three").unwrap()).isNone());
+
+	auto uuids = makeClockCache<UUID, int>(_memoryManager, 4).unwrap();
+	auto const id = makeUUID(1, 2, 3, 4);
+	ASSERT_TRUE(uuids.put(id, 7).isOk());
+	ASSERT_TRUE(uuids.put(makeUUID(4, 3, 2, 1), 8).isOk());
+	EXPECT_EQ(7, *uuids.get(id));
+	EXPECT_EQ(8, *uuids.get(makeUUID(4, 3, 2, 1)));
+	EXPECT_TRUE(uuids.get(makeUUID(1, 2, 3, 5)).isNone());
+}
+
+TEST_F(TestClockCache, valuesAreDestroyed) {
+	ASSERT_EQ(0, SimpleType::InstanceCount);
+	{
+		auto cache = makeClockCache<int, SimpleType>(_memoryManager, 8).unwrap();
+		for (int i = 0; i < 20; ++i) {
+			ASSERT_TRUE(cache.put(i, SimpleType{i, 0, 0}).isOk());
+		}
+		EXPECT_EQ(8, SimpleType::InstanceCount);
+
+		cache.clear();
+		EXPECT_TRUE(cache.empty());
+		EXPECT_EQ(0, SimpleType::InstanceCount);
+
+		ASSERT_TRUE(cache.put(1, SimpleType{1, 2, 3}).isOk());
+		EXPECT_EQ(1, SimpleType::InstanceCount);
+	}
+
+	EXPECT_EQ(0, SimpleType::InstanceCount);
+	EXPECT_EQ(0U, _memoryManager.size());
+}
+
+TEST_F(TestClockCache, allocationFailureIsReported) {
+	MemoryManager tinyManager{64};
+	EXPECT_TRUE((makeClockCache<uint64, uint64>(tinyManager, 1024).isError()));
+}
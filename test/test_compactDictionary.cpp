@@ -0,0 +1,192 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/test_compactDictionary.cpp
+ *	@brief		Test suit for Solace::CompactDictionary
+ ******************************************************************************/
+#include <solace/compactDictionary.hpp>    // Class being tested.
+
+#include <gtest/gtest.h>
+#include "mockTypes.hpp"
+
+using namespace Solace;
+
+
+using Dict = CompactDictionary<int32, SimpleType>;
+
+
+TEST(TestCompactDictionary, emptyDictionaryIsEmpty) {
+	Dict v;
+
+	EXPECT_TRUE(v.empty());
+	EXPECT_EQ(0U, v.size());
+	EXPECT_EQ(0U, v.capacity());
+	EXPECT_TRUE(v.put(1, 2, 3, 4).isError());
+	EXPECT_EQ(0, SimpleType::InstanceCount);
+}
+
+TEST(TestCompactDictionary, capacityIsRoundedToBlocks) {
+	auto maybeDict = makeCompactDictionary<int32, SimpleType>(10);
+	ASSERT_TRUE(maybeDict.isOk());
+
+	auto& v = maybeDict.unwrap();
+	EXPECT_EQ(2 * Dict::kBlockSize, v.capacity());
+	EXPECT_TRUE(v.empty());
+	EXPECT_EQ(0, SimpleType::InstanceCount);
+}
+
+TEST(TestCompactDictionary, putAndFind) {
+	ASSERT_EQ(0, SimpleType::InstanceCount);
+	{
+		auto dict = makeCompactDictionary<int32, SimpleType>(20).moveResult();
+		for (int32 i = 0; i < 20; ++i) {
+			auto maybeValue = dict.put(i * 3, i, i + 1, i + 2);
+			ASSERT_TRUE(maybeValue.isOk());
+			EXPECT_EQ(i, maybeValue.unwrap().x);
+		}
+		EXPECT_EQ(20U, dict.size());
+		EXPECT_EQ(20, SimpleType::InstanceCount);
+
+		for (int32 i = 0; i < 20; ++i) {
+			auto maybeValue = dict.find(i * 3);
+			ASSERT_TRUE(maybeValue.isSome());
+			EXPECT_EQ(i + 1, (*maybeValue).y);
+		}
+
+		EXPECT_TRUE(dict.contains(57));
+		EXPECT_FALSE(dict.contains(58));
+		EXPECT_TRUE(dict.find(1).isNone());
+	}
+	EXPECT_EQ(0, SimpleType::InstanceCount);
+}
+
+TEST(TestCompactDictionary, putIntoFullDictionaryFails) {
+	auto dict = makeCompactDictionary<int32, int32>(1).moveResult();
+	for (int32 i = 0; i < static_cast<int32>(dict.capacity()); ++i) {
+		EXPECT_TRUE(dict.put(i, i).isOk());
+	}
+	EXPECT_TRUE(dict.put(-1, 0).isError());
+}
+
+TEST(TestCompactDictionary, eraseMovesLastEntry) {
+	ASSERT_EQ(0, SimpleType::InstanceCount);
+	{
+		auto dict = makeCompactDictionary<int32, SimpleType>(16).moveResult();
+		for (int32 i = 0; i < 12; ++i) {
+			dict.put(i, i, 0, 0);
+		}
+
+		EXPECT_TRUE(dict.erase(3));
+		EXPECT_FALSE(dict.erase(3));
+		EXPECT_FALSE(dict.erase(42));
+		EXPECT_EQ(11U, dict.size());
+		EXPECT_EQ(11, SimpleType::InstanceCount);
+		EXPECT_FALSE(dict.contains(3));
+
+		// Last entry took the place of the erased one
+		auto it = dict.begin();
+		for (int i = 0; i < 3; ++i) {
+			++it;
+		}
+		EXPECT_EQ(11, (*it).key);
+		EXPECT_EQ(11, (*it).value.x);
+
+		// Erase the last entry
+		EXPECT_TRUE(dict.erase(10));
+		EXPECT_EQ(10U, dict.size());
+		for (int32 i = 0; i < 12; ++i) {
+			if (i != 3 && i != 10) {
+				ASSERT_TRUE(dict.find(i).isSome());
+				EXPECT_EQ(i, (*dict.find(i)).x);
+			}
+		}
+
+		// Slots freed by erase are reused
+		EXPECT_TRUE(dict.put(100, 100, 0, 0).isOk());
+		EXPECT_TRUE(dict.put(101, 101, 0, 0).isOk());
+		EXPECT_EQ(12U, dict.size());
+	}
+	EXPECT_EQ(0, SimpleType::InstanceCount);
+}
+
+TEST(TestCompactDictionary, shrinkReleasesUnusedBlocks) {
+	ASSERT_EQ(0, SimpleType::InstanceCount);
+	{
+		MemoryManager memoryManager{1 << 20};
+		auto dict = makeCompactDictionary<int32, SimpleType>(memoryManager, 64).moveResult();
+		for (int32 i = 0; i < 64; ++i) {
+			dict.put(i, i, i, i);
+		}
+		for (int32 i = 0; i < 60; ++i) {
+			dict.erase(i);
+		}
+		EXPECT_EQ(4, SimpleType::InstanceCount);
+
+		ASSERT_TRUE(dict.shrink(memoryManager).isOk());
+		EXPECT_EQ(Dict::kBlockSize, dict.capacity());
+		EXPECT_EQ(Dict::memorySize(4), memoryManager.size());
+		EXPECT_EQ(4U, dict.size());
+		EXPECT_EQ(4, SimpleType::InstanceCount);
+		for (int32 i = 60; i < 64; ++i) {
+			ASSERT_TRUE(dict.find(i).isSome());
+			EXPECT_EQ(i, (*dict.find(i)).z);
+		}
+
+		while (!dict.empty()) {
+			dict.erase((*dict.begin()).key);
+		}
+		ASSERT_TRUE(dict.shrink(memoryManager).isOk());
+		EXPECT_EQ(0U, dict.capacity());
+		EXPECT_TRUE(memoryManager.empty());
+	}
+	EXPECT_EQ(0, SimpleType::InstanceCount);
+}
+
+TEST(TestCompactDictionary, iterateEntries) {
+	auto dict = makeCompactDictionary<int32, int32>(20).moveResult();
+	for (int32 i = 0; i < 20; ++i) {
+		dict.put(i, i * i);
+	}
+
+	int32 count = 0;
+	for (auto entry : dict) {
+		EXPECT_EQ(entry.key * entry.key, entry.value);
+		entry.value = -1;
+		++count;
+	}
+	EXPECT_EQ(20, count);
+
+	auto const& constDict = dict;
+	for (auto entry : constDict) {
+		EXPECT_EQ(-1, entry.value);
+	}
+}
+
+TEST(TestCompactDictionary, moveTransfersEntries) {
+	ASSERT_EQ(0, SimpleType::InstanceCount);
+	{
+		auto dict = makeCompactDictionary<int32, SimpleType>(4).moveResult();
+		dict.put(1, 1, 2, 3);
+
+		auto other = mv(dict);
+		EXPECT_TRUE(dict.empty());
+		EXPECT_EQ(1U, other.size());
+		EXPECT_EQ(1, SimpleType::InstanceCount);
+	}
+	EXPECT_EQ(0, SimpleType::InstanceCount);
+}
+
@@ -0,0 +1,97 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/test_cpuFeatures.cpp
+ *	@brief		Test suit for CPU features detection and kernel dispatch
+ ******************************************************************************/
+#include <solace/cpuFeatures.hpp>    // Class being tested.
+
+#include <gtest/gtest.h>
+
+using namespace Solace;
+
+
+namespace {
+
+int scalarImpl(int x) { return x; }
+int sse42Impl(int x) { return x * 2; }
+int impossibleImpl(int x) { return x * 3; }
+
+}  // namespace
+
+
+TEST(TestCpuFeatures, featureSet) {
+	constexpr CpuFeatureSet empty;
+	EXPECT_TRUE(empty.empty());
+	EXPECT_FALSE(empty.has(CpuFeature::SSE2));
+
+	constexpr CpuFeatureSet features{CpuFeature::SSE2, CpuFeature::AVX2};
+	EXPECT_TRUE(features.has(CpuFeature::SSE2));
+	EXPECT_TRUE(features.has(CpuFeature::AVX2));
+	EXPECT_FALSE(features.has(CpuFeature::NEON));
+
+	EXPECT_TRUE(features.contains(CpuFeatureSet{CpuFeature::AVX2}));
+	EXPECT_TRUE(features.contains(empty));
+	EXPECT_FALSE(features.contains(CpuFeatureSet{CpuFeature::AVX2, CpuFeature::BMI2}));
+
+	EXPECT_EQ(CpuFeatureSet{CpuFeature::AVX2}, features.intersect(CpuFeatureSet{CpuFeature::AVX2, CpuFeature::BMI2}));
+}
+
+
+TEST(TestCpuFeatures, parseLevel) {
+	EXPECT_EQ(CpuLevel::Scalar, parseCpuLevel("scalar").get());
+	EXPECT_EQ(CpuLevel::SSE4_2, parseCpuLevel("SSE4.2").get());
+	EXPECT_EQ(CpuLevel::AVX2, parseCpuLevel("Avx2").get());
+	EXPECT_TRUE(parseCpuLevel("avx3000").isNone());
+}
+
+
+TEST(TestCpuFeatures, levelsAreNested) {
+	EXPECT_TRUE(cpuLevelFeatures(CpuLevel::Scalar).empty());
+	EXPECT_TRUE(cpuLevelFeatures(CpuLevel::SSE4_2).contains(cpuLevelFeatures(CpuLevel::SSE2)));
+	EXPECT_TRUE(cpuLevelFeatures(CpuLevel::AVX2).contains(cpuLevelFeatures(CpuLevel::SSE4_2)));
+	EXPECT_TRUE(cpuLevelFeatures(CpuLevel::AVX512).contains(cpuLevelFeatures(CpuLevel::AVX2)));
+}
+
+
+TEST(TestCpuFeatures, cachedFeaturesAreSupported) {
+	EXPECT_TRUE(detectCpuFeatures().contains(cpuFeatures()));
+#if defined(__x86_64__)
+	EXPECT_TRUE(detectCpuFeatures().has(CpuFeature::SSE2));
+#endif
+}
+
+
+TEST(TestCpuFeatures, dispatchSelectsBestCandidate) {
+	static KernelDispatch<int(int)>::Candidate const kCandidates[] = {
+		{{CpuFeature::AVX512F, CpuFeature::NEON}, impossibleImpl},
+		{{CpuFeature::SSE4_2}, sse42Impl},
+	};
+	KernelDispatch<int(int)> kernel{kCandidates, scalarImpl};
+
+	EXPECT_EQ(&scalarImpl, kernel.select(CpuFeatureSet{}));
+	EXPECT_EQ(&sse42Impl, kernel.select(cpuLevelFeatures(CpuLevel::AVX2)));
+
+	auto const expected = cpuFeatures().has(CpuFeature::SSE4_2) ? 14 : 7;
+	EXPECT_EQ(expected, kernel(7));
+}
+
+
+TEST(TestCpuFeatures, dispatchFallback) {
+	KernelDispatch<int(int)> kernel{scalarImpl};
+	EXPECT_EQ(5, kernel(5));
+}
@@ -272,3 +272,27 @@ TEST(TestDictionary, find) {
 
 	ASSERT_EQ(0, SimpleType::InstanceCount);
 }
+
+
+TEST(TestDictionary, eraseMovesLastEntry) {
+	ASSERT_EQ(0, SimpleType::InstanceCount);
+	{
+		auto dict = makeDictionary<int32, SimpleType>(4).moveResult();
+		dict.put(1, 1, 0, 0);
+		dict.put(2, 2, 0, 0);
+		dict.put(3, 3, 0, 0);
+
+		EXPECT_TRUE(dict.erase(1));
+		EXPECT_FALSE(dict.erase(1));
+		EXPECT_EQ(2U, dict.size());
+		EXPECT_EQ(2, SimpleType::InstanceCount);
+		EXPECT_EQ(3, dict.keys()[0]);
+		EXPECT_EQ(3, dict.values()[0].x);
+		EXPECT_TRUE(dict.contains(2));
+
+		EXPECT_TRUE(dict.put(4, 4, 0, 0).isOk());
+		EXPECT_TRUE(dict.put(5, 5, 0, 0).isOk());
+		EXPECT_TRUE(dict.put(6, 6, 0, 0).isError());
+	}
+	EXPECT_EQ(0, SimpleType::InstanceCount);
+}
@@ -0,0 +1,123 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/test_errorDomain.cpp
+ *	@brief		Test suit for Solace::ErrorDomain registry
+ ******************************************************************************/
+#include <solace/errorDomain.hpp>    // Class being tested.
+#include <solace/string.hpp>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+using namespace Solace;
+
+
+namespace {
+
+struct MockErrorDomain : public ErrorDomain {
+	explicit MockErrorDomain(StringView domainName) noexcept
+		: _name{domainName}
+	{}
+
+	StringView name() const noexcept override { return _name; }
+	String message(int) const noexcept override { return makeString(_name).unwrap(); }
+
+	StringView _name;
+};
+
+// Registry keeps pointers to the registered domains: like the library's own domains, these live for the whole run
+MockErrorDomain kEmptyDomain{"empty"};
+MockErrorDomain kRegisteredDomain{"t-reg"};
+MockErrorDomain kFirstDomain{"first"};
+MockErrorDomain kSecondDomain{"second"};
+MockErrorDomain kThreadDomains[] = {
+	MockErrorDomain{"t-thr-0"}, MockErrorDomain{"t-thr-1"},
+	MockErrorDomain{"t-thr-2"}, MockErrorDomain{"t-thr-3"}
+};
+
+}  // namespace
+
+
+TEST(TestErrorDomain, posixDomainIsRegistered) {
+	auto maybeDomain = findErrorDomain(atom("posix"));
+	ASSERT_TRUE(maybeDomain.isSome());
+}
+
+
+TEST(TestErrorDomain, unknownDomainIsNotFound) {
+	EXPECT_TRUE(findErrorDomain(atom("t-unk")).isNone());
+	EXPECT_TRUE(findErrorDomain(atom("")).isNone());
+}
+
+
+TEST(TestErrorDomain, emptyAtomCanNotBeRegistered) {
+	EXPECT_EQ(0U, registerErrorDomain(atom(""), kEmptyDomain));
+}
+
+
+TEST(TestErrorDomain, registerAndFind) {
+	EXPECT_NE(0U, registerErrorDomain(atom("t-reg"), kRegisteredDomain));
+
+	auto maybeDomain = findErrorDomain(atom("t-reg"));
+	ASSERT_TRUE(maybeDomain.isSome());
+	EXPECT_EQ(&kRegisteredDomain, &(maybeDomain.get()));
+	EXPECT_EQ(StringView{"t-reg"}, maybeDomain.get().name());
+}
+
+
+TEST(TestErrorDomain, reRegistrationReplacesDomain) {
+	auto const firstId = registerErrorDomain(atom("t-repl"), kFirstDomain);
+	EXPECT_NE(0U, firstId);
+	EXPECT_EQ(&kFirstDomain, &(findErrorDomain(atom("t-repl")).get()));
+
+	auto const secondId = registerErrorDomain(atom("t-repl"), kSecondDomain);
+	EXPECT_NE(0U, secondId);
+	EXPECT_EQ(&kSecondDomain, &(findErrorDomain(atom("t-repl")).get()));
+}
+
+
+TEST(TestErrorDomain, concurrentRegistrationAndLookup) {
+	constexpr int kNbThreads = 4;
+	AtomValue const categories[kNbThreads] = {atom("t-thr-0"), atom("t-thr-1"), atom("t-thr-2"), atom("t-thr-3")};
+
+	std::vector<std::thread> threads;
+	for (int i = 0; i < kNbThreads; ++i) {
+		threads.emplace_back([&, i]() {
+			registerErrorDomain(categories[i], kThreadDomains[i]);
+			for (int j = 0; j < 1000; ++j) {
+				auto const k = (i + j) % kNbThreads;
+				auto maybeDomain = findErrorDomain(categories[k]);
+				if (maybeDomain) {
+					EXPECT_EQ(&kThreadDomains[k], &(maybeDomain.get()));
+				}
+			}
+		});
+	}
+
+	for (auto& t : threads) {
+		t.join();
+	}
+
+	for (int i = 0; i < kNbThreads; ++i) {
+		auto maybeDomain = findErrorDomain(categories[i]);
+		ASSERT_TRUE(maybeDomain.isSome());
+		EXPECT_EQ(&kThreadDomains[i], &(maybeDomain.get()));
+	}
+}
@@ -0,0 +1,128 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/test_errorStats.cpp
+ *	@brief		Test suit for error counters
+ ******************************************************************************/
+#include <solace/errorStats.hpp>    // Class being tested.
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+using namespace Solace;
+
+
+namespace {
+
+constexpr AtomValue kTestDomain = atom("t-stats");
+constexpr StringLiteral kTagA{"tagA"};
+constexpr StringLiteral kTagB{"tagB"};
+
+ErrorStatsEntry const*
+findEntry(ArrayView<ErrorStatsEntry> entries, uint32 count, int code, StringView tag) {
+	for (uint32 i = 0; i < count; ++i) {
+		auto const& e = entries.begin()[i];
+		if (e.domain == kTestDomain && e.code == code && e.tag.data() == tag.data()) {
+			return &e;
+		}
+	}
+
+	return nullptr;
+}
+
+}  // namespace
+
+
+TEST(TestErrorStats, recordAndSnapshot) {
+	errorStatsReset();
+
+	recordError(kTestDomain, 1, kTagA);
+	recordError(kTestDomain, 1, kTagA);
+	recordError(kTestDomain, 2, kTagA);
+	recordError(Error{kTestDomain, 1, kTagB});
+
+	ErrorStatsEntry buffer[16];
+	auto const count = errorStatsSnapshot(buffer);
+
+	auto entry = findEntry(buffer, count, 1, kTagA);
+	ASSERT_NE(nullptr, entry);
+	EXPECT_EQ(2U, entry->count);
+
+	entry = findEntry(buffer, count, 2, kTagA);
+	ASSERT_NE(nullptr, entry);
+	EXPECT_EQ(1U, entry->count);
+
+	entry = findEntry(buffer, count, 1, kTagB);
+	ASSERT_NE(nullptr, entry);
+	EXPECT_EQ(1U, entry->count);
+}
+
+
+TEST(TestErrorStats, resetClearsCounters) {
+	recordError(kTestDomain, 3, kTagA);
+	errorStatsReset();
+
+	ErrorStatsEntry buffer[16];
+	auto const count = errorStatsSnapshot(buffer);
+	EXPECT_EQ(nullptr, findEntry(buffer, count, 3, kTagA));
+}
+
+
+TEST(TestErrorStats, countersAggregatedAcrossThreads) {
+	errorStatsReset();
+
+	constexpr int kNbThreads = 4;
+	constexpr int kNbErrors = 1000;
+
+	std::vector<std::thread> threads;
+	for (int i = 0; i < kNbThreads; ++i) {
+		threads.emplace_back([]() noexcept {
+			for (int j = 0; j < kNbErrors; ++j) {
+				recordError(kTestDomain, 4, kTagA);
+			}
+		});
+	}
+
+	for (auto& t : threads) {
+		t.join();
+	}
+
+	ErrorStatsEntry buffer[16];
+	auto const count = errorStatsSnapshot(buffer);
+	auto entry = findEntry(buffer, count, 4, kTagA);
+	ASSERT_NE(nullptr, entry);
+	EXPECT_EQ(static_cast<uint64>(kNbThreads * kNbErrors), entry->count);
+}
+
+
+TEST(TestErrorStats, topN) {
+	errorStatsReset();
+
+	for (int i = 0; i < 3; ++i) recordError(kTestDomain, 5, kTagA);
+	for (int i = 0; i < 7; ++i) recordError(kTestDomain, 6, kTagA);
+	for (int i = 0; i < 5; ++i) recordError(kTestDomain, 7, kTagA);
+
+	ErrorStatsEntry buffer[16];
+	auto const top = errorStatsTopN(buffer, 2);
+	ASSERT_EQ(2U, top.size());
+	EXPECT_EQ(6, top.begin()[0].code);
+	EXPECT_EQ(7U, top.begin()[0].count);
+	EXPECT_EQ(7, top.begin()[1].code);
+	EXPECT_EQ(5U, top.begin()[1].count);
+}
@@ -0,0 +1,158 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/test_exception.cpp
+ *	@brief		Test suit for Solace::Exception
+ ******************************************************************************/
+#include <solace/exception.hpp>    // Class being tested.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace Solace;
+
+
+namespace {
+
+struct CountingException final : public Exception {
+	explicit CountingException(std::atomic<int>& formatCount) noexcept
+		: Exception{DeferFormatting{}, "Counted"}
+		, _formatCount{&formatCount}
+	{}
+
+	CountingException(CountingException const& other) noexcept
+		: Exception{DeferFormatting{}, other}
+		, _formatCount{other._formatCount}
+	{}
+
+protected:
+	void formatMessage(details::StringWriter& writer) const noexcept override {
+		_formatCount->fetch_add(1);
+		writer.append(" once");
+	}
+
+private:
+	std::atomic<int>*	_formatCount;
+};
+
+}  // namespace
+
+
+TEST(TestException, messageIsCopied) {
+	char buffer[] = "Some message";
+	Exception e{StringView{buffer}};
+	buffer[0] = 'X';
+
+	EXPECT_EQ(StringView{"Some message"}, e.getMessage());
+	EXPECT_STREQ("Some message", e.what());
+}
+
+
+TEST(TestException, longMessageIsTruncated) {
+	char buffer[Exception::kMaxMessageSize * 2];
+	memset(buffer, 'x', sizeof(buffer));
+
+	Exception e{StringView{buffer, sizeof(buffer)}};
+	EXPECT_EQ(Exception::kMaxMessageSize, e.getMessage().size());
+	EXPECT_EQ(Exception::kMaxMessageSize, strlen(e.what()));
+}
+
+
+TEST(TestException, indexOutOfRangeMessage) {
+	IndexOutOfRangeException e{uint32{7}, uint32{0}, uint32{5}, "Test[]"};
+
+	EXPECT_EQ(StringView{"Test[]: 7 is out of range [0, 5)"}, e.getMessage());
+	EXPECT_STREQ("Test[]: 7 is out of range [0, 5)", e.what());
+}
+
+
+TEST(TestException, overflowMessage) {
+	OverflowException e{"offset", uint64{12}, uint64{0}, uint64{10}};
+
+	EXPECT_EQ(StringView{"Value 'offset'=12 overflows range [0, 10)"}, e.getMessage());
+}
+
+
+TEST(TestException, invalidStateMessage) {
+	EXPECT_EQ(StringView{"Invalid State"}, InvalidStateException{}.getMessage());
+	EXPECT_EQ(StringView{"Invalid State tag"}, InvalidStateException{"tag"}.getMessage());
+}
+
+
+TEST(TestException, ioExceptionMessage) {
+	IOException e{ENOENT, "open"};
+	EXPECT_EQ(ENOENT, e.getErrorCode());
+
+	auto const expectedPrefix = StringView{"open["};
+	auto const message = e.getMessage();
+	ASSERT_LT(expectedPrefix.size(), message.size());
+	EXPECT_EQ(expectedPrefix, message.substring(0, expectedPrefix.size()));
+	EXPECT_EQ(message.size(), strlen(e.what()));
+}
+
+
+TEST(TestException, copiedExceptionKeepsMessage) {
+	try {
+		raise<IllegalArgumentException>("arg");
+	} catch (Exception const& e) {
+		Exception copy{e};
+		EXPECT_EQ(StringView{"Illegal argument 'arg'"}, copy.getMessage());
+	}
+}
+
+
+TEST(TestException, copyAndMoveDoNotFormatMessage) {
+	std::atomic<int> formatCount{0};
+	CountingException e{formatCount};
+
+	CountingException copy{e};
+	CountingException moved{std::move(e)};
+	EXPECT_EQ(0, formatCount.load());
+
+	EXPECT_EQ(StringView{"Counted once"}, copy.getMessage());
+	EXPECT_EQ(StringView{"Counted once"}, moved.getMessage());
+	EXPECT_EQ(2, formatCount.load());
+
+	// Copy of a formatted exception carries the message.
+	CountingException copyOfFormatted{copy};
+	EXPECT_STREQ("Counted once", copyOfFormatted.what());
+	EXPECT_EQ(2, formatCount.load());
+}
+
+
+TEST(TestException, concurrentAccessFormatsMessageOnce) {
+	std::atomic<int> formatCount{0};
+	CountingException const e{formatCount};
+
+	std::vector<std::thread> readers;
+	for (int i = 0; i < 4; ++i) {
+		readers.emplace_back([&e]() noexcept {
+			EXPECT_STREQ("Counted once", e.what());
+		});
+	}
+
+	for (auto& reader : readers) {
+		reader.join();
+	}
+
+	EXPECT_EQ(1, formatCount.load());
+}
@@ -0,0 +1,205 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/test_glob.cpp
+ *	@brief		Test suit for compiled glob patterns
+ ******************************************************************************/
+#include <solace/glob.hpp>    // Class being tested.
+#include <solace/output_utils.hpp>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace Solace;
+
+
+namespace {
+
+GlobPattern compile(StringView pattern) {
+	auto maybePattern = makeGlobPattern(pattern);
+	EXPECT_TRUE(maybePattern.isOk());
+
+	return maybePattern.moveResult();
+}
+
+Path parsePath(StringView str) {
+	auto maybePath = Path::parse(str);
+	EXPECT_TRUE(maybePath.isOk());
+
+	return maybePath.moveResult();
+}
+
+/// Check that a pattern gives the same answer for a path and for its string representation
+bool matches(GlobPattern const& pattern, StringView str) {
+	auto const byString = pattern.matches(str);
+	EXPECT_EQ(byString, pattern.matches(parsePath(str))) << str;
+
+	return byString;
+}
+
+}  // namespace
+
+
+TEST(TestGlob, literalPattern) {
+	auto const pattern = compile("etc/config.json");
+
+	EXPECT_EQ(2U, pattern.segmentsCount());
+	EXPECT_FALSE(pattern.hasAnySegments());
+	EXPECT_TRUE(matches(pattern, "etc/config.json"));
+	EXPECT_TRUE(matches(pattern, "etc/config.json/"));
+	EXPECT_FALSE(matches(pattern, "/etc/config.json"));
+	EXPECT_FALSE(matches(pattern, "etc/config.jso"));
+	EXPECT_FALSE(matches(pattern, "etc/config.json/x"));
+	EXPECT_FALSE(matches(pattern, "config.json"));
+}
+
+
+TEST(TestGlob, starMatchesWithinComponent) {
+	auto const pattern = compile("*.log");
+
+	EXPECT_TRUE(matches(pattern, "server.log"));
+	EXPECT_TRUE(matches(pattern, ".log"));
+	EXPECT_TRUE(matches(pattern, "a.log.log"));
+	EXPECT_FALSE(matches(pattern, "server.log1"));
+	EXPECT_FALSE(matches(pattern, "logs/server.log"));
+	EXPECT_FALSE(pattern.matches(StringView{""}));
+
+	auto const middle = compile("a*b*c");
+	EXPECT_TRUE(matches(middle, "abc"));
+	EXPECT_TRUE(matches(middle, "aXbYbZc"));
+	EXPECT_TRUE(matches(middle, "abcbc"));
+	EXPECT_FALSE(matches(middle, "abcb"));
+	EXPECT_FALSE(matches(middle, "ac"));
+
+	EXPECT_TRUE(matches(compile("**.txt"), "notes.txt"));
+	EXPECT_TRUE(matches(compile("*"), "anything"));
+	EXPECT_FALSE(matches(compile("*"), "two/components"));
+}
+
+
+TEST(TestGlob, singleCharacterAndClasses) {
+	auto const pattern = compile("[a-f]?[!0-9x]");
+
+	EXPECT_TRUE(matches(pattern, "a1b"));
+	EXPECT_TRUE(matches(pattern, "fzz"));
+	EXPECT_FALSE(matches(pattern, "g1b"));
+	EXPECT_FALSE(matches(pattern, "a15"));
+	EXPECT_FALSE(matches(pattern, "a1x"));
+	EXPECT_FALSE(matches(pattern, "a1"));
+
+	auto const classes = compile("[]a]*[^-]");
+	EXPECT_TRUE(matches(classes, "]b"));
+	EXPECT_TRUE(matches(classes, "a-b"));
+	EXPECT_FALSE(matches(classes, "b-b"));
+	EXPECT_FALSE(matches(classes, "a-"));
+
+	EXPECT_TRUE(matches(compile("[a-]"), "-"));
+	EXPECT_TRUE(matches(compile("data-[0-9][0-9].*"), "data-42.csv"));
+	EXPECT_FALSE(matches(compile("data-[0-9][0-9].*"), "data-4x.csv"));
+}
+
+
+TEST(TestGlob, escapedCharactersAreLiteral) {
+	auto const pattern = compile("\\*\\?\\[x]");
+
+	EXPECT_TRUE(matches(pattern, "*?[x]"));
+	EXPECT_FALSE(matches(pattern, "a?[x]"));
+	EXPECT_FALSE(matches(pattern, "*?x"));
+}
+
+
+TEST(TestGlob, anySegments) {
+	auto const pattern = compile("**/tmp/*");
+
+	EXPECT_TRUE(pattern.hasAnySegments());
+	EXPECT_TRUE(matches(pattern, "tmp/file"));
+	EXPECT_TRUE(matches(pattern, "var/tmp/file"));
+	EXPECT_TRUE(matches(pattern, "/var/lib/tmp/file"));
+	EXPECT_TRUE(matches(pattern, "tmp/tmp/tmp/x"));
+	EXPECT_FALSE(matches(pattern, "var/tmp"));
+	EXPECT_FALSE(matches(pattern, "var/tmp/a/b"));
+
+	auto const middle = compile("src/**/test_*.cpp");
+	EXPECT_TRUE(matches(middle, "src/test_a.cpp"));
+	EXPECT_TRUE(matches(middle, "src/a/b/c/test_a.cpp"));
+	EXPECT_FALSE(matches(middle, "include/a/test_a.cpp"));
+	EXPECT_FALSE(matches(middle, "src/a/test_a.hpp"));
+
+	auto const trailing = compile("build/**");
+	EXPECT_TRUE(matches(trailing, "build"));
+	EXPECT_TRUE(matches(trailing, "build/a/b"));
+	EXPECT_FALSE(matches(trailing, "src/build"));
+
+	EXPECT_TRUE(matches(compile("**"), "any/path/at/all"));
+	EXPECT_TRUE(compile("**").matches(Path{}));
+}
+
+
+TEST(TestGlob, absolutePatterns) {
+	auto const pattern = compile("/var/*/*.log");
+
+	EXPECT_TRUE(matches(pattern, "/var/log/syslog.log"));
+	EXPECT_FALSE(matches(pattern, "var/log/syslog.log"));
+	EXPECT_TRUE(matches(compile("/"), "/"));
+	EXPECT_FALSE(matches(compile("/"), "a"));
+	EXPECT_TRUE(compile("").matches(Path{}));
+	EXPECT_TRUE(compile("").matches(StringView{""}));
+	EXPECT_FALSE(matches(compile(""), "a"));
+}
+
+
+TEST(TestGlob, malformedPatternsAreRejected) {
+	EXPECT_TRUE(makeGlobPattern("[abc").isError());
+	EXPECT_TRUE(makeGlobPattern("abc\\").isError());
+	EXPECT_TRUE(makeGlobPattern("[z-a]").isError());
+	EXPECT_TRUE(makeGlobPattern("a/[!]/b").isError());
+}
+
+
+TEST(TestGlob, patternIsMovable) {
+	auto pattern = compile("*.cpp");
+	GlobPattern moved{mv(pattern)};
+
+	EXPECT_TRUE(moved.matches(StringView{"main.cpp"}));
+	EXPECT_EQ(0U, pattern.segmentsCount());
+	EXPECT_FALSE(pattern.matches(StringView{"main.cpp"}));
+}
+
+
+TEST(TestGlob, setMatchesAllPatterns) {
+	MemoryManager memoryManager{1 << 16};
+	StringView const patterns[] = {"*.log", "**/tmp/*", "[a-f]*", "/etc/**"};
+
+	auto maybeSet = makeGlobSet(memoryManager, patterns);
+	ASSERT_TRUE(maybeSet.isOk());
+	auto const& set = *maybeSet;
+	ASSERT_EQ(4U, set.size());
+
+	std::vector<GlobSet::size_type> matched;
+	EXPECT_EQ(2U, set.forEachMatch(StringView{"app.log"}, [&matched](GlobSet::size_type i) { matched.push_back(i); }));
+	EXPECT_EQ((std::vector<GlobSet::size_type>{0, 2}), matched);
+
+	auto const path = parsePath("/etc/tmp/x.conf");
+	EXPECT_EQ(1U, *set.firstMatch(path));
+	EXPECT_TRUE(set.matchesAny(path));
+	EXPECT_FALSE(set.matchesAny(StringView{"src/main.cpp"}));
+	EXPECT_TRUE(set.firstMatch(StringView{"src/main.cpp"}).isNone());
+
+	StringView const invalid[] = {"*.log", "[x"};
+	EXPECT_TRUE(makeGlobSet(memoryManager, invalid).isError());
+}
@@ -0,0 +1,276 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/test_lineScanner.cpp
+ *	@brief		Test suit for the line scanner
+ ******************************************************************************/
+#include <solace/lineScanner.hpp>    // Class being tested.
+#include <solace/posixErrorDomain.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+using namespace Solace;
+
+
+namespace {
+
+MemoryView textView(std::string const& text) {
+	return wrapMemory(text.data(), text.size());
+}
+
+std::vector<std::string> collectLines(MemoryView data) {
+	std::vector<std::string> lines;
+	auto result = scanLines(data, [&lines](ArrayView<StringView> batch) {
+		for (auto line : batch) {
+			lines.emplace_back(line.data(), line.size());
+		}
+	});
+	EXPECT_TRUE(result.isOk());
+	EXPECT_EQ(lines.size(), result.unwrap().nbLines);
+	EXPECT_EQ(0U, result.unwrap().nbSkipped);
+
+	return lines;
+}
+
+/// Reference splitting of the text into lines
+std::vector<std::string> splitLines(std::string const& text) {
+	std::vector<std::string> lines;
+	std::string::size_type from = 0;
+	while (from < text.size()) {
+		auto const to = text.find('\n', from);
+		if (to == std::string::npos) {
+			lines.emplace_back(text.substr(from));
+			break;
+		}
+
+		lines.emplace_back(text.substr(from, to - from));
+		from = to + 1;
+	}
+
+	return lines;
+}
+
+/// Text of lines of varying length, spanning many 64-byte blocks and batches
+std::string makeText(uint32 nbLines) {
+	std::string text;
+	for (uint32 i = 0; i < nbLines; ++i) {
+		text.append(i % 97, static_cast<char>('a' + i % 26));
+		text.push_back('\n');
+	}
+
+	return text;
+}
+
+}  // namespace
+
+
+TEST(TestLineScanner, emptyTextHasNoLines) {
+	bool called = false;
+	auto result = scanLines(MemoryView{}, [&called](ArrayView<StringView>) { called = true; });
+
+	ASSERT_TRUE(result.isOk());
+	EXPECT_EQ(0U, result.unwrap().nbLines);
+	EXPECT_FALSE(called);
+}
+
+
+TEST(TestLineScanner, splitsTextIntoLines) {
+	std::string const text = "first\n\nthird\r\nlast";
+	auto const lines = collectLines(textView(text));
+
+	ASSERT_EQ(4U, lines.size());
+	EXPECT_EQ("first", lines[0]);
+	EXPECT_EQ("", lines[1]);
+	EXPECT_EQ("third\r", lines[2]);
+	EXPECT_EQ("last", lines[3]);
+
+	// Trailing newline does not produce an empty line
+	EXPECT_EQ(1U, collectLines(textView("single\n")).size());
+	EXPECT_EQ(2U, collectLines(textView("\n\n")).size());
+}
+
+
+TEST(TestLineScanner, scansManyBlocksInBatches) {
+	auto text = makeText(3000);
+	text += "unterminated";
+
+	uint32 nbBatches = 0;
+	std::vector<std::string> lines;
+	auto result = scanLines(textView(text), [&](ArrayView<StringView> batch) {
+		EXPECT_LE(batch.size(), LineScanner::kBatchSize);
+		nbBatches += 1;
+		for (auto line : batch) {
+			lines.emplace_back(line.data(), line.size());
+		}
+	});
+
+	ASSERT_TRUE(result.isOk());
+	EXPECT_EQ(3001U, result.unwrap().nbLines);
+	EXPECT_LE(3001U / LineScanner::kBatchSize, nbBatches);
+	EXPECT_EQ(splitLines(text), lines);
+}
+
+
+TEST(TestLineScanner, findsNewlines) {
+	auto const text = makeText(200);
+	auto const view = textView(text);
+
+	for (MemoryView::size_type from = 0; from < view.size(); from += 7) {
+		auto const expected = text.find('\n', from);
+		EXPECT_EQ(expected, findNewline(view, from));
+	}
+
+	EXPECT_EQ(view.size(), findNewline(view, view.size()));
+	EXPECT_EQ(5U, findNewline(textView("no newline"), 5) - 5);
+}
+
+
+TEST(TestLineScanner, tooLongLinesAreSkipped) {
+	std::string text = "short\n";
+	text.append(70000, 'x');
+	text += "\nafter\n";
+	text.append(100000, 'y');  // Not terminated last line
+
+	LineScanner scanner{textView(text)};
+	StringView batch[4];
+
+	ASSERT_EQ(2U, scanner.next(batch));
+	EXPECT_EQ("short", batch[0]);
+	EXPECT_EQ("after", batch[1]);
+	EXPECT_EQ(2U, scanner.nbSkipped());
+	EXPECT_TRUE(scanner.done());
+	EXPECT_EQ(0U, scanner.next(batch));
+
+	auto result = scanLines(textView(text), [](ArrayView<StringView>) {});
+	ASSERT_TRUE(result.isOk());
+	EXPECT_EQ(2U, result.unwrap().nbLines);
+	EXPECT_EQ(2U, result.unwrap().nbSkipped);
+
+	// Text of only an over-long line
+	std::string const longLine(1 << 17, 'z');
+	bool called = false;
+	auto longResult = scanLines(textView(longLine), [&called](ArrayView<StringView>) { called = true; });
+	ASSERT_TRUE(longResult.isOk());
+	EXPECT_EQ(0U, longResult.unwrap().nbLines);
+	EXPECT_EQ(1U, longResult.unwrap().nbSkipped);
+	EXPECT_FALSE(called);
+}
+
+
+TEST(TestLineScanner, chunksAreLineAligned) {
+	auto const text = makeText(1000);
+	auto const view = textView(text);
+	MemoryView::size_type const chunkSize = 1000;
+
+	uint64 nbLines = 0;
+	MemoryView::size_type expectedStart = 0;
+	for (uint64 i = 0; i <= view.size() / chunkSize; ++i) {
+		auto const chunk = lineChunk(view, i, chunkSize);
+		auto const start = static_cast<MemoryView::size_type>(chunk.begin() - view.begin());
+
+		if (!chunk.empty()) {
+			EXPECT_EQ(expectedStart, start);
+			EXPECT_TRUE(start == 0 || text[start - 1] == '\n');
+			expectedStart = start + chunk.size();
+		}
+
+		nbLines += collectLines(chunk).size();
+	}
+
+	EXPECT_EQ(view.size(), expectedStart);
+	EXPECT_EQ(1000U, nbLines);
+	EXPECT_TRUE(lineChunk(view, view.size(), chunkSize).empty());
+}
+
+
+TEST(TestLineScanner, longLinesProduceEmptyChunks) {
+	std::string text(300, 'x');
+	text += "\nend";
+	auto const view = textView(text);
+
+	EXPECT_EQ(301U, lineChunk(view, 0, 100).size());
+	EXPECT_TRUE(lineChunk(view, 1, 100).empty());
+	EXPECT_TRUE(lineChunk(view, 2, 100).empty());
+	EXPECT_EQ(3U, lineChunk(view, 3, 100).size());
+}
+
+
+TEST(TestLineScanner, parallelScanVisitsEveryLineOnce) {
+	MemoryManager memoryManager{1 << 24};
+	ThreadPoolConfig config;
+	config.nbWorkers = 4;
+	auto maybePool = makeThreadPool(memoryManager, config);
+	ASSERT_TRUE(maybePool.isOk());
+
+	auto const text = makeText(20000);
+	std::atomic<uint64> nbBytes{0};
+	std::atomic<uint64> nbLines{0};
+
+	auto result = scanLines(*maybePool, textView(text), [&](ArrayView<StringView> batch) {
+		nbLines.fetch_add(batch.size());
+		for (auto line : batch) {
+			nbBytes.fetch_add(line.size() + 1);
+		}
+	}, 4096);
+
+	ASSERT_TRUE(result.isOk());
+	EXPECT_EQ(20000U, result.unwrap().nbLines);
+	EXPECT_EQ(0U, result.unwrap().nbSkipped);
+	EXPECT_EQ(20000U, nbLines.load());
+	EXPECT_EQ(text.size(), nbBytes.load());
+}
+
+
+TEST(TestLineScanner, callbackErrorStopsScan) {
+	MemoryManager memoryManager{1 << 24};
+	auto maybePool = makeThreadPool(memoryManager);
+	ASSERT_TRUE(maybePool.isOk());
+
+	auto const text = makeText(5000);
+	auto stop = [](ArrayView<StringView>) -> Result<void, Error> {
+		return makeError(BasicError::InvalidInput, "test");
+	};
+
+	EXPECT_TRUE(scanLines(textView(text), stop).isError());
+	EXPECT_TRUE(scanLines(*maybePool, textView(text), stop, 1024).isError());
+}
+
+
+TEST(TestLineScanner, parallelScanSkipsTooLongLines) {
+	MemoryManager memoryManager{1 << 24};
+	auto maybePool = makeThreadPool(memoryManager);
+	ASSERT_TRUE(maybePool.isOk());
+
+	auto text = makeText(3000);
+	text.append(80000, 'x');
+	text += '\n';
+	text += makeText(3000);
+
+	std::atomic<uint64> nbLines{0};
+	auto result = scanLines(*maybePool, textView(text), [&nbLines](ArrayView<StringView> batch) {
+		nbLines.fetch_add(batch.size());
+	}, 4096);
+
+	ASSERT_TRUE(result.isOk());
+	EXPECT_EQ(6000U, result.unwrap().nbLines);
+	EXPECT_EQ(1U, result.unwrap().nbSkipped);
+	EXPECT_EQ(6000U, nbLines.load());
+}
@@ -0,0 +1,181 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ * @file: test/test_mappedDictionary.cpp
+ * @brief Test suit for the immutable memory mappable dictionary
+ *******************************************************************************/
+#include <solace/mappedDictionary.hpp>  // Class being tested
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace Solace;
+
+
+class TestMappedDictionary : public ::testing::Test {
+protected:
+
+	/// Build a dictionary of given keys, each mapped to the key reversed.
+	MemoryResource build(std::vector<std::string> const& keys) {
+		_values.clear();
+		for (auto const& key : keys) {
+			_values.emplace_back(key.rbegin(), key.rend());
+		}
+
+		auto builder = makeMappedDictionaryBuilder(_memoryManager, static_cast<uint32>(keys.size())).moveResult();
+		for (size_t i = 0; i < keys.size(); ++i) {
+			EXPECT_TRUE(builder.add(StringView{keys[i].data(), static_cast<StringView::size_type>(keys[i].size())},
+									wrapMemory(_values[i].data(), _values[i].size())).isOk());
+		}
+
+		ByteWriter writer{_memoryManager.allocate(builder.encodedSize()).moveResult()};
+		auto built = builder.build(writer);
+		EXPECT_TRUE(built.isOk());
+		EXPECT_EQ(builder.encodedSize(), writer.position());
+
+		return writer.moveResource();
+	}
+
+	static std::string toString(MemoryView view) {
+		return std::string{static_cast<char const*>(view.dataAddress()), view.size()};
+	}
+
+	MemoryManager				_memoryManager{1 << 24};
+	std::vector<std::string>	_values;
+};
+
+
+TEST_F(TestMappedDictionary, emptyDictionary) {
+	auto maybeDictionary = MappedDictionary::open(build({}));
+	ASSERT_TRUE(maybeDictionary.isOk());
+
+	auto& dictionary = maybeDictionary.unwrap();
+	EXPECT_TRUE(dictionary.empty());
+	EXPECT_FALSE(dictionary.contains("key"));
+}
+
+TEST_F(TestMappedDictionary, findValues) {
+	auto dictionary = MappedDictionary::open(build({"one", "two", "three", "", "a rather long key of many words"}))
+			.moveResult();
+	EXPECT_EQ(5U, dictionary.size());
+
+	EXPECT_EQ("eno", toString(dictionary.find("one").get()));
+	EXPECT_EQ("owt", toString(dictionary.find("two").get()));
+	EXPECT_EQ("eerht", toString(dictionary.find("three").get()));
+	EXPECT_EQ("", toString(dictionary.find("").get()));
+	EXPECT_EQ("sdrow ynam fo yek gnol rehtar a", toString(dictionary.find("a rather long key of many words").get()));
+
+	EXPECT_FALSE(dictionary.contains("four"));
+	EXPECT_FALSE(dictionary.contains("on"));
+	EXPECT_FALSE(dictionary.contains("onee"));
+}
+
+TEST_F(TestMappedDictionary, valuesAreViewsIntoData) {
+	auto dictionary = MappedDictionary::open(build({"key", "other"})).moveResult();
+
+	auto const data = dictionary.view();
+	auto const value = dictionary.find("other").get();
+	EXPECT_GE(value.dataAddress(), data.dataAddress());
+	EXPECT_LE(value.end(), data.end());
+	EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(value.dataAddress()) % MappedDictionaryFormat::kAlignment);
+}
+
+TEST_F(TestMappedDictionary, manyKeys) {
+	constexpr int kCount = 20000;
+	std::vector<std::string> keys;
+	for (int i = 0; i < kCount; ++i) {
+		keys.push_back("key-" + std::to_string(i * 7919));
+	}
+
+	auto dictionary = MappedDictionary::open(build(keys)).moveResult();
+	ASSERT_EQ(static_cast<uint32>(kCount), dictionary.size());
+	for (int i = 0; i < kCount; ++i) {
+		auto const& key = keys[i];
+		auto value = dictionary.find(StringView{key.data(), static_cast<StringView::size_type>(key.size())});
+		ASSERT_TRUE(value.isSome()) << key;
+		ASSERT_EQ(std::string(key.rbegin(), key.rend()), toString(value.get()));
+	}
+
+	EXPECT_FALSE(dictionary.contains("key-1"));
+	EXPECT_FALSE(dictionary.contains("missing"));
+}
+
+TEST_F(TestMappedDictionary, duplicateKeysAreAnError) {
+	auto builder = makeMappedDictionaryBuilder(_memoryManager, 3).moveResult();
+	builder.add("one", MemoryView{});
+	builder.add("two", MemoryView{});
+	builder.add("one", MemoryView{});
+	EXPECT_TRUE(builder.add("three", MemoryView{}).isError());
+
+	auto buffer = _memoryManager.allocate(builder.encodedSize()).moveResult();
+	ByteWriter writer{buffer};
+	EXPECT_TRUE(builder.build(writer).isError());
+}
+
+TEST_F(TestMappedDictionary, buildIntoSmallBufferIsAnError) {
+	auto builder = makeMappedDictionaryBuilder(_memoryManager, 1).moveResult();
+	builder.add("one", wrapMemory("value", 5));
+
+	byte buffer[64];
+	ByteWriter writer{wrapMemory(buffer)};
+	EXPECT_TRUE(builder.build(writer).isError());
+	EXPECT_EQ(0U, writer.position());
+}
+
+TEST_F(TestMappedDictionary, invalidDataIsNotOpened) {
+	auto data = build({"one", "two"});
+
+	// Truncated
+	{
+		auto copy = _memoryManager.allocate(data.size() - 1).moveResult();
+		ASSERT_TRUE(copy.view().write(data.view().slice(0, data.size() - 1)).isOk());
+		EXPECT_TRUE(MappedDictionary::open(mv(copy)).isError());
+	}
+
+	// Bad magic
+	{
+		auto copy = _memoryManager.allocate(data.size()).moveResult();
+		ASSERT_TRUE(copy.view().write(data.view()).isOk());
+		copy.view()[0] = 'X';
+		EXPECT_TRUE(MappedDictionary::open(mv(copy)).isError());
+	}
+
+	EXPECT_TRUE(MappedDictionary::open(MemoryResource{}).isError());
+	EXPECT_TRUE(MappedDictionary::open(mv(data)).isOk());
+}
+
+TEST_F(TestMappedDictionary, openFile) {
+	auto data = build({"alpha", "beta", "gamma"});
+	auto const path = ::testing::TempDir() + "solace_mappedDictionary_" + std::to_string(getpid());
+	{
+		auto file = std::fopen(path.c_str(), "wb");
+		ASSERT_NE(nullptr, file);
+		ASSERT_EQ(data.size(), std::fwrite(data.view().dataAddress(), 1, data.size(), file));
+		std::fclose(file);
+	}
+
+	auto maybeDictionary = MappedDictionary::open(StringView{path.c_str()});
+	std::remove(path.c_str());
+	ASSERT_TRUE(maybeDictionary.isOk());
+	EXPECT_EQ("ammag", toString(maybeDictionary.unwrap().find("gamma").get()));
+	EXPECT_FALSE(maybeDictionary.unwrap().contains("delta"));
+}
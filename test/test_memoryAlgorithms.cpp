@@ -0,0 +1,175 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/test_memoryAlgorithms.cpp
+ *	@brief		Test suit for vectorized memory algorithms
+ ******************************************************************************/
+#include <solace/memoryAlgorithms.hpp>    // Functions being tested.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace Solace;
+
+
+namespace {
+
+/// Pseudo-random bytes from a small alphabet, so that values repeat often
+std::vector<byte> makeData(size_t size, uint32 seed = 7) {
+	std::vector<byte> data(size);
+	for (auto& b : data) {
+		seed = seed * 1103515245 + 12345;
+		b = static_cast<byte>('a' + (seed >> 16) % 8);
+	}
+
+	return data;
+}
+
+MemoryView view(std::vector<byte> const& data) {
+	return wrapMemory(data.data(), data.size());
+}
+
+}  // namespace
+
+
+TEST(TestMemoryAlgorithms, findByte) {
+	auto const data = makeData(1000);
+
+	for (size_t from = 0; from < data.size(); from += 13) {
+		for (byte value : {byte{'a'}, byte{'h'}}) {
+			Optional<MemoryView::size_type> expected;
+			for (auto i = from; i < data.size(); ++i) {
+				if (data[i] == value) {
+					expected = i;
+					break;
+				}
+			}
+
+			EXPECT_EQ(expected, find(view(data), value, from));
+		}
+	}
+
+	EXPECT_TRUE(find(view(data), byte{'z'}).isNone());
+	EXPECT_TRUE(find(view(data), byte{'a'}, data.size()).isNone());
+	EXPECT_TRUE(find(MemoryView{}, byte{0}).isNone());
+
+	std::vector<byte> sparse(200, 0);
+	sparse[130] = 1;
+	EXPECT_EQ(130U, *find(view(sparse), byte{1}));
+}
+
+
+TEST(TestMemoryAlgorithms, findPattern) {
+	auto data = makeData(2000);
+	byte const needle[] = {'x', 'y', 'a', 'b', 'z'};
+	std::copy(std::begin(needle), std::end(needle), data.begin() + 1500);
+
+	EXPECT_EQ(1500U, *find(view(data), wrapMemory(needle)));
+	EXPECT_TRUE(find(view(data), wrapMemory(needle), 1501).isNone());
+	EXPECT_EQ(1501U, *find(view(data), wrapMemory(needle).slice(1, 5)));
+
+	// Patterns cut from the data itself are found at or before the position they are taken from
+	for (size_t length : {2U, 3U, 7U, 31U, 40U}) {
+		for (size_t at = 0; at + length <= data.size(); at += 97) {
+			auto const pattern = view(data).slice(at, at + length);
+			auto const found = find(view(data), pattern);
+			ASSERT_TRUE(found.isSome());
+			EXPECT_LE(*found, at);
+			EXPECT_EQ(pattern, view(data).slice(*found, *found + length));
+		}
+	}
+
+	EXPECT_EQ(10U, *find(view(data), MemoryView{}, 10));
+	EXPECT_TRUE(find(view(data).slice(0, 3), wrapMemory(needle)).isNone());
+	EXPECT_EQ(4U, *find(wrapMemory("abcdxy"), wrapMemory("xy", 2)));
+}
+
+
+TEST(TestMemoryAlgorithms, countBytes) {
+	auto const data = makeData(100000);
+
+	MemoryView::size_type expected = 0;
+	for (auto b : data) {
+		expected += (b == 'c');
+	}
+
+	EXPECT_EQ(expected, count(view(data), byte{'c'}));
+	EXPECT_EQ(0U, count(view(data), byte{'z'}));
+	EXPECT_EQ(0U, count(MemoryView{}, byte{'c'}));
+
+	// More than 255 matching vectors in a row
+	std::vector<byte> same(70001, 'q');
+	EXPECT_EQ(same.size(), count(view(same), byte{'q'}));
+}
+
+
+TEST(TestMemoryAlgorithms, firstMismatch) {
+	auto const data = makeData(500);
+
+	for (size_t at : {0U, 1U, 15U, 16U, 31U, 32U, 63U, 100U, 499U}) {
+		auto other = data;
+		other[at] ^= 0x20;
+		EXPECT_EQ(at, *firstMismatch(view(data), view(other)));
+	}
+
+	EXPECT_TRUE(firstMismatch(view(data), view(data)).isNone());
+	EXPECT_TRUE(firstMismatch(MemoryView{}, MemoryView{}).isNone());
+	EXPECT_EQ(100U, *firstMismatch(view(data), view(data).slice(0, 100)));
+	EXPECT_EQ(0U, *firstMismatch(MemoryView{}, view(data)));
+}
+
+
+TEST(TestMemoryAlgorithms, xorWithRepeatingMask) {
+	auto const data = makeData(1000);
+
+	for (size_t maskSize : {1U, 3U, 4U, 32U, 33U, 300U}) {
+		auto const mask = makeData(maskSize, 11);
+
+		for (size_t offset : {0U, 1U, 5U}) {
+			auto masked = data;
+			xorWith(wrapMemory(masked.data(), masked.size()), view(mask), offset);
+
+			for (size_t i = 0; i < data.size(); ++i) {
+				ASSERT_EQ(data[i] ^ mask[(i + offset) % maskSize], masked[i]) << maskSize << ":" << i;
+			}
+
+			// Masking is its own inverse
+			xorWith(wrapMemory(masked.data(), masked.size()), view(mask), offset);
+			EXPECT_EQ(data, masked);
+		}
+	}
+}
+
+
+TEST(TestMemoryAlgorithms, xorWithMaskInParts) {
+	byte const key[] = {0x37, 0xfa, 0x21, 0x3d};
+	auto const data = makeData(257);
+
+	auto whole = data;
+	xorWith(wrapMemory(whole.data(), whole.size()), wrapMemory(key));
+
+	auto parts = data;
+	auto buffer = wrapMemory(parts.data(), parts.size());
+	xorWith(buffer.slice(0, 45), wrapMemory(key));
+	xorWith(buffer.slice(45, 257), wrapMemory(key), 45);
+	EXPECT_EQ(whole, parts);
+
+	auto unchanged = data;
+	xorWith(wrapMemory(unchanged.data(), unchanged.size()), MemoryView{});
+	EXPECT_EQ(data, unchanged);
+}
@@ -0,0 +1,149 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/test_memoryCopy.cpp
+ *	@brief		Test suit for bulk memory copy
+ ******************************************************************************/
+#include <solace/memoryCopy.hpp>    // Functions being tested.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace Solace;
+
+
+namespace {
+
+std::vector<byte> makeData(size_t size) {
+	std::vector<byte> data(size);
+	for (size_t i = 0; i < size; ++i) {
+		data[i] = static_cast<byte>((i * 131) ^ (i >> 7));
+	}
+
+	return data;
+}
+
+}  // namespace
+
+
+class TestMemoryCopy : public ::testing::Test {
+protected:
+	void SetUp() override {
+		_threshold = nonTemporalThreshold();
+	}
+
+	void TearDown() override {
+		setNonTemporalThreshold(_threshold);
+	}
+
+	MemoryView::size_type _threshold{0};
+};
+
+
+TEST_F(TestMemoryCopy, thresholdIsTunable) {
+	EXPECT_EQ(kDefaultNonTemporalThreshold, nonTemporalThreshold());
+
+	setNonTemporalThreshold(1 << 20);
+	EXPECT_EQ(1U << 20, nonTemporalThreshold());
+
+	setNonTemporalThreshold(1);
+	EXPECT_EQ(kBulkCopyThreshold, nonTemporalThreshold());
+}
+
+
+TEST_F(TestMemoryCopy, copiesAllSizesAndAlignments) {
+	// Low threshold to exercise streaming stores along with the regular path
+	setNonTemporalThreshold(8 * 1024);
+
+	auto const source = makeData(40 * 1024);
+	for (size_t size : {0U, 1U, 100U, 2047U, 2048U, 5000U, 8191U, 8192U, 20000U, 40000U}) {
+		for (size_t offset : {0U, 1U, 7U, 33U}) {
+			std::vector<byte> dest(size + 64, 0xEE);
+			copyMemory(dest.data() + offset, source.data() + (offset ^ 5), size);
+
+			ASSERT_TRUE(std::equal(source.begin() + (offset ^ 5), source.begin() + (offset ^ 5) + size,
+								   dest.begin() + offset)) << size << " at " << offset;
+			EXPECT_EQ(0xEE, dest[offset + size]);
+			EXPECT_TRUE(offset == 0 || dest[offset - 1] == 0xEE);
+		}
+	}
+}
+
+
+TEST_F(TestMemoryCopy, overlappingRegions) {
+	setNonTemporalThreshold(kBulkCopyThreshold);
+
+	auto const original = makeData(64 * 1024);
+
+	auto forward = original;
+	copyMemory(forward.data() + 1000, forward.data(), 50000);
+	EXPECT_TRUE(std::equal(original.begin(), original.begin() + 50000, forward.begin() + 1000));
+
+	auto backward = original;
+	copyMemory(backward.data(), backward.data() + 1000, 50000);
+	EXPECT_TRUE(std::equal(original.begin() + 1000, original.begin() + 51000, backward.begin()));
+
+	auto streamed = original;
+	copyNonTemporal(streamed.data() + 3, streamed.data(), 50000);
+	EXPECT_TRUE(std::equal(original.begin(), original.begin() + 50000, streamed.begin() + 3));
+}
+
+
+TEST_F(TestMemoryCopy, fillsAllSizes) {
+	setNonTemporalThreshold(8 * 1024);
+
+	for (size_t size : {0U, 3U, 2048U, 8192U, 30001U}) {
+		std::vector<byte> dest(size + 2, 0);
+		fillMemory(dest.data() + 1, 0x5A, size);
+
+		EXPECT_EQ(0, dest.front());
+		EXPECT_EQ(0, dest.back());
+		EXPECT_EQ(size, static_cast<size_t>(std::count(dest.begin(), dest.end(), 0x5A)));
+	}
+}
+
+
+TEST_F(TestMemoryCopy, copyNonTemporalViews) {
+	auto const source = makeData(100000);
+	std::vector<byte> dest(100001, 0);
+
+	auto const destView = wrapMemory(dest.data() + 1, 100000);
+	ASSERT_TRUE(copyNonTemporal(destView, wrapMemory(source.data(), source.size())).isOk());
+	EXPECT_EQ(wrapMemory(source.data(), source.size()), destView);
+
+	auto small = makeData(10);
+	EXPECT_TRUE(copyNonTemporal(wrapMemory(small.data(), small.size()), wrapMemory(source.data(), 11)).isError());
+	ASSERT_TRUE(copyNonTemporal(wrapMemory(small.data(), small.size()), wrapMemory(source.data(), 5)).isOk());
+	EXPECT_TRUE(std::equal(source.begin(), source.begin() + 5, small.begin()));
+}
+
+
+TEST_F(TestMemoryCopy, largeWritesThroughViews) {
+	setNonTemporalThreshold(16 * 1024);
+
+	auto const source = makeData(1 << 20);
+	std::vector<byte> dest(source.size());
+
+	auto destView = wrapMemory(dest.data(), dest.size());
+	ASSERT_TRUE(destView.write(wrapMemory(source.data(), source.size())).isOk());
+	EXPECT_EQ(source, dest);
+
+	destView.fill(0x11);
+	EXPECT_EQ(dest.size(), static_cast<size_t>(std::count(dest.begin(), dest.end(), 0x11)));
+}
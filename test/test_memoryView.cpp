@@ -361,3 +361,37 @@ TEST(TestMemoryView, testPlacementConstruct) {
         EXPECT_EQ(0, SimpleType::InstanceCount);
     }
 }
+
+
+TEST(TestMemoryView, uncheckedAccess) {
+    byte src[] = {1, 2, 3, 4};
+    auto buffer = wrapMemory(src);
+
+    EXPECT_EQ(3, buffer.unchecked_at(2));
+    buffer.unchecked_at(2) = 7;
+    EXPECT_EQ(7, buffer[2]);
+
+    MemoryView const view = buffer;
+    EXPECT_EQ(7, view.unchecked_at(2));
+
+#if SOLACE_BOUNDS_CHECK_ENABLED
+    EXPECT_THROW(view[4], IndexOutOfRangeException);
+    EXPECT_THROW(buffer[4], IndexOutOfRangeException);
+#endif
+}
+
+
+TEST(TestMemoryView, checkedSlice) {
+    byte src[] = {1, 2, 3, 4, 5, 6};
+    auto buffer = wrapMemory(src);
+
+    auto slice = buffer.checkedSlice(1, 4);
+    ASSERT_EQ(3U, slice.size());
+    EXPECT_EQ(2, slice.unchecked_at(0));
+    EXPECT_EQ(4, slice.unchecked_at(2));
+
+    EXPECT_EQ(0U, buffer.checkedSlice(6, 6).size());
+
+    EXPECT_THROW(buffer.checkedSlice(2, 7), IndexOutOfRangeException);
+    EXPECT_THROW(buffer.checkedSlice(4, 2), IndexOutOfRangeException);
+}
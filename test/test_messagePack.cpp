@@ -0,0 +1,294 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ * @file: test/test_messagePack.cpp
+ ********************************************************************************/
+#include <solace/messagePack.hpp>  // Class being tested
+#include <solace/posixErrorDomain.hpp>
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <vector>
+
+using namespace Solace;
+
+
+class TestMessagePack : public ::testing::Test {
+protected:
+
+	/// @return Encoded bytes written so far.
+	std::vector<byte> written() const {
+		auto const view = _dest.viewWritten();
+		return std::vector<byte>(view.begin(), view.end());
+	}
+
+	ByteReader reader() const {
+		return ByteReader{_dest.viewWritten()};
+	}
+
+	byte		_buffer[1024];
+	ByteWriter	_dest{wrapMemory(_buffer)};
+	MessagePackWriter	_writer{_dest};
+};
+
+
+TEST_F(TestMessagePack, integersUseCompactEncoding) {
+	_writer.writeUInt(7);
+	_writer.writeUInt(200);
+	_writer.writeUInt(0x1234);
+	_writer.writeInt(-1);
+	_writer.writeInt(-100);
+	_writer.writeInt(42);
+
+	EXPECT_EQ((std::vector<byte>{
+				  0x07,
+				  0xcc, 0xc8,
+				  0xcd, 0x12, 0x34,
+				  0xff,
+				  0xd0, 0x9c,
+				  0x2a}),
+			  written());
+}
+
+TEST_F(TestMessagePack, integersRoundTrip) {
+	int64 const values[] = {
+		0, 1, 127, 128, 255, 256, 65535, 65536, -1, -32, -33, -128, -129, -32768, -32769,
+		std::numeric_limits<int32>::min(), std::numeric_limits<int32>::max(),
+		std::numeric_limits<int64>::min(), std::numeric_limits<int64>::max()
+	};
+
+	for (auto value : values) {
+		ASSERT_TRUE(_writer.writeInt(value).isOk());
+	}
+	ASSERT_TRUE(_writer.writeUInt(std::numeric_limits<uint64>::max()).isOk());
+
+	auto src = reader();
+	MessagePackReader msg{src};
+	for (auto value : values) {
+		auto read = msg.readInt();
+		ASSERT_TRUE(read.isOk());
+		EXPECT_EQ(value, read.unwrap());
+	}
+
+	// Value does not fit int64, but can be read as unsigned
+	EXPECT_TRUE(msg.readInt().isError());
+	EXPECT_EQ(std::numeric_limits<uint64>::max(), msg.readUInt().unwrap());
+	EXPECT_EQ(0U, src.remaining());
+}
+
+TEST_F(TestMessagePack, negativeIntegerIsNotUnsigned) {
+	_writer.writeInt(-5);
+
+	auto src = reader();
+	MessagePackReader msg{src};
+	EXPECT_TRUE(msg.readUInt().isError());
+	EXPECT_EQ(0U, src.position());
+	EXPECT_EQ(-5, msg.readInt().unwrap());
+}
+
+TEST_F(TestMessagePack, scalarsRoundTrip) {
+	_writer.writeNil();
+	_writer.writeBool(true);
+	_writer.writeBool(false);
+	_writer.writeFloat(1.5f);
+	_writer.writeDouble(-0.25);
+
+	EXPECT_EQ((std::vector<byte>{
+				  0xc0, 0xc3, 0xc2,
+				  0xca, 0x3f, 0xc0, 0x00, 0x00,
+				  0xcb, 0xbf, 0xd0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}),
+			  written());
+
+	auto src = reader();
+	MessagePackReader msg{src};
+	EXPECT_TRUE(msg.readNil().isOk());
+	EXPECT_TRUE(msg.readBool().unwrap());
+	EXPECT_FALSE(msg.readBool().unwrap());
+	EXPECT_EQ(1.5, msg.readDouble().unwrap());
+	EXPECT_EQ(-0.25, msg.readDouble().unwrap());
+}
+
+TEST_F(TestMessagePack, stringsAndBinariesAreReadInPlace) {
+	byte const blob[] = {1, 2, 3};
+	_writer.writeString("hello");
+	_writer.writeBinary(wrapMemory(blob));
+
+	EXPECT_EQ((std::vector<byte>{
+				  0xa5, 'h', 'e', 'l', 'l', 'o',
+				  0xc4, 0x03, 1, 2, 3}),
+			  written());
+
+	auto src = reader();
+	MessagePackReader msg{src};
+	auto str = msg.readString();
+	ASSERT_TRUE(str.isOk());
+	EXPECT_EQ(StringView{"hello"}, str.unwrap());
+	EXPECT_EQ(static_cast<void const*>(_buffer + 1), static_cast<void const*>(str.unwrap().data()));
+
+	auto bin = msg.readBinary();
+	ASSERT_TRUE(bin.isOk());
+	EXPECT_EQ(wrapMemory(blob), bin.unwrap());
+	EXPECT_EQ(static_cast<void const*>(_buffer + 8), bin.unwrap().dataAddress());
+}
+
+TEST_F(TestMessagePack, longStringUsesLengthPrefix) {
+	char text[300];
+	memset(text, 'x', sizeof(text));
+	ASSERT_TRUE(_writer.writeString(StringView{text, sizeof(text)}).isOk());
+	EXPECT_EQ(0xda, _buffer[0]);
+	EXPECT_EQ(3U + sizeof(text), _dest.position());
+
+	auto src = reader();
+	EXPECT_EQ(sizeof(text), MessagePackReader{src}.readString().unwrap().size());
+}
+
+TEST_F(TestMessagePack, extensionsRoundTrip) {
+	byte const fixed[4] = {0xde, 0xad, 0xbe, 0xef};
+	byte const sized[3] = {1, 2, 3};
+	_writer.writeExtension(5, wrapMemory(fixed));
+	_writer.writeExtension(-2, wrapMemory(sized));
+
+	EXPECT_EQ((std::vector<byte>{
+				  0xd6, 0x05, 0xde, 0xad, 0xbe, 0xef,
+				  0xc7, 0x03, 0xfe, 1, 2, 3}),
+			  written());
+
+	auto src = reader();
+	MessagePackReader msg{src};
+	auto first = msg.readExtension().unwrap();
+	EXPECT_EQ(5, first.type);
+	EXPECT_EQ(wrapMemory(fixed), first.data);
+
+	auto second = msg.readExtension().unwrap();
+	EXPECT_EQ(-2, second.type);
+	EXPECT_EQ(wrapMemory(sized), second.data);
+}
+
+TEST_F(TestMessagePack, containersRoundTrip) {
+	_writer.writeMapHeader(2);
+	_writer.writeString("id");
+	_writer.writeUInt(42);
+	_writer.writeString("tags");
+	_writer.writeArrayHeader(20);
+	for (int i = 0; i < 20; ++i) {
+		_writer.writeInt(i);
+	}
+
+	EXPECT_EQ(0x82, _buffer[0]);
+
+	auto src = reader();
+	MessagePackReader msg{src};
+	ASSERT_TRUE(msg.validate().isOk());
+	EXPECT_EQ(0U, src.position());
+
+	EXPECT_EQ(MessagePackType::Map, msg.peekType().unwrap());
+	EXPECT_EQ(2U, msg.readMapHeader().unwrap());
+	EXPECT_EQ(StringView{"id"}, msg.readString().unwrap());
+	EXPECT_EQ(42U, msg.readUInt().unwrap());
+	EXPECT_EQ(StringView{"tags"}, msg.readString().unwrap());
+	EXPECT_EQ(20U, msg.readArrayHeader().unwrap());
+	for (int i = 0; i < 20; ++i) {
+		EXPECT_EQ(i, msg.readInt().unwrap());
+	}
+	EXPECT_EQ(0U, src.remaining());
+}
+
+TEST_F(TestMessagePack, typeMismatchLeavesPositionUnchanged) {
+	_writer.writeString("text");
+
+	auto src = reader();
+	MessagePackReader msg{src};
+	EXPECT_EQ(MessagePackType::String, msg.peekType().unwrap());
+	EXPECT_TRUE(msg.readInt().isError());
+	EXPECT_TRUE(msg.readBinary().isError());
+	EXPECT_TRUE(msg.readMapHeader().isError());
+	EXPECT_EQ(0U, src.position());
+	EXPECT_EQ(StringView{"text"}, msg.readString().unwrap());
+}
+
+TEST_F(TestMessagePack, skipNestedValues) {
+	_writer.writeArrayHeader(3);
+	_writer.writeMapHeader(1);
+	_writer.writeString("key");
+	_writer.writeArrayHeader(2);
+	_writer.writeNil();
+	_writer.writeBinary(wrapMemory(_buffer, 100));
+	_writer.writeDouble(3.0);
+	_writer.writeArrayHeader(0);
+	_writer.writeString("after");
+
+	auto src = reader();
+	MessagePackReader msg{src};
+	ASSERT_TRUE(msg.skip().isOk());
+	EXPECT_EQ(StringView{"after"}, msg.readString().unwrap());
+	EXPECT_EQ(0U, src.remaining());
+}
+
+TEST_F(TestMessagePack, writerDoesNotWritePartialValues) {
+	byte small[4];
+	ByteWriter dest{wrapMemory(small)};
+	MessagePackWriter writer{dest};
+
+	EXPECT_TRUE(writer.writeString("abc").isOk());
+	EXPECT_TRUE(writer.writeString("long").isError());
+	EXPECT_TRUE(writer.writeUInt(300).isError());
+	EXPECT_EQ(4U, dest.position());
+}
+
+TEST_F(TestMessagePack, malformedInputIsAnError) {
+	byte const reserved[] = {0xc1};
+	byte const truncatedString[] = {0xa5, 'a', 'b'};
+	byte const truncatedArray[] = {0x93, 0x01, 0x02};
+	byte const truncatedHeader[] = {0xcd, 0x01};
+	byte const hugeArray[] = {0xdd, 0xff, 0xff, 0xff, 0xff, 0x01};
+
+	for (auto data : {wrapMemory(reserved), wrapMemory(truncatedString), wrapMemory(truncatedArray),
+					  wrapMemory(truncatedHeader), wrapMemory(hugeArray)}) {
+		ByteReader src{data};
+		MessagePackReader msg{src};
+		EXPECT_TRUE(msg.validate().isError());
+		EXPECT_TRUE(msg.skip().isError());
+		EXPECT_EQ(0U, src.position());
+	}
+
+	ByteReader src{wrapMemory(truncatedString)};
+	EXPECT_TRUE(MessagePackReader{src}.readString().isError());
+	EXPECT_EQ(0U, src.position());
+
+	auto result = MessagePackReader{src}.validate();
+	ASSERT_TRUE(result.isError());
+	EXPECT_EQ(makeError(BasicError::Overflow, "test"), result.getError());
+}
+
+TEST_F(TestMessagePack, validateDoesNotMoveSharedSource) {
+	_writer.writeArrayHeader(2);
+	_writer.writeInt(1);
+	_writer.writeString("two");
+	_writer.writeNil();
+
+	auto src = reader();
+	MessagePackReader const msg{src};
+	ASSERT_TRUE(msg.validate().isOk());
+	EXPECT_EQ(0U, src.position());
+
+	// Validation starts at the current position of the source
+	ASSERT_TRUE(MessagePackReader{src}.skip().isOk());
+	auto const position = src.position();
+	ASSERT_TRUE(msg.validate().isOk());
+	EXPECT_EQ(position, src.position());
+}
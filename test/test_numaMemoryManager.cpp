@@ -0,0 +1,167 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/test_numaMemoryManager.cpp
+ *	@brief		Test suit for the NUMA-aware memory manager
+ ******************************************************************************/
+#include <solace/numaMemoryManager.hpp>  // Class being tested
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+using namespace Solace;
+
+
+namespace {
+
+constexpr MemoryManager::size_type kPoolSize = 16 * 1024;
+
+}  // namespace
+
+
+TEST(TestNumaMemoryManager, allocationsBeforeReserveUseHeap) {
+	NumaMemoryManager manager{4096};
+	EXPECT_FALSE(manager.isReserved());
+	EXPECT_EQ(0U, manager.nbNodes());
+
+	auto maybeBlock = manager.allocate(128);
+	ASSERT_TRUE(maybeBlock.isOk());
+	EXPECT_EQ(128U, manager.size());
+
+	EXPECT_TRUE(manager.allocateOnNode(0, 128).isError());
+	EXPECT_TRUE(manager.nodeUsage(0).isError());
+}
+
+TEST(TestNumaMemoryManager, reserveValidatesSize) {
+	NumaMemoryManager manager{kPoolSize};
+	EXPECT_TRUE(manager.reserve(0).isError());
+	EXPECT_TRUE(manager.reserve(kPoolSize * NumaMemoryManager::kMaxNodes + 1).isError());
+	EXPECT_FALSE(manager.isReserved());
+}
+
+TEST(TestNumaMemoryManager, reserveCreatesPoolPerNode) {
+	NumaMemoryManager manager{NumaMemoryManager::kMaxNodes * kPoolSize};
+	ASSERT_TRUE(manager.reserve(kPoolSize).isOk());
+	ASSERT_TRUE(manager.isReserved());
+	ASSERT_LE(1U, manager.nbNodes());
+
+	EXPECT_TRUE(manager.reserve(kPoolSize).isError());
+
+	for (uint32 i = 0; i < manager.nbNodes(); ++i) {
+		auto maybeUsage = manager.nodeUsage(manager.nodeId(i));
+		ASSERT_TRUE(maybeUsage.isOk());
+
+		auto const& usage = maybeUsage.unwrap();
+		EXPECT_EQ(manager.nodeId(i), usage.node);
+		EXPECT_EQ(kPoolSize, usage.capacity);
+		EXPECT_EQ(0U, usage.allocated);
+	}
+
+	// Current node always has a pool: the one it runs on or the only pool of a non-NUMA system
+	auto const node = NumaMemoryManager::currentNode();
+	EXPECT_TRUE(manager.nodeUsage(node).isOk() || manager.nbNodes() == 1);
+}
+
+TEST(TestNumaMemoryManager, allocateOnNodeIsAccounted) {
+	NumaMemoryManager manager{NumaMemoryManager::kMaxNodes * kPoolSize};
+	ASSERT_TRUE(manager.reserve(kPoolSize).isOk());
+	auto const node = manager.nodeId(0);
+	{
+		auto first = manager.allocateOnNode(node, 100);
+		auto second = manager.allocateOnNode(node, 64);
+		ASSERT_TRUE(first.isOk());
+		ASSERT_TRUE(second.isOk());
+		EXPECT_EQ(128U, first.unwrap().size());
+		EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(first.unwrap().view().dataAddress()) %
+				  NumaMemoryManager::kAlignment);
+		EXPECT_EQ(192U, manager.size());
+
+		auto usage = manager.nodeUsage(node).unwrap();
+		EXPECT_EQ(192U, usage.allocated);
+		EXPECT_EQ(2U, usage.nbAllocations);
+		EXPECT_EQ(0U, usage.nbFallbacks);
+
+		first.unwrap().view().fill(0xAB);
+	}
+
+	EXPECT_EQ(0U, manager.size());
+	EXPECT_EQ(0U, manager.nodeUsage(node).unwrap().allocated);
+}
+
+TEST(TestNumaMemoryManager, allocateOnUnknownNodeFails) {
+	NumaMemoryManager manager{NumaMemoryManager::kMaxNodes * kPoolSize};
+	ASSERT_TRUE(manager.reserve(kPoolSize).isOk());
+
+	EXPECT_TRUE(manager.allocateOnNode(NumaMemoryManager::kMaxNodes, 64).isError());
+	EXPECT_TRUE(manager.nodeUsage(NumaMemoryManager::kMaxNodes).isError());
+}
+
+TEST(TestNumaMemoryManager, exhaustedPoolFallsBackToHeap) {
+	NumaMemoryManager manager{NumaMemoryManager::kMaxNodes * kPoolSize + 1024};
+	ASSERT_TRUE(manager.reserve(kPoolSize).isOk());
+	auto const node = manager.nodeId(0);
+
+	auto whole = manager.allocateOnNode(node, kPoolSize);
+	ASSERT_TRUE(whole.isOk());
+	EXPECT_EQ(0U, manager.nodeUsage(node).unwrap().capacity - manager.nodeUsage(node).unwrap().allocated);
+
+	auto extra = manager.allocateOnNode(node, 256);
+	ASSERT_TRUE(extra.isOk());
+	EXPECT_EQ(1U, manager.nodeUsage(node).unwrap().nbFallbacks);
+	EXPECT_EQ(kPoolSize + 256, manager.size());
+}
+
+TEST(TestNumaMemoryManager, defaultAllocationUsesLocalPool) {
+	NumaMemoryManager manager{NumaMemoryManager::kMaxNodes * kPoolSize};
+	ASSERT_TRUE(manager.reserve(kPoolSize).isOk());
+
+	auto block = manager.allocate(64);
+	ASSERT_TRUE(block.isOk());
+
+	uint64 nbAllocations = 0;
+	for (uint32 i = 0; i < manager.nbNodes(); ++i) {
+		nbAllocations += manager.nodeUsage(manager.nodeId(i)).unwrap().nbAllocations;
+	}
+	EXPECT_EQ(1U, nbAllocations);
+}
+
+TEST(TestNumaMemoryManager, concurrentAllocationsAreAccounted) {
+	NumaMemoryManager manager{NumaMemoryManager::kMaxNodes * kPoolSize + 64 * 1024};
+	ASSERT_TRUE(manager.reserve(kPoolSize).isOk());
+
+	std::vector<std::thread> workers;
+	for (int i = 0; i < 4; ++i) {
+		workers.emplace_back([&manager]() noexcept {
+			for (int j = 0; j < 1000; ++j) {
+				// Some of the allocations exhaust the pool and fall back to the heap
+				auto block = manager.allocate(64 + (j % 8) * 1024);
+				EXPECT_TRUE(block.isOk());
+			}
+		});
+	}
+
+	for (auto& worker : workers) {
+		worker.join();
+	}
+
+	EXPECT_EQ(0U, manager.size());
+	for (uint32 i = 0; i < manager.nbNodes(); ++i) {
+		EXPECT_EQ(0U, manager.nodeUsage(manager.nodeId(i)).unwrap().allocated);
+	}
+}
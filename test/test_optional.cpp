@@ -598,3 +598,61 @@ TEST_F(TestOptional, refTypes) {
 	EXPECT_EQ(3213, valueRef.x_);
 	EXPECT_EQ(1, MoveOnlyType::InstanceCount);
 }
+
+
+namespace {
+
+/// A type with a niche: negative values are never valid.
+struct NonNegative {
+	int value;
+};
+
+}  // namespace
+
+namespace Solace {
+template <>
+struct OptionalNiche<NonNegative> : std::true_type {
+	static constexpr NonNegative none() noexcept { return {-1}; }
+	static constexpr bool isNone(NonNegative const& v) noexcept { return v.value < 0; }
+};
+}  // namespace Solace
+
+
+TEST_F(TestOptional, nicheHasNoOverhead) {
+	static_assert(sizeof(Optional<NonNegative>) == sizeof(NonNegative), "Niche must be used to store optional");
+	static_assert(sizeof(Optional<Error>) == sizeof(Error), "Niche must be used to store optional");
+
+	Optional<NonNegative> maybeValue;
+	EXPECT_TRUE(maybeValue.isNone());
+
+	maybeValue = NonNegative{17};
+	ASSERT_TRUE(maybeValue.isSome());
+	EXPECT_EQ(17, maybeValue.get().value);
+
+	Optional<NonNegative> other;
+	other.swap(maybeValue);
+	EXPECT_TRUE(maybeValue.isNone());
+	ASSERT_TRUE(other.isSome());
+	EXPECT_EQ(17, other.get().value);
+
+	other = none;
+	EXPECT_TRUE(other.isNone());
+	EXPECT_THROW(other.get(), Exception);
+}
+
+
+TEST_F(TestOptional, nicheValueIsNone) {
+	auto const maybeValue = Optional<NonNegative>{NonNegative{-5}};
+	EXPECT_TRUE(maybeValue.isNone());
+}
+
+
+TEST_F(TestOptional, errorNiche) {
+	Optional<Error> maybeError;
+	EXPECT_TRUE(maybeError.isNone());
+
+	maybeError = Error{atom("test"), 0, "zero code"};
+	ASSERT_TRUE(maybeError.isSome());
+	EXPECT_EQ(0, maybeError.get().value());
+	EXPECT_EQ(atom("test"), maybeError.get().domain());
+}
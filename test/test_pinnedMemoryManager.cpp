@@ -0,0 +1,182 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/test_pinnedMemoryManager.cpp
+ *	@brief		Test suit for the pinned memory manager
+ ******************************************************************************/
+#include <solace/pinnedMemoryManager.hpp>  // Class being tested
+
+#include <gtest/gtest.h>
+
+using namespace Solace;
+
+
+namespace {
+
+// Keep the arena small to stay within the default RLIMIT_MEMLOCK
+constexpr MemoryManager::size_type kArenaSize = 16 * 1024;
+
+void countFallback(MemoryManager::size_type nbBytes, void* context) noexcept {
+	*static_cast<uint64*>(context) += nbBytes;
+}
+
+}  // namespace
+
+
+TEST(TestPinnedMemoryManager, allocationsBeforeReserveFallBack) {
+	PinnedMemoryManager manager{4096};
+	EXPECT_FALSE(manager.isPinned());
+
+	auto maybeBlock = manager.allocate(128);
+	ASSERT_TRUE(maybeBlock.isOk());
+	EXPECT_EQ(1U, manager.nbFallbackAllocations());
+	EXPECT_EQ(128U, manager.fallbackBytes());
+	EXPECT_EQ(128U, manager.size());
+}
+
+TEST(TestPinnedMemoryManager, reserveValidatesSize) {
+	PinnedMemoryManager manager{kArenaSize};
+	EXPECT_TRUE(manager.reserve(0).isError());
+	EXPECT_TRUE(manager.reserve(kArenaSize + 1).isError());
+	EXPECT_FALSE(manager.isPinned());
+}
+
+TEST(TestPinnedMemoryManager, reserveRejectsPageRoundingAboveCapacity) {
+	PinnedMemoryManager manager{1000};
+	EXPECT_TRUE(manager.reserve(1000).isError());
+	EXPECT_FALSE(manager.isPinned());
+}
+
+TEST(TestPinnedMemoryManager, roundedAllocationIsChargedAgainstLimit) {
+	constexpr MemoryManager::size_type kCapacity = kArenaSize + 100;
+	PinnedMemoryManager manager{kCapacity};
+	ASSERT_TRUE(manager.reserve(kArenaSize).isOk());
+
+	auto block = manager.allocate(100);
+	ASSERT_TRUE(block.isOk());
+	EXPECT_EQ(128U, block.unwrap().size());
+	EXPECT_EQ(128U, manager.size());
+	EXPECT_EQ(kCapacity - 128, manager.limit());
+
+	// Too large for the rest of the arena: served from the heap, leaving 56 bytes of limit
+	auto large = manager.allocate(kArenaSize - 84);
+	ASSERT_TRUE(large.isOk());
+	EXPECT_EQ(1U, manager.nbFallbackAllocations());
+	EXPECT_EQ(56U, manager.limit());
+
+	// Request fits the limit but its 64 bytes block does not: the arena is not used past capacity
+	auto small = manager.allocate(50);
+	ASSERT_TRUE(small.isOk());
+	EXPECT_EQ(2U, manager.nbFallbackAllocations());
+	EXPECT_EQ(6U, manager.limit());
+}
+
+TEST(TestPinnedMemoryManager, allocationsServedFromArena) {
+	PinnedMemoryManager manager{1024 * 1024};
+	ASSERT_TRUE(manager.reserve(kArenaSize).isOk());
+	ASSERT_TRUE(manager.isPinned());
+	EXPECT_EQ(kArenaSize, manager.arenaCapacity());
+	EXPECT_EQ(kArenaSize, manager.arenaAvailable());
+	{
+		auto first = manager.allocate(100);
+		auto second = manager.allocate(64);
+		ASSERT_TRUE(first.isOk());
+		ASSERT_TRUE(second.isOk());
+		EXPECT_EQ(128U, first.unwrap().size());
+		EXPECT_EQ(64U, second.unwrap().size());
+		EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(first.unwrap().view().dataAddress()) %
+				  PinnedMemoryManager::kAlignment);
+
+		EXPECT_EQ(kArenaSize - 192, manager.arenaAvailable());
+		EXPECT_EQ(192U, manager.size());
+		EXPECT_EQ(0U, manager.nbFallbackAllocations());
+
+		first.unwrap().view().fill(0xAB);
+	}
+
+	EXPECT_EQ(kArenaSize, manager.arenaAvailable());
+	EXPECT_TRUE(manager.empty());
+
+	// Freed blocks are merged back: the whole arena is available as one block
+	auto whole = manager.allocate(kArenaSize);
+	ASSERT_TRUE(whole.isOk());
+	EXPECT_EQ(0U, manager.nbFallbackAllocations());
+}
+
+TEST(TestPinnedMemoryManager, freedBlocksAreReused) {
+	PinnedMemoryManager manager{1024 * 1024};
+	ASSERT_TRUE(manager.reserve(kArenaSize).isOk());
+
+	auto a = manager.allocate(1024).moveResult();
+	auto b = manager.allocate(1024).moveResult();
+	auto c = manager.allocate(1024).moveResult();
+	auto const addressOfB = b.view().dataAddress();
+
+	b = MemoryResource{};
+	auto d = manager.allocate(512).moveResult();
+	EXPECT_EQ(addressOfB, d.view().dataAddress());
+
+	a = MemoryResource{};
+	c = MemoryResource{};
+	d = MemoryResource{};
+	EXPECT_EQ(kArenaSize, manager.arenaAvailable());
+}
+
+TEST(TestPinnedMemoryManager, exhaustedArenaIsReported) {
+	uint64 observed = 0;
+	PinnedMemoryConfig config;
+	config.onFallback = &countFallback;
+	config.fallbackContext = &observed;
+
+	PinnedMemoryManager manager{1024 * 1024, config};
+	ASSERT_TRUE(manager.reserve(kArenaSize).isOk());
+
+	auto arena = manager.allocate(kArenaSize);
+	ASSERT_TRUE(arena.isOk());
+
+	auto overflow = manager.allocate(256);
+	ASSERT_TRUE(overflow.isOk());
+	EXPECT_EQ(1U, manager.nbFallbackAllocations());
+	EXPECT_EQ(256U, manager.fallbackBytes());
+	EXPECT_EQ(256U, observed);
+	EXPECT_EQ(kArenaSize + 256, manager.size());
+}
+
+TEST(TestPinnedMemoryManager, fallbackCanBeDisabled) {
+	PinnedMemoryConfig config;
+	config.allowFallback = false;
+
+	PinnedMemoryManager manager{1024 * 1024, config};
+	ASSERT_TRUE(manager.reserve(kArenaSize).isOk());
+
+	auto arena = manager.allocate(kArenaSize);
+	ASSERT_TRUE(arena.isOk());
+	EXPECT_TRUE(manager.allocate(1).isError());
+	EXPECT_EQ(0U, manager.nbFallbackAllocations());
+}
+
+TEST(TestPinnedMemoryManager, hugePagesRequestFallsBackToNormalPages) {
+	PinnedMemoryConfig config;
+	config.useHugePages = true;
+
+	PinnedMemoryManager manager{4 * 1024 * 1024, config};
+	ASSERT_TRUE(manager.reserve(kArenaSize).isOk());
+	EXPECT_TRUE(manager.isPinned());
+	if (!manager.usesHugePages()) {
+		EXPECT_EQ(kArenaSize, manager.arenaCapacity());
+	}
+}
@@ -0,0 +1,125 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/test_probe.cpp
+ *	@brief		Test suit for latency probes
+ ******************************************************************************/
+#include <solace/probe.hpp>  // Class being tested
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using namespace Solace;
+
+
+namespace {
+
+Optional<ProbeStats> findStats(StringView name) {
+	ProbeStats buffer[kMaxProbes];
+	auto const nbEntries = probeStatsSnapshot(arrayView(buffer));
+	for (uint32 i = 0; i < nbEntries; ++i) {
+		if (buffer[i].name == name) {
+			return buffer[i];
+		}
+	}
+
+	return none;
+}
+
+}  // namespace
+
+
+TEST(TestProbe, registerSameNameReturnsSameId) {
+	auto const id = registerProbe("test.probe.register");
+	EXPECT_NE(kInvalidProbe, id);
+	EXPECT_EQ(id, registerProbe("test.probe.register"));
+	EXPECT_NE(id, registerProbe("test.probe.other"));
+}
+
+TEST(TestProbe, snapshotReportsPercentiles) {
+	auto const id = registerProbe("test.probe.percentiles");
+	probeStatsReset();
+
+	for (uint64 ticks = 1; ticks <= 1000; ++ticks) {
+		recordProbe(id, ticks);
+	}
+
+	auto maybeStats = findStats("test.probe.percentiles");
+	ASSERT_TRUE(maybeStats.isSome());
+
+	auto const& stats = *maybeStats;
+	EXPECT_EQ(1000U, stats.count);
+	EXPECT_LE(stats.minNs, stats.p50Ns);
+	EXPECT_LE(stats.p50Ns, stats.p99Ns);
+	EXPECT_LE(stats.p99Ns, stats.p999Ns);
+	EXPECT_LE(stats.p999Ns, stats.maxNs);
+	EXPECT_LE(stats.p50Ns, stats.meanNs + stats.meanNs / 8);
+
+	// Median of 1..1000 is ~500 ticks and p99.9 is ~1000 ticks, regardless of the tick duration
+	auto const ratio = static_cast<double>(stats.p999Ns) / static_cast<double>(stats.p50Ns);
+	EXPECT_GT(ratio, 1.7);
+	EXPECT_LT(ratio, 2.3);
+}
+
+TEST(TestProbe, snapshotMergesThreads) {
+	auto const id = registerProbe("test.probe.threads");
+	probeStatsReset();
+
+	std::thread threads[4];
+	for (auto& t : threads) {
+		t = std::thread{[id]() noexcept {
+			for (uint64 i = 0; i < 1000; ++i) {
+				recordProbe(id, 100 + i);
+			}
+		}};
+	}
+	for (auto& t : threads) {
+		t.join();
+	}
+
+	auto maybeStats = findStats("test.probe.threads");
+	ASSERT_TRUE(maybeStats.isSome());
+	EXPECT_EQ(4000U, (*maybeStats).count);
+}
+
+TEST(TestProbe, scopedTimerRecordsScope) {
+	auto const id = registerProbe("test.probe.scope");
+	probeStatsReset();
+	{
+		ScopedTimer timer{id};
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	auto maybeStats = findStats("test.probe.scope");
+	ASSERT_TRUE(maybeStats.isSome());
+	EXPECT_EQ(1U, (*maybeStats).count);
+	EXPECT_GE((*maybeStats).maxNs, 900U * 1000U);
+}
+
+TEST(TestProbe, resetClearsHistograms) {
+	auto const id = registerProbe("test.probe.reset");
+	recordProbe(id, 10);
+	recordProbe(kInvalidProbe, 10);  // Ignored
+
+	probeStatsReset();
+
+	auto maybeStats = findStats("test.probe.reset");
+	ASSERT_TRUE(maybeStats.isSome());
+	EXPECT_EQ(0U, (*maybeStats).count);
+	EXPECT_EQ(0U, (*maybeStats).p99Ns);
+}
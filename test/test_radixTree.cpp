@@ -0,0 +1,430 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/test_radixTree.cpp
+ *	@brief		Test suit for Solace::RadixTree
+ ******************************************************************************/
+#include <solace/radixTree.hpp>  // Class being tested
+
+#include "mockTypes.hpp"
+#include "randomSequence.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+
+using namespace Solace;
+
+
+namespace {
+
+inline StringView viewOf(std::string const& str) {
+	return {str.data(), static_cast<StringView::size_type>(str.size())};
+}
+
+/// Random key over a small alphabet, so that keys share prefixes, with occasional arbitrary bytes
+std::string randomKey(uint64& seed) {
+	std::string key;
+	auto const length = nextRandom(seed) % 12;
+	for (uint64 i = 0; i < length; ++i) {
+		auto const r = nextRandom(seed);
+		key.push_back((r % 8 == 0)
+					  ? static_cast<char>(r >> 8)
+					  : static_cast<char>('a' + r % 4));
+	}
+
+	return key;
+}
+
+template<typename Tree>
+void expectSameEntries(Tree const& tree, std::map<std::string, int> const& expected) {
+	ASSERT_EQ(expected.size(), tree.size());
+
+	auto it = expected.begin();
+	for (auto entry : tree) {
+		ASSERT_TRUE(it != expected.end());
+		EXPECT_EQ(viewOf(it->first), entry.key);
+		EXPECT_EQ(it->second, entry.value);
+		++it;
+	}
+	EXPECT_TRUE(it == expected.end());
+}
+
+}  // namespace
+
+
+class TestRadixTree : public ::testing::Test {
+protected:
+	MemoryManager _memoryManager{16 * 1024 * 1024};
+};
+
+
+TEST_F(TestRadixTree, emptyTreeDoesNotAllocate) {
+	RadixTree<int> tree{_memoryManager};
+
+	EXPECT_TRUE(tree.empty());
+	EXPECT_EQ(0U, tree.size());
+	EXPECT_TRUE(tree.begin() == tree.end());
+	EXPECT_TRUE(tree.find("key").isNone());
+	EXPECT_TRUE(tree.find("").isNone());
+	EXPECT_TRUE(tree.withPrefix("").empty());
+	EXPECT_FALSE(tree.erase("key"));
+	EXPECT_EQ(0U, _memoryManager.size());
+}
+
+TEST_F(TestRadixTree, putAndFind) {
+	RadixTree<int> tree{_memoryManager};
+	ASSERT_TRUE(tree.put("romane", 1).isOk());
+	ASSERT_TRUE(tree.put("romanus", 2).isOk());
+	ASSERT_TRUE(tree.put("romulus", 3).isOk());
+	ASSERT_TRUE(tree.put("rubens", 4).isOk());
+
+	EXPECT_EQ(4U, tree.size());
+	EXPECT_EQ(1, *tree.find("romane"));
+	EXPECT_EQ(2, *tree.find("romanus"));
+	EXPECT_EQ(3, *tree.find("romulus"));
+	EXPECT_EQ(4, *tree.find("rubens"));
+	EXPECT_TRUE(tree.find("roman").isNone());
+	EXPECT_TRUE(tree.find("romanes").isNone());
+	EXPECT_TRUE(tree.find("r").isNone());
+	EXPECT_TRUE(tree.find("ruby").isNone());
+	EXPECT_TRUE(tree.contains("rubens"));
+
+	// Value of an existing key is replaced
+	auto maybeValue = tree.put("romulus", 33);
+	ASSERT_TRUE(maybeValue.isOk());
+	EXPECT_EQ(33, maybeValue.unwrap());
+	EXPECT_EQ(4U, tree.size());
+	EXPECT_EQ(33, *tree.find("romulus"));
+
+	*tree.find("rubens") = 44;
+	EXPECT_EQ(44, *tree.find("rubens"));
+}
+
+TEST_F(TestRadixTree, keysThatArePrefixesOfOtherKeys) {
+	RadixTree<int> tree{_memoryManager};
+	ASSERT_TRUE(tree.put("abc", 3).isOk());
+	ASSERT_TRUE(tree.put("a", 1).isOk());
+	ASSERT_TRUE(tree.put("abcd", 4).isOk());
+	ASSERT_TRUE(tree.put("", 0).isOk());
+	ASSERT_TRUE(tree.put("ab", 2).isOk());
+
+	for (int i = 0; i <= 4; ++i) {
+		auto const key = StringView{"abcd"}.substring(0, static_cast<StringView::size_type>(i));
+		ASSERT_TRUE(tree.find(key).isSome());
+		EXPECT_EQ(i, *tree.find(key));
+	}
+
+	int expected = 0;
+	for (auto entry : tree) {
+		EXPECT_EQ(expected, entry.value);
+		EXPECT_EQ(static_cast<StringView::size_type>(expected), entry.key.size());
+		++expected;
+	}
+	EXPECT_EQ(5, expected);
+
+	EXPECT_TRUE(tree.erase("ab"));
+	EXPECT_TRUE(tree.erase(""));
+	EXPECT_FALSE(tree.erase("ab"));
+	EXPECT_TRUE(tree.find("ab").isNone());
+	EXPECT_EQ(3, *tree.find("abc"));
+	EXPECT_EQ(4, *tree.find("abcd"));
+	EXPECT_EQ(3U, tree.size());
+}
+
+TEST_F(TestRadixTree, compressedPathIsSplitAndRejoined) {
+	RadixTree<int> tree{_memoryManager};
+	ASSERT_TRUE(tree.put("abcdefgh", 1).isOk());
+	auto const singleKeyMemory = tree.memoryUsed();
+
+	// Key diverging within the shared path splits it at the first different byte
+	ASSERT_TRUE(tree.put("abcdxyz", 2).isOk());
+	EXPECT_LT(singleKeyMemory, tree.memoryUsed());
+	EXPECT_EQ(1, *tree.find("abcdefgh"));
+	EXPECT_EQ(2, *tree.find("abcdxyz"));
+	EXPECT_TRUE(tree.find("abcd").isNone());
+	EXPECT_TRUE(tree.find("abcdX").isNone());
+	EXPECT_TRUE(tree.find("abcdefg").isNone());
+	EXPECT_TRUE(tree.find("abcdefghi").isNone());
+	EXPECT_TRUE(tree.find("abXdefgh").isNone());
+
+	// Key ending at the split point is stored in the branching node
+	ASSERT_TRUE(tree.put("abcd", 3).isOk());
+	ASSERT_TRUE(tree.put("abcdxy", 4).isOk());
+	EXPECT_EQ(3, *tree.find("abcd"));
+	EXPECT_EQ(4, *tree.find("abcdxy"));
+	EXPECT_EQ(4U, tree.size());
+
+	// Removing the branches joins the path back into a single leaf
+	EXPECT_TRUE(tree.erase("abcdxy"));
+	EXPECT_TRUE(tree.erase("abcd"));
+	EXPECT_TRUE(tree.erase("abcdxyz"));
+	EXPECT_EQ(1U, tree.size());
+	EXPECT_EQ(1, *tree.find("abcdefgh"));
+	EXPECT_EQ(singleKeyMemory, tree.memoryUsed());
+}
+
+TEST_F(TestRadixTree, prefixLookupWithinCompressedPath) {
+	RadixTree<int> tree{_memoryManager};
+	ASSERT_TRUE(tree.put("interstellar", 1).isOk());
+	ASSERT_TRUE(tree.put("internal", 2).isOk());
+	ASSERT_TRUE(tree.put("internet", 3).isOk());
+
+	auto count = [&tree](StringView prefix) {
+		int n = 0;
+		for (auto entry : tree.withPrefix(prefix)) {
+			EXPECT_TRUE(entry.key.startsWith(prefix));
+			++n;
+		}
+		return n;
+	};
+
+	// Prefix ending in the middle of a compressed path, at a branch and inside a leaf
+	EXPECT_EQ(3, count("in"));
+	EXPECT_EQ(3, count("inter"));
+	EXPECT_EQ(2, count("intern"));
+	EXPECT_EQ(1, count("interne"));
+	EXPECT_EQ(1, count("inters"));
+	EXPECT_EQ(1, count("interstellar"));
+	EXPECT_EQ(0, count("interstellars"));
+	EXPECT_EQ(0, count("inx"));
+	EXPECT_EQ(0, count("interx"));
+}
+
+TEST_F(TestRadixTree, keysAreOrderedByUnsignedBytes) {
+	RadixTree<int> tree{_memoryManager};
+	char const high[] = {static_cast<char>(0xF0), 'x'};
+	char const zero[] = {'\0', 'x'};
+	ASSERT_TRUE(tree.put(StringView{high, 2}, 3).isOk());
+	ASSERT_TRUE(tree.put("x", 2).isOk());
+	ASSERT_TRUE(tree.put(StringView{zero, 2}, 1).isOk());
+
+	int expected = 1;
+	for (auto entry : tree) {
+		EXPECT_EQ(expected++, entry.value);
+	}
+	EXPECT_EQ(4, expected);
+}
+
+TEST_F(TestRadixTree, nodesGrowToAllByteValues) {
+	RadixTree<int> tree{_memoryManager};
+	std::map<std::string, int> expected;
+
+	// Every byte value after a shared prefix: Node4 grows up to Node256
+	for (int i = 0; i < 256; ++i) {
+		std::string key{"node/"};
+		key.push_back(static_cast<char>((i * 37) % 256));
+		ASSERT_TRUE(tree.put(viewOf(key), i).isOk());
+		expected[key] = i;
+
+		auto value = tree.find(viewOf(key));
+		ASSERT_TRUE(value.isSome());
+		ASSERT_EQ(i, *value);
+	}
+
+	expectSameEntries(tree, expected);
+
+	// And shrink back as children are removed
+	for (int i = 0; i < 255; ++i) {
+		std::string key{"node/"};
+		key.push_back(static_cast<char>((i * 37) % 256));
+		ASSERT_TRUE(tree.erase(viewOf(key)));
+		expected.erase(key);
+	}
+
+	expectSameEntries(tree, expected);
+}
+
+TEST_F(TestRadixTree, randomInsertAndEraseMatchStdMap) {
+	RadixTree<int> tree{_memoryManager};
+	std::map<std::string, int> expected;
+
+	uint64 seed = 7;
+	for (int i = 0; i < 20000; ++i) {
+		auto const key = randomKey(seed);
+		if (nextRandom(seed) % 3 == 0) {
+			EXPECT_EQ(expected.erase(key) != 0, tree.erase(viewOf(key)));
+		} else {
+			ASSERT_TRUE(tree.put(viewOf(key), i).isOk());
+			expected[key] = i;
+		}
+	}
+
+	expectSameEntries(tree, expected);
+	for (auto const& entry : expected) {
+		auto value = tree.find(viewOf(entry.first));
+		ASSERT_TRUE(value.isSome());
+		EXPECT_EQ(entry.second, *value);
+	}
+
+	// Erase everything: all memory returns to the arena
+	for (auto const& entry : expected) {
+		ASSERT_TRUE(tree.erase(viewOf(entry.first)));
+	}
+	EXPECT_TRUE(tree.empty());
+	EXPECT_TRUE(tree.begin() == tree.end());
+	EXPECT_EQ(0U, tree.memoryUsed());
+}
+
+TEST_F(TestRadixTree, prefixIteration) {
+	RadixTree<int> tree{_memoryManager};
+	char const* const paths[] = {
+		"/usr/bin/env", "/usr/lib/libc.so", "/usr/lib/libm.so", "/usr/local/bin/tool",
+		"/etc/hosts", "/etc/passwd", "/usr/lib", "/var/log/messages"
+	};
+
+	int i = 0;
+	for (auto path : paths) {
+		ASSERT_TRUE(tree.put(path, i++).isOk());
+	}
+
+	auto collect = [&tree](StringView prefix) {
+		std::string result;
+		for (auto entry : tree.withPrefix(prefix)) {
+			result.append(entry.key.data(), entry.key.size());
+			result.push_back(';');
+		}
+		return result;
+	};
+
+	EXPECT_EQ("/usr/lib;/usr/lib/libc.so;/usr/lib/libm.so;", collect("/usr/lib"));
+	EXPECT_EQ("/usr/lib/libc.so;/usr/lib/libm.so;", collect("/usr/lib/"));
+	EXPECT_EQ("/usr/lib;/usr/lib/libc.so;/usr/lib/libm.so;/usr/local/bin/tool;", collect("/usr/l"));
+	EXPECT_EQ("/etc/hosts;/etc/passwd;", collect("/etc/"));
+	EXPECT_EQ("/etc/passwd;", collect("/etc/pa"));
+	EXPECT_EQ("/var/log/messages;", collect("/var/log/messages"));
+	EXPECT_EQ("", collect("/var/log/messages/"));
+	EXPECT_EQ("", collect("/opt"));
+	EXPECT_EQ("", collect("/usr/lib/libz"));
+	auto const all = collect("");
+	EXPECT_EQ(8, std::count(all.begin(), all.end(), ';'));
+}
+
+TEST_F(TestRadixTree, memoryIsProportionalToKeyBytes) {
+	RadixTree<uint32> tree{_memoryManager};
+
+	// Long keys sharing a long prefix: the prefix is stored once per node, not per level
+	std::string key(1000, 'p');
+	size_t keyBytes = 0;
+	for (uint32 i = 0; i < 100; ++i) {
+		key.replace(key.size() - 3, 3, std::to_string(100 + i));
+		ASSERT_TRUE(tree.put(viewOf(key), i).isOk());
+		keyBytes += key.size();
+	}
+
+	EXPECT_LT(tree.memoryUsed(), 2 * keyBytes);
+}
+
+TEST_F(TestRadixTree, valuesAreDestroyed) {
+	ASSERT_EQ(0, SimpleType::InstanceCount);
+	{
+		RadixTree<SimpleType> tree{_memoryManager};
+		uint64 seed = 3;
+		for (int i = 0; i < 300; ++i) {
+			auto const key = std::to_string(nextRandom(seed));
+			ASSERT_TRUE(tree.put(viewOf(key), i, 0, 0).isOk());
+		}
+		EXPECT_EQ(static_cast<int>(tree.size()), SimpleType::InstanceCount);
+
+		ASSERT_TRUE(tree.put("key", 1, 2, 3).isOk());
+		ASSERT_TRUE(tree.put("key", 4, 5, 6).isOk());
+		EXPECT_EQ(4, (*tree.find("key")).x);
+		EXPECT_TRUE(tree.erase("key"));
+		EXPECT_EQ(static_cast<int>(tree.size()), SimpleType::InstanceCount);
+	}
+
+	EXPECT_EQ(0, SimpleType::InstanceCount);
+	EXPECT_EQ(0U, _memoryManager.size());
+}
+
+TEST_F(TestRadixTree, failedReplaceKeepsExistingValue) {
+	/// Value counting its live instances that can not be constructed from a negative number
+	struct Checked {
+		Checked(int x, int& nbLive) : value{x}, liveCounter{&nbLive} {
+			if (x < 0) {
+				raise<IllegalArgumentException>("x");
+			}
+			*liveCounter += 1;
+		}
+
+		Checked(Checked&& other) noexcept : value{other.value}, liveCounter{other.liveCounter} {
+			*liveCounter += 1;
+		}
+
+		Checked& operator= (Checked&& other) noexcept {
+			value = other.value;
+			return *this;
+		}
+
+		~Checked() {
+			*liveCounter -= 1;
+		}
+
+		int value;
+		int* liveCounter;
+	};
+
+	int nbLive = 0;
+	{
+		RadixTree<Checked> tree{_memoryManager};
+		ASSERT_TRUE(tree.put("key", 1, nbLive).isOk());
+		ASSERT_TRUE(tree.put("keys", 2, nbLive).isOk());  // "key" is now stored in an inner node
+		ASSERT_TRUE(tree.put("leaf", 3, nbLive).isOk());
+		EXPECT_EQ(3, nbLive);
+
+		EXPECT_THROW(tree.put("key", -1, nbLive), IllegalArgumentException);
+		EXPECT_THROW(tree.put("leaf", -1, nbLive), IllegalArgumentException);
+		EXPECT_EQ(3, nbLive);
+		EXPECT_EQ(1, (*tree.find("key")).value);
+		EXPECT_EQ(3, (*tree.find("leaf")).value);
+
+		ASSERT_TRUE(tree.put("key", 10, nbLive).isOk());
+		ASSERT_TRUE(tree.put("leaf", 30, nbLive).isOk());
+		EXPECT_EQ(3, nbLive);
+		EXPECT_EQ(10, (*tree.find("key")).value);
+		EXPECT_EQ(30, (*tree.find("leaf")).value);
+	}
+	EXPECT_EQ(0, nbLive);
+}
+
+TEST_F(TestRadixTree, moveTransfersEntries) {
+	RadixTree<int> tree{_memoryManager};
+	ASSERT_TRUE(tree.put("one", 1).isOk());
+	ASSERT_TRUE(tree.put("two", 2).isOk());
+
+	RadixTree<int> other{mv(tree)};
+	EXPECT_TRUE(tree.empty());
+	EXPECT_TRUE(tree.find("one").isNone());
+	EXPECT_EQ(2U, other.size());
+	EXPECT_EQ(2, *other.find("two"));
+
+	other.clear();
+	EXPECT_TRUE(other.empty());
+	EXPECT_EQ(0U, _memoryManager.size());
+	ASSERT_TRUE(other.put("three", 3).isOk());
+	EXPECT_EQ(3, *other.find("three"));
+}
+
+TEST_F(TestRadixTree, allocationFailureIsReported) {
+	MemoryManager tinyManager{64};
+	RadixTree<int> tree{tinyManager};
+
+	EXPECT_TRUE(tree.put("key", 1).isError());
+	EXPECT_TRUE(tree.empty());
+}
@@ -184,6 +184,19 @@ TEST_F(TestResult, testVoidFailure) {
 }
 
 
+TEST_F(TestResult, voidResultUsesErrorNiche) {
+	static_assert(sizeof(Result<void, Error>) == sizeof(Error), "Result<void, Error> must be as small as Error");
+
+	Result<void, Error> ok = Ok();
+	EXPECT_TRUE(ok.isOk());
+
+	// Error code 0 is a valid error code: BasicError::Overflow
+	Result<void, Error> r = makeError(BasicError::Overflow, "voidResultUsesErrorNiche");
+	ASSERT_TRUE(r.isError());
+	EXPECT_EQ(0, r.getError().value());
+}
+
+
 TEST_F(TestResult, testTypeConvertion) {
     {
         Result<int, Unit> r = Ok(10);
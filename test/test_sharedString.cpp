@@ -0,0 +1,156 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ * @file: test/test_sharedString.cpp
+ * @brief Test suit for Solace::SharedString
+ *******************************************************************************/
+#include <solace/sharedString.hpp>  // Class being tested
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+using namespace Solace;
+
+
+TEST(TestSharedString, emptyString) {
+	SharedString str;
+	EXPECT_TRUE(str.empty());
+	EXPECT_EQ(0U, str.size());
+	EXPECT_EQ(0U, str.useCount());
+	EXPECT_EQ(StringView{}, str.view());
+
+	auto maybeEmpty = makeSharedString(StringView{});
+	ASSERT_TRUE(maybeEmpty.isOk());
+	EXPECT_TRUE(maybeEmpty.unwrap().empty());
+}
+
+TEST(TestSharedString, literalIsNotCopied) {
+	static constexpr char kText[] = "literal";
+	auto str = makeSharedString(StringLiteral{kText});
+
+	EXPECT_EQ(kText, str.view().data());
+	EXPECT_EQ(0U, str.useCount());
+	EXPECT_EQ("literal", str);
+}
+
+TEST(TestSharedString, makeFromViewCopiesOnce) {
+	MemoryManager memoryManager{4096};
+	char text[] = "some text";
+	{
+		auto maybeStr = makeSharedString(memoryManager, StringView{text});
+		ASSERT_TRUE(maybeStr.isOk());
+		text[0] = 'S';
+
+		auto& str = maybeStr.unwrap();
+		EXPECT_EQ("some text", str);
+		EXPECT_EQ(1U, str.useCount());
+		EXPECT_FALSE(memoryManager.empty());
+	}
+	EXPECT_TRUE(memoryManager.empty());
+}
+
+TEST(TestSharedString, copiesShareBuffer) {
+	MemoryManager memoryManager{4096};
+	{
+		auto str = makeSharedString(memoryManager, "shared content").moveResult();
+		{
+			SharedString copy{str};
+			EXPECT_EQ(2U, str.useCount());
+			EXPECT_EQ(str.view().data(), copy.view().data());
+			EXPECT_EQ(str, copy);
+
+			SharedString other;
+			other = copy;
+			EXPECT_EQ(3U, str.useCount());
+
+			SharedString moved{mv(other)};
+			EXPECT_TRUE(other.empty());
+			EXPECT_EQ(3U, str.useCount());
+		}
+		EXPECT_EQ(1U, str.useCount());
+		EXPECT_FALSE(memoryManager.empty());
+	}
+	EXPECT_TRUE(memoryManager.empty());
+}
+
+TEST(TestSharedString, substringKeepsParentAlive) {
+	MemoryManager memoryManager{4096};
+	SharedString tail;
+	{
+		auto str = makeSharedString(memoryManager, "key=value").moveResult();
+		auto key = str.substring(0, 3);
+		tail = str.substring(4);
+
+		EXPECT_EQ("key", key);
+		EXPECT_EQ("value", tail);
+		EXPECT_EQ(str.view().data() + 4, tail.view().data());
+		EXPECT_EQ(3U, str.useCount());
+
+		// Out of range bounds are clamped
+		EXPECT_TRUE(str.substring(20).empty());
+		EXPECT_EQ("value", str.substring(4, 100));
+	}
+	EXPECT_FALSE(memoryManager.empty());
+	EXPECT_EQ(1U, tail.useCount());
+	EXPECT_EQ("value", tail);
+
+	tail = SharedString{};
+	EXPECT_TRUE(memoryManager.empty());
+}
+
+TEST(TestSharedString, convertsToAndFromString) {
+	auto str = makeString("converted").unwrap();
+	auto shared = makeSharedString(str).moveResult();
+	EXPECT_EQ(str.view(), shared.view());
+	EXPECT_NE(str.view().data(), shared.view().data());
+
+	auto back = makeString(shared).unwrap();
+	EXPECT_EQ(back, shared.view());
+	EXPECT_EQ(str.hashCode(), shared.hashCode());
+}
+
+TEST(TestSharedString, compare) {
+	auto str = makeSharedString("abc").moveResult();
+	EXPECT_TRUE(str.startsWith("ab"));
+	EXPECT_TRUE(str.endsWith("bc"));
+	EXPECT_EQ(0, str.compareTo("abc"));
+	EXPECT_NE(str, makeSharedString("abd").unwrap());
+	EXPECT_NE(str, "ab");
+}
+
+TEST(TestSharedString, copiesFromManyThreads) {
+	auto str = makeSharedString("shared between threads").moveResult();
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t) {
+		threads.emplace_back([&str]() {
+			for (int i = 0; i < 10000; ++i) {
+				SharedString copy{str};
+				auto sub = copy.substring(7, 7);
+				ASSERT_EQ("between", sub);
+			}
+		});
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	EXPECT_EQ(1U, str.useCount());
+}
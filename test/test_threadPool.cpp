@@ -0,0 +1,238 @@
+/*
+*  Copyright 2016 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libSolace Unit Test Suit
+ *	@file test/test_threadPool.cpp
+ *	@brief		Test suit for the work-stealing thread pool
+ ******************************************************************************/
+#include <solace/threadPool.hpp>    // Class being tested.
+#include <solace/posixErrorDomain.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+using namespace Solace;
+
+
+namespace {
+
+ThreadPool makeTestPool(MemoryManager& manager, ThreadPoolConfig const& config = {}) {
+	auto maybePool = makeThreadPool(manager, config);
+	EXPECT_TRUE(maybePool.isOk());
+
+	return maybePool.moveResult();
+}
+
+uint64 fib(ThreadPool& pool, uint64 n) {
+	if (n < 2) {
+		return n;
+	}
+
+	auto maybeLeft = pool.submit([&pool, n]() { return fib(pool, n - 1); });
+	auto const right = fib(pool, n - 2);
+	if (!maybeLeft) {  // Out of frames: compute inline
+		return fib(pool, n - 1) + right;
+	}
+
+	return maybeLeft.unwrap().get().unwrap() + right;
+}
+
+}  // namespace
+
+
+class TestThreadPool : public ::testing::Test {
+protected:
+	MemoryManager	_memoryManager{1 << 24};
+};
+
+
+TEST_F(TestThreadPool, defaultSizeFromOnlineCpus) {
+	auto pool = makeTestPool(_memoryManager);
+	EXPECT_GT(pool.size(), 0U);
+
+	ThreadPoolConfig config;
+	config.nbWorkers = 3;
+	auto pool3 = makeTestPool(_memoryManager, config);
+	EXPECT_EQ(3U, pool3.size());
+}
+
+TEST_F(TestThreadPool, invalidConfigurationIsAnError) {
+	ThreadPoolConfig config;
+	config.dequeCapacity = 1000;
+	EXPECT_TRUE(makeThreadPool(_memoryManager, config).isError());
+
+	config = {};
+	config.nbTaskFrames = 0;
+	EXPECT_TRUE(makeThreadPool(_memoryManager, config).isError());
+
+	EXPECT_TRUE(_memoryManager.empty());
+}
+
+TEST_F(TestThreadPool, submitReturnsValue) {
+	auto pool = makeTestPool(_memoryManager);
+
+	auto maybeHandle = pool.submit([]() { return 42; });
+	ASSERT_TRUE(maybeHandle.isOk());
+
+	auto result = maybeHandle.unwrap().get();
+	ASSERT_TRUE(result.isOk());
+	EXPECT_EQ(42, result.unwrap());
+}
+
+TEST_F(TestThreadPool, handleOutlivesMovedFromPool) {
+	auto pool = makeTestPool(_memoryManager);
+
+	auto maybeHandle = pool.submit([]() { return 17; });
+	ASSERT_TRUE(maybeHandle.isOk());
+
+	{
+		ThreadPool moved{mv(pool)};
+		auto handle = maybeHandle.moveResult();
+		EXPECT_EQ(17, handle.get().unwrap());
+
+		// Handle released without taking the result after the pool has been moved again
+		auto other = moved.submit([]() { return 1; });
+		ASSERT_TRUE(other.isOk());
+		pool = mv(moved);
+	}
+
+	EXPECT_EQ(2, pool.submit([]() { return 2; }).unwrap().get().unwrap());
+}
+
+TEST_F(TestThreadPool, submitPropagatesErrors) {
+	auto pool = makeTestPool(_memoryManager);
+
+	auto maybeHandle = pool.submit([]() -> Result<int, Error> {
+		return makeError(GenericError::INVAL, "test");
+	});
+	ASSERT_TRUE(maybeHandle.isOk());
+
+	auto result = maybeHandle.unwrap().get();
+	ASSERT_TRUE(result.isError());
+	EXPECT_EQ(makeError(GenericError::INVAL, "test"), result.getError());
+}
+
+TEST_F(TestThreadPool, submitVoidTask) {
+	auto pool = makeTestPool(_memoryManager);
+
+	std::atomic<int> counter{0};
+	auto maybeHandle = pool.submit([&counter]() { counter.fetch_add(1); });
+	ASSERT_TRUE(maybeHandle.isOk());
+	EXPECT_TRUE(maybeHandle.unwrap().get().isOk());
+	EXPECT_EQ(1, counter.load());
+}
+
+TEST_F(TestThreadPool, destructionWaitsForDetachedTasks) {
+	std::atomic<int> counter{0};
+	{
+		auto pool = makeTestPool(_memoryManager);
+		for (int i = 0; i < 1000; ++i) {
+			while (!pool.execute([&counter]() { counter.fetch_add(1); })) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	EXPECT_EQ(1000, counter.load());
+	EXPECT_TRUE(_memoryManager.empty());
+}
+
+TEST_F(TestThreadPool, forkJoinFromWorkers) {
+	ThreadPoolConfig config;
+	config.nbWorkers = 4;
+	auto pool = makeTestPool(_memoryManager, config);
+
+	auto maybeHandle = pool.submit([&pool]() { return fib(pool, 20); });
+	ASSERT_TRUE(maybeHandle.isOk());
+	EXPECT_EQ(6765U, maybeHandle.unwrap().get().unwrap());
+}
+
+TEST_F(TestThreadPool, outOfFramesIsAnError) {
+	ThreadPoolConfig config;
+	config.nbWorkers = 2;
+	config.nbTaskFrames = 2;
+	auto pool = makeTestPool(_memoryManager, config);
+
+	std::atomic<bool> release{false};
+	auto blocker = [&release]() {
+		while (!release.load()) {
+			std::this_thread::yield();
+		}
+	};
+
+	auto first = pool.submit(blocker);
+	auto second = pool.submit(blocker);
+	ASSERT_TRUE(first.isOk());
+	ASSERT_TRUE(second.isOk());
+
+	auto third = pool.submit([]() { return 1; });
+	ASSERT_TRUE(third.isError());
+	EXPECT_EQ(makeError(GenericError::AGAIN, "ThreadPool::allocateFrame"), third.getError());
+
+	release.store(true);
+	EXPECT_TRUE(first.unwrap().get().isOk());
+	EXPECT_TRUE(second.unwrap().get().isOk());
+
+	// Frames are returned into the pool once results are taken
+	auto fourth = pool.submit([]() { return 4; });
+	ASSERT_TRUE(fourth.isOk());
+	EXPECT_EQ(4, fourth.unwrap().get().unwrap());
+}
+
+TEST_F(TestThreadPool, parallelForCoversRange) {
+	ThreadPoolConfig config;
+	config.nbWorkers = 4;
+	config.pinWorkers = true;
+	auto pool = makeTestPool(_memoryManager, config);
+
+	std::atomic<uint64> sum{0};
+	std::atomic<uint32> nbCalls{0};
+	auto result = pool.parallelFor(10, 10010, 64, [&](uint64 from, uint64 to) {
+		uint64 localSum = 0;
+		for (auto i = from; i < to; ++i) {
+			localSum += i;
+		}
+
+		sum.fetch_add(localSum);
+		nbCalls.fetch_add(1);
+	});
+
+	ASSERT_TRUE(result.isOk());
+	EXPECT_EQ(50095000U, sum.load());
+	EXPECT_EQ(157U, nbCalls.load());
+
+	EXPECT_TRUE(pool.parallelFor(5, 5, 1, [](uint64, uint64) {}).isOk());
+}
+
+TEST_F(TestThreadPool, parallelForStopsOnError) {
+	auto pool = makeTestPool(_memoryManager);
+
+	std::atomic<uint32> nbCalls{0};
+	auto result = pool.parallelFor(0, 100000, 1, [&](uint64 from, uint64) -> Result<void, Error> {
+		nbCalls.fetch_add(1);
+		if (from == 10) {
+			return makeError(GenericError::RANGE, "chunk");
+		}
+
+		return Ok();
+	});
+
+	ASSERT_TRUE(result.isError());
+	EXPECT_EQ(makeError(GenericError::RANGE, "chunk"), result.getError());
+	EXPECT_LT(nbCalls.load(), 100000U);
+}
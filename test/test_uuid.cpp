@@ -192,3 +192,24 @@ TEST(TestUUID, testContainerReq) {
         }
     }
 }
+
+
+TEST(TestUUID, hashCodeSpreadsSequentialIds) {
+    // Time-based UUIDs of consecutive timestamps differ in a single byte
+    byte bytes[UUID::StaticSize] = {0x01, 0x8f, 0x3a, 0x7c, 0x20, 0x00, 0x70, 0x00,
+                                    0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01};
+
+    std::vector<bool> lowBytesSeen(256, false);
+    uint32 nbDistinct = 0;
+    for (uint32 i = 0; i < 256; ++i) {
+        bytes[5] = static_cast<byte>(i);
+        auto const lowByte = UUID{bytes}.hashCode() & 0xFF;
+        if (!lowBytesSeen[lowByte]) {
+            lowBytesSeen[lowByte] = true;
+            nbDistinct += 1;
+        }
+    }
+
+    // Unmixed bytes would all share the same low byte
+    EXPECT_LT(100U, nbDistinct);
+}